@@ -1,8 +1,11 @@
+use crate::python_bridge;
 use serde::Serialize;
-use std::thread;
-use std::time::Duration;
+use serde_json::{json, Map, Value};
 use tauri::{AppHandle, Emitter};
 
+/// Default output directory when the UI does not pick one
+const DEFAULT_TARGET_DIR: &str = "backups";
+
 #[derive(Serialize, Clone, Debug)]
 pub struct BackupPayload {
     pub task_id: String,
@@ -11,17 +14,88 @@ pub struct BackupPayload {
     pub speed: String,
     pub eta: String,
     pub msg: String,
+    // Measured by the Python backup service (BackupTelemetry)
+    pub bytes_done: u64,
+    pub bytes_total: u64,
+    pub bytes_per_second: f64,
+    pub eta_seconds: Option<f64>,
+    pub phase_seconds: Map<String, Value>,
+}
+
+impl BackupPayload {
+    /// Map one Python telemetry dict onto the IPC payload
+    fn from_telemetry(task_id: &str, event: &Value) -> Self {
+        let bytes_per_second = event["bytes_per_second"].as_f64().unwrap_or(0.0);
+        let eta_seconds = event["eta_seconds"].as_f64();
+        BackupPayload {
+            task_id: task_id.to_string(),
+            phase: event["phase"].as_str().unwrap_or("init").to_string(),
+            progress: event["percent"].as_f64().unwrap_or(0.0),
+            speed: format_speed(bytes_per_second),
+            eta: format_eta(eta_seconds),
+            msg: event["message"].as_str().unwrap_or_default().to_string(),
+            bytes_done: event["bytes_done"].as_u64().unwrap_or(0),
+            bytes_total: event["bytes_total"].as_u64().unwrap_or(0),
+            bytes_per_second,
+            eta_seconds,
+            phase_seconds: event["phase_seconds"]
+                .as_object()
+                .cloned()
+                .unwrap_or_default(),
+        }
+    }
+
+    fn error(task_id: &str, msg: String) -> Self {
+        BackupPayload {
+            task_id: task_id.to_string(),
+            phase: "error".to_string(),
+            progress: 0.0,
+            speed: format_speed(0.0),
+            eta: String::new(),
+            msg,
+            bytes_done: 0,
+            bytes_total: 0,
+            bytes_per_second: 0.0,
+            eta_seconds: None,
+            phase_seconds: Map::new(),
+        }
+    }
+}
+
+/// Binary units, like the service's own progress messages
+fn format_speed(bytes_per_second: f64) -> String {
+    format!("{:.1} MiB/s", bytes_per_second / (1024.0 * 1024.0))
+}
+
+fn format_eta(eta_seconds: Option<f64>) -> String {
+    match eta_seconds {
+        Some(secs) => format!("{}s", secs.ceil() as u64),
+        None => "CALC...".to_string(),
+    }
+}
+
+/// Missing and empty passkeys are both refused: an empty passphrase
+/// would still "encrypt" the vault, under a key anyone can derive
+fn require_passkey(passkey: Option<String>) -> Result<String, String> {
+    match passkey {
+        Some(p) if !p.is_empty() => Ok(p),
+        _ => Err("Backup requires the vault passkey".to_string()),
+    }
 }
 
 /// OMEGA PROTOCOL: Hybrid Command-Init → Event-Stream
 ///
-/// Returns TaskID immediately, spawns worker thread for actual backup.
-/// Worker emits `backup_progress` events to single global channel.
+/// Returns TaskID immediately; the backup runs in the Python backup
+/// service on the bridge worker pool. Every progress report of the
+/// service (already throttled there to ~10/s, plus phase changes) is
+/// emitted as a `backup_progress` event on the single global channel.
 #[tauri::command]
 pub async fn cmd_backup_start(
     app: AppHandle,
-    _target_dir: Option<String>,
+    target_dir: Option<String>,
+    passkey: Option<String>,
 ) -> Result<String, String> {
+    let passkey = require_passkey(passkey)?;
     let task_id = format!(
         "OMEGA-{}",
         std::time::SystemTime::now()
@@ -29,64 +103,90 @@ pub async fn cmd_backup_start(
             .unwrap_or_default()
             .as_millis()
     );
+    let payload = json!({
+        "task_id": task_id,
+        "target_dir": target_dir.unwrap_or_else(|| DEFAULT_TARGET_DIR.to_string()),
+        "passkey": passkey,
+    });
+
     let app_handle = app.clone();
     let tid = task_id.clone();
 
-    // Spawn worker thread (Hybrid Flow - return immediately)
-    thread::spawn(move || {
-        let emit = |phase: &str, prog: f64, eta: &str, msg: &str| {
-            let payload = BackupPayload {
-                task_id: tid.clone(),
-                phase: phase.to_string(),
-                progress: prog,
-                speed: if prog < 100.0 {
-                    "45 MB/s".to_string()
-                } else {
-                    "0 MB/s".to_string()
-                },
-                eta: eta.to_string(),
-                msg: msg.to_string(),
-            };
-            // SINGLE GLOBAL CHANNEL (ADR-008 Rule #4)
-            let _ = app_handle.emit("backup_progress", payload);
-        };
-
-        // Phase 1: INIT
-        emit("init", 0.0, "CALC...", "Initializing Omega Engine...");
-        thread::sleep(Duration::from_millis(800));
-
-        // Phase 2: SNAPSHOT
-        emit(
-            "snapshot",
-            10.0,
-            "15s",
-            "Taking atomic snapshot (VACUUM INTO)...",
-        );
-        thread::sleep(Duration::from_millis(1000));
-
-        // Phase 3: ENCRYPTING (Loop with progress events)
-        for i in 11..=90 {
-            if i % 5 == 0 {
-                let remaining = 90 - i;
-                let eta = format!("{}-{}s", remaining / 10, remaining / 8);
-                emit(
-                    "encrypting",
-                    i as f64,
-                    &eta,
-                    &format!("Encrypting chunk #{}...", i),
+    // Worker pool (Hybrid Flow - return immediately)
+    tauri::async_runtime::spawn_blocking(move || {
+        let progress_app = app_handle.clone();
+        let progress_tid = tid.clone();
+        let result = python_bridge::dispatch_to_python_with_progress(
+            "backup.start",
+            payload,
+            move |event| {
+                // SINGLE GLOBAL CHANNEL (ADR-008 Rule #4)
+                let _ = progress_app.emit(
+                    "backup_progress",
+                    BackupPayload::from_telemetry(&progress_tid, &event),
                 );
-            }
-            thread::sleep(Duration::from_millis(50));
-        }
-
-        // Phase 4: FINALIZE
-        emit("finalizing", 95.0, "1-2s", "Verifying Poly1305 MAC...");
-        thread::sleep(Duration::from_millis(800));
+            },
+        );
 
-        // Phase 5: DONE
-        emit("done", 100.0, "0s", "Backup secured successfully.");
+        // Success already ended with the service's "done" event
+        let failure = match result {
+            Ok(result) if result["status"] == "success" => None,
+            Ok(result) => Some(
+                result["message"]
+                    .as_str()
+                    .unwrap_or("Unknown error")
+                    .to_string(),
+            ),
+            Err(e) => Some(format!("Bridge error: {}", e)),
+        };
+        if let Some(msg) = failure {
+            let _ = app_handle.emit("backup_progress", BackupPayload::error(&tid, msg));
+        }
     });
 
     // Return TaskID immediately (Command Handshake)
     Ok(task_id)
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_payload_from_telemetry() {
+        let event = json!({
+            "phase": "encrypt",
+            "percent": 42,
+            "message": "Encrypting... 10.0 MiB (50.0 MiB/s)",
+            "bytes_done": 10_485_760u64,
+            "bytes_total": 20_971_520u64,
+            "bytes_per_second": 52_428_800.0,
+            "eta_seconds": 1.2,
+            "phase_seconds": {"snapshot": 0.01, "kdf": 0.8}
+        });
+        let payload = BackupPayload::from_telemetry("OMEGA-1", &event);
+        assert_eq!(payload.phase, "encrypt");
+        assert_eq!(payload.progress, 42.0);
+        assert_eq!(payload.speed, "50.0 MiB/s");
+        assert_eq!(payload.eta, "2s");
+        assert_eq!(payload.bytes_total, 20_971_520);
+        assert_eq!(payload.phase_seconds.len(), 2);
+    }
+
+    #[test]
+    fn test_empty_passkey_rejected() {
+        assert!(require_passkey(None).is_err());
+        assert!(require_passkey(Some(String::new())).is_err());
+        assert_eq!(
+            require_passkey(Some("Pass123!".into())).unwrap(),
+            "Pass123!"
+        );
+    }
+
+    #[test]
+    fn test_unknown_eta() {
+        let payload = BackupPayload::from_telemetry("OMEGA-1", &json!({"phase": "kdf"}));
+        assert_eq!(payload.eta, "CALC...");
+        assert_eq!(payload.speed, "0.0 MiB/s");
+    }
+}
@@ -16,8 +16,8 @@ use tauri::command;
 /// * JSON response from Python Dispatcher
 #[command]
 pub async fn cmd_dispatch(cmd: String, payload: Value) -> Result<Value, String> {
-    // Delegate to Python bridge
-    python_bridge::dispatch_to_python(&cmd, payload)
+    // Delegate to Python bridge (worker pool, never the async runtime threads)
+    python_bridge::dispatch_to_python_async(cmd, payload).await
 }
 
 /// Tauri command to restore backup from .cvbak file.
@@ -29,5 +29,5 @@ pub async fn cmd_restore_from_file(file_path: String) -> Result<Value, String> {
         "file_path": file_path
     });
 
-    python_bridge::dispatch_to_python("restore.start", payload)
+    python_bridge::dispatch_to_python_async("restore.start".to_string(), payload).await
 }
@@ -10,8 +10,11 @@ use tauri::command;
 ///
 /// This is the E2E connection point:
 /// Frontend (DropZone/FilePicker) → This Command → PyO3 Bridge → Python Dispatcher
+///
+/// Async + worker-pool dispatch: a sync command would run the whole
+/// restore on the main thread and freeze the window.
 #[command]
-pub fn cmd_restore_backup(path: String) -> Result<String, String> {
+pub async fn cmd_restore_backup(path: String) -> Result<String, String> {
     // Validate file extension
     if !path.to_lowercase().ends_with(".cvbak") {
         return Err("Invalid file format. Expected .cvbak".into());
@@ -25,7 +28,7 @@ pub fn cmd_restore_backup(path: String) -> Result<String, String> {
     });
 
     // Call Python via PyO3 Bridge
-    match python_bridge::dispatch_to_python("restore.start", payload) {
+    match python_bridge::dispatch_to_python_async("restore.start".to_string(), payload).await {
         Ok(result) => {
             println!("✅ [RUST] Python returned: {:?}", result);
 
@@ -7,17 +7,18 @@
 //! - Dynamic Path Resolution (Gap 2 Fix)
 //! - Persistent Session State data via OnceCell (Gap 3 Fix)
 
-use once_cell::sync::Lazy;
+use pyo3::exceptions::PyTypeError;
 use pyo3::prelude::*;
-use pyo3::types::PyDict;
-use serde_json::Value;
+use pyo3::sync::GILOnceCell;
+use pyo3::types::{PyBool, PyDict, PyFloat, PyList, PyLong, PyString, PyTuple};
+use serde_json::{Map, Number, Value};
 use std::env;
 use std::path::PathBuf;
-use std::sync::Mutex;
 
 // GLOBAL STATE: Persist Python Dispatcher instance
-// Mutex ensures thread safety across Tauri command calls
-static PYTHON_DISPATCHER: Lazy<Mutex<Option<PyObject>>> = Lazy::new(|| Mutex::new(None));
+// GILOnceCell: set once under the GIL, then read without any Rust lock,
+// so a long-running handler never blocks other commands on our side
+static PYTHON_DISPATCHER: GILOnceCell<PyObject> = GILOnceCell::new();
 
 /// Helper: Resolve Python Core source path dynamically
 fn get_python_src_path() -> PathBuf {
@@ -47,15 +48,9 @@ fn get_python_src_path() -> PathBuf {
     current_dir
 }
 
-/// Initialize Python environment and cache Dispatcher instance
-pub fn init_python_backend() -> PyResult<()> {
-    let mut dispatcher_guard = PYTHON_DISPATCHER.lock().unwrap();
-
-    if dispatcher_guard.is_some() {
-        return Ok(());
-    }
-
-    Python::with_gil(|py| {
+/// Dispatcher singleton (imported and created on first use)
+fn dispatcher(py: Python<'_>) -> PyResult<&Bound<'_, PyAny>> {
+    let instance = PYTHON_DISPATCHER.get_or_try_init(py, || -> PyResult<PyObject> {
         // 1. Setup Path
         let sys = py.import_bound("sys")?;
         let path = sys.getattr("path")?;
@@ -66,11 +61,8 @@ pub fn init_python_backend() -> PyResult<()> {
         println!("🐍 [PyO3] PYTHONPATH injected: {:?}", src_path);
 
         // 2. Import Module
-        // We assume 'core.dispatcher' based on 'src' being the root in sys.path
-        // If sys.path points to 'src', then 'import core.dispatcher' is valid?
-        // Let's verify: E:\DEV\Convert\src\core\dispatcher.py
-        // If sys.path = E:\DEV\Convert\src
-        // Then 'import core.dispatcher' works.
+        // 'src' is the root in sys.path, so E:\DEV\Convert\src\core\dispatcher.py
+        // is 'core.dispatcher'
         let module = PyModule::import_bound(py, "core.dispatcher").map_err(|e| {
             println!("❌ [PyO3] Import Failed: {}", e);
             e
@@ -80,39 +72,165 @@ pub fn init_python_backend() -> PyResult<()> {
         let class = module.getattr("Dispatcher")?;
         let instance = class.call0()?;
 
-        // 4. Cache it
-        *dispatcher_guard = Some(instance.unbind());
         println!("🐍 [PyO3] Dispatcher Singleton Initialized.");
+        Ok(instance.unbind())
+    })?;
+    Ok(instance.bind(py))
+}
 
-        Ok(())
+/// Initialize Python environment and cache Dispatcher instance
+pub fn init_python_backend() -> PyResult<()> {
+    Python::with_gil(|py| dispatcher(py).map(|_| ()))
+}
+
+/// serde_json::Value -> Python object (no JSON text round-trip)
+fn json_to_py(py: Python<'_>, value: &Value) -> PyResult<PyObject> {
+    Ok(match value {
+        Value::Null => py.None(),
+        Value::Bool(b) => b.into_py(py),
+        Value::Number(n) => {
+            if let Some(i) = n.as_i64() {
+                i.into_py(py)
+            } else if let Some(u) = n.as_u64() {
+                u.into_py(py)
+            } else {
+                n.as_f64().unwrap_or(f64::NAN).into_py(py)
+            }
+        }
+        Value::String(s) => s.as_str().into_py(py),
+        Value::Array(items) => {
+            let list = PyList::empty_bound(py);
+            for item in items {
+                list.append(json_to_py(py, item)?)?;
+            }
+            list.into_any().unbind()
+        }
+        Value::Object(map) => {
+            let dict = PyDict::new_bound(py);
+            for (key, item) in map {
+                dict.set_item(key, json_to_py(py, item)?)?;
+            }
+            dict.into_any().unbind()
+        }
     })
 }
 
+/// Python object -> serde_json::Value, with json.dumps semantics
+/// (tuples become arrays, non-str keys are stringified, NaN becomes null)
+fn py_to_json(obj: &Bound<'_, PyAny>) -> PyResult<Value> {
+    if obj.is_none() {
+        return Ok(Value::Null);
+    }
+    // bool before int: bool is an int subclass in Python
+    if let Ok(b) = obj.downcast::<PyBool>() {
+        return Ok(Value::Bool(b.is_true()));
+    }
+    if obj.is_instance_of::<PyLong>() {
+        if let Ok(i) = obj.extract::<i64>() {
+            return Ok(Value::from(i));
+        }
+        if let Ok(u) = obj.extract::<u64>() {
+            return Ok(Value::from(u));
+        }
+        return Ok(Number::from_f64(obj.extract::<f64>()?).map_or(Value::Null, Value::Number));
+    }
+    if let Ok(f) = obj.downcast::<PyFloat>() {
+        return Ok(Number::from_f64(f.value()).map_or(Value::Null, Value::Number));
+    }
+    if obj.is_instance_of::<PyString>() {
+        return Ok(Value::String(obj.extract::<String>()?));
+    }
+    if let Ok(dict) = obj.downcast::<PyDict>() {
+        let mut map = Map::with_capacity(dict.len());
+        for (key, item) in dict.iter() {
+            let key = if key.is_instance_of::<PyString>() {
+                key.extract::<String>()?
+            } else {
+                match py_to_json(&key)? {
+                    Value::String(s) => s,
+                    other => other.to_string(),
+                }
+            };
+            map.insert(key, py_to_json(&item)?);
+        }
+        return Ok(Value::Object(map));
+    }
+    if let Ok(list) = obj.downcast::<PyList>() {
+        return list
+            .iter()
+            .map(|item| py_to_json(&item))
+            .collect::<PyResult<_>>()
+            .map(Value::Array);
+    }
+    if let Ok(tuple) = obj.downcast::<PyTuple>() {
+        return tuple
+            .iter()
+            .map(|item| py_to_json(&item))
+            .collect::<PyResult<_>>()
+            .map(Value::Array);
+    }
+    Err(PyTypeError::new_err(format!(
+        "Object of type {} is not JSON serializable",
+        obj.get_type()
+    )))
+}
+
+/// Callable handed to Python as envelope["progress"]: each call carries
+/// one telemetry dict, converted natively and passed to the Rust closure.
+#[pyclass]
+struct ProgressSink {
+    on_event: Box<dyn Fn(Value) + Send + Sync>,
+}
+
+#[pymethods]
+impl ProgressSink {
+    fn __call__(&self, event: &Bound<'_, PyAny>) -> PyResult<()> {
+        (self.on_event)(py_to_json(event)?);
+        Ok(())
+    }
+}
+
 /// Dispatch command to Python (Stateful)
+///
+/// Blocks the calling thread for as long as the handler runs: call it
+/// from a worker (see `dispatch_to_python_async`), never from the Tauri
+/// main thread.
 pub fn dispatch_to_python(cmd: &str, payload: Value) -> Result<Value, String> {
-    // Ensure initialized
-    if PYTHON_DISPATCHER.lock().unwrap().is_none() {
-        init_python_backend().map_err(|e| format!("Init Failed: {}", e))?;
-    }
+    dispatch_inner(cmd, payload, None)
+}
 
+/// Like `dispatch_to_python`, with `on_progress` receiving every progress
+/// event the handler reports (on the calling thread, GIL held: keep it short)
+pub fn dispatch_to_python_with_progress(
+    cmd: &str,
+    payload: Value,
+    on_progress: impl Fn(Value) + Send + Sync + 'static,
+) -> Result<Value, String> {
+    dispatch_inner(cmd, payload, Some(Box::new(on_progress)))
+}
+
+fn dispatch_inner(
+    cmd: &str,
+    payload: Value,
+    on_progress: Option<Box<dyn Fn(Value) + Send + Sync>>,
+) -> Result<Value, String> {
     Python::with_gil(|py| {
-        let guard = PYTHON_DISPATCHER.lock().unwrap();
-        let py_instance = guard.as_ref().expect("Dispatcher should be initialized");
-        let dispatcher = py_instance.bind(py);
+        let dispatcher = dispatcher(py).map_err(|e| format!("Init Failed: {}", e))?;
 
         // Create envelope
+        // The Python Dispatcher expects a DICT payload, NOT a string
         let envelope = PyDict::new_bound(py);
-        envelope.set_item("cmd", cmd).unwrap();
-
-        // Pass payload as JSON string to handle complex types reliably
-        let payload_str = serde_json::to_string(&payload).unwrap();
-
-        // IMPORTANT: The Python Dispatcher expects a DICT payload, NOT a string.
-        // We must convert JSON string -> Python Dict here to match the Interface.
-        let json_module = PyModule::import_bound(py, "json").unwrap();
-        let payload_dict = json_module.call_method1("loads", (payload_str,)).unwrap();
-
-        envelope.set_item("payload", payload_dict).unwrap();
+        envelope
+            .set_item("cmd", cmd)
+            .and_then(|_| envelope.set_item("payload", json_to_py(py, &payload)?))
+            .map_err(|e| format!("Envelope Error: {}", e))?;
+        if let Some(on_event) = on_progress {
+            let sink = Py::new(py, ProgressSink { on_event })
+                .map_err(|e| format!("Envelope Error: {}", e))?;
+            envelope
+                .set_item("progress", sink)
+                .map_err(|e| format!("Envelope Error: {}", e))?;
+        }
 
         // Call handle
         let result = dispatcher
@@ -120,17 +238,21 @@ pub fn dispatch_to_python(cmd: &str, payload: Value) -> Result<Value, String> {
             .map_err(|e| format!("Python Execution Error: {}", e))?;
 
         // Convert result back to Rust Value
-        let result_str = json_module
-            .call_method1("dumps", (result,))
-            .unwrap()
-            .extract::<String>()
-            .unwrap();
-
-        let val: Value = serde_json::from_str(&result_str).unwrap();
-        Ok(val)
+        py_to_json(&result).map_err(|e| format!("Result Conversion Error: {}", e))
     })
 }
 
+/// Dispatch on Tauri's blocking worker pool.
+///
+/// The awaiting command yields instead of pinning an async runtime
+/// thread, so UI polling and other commands keep running during e.g. a
+/// long restore.
+pub async fn dispatch_to_python_async(cmd: String, payload: Value) -> Result<Value, String> {
+    tauri::async_runtime::spawn_blocking(move || dispatch_to_python(&cmd, payload))
+        .await
+        .map_err(|e| format!("Dispatch Worker Error: {}", e))?
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -147,4 +269,39 @@ mod tests {
         // Second call should return immediately
         assert!(init_python_backend().is_ok());
     }
+
+    #[test]
+    fn test_native_json_round_trip() {
+        let value = serde_json::json!({
+            "cmd": "backup.start",
+            "n": -42,
+            "big": u64::MAX,
+            "ratio": 0.5,
+            "ok": true,
+            "none": null,
+            "items": [1, "two", [3.0], {"four": false}]
+        });
+        Python::with_gil(|py| {
+            let obj = json_to_py(py, &value).unwrap();
+            let bound = obj.bind(py);
+            assert!(bound.downcast::<PyDict>().is_ok());
+            assert_eq!(py_to_json(bound).unwrap(), value);
+        });
+    }
+
+    #[test]
+    fn test_python_only_types_follow_json_dumps() {
+        Python::with_gil(|py| {
+            let obj = py
+                .eval_bound("{1: (True, float('nan'))}", None, None)
+                .unwrap();
+            assert_eq!(
+                py_to_json(&obj).unwrap(),
+                serde_json::json!({"1": [true, null]})
+            );
+
+            let set = py.eval_bound("{1, 2}", None, None).unwrap();
+            assert!(py_to_json(&set).is_err());
+        });
+    }
 }
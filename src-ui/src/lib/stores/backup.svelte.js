@@ -9,11 +9,17 @@ export const backupState = $state({
     eta: '--',
     message: '',
 
-    async start() {
+    // passkey: vault passkey the backup is encrypted under (never stored here)
+    async start(passkey, targetDir = null) {
+        if (!passkey) {
+            this.phase = 'error';
+            this.message = 'Backup requires the vault passkey';
+            return;
+        }
         try {
             this.phase = 'init';
             this.message = 'Starting...';
-            await invoke('cmd_backup_start');
+            await invoke('cmd_backup_start', { passkey, targetDir });
         } catch (err) {
             this.phase = 'error';
             this.message = err;
@@ -27,5 +33,5 @@ listen('backup_progress', (event) => {
     backupState.progress = p.progress;
     backupState.speed = p.speed;
     backupState.eta = p.eta;
-    backupState.message = p.message;
+    backupState.message = p.msg;
 });
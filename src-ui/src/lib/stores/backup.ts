@@ -34,7 +34,17 @@ function createBackupStore() {
         subscribe,
 
         // Start backup - Hybrid Flow
-        start: async (targetDir?: string) => {
+        start: async (passkey: string, targetDir?: string) => {
+            if (!passkey) {
+                set({
+                    ...initialState,
+                    phase: 'error',
+                    error: 'Backup requires the vault passkey',
+                    message: 'Failed to start backup'
+                });
+                return;
+            }
+
             // Reset state
             set({
                 ...initialState,
@@ -46,7 +56,8 @@ function createBackupStore() {
             try {
                 // COMMAND: Get TaskID immediately (no blocking)
                 const taskId = await invoke<string>('cmd_backup_start', {
-                    targetDir: targetDir || null
+                    targetDir: targetDir || null,
+                    passkey
                 });
 
                 update(s => ({ ...s, taskId }));
@@ -3,11 +3,16 @@
 // Backup Progress Event (from Rust worker thread)
 export interface BackupPayload {
     task_id: string;
-    phase: 'init' | 'snapshot' | 'encrypting' | 'finalizing' | 'done' | 'error';
+    phase: 'init' | 'snapshot' | 'kdf' | 'encrypt' | 'write' | 'verify' | 'done' | 'error';
     progress: number;       // 0.0 - 100.0
-    speed: string;          // "45 MB/s"
-    eta: string;            // "10-15s" range
+    speed: string;          // "45.2 MiB/s" (measured)
+    eta: string;            // "12s", "CALC..." while unknown
     msg: string;            // Error message when phase === 'error'
+    bytes_done: number;     // Of the current phase
+    bytes_total: number;
+    bytes_per_second: number;
+    eta_seconds: number | null;
+    phase_seconds: Record<string, number>;  // snapshot, kdf, encrypt, write, verify
 }
 
 // Recovery SVG Response (Blind Protocol)
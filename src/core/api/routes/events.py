@@ -0,0 +1,66 @@
+"""
+EVENTS.PY - Event Pipeline Metrics Endpoint
+Sprint 6 Background Services
+
+GET /events/metrics returns one snapshot per registered component
+(HeavyEventBus, IndexerQueue, ExtractionPipeline), including the
+p50/p95/p99/max latency fields recorded by src.core.utils.histogram.
+
+src/core/main.py registers the live instances on startup:
+    register_metrics_source("eventbus", event_bus.metrics)
+    register_metrics_source("indexer_queue", indexer_queue.metrics)
+    register_metrics_source("pipeline", pipeline.get_stats)
+
+"tuning" (the active hardware profile, src.utils.tuning) is always
+registered.
+"""
+
+import dataclasses
+import threading
+from typing import Any, Callable, Dict
+
+from fastapi import APIRouter
+
+from ....utils.tuning import get_tuning_profile
+
+router = APIRouter(prefix="/events", tags=["events"])
+
+_sources: Dict[str, Callable[[], Any]] = {}
+_sources_lock = threading.Lock()
+
+
+def register_metrics_source(name: str, provider: Callable[[], Any]) -> None:
+    """Expose provider() (dataclass or dict) under `name`."""
+    with _sources_lock:
+        _sources[name] = provider
+
+
+def unregister_metrics_source(name: str) -> None:
+    with _sources_lock:
+        _sources.pop(name, None)
+
+
+# Chosen worker counts / buffer sizes and the hardware they came from
+register_metrics_source("tuning", lambda: get_tuning_profile().snapshot())
+
+
+def _to_dict(snapshot: Any) -> Any:
+    if dataclasses.is_dataclass(snapshot):
+        return dataclasses.asdict(snapshot)
+    return snapshot
+
+
+@router.get("/metrics")
+async def get_event_metrics() -> Dict[str, Any]:
+    """Metrics snapshot of every registered component."""
+    with _sources_lock:
+        sources = list(_sources.items())
+
+    result: Dict[str, Any] = {}
+    for name, provider in sources:
+        try:
+            result[name] = _to_dict(provider())
+        except Exception as e:
+            # One failing component must not hide the others
+            result[name] = {"error": f"{type(e).__name__}: {e}"}
+    return result
@@ -3,21 +3,30 @@ import hashlib
 import logging
 from typing import Tuple
 
+from ..security.key_cache import DerivedKeyCache
+
 logger = logging.getLogger(__name__)
 
 class HMACService:
-    def __init__(self, master_keys: dict[str, bytes]):
+    def __init__(self, master_keys: dict[str, bytes], kms=None):
         """
         Initialize HMAC Service with master keys.
         
         Args:
             master_keys: Dict mapping key_version (e.g., 'v1') to raw bytes.
                          Example: {'v1': b'...', 'v2': b'...'}
+            kms: KMS whose lock()/unlock() must also clear the stream-key
+                 cache (pass it whenever the master keys came from a KMS)
         """
         if not master_keys:
             raise ValueError("At least one master key is required")
             
         self.master_keys = master_keys
+        # (key_version, stream_id) -> stream key; cleared on rotate_key()
+        # and, through `kms`, on vault lock
+        self.key_cache = DerivedKeyCache()
+        if kms is not None:
+            kms.register_key_cache(self.key_cache)
         # Determine current (latest) version by sorting keys
         self.current_version = sorted(master_keys.keys())[-1]
         logger.info(f"HMACService initialized. Active Key Version: {self.current_version}")
@@ -70,7 +79,10 @@ class HMACService:
             raise ValueError(f"Unknown key version: {version}")
             
         master_key = self.master_keys[version]
-        stream_key = self._derive_stream_key(master_key, stream_id)
+        stream_key = self.key_cache.get_or_derive(
+            (version, stream_id),
+            lambda: self._derive_stream_key(master_key, stream_id)
+        )
         
         hmac_obj = hmac.new(stream_key, payload_bytes, hashlib.sha3_256)
         return hmac_obj.hexdigest(), version
@@ -104,6 +116,8 @@ class HMACService:
         
         self.master_keys[new_version] = new_master_key
         self.current_version = new_version
+        # Rotation may follow a suspected compromise: re-derive everything
+        self.key_cache.clear()
         logger.info(f"HMAC Key Rotated. New Active Version: {self.current_version}")
         
         return new_version
@@ -3,7 +3,17 @@ Command Dispatcher - Routes commands to appropriate services.
 
 Implements routing logic for Hybrid SSOT architecture.
 """
-from typing import Dict, Any
+import asyncio
+import time
+from dataclasses import asdict
+from pathlib import Path
+from typing import Dict, Any, Callable, Optional
+
+# Vault database (same default as main.py)
+DEFAULT_DB_PATH = Path("data/mds.db")
+
+# progress(event: dict) - supplied by the Rust bridge as envelope["progress"]
+ProgressSink = Callable[[Dict[str, Any]], None]
 
 
 class Dispatcher:
@@ -25,7 +35,8 @@ class Dispatcher:
         Route command to appropriate handler.
         
         Args:
-            envelope: Command envelope with 'cmd' and 'payload' keys
+            envelope: Command envelope with 'cmd' and 'payload' keys, and
+                optionally 'progress' (callable receiving telemetry dicts)
             
         Returns:
             Result dictionary with 'status' and additional data
@@ -57,18 +68,26 @@ class Dispatcher:
                 return self._error(f"Unknown service: {service_name}")
             
             # Delegate to service handler
-            return self._services[service_name](action, envelope["payload"])
+            return self._services[service_name](action, envelope["payload"], envelope.get("progress"))
             
         except Exception as e:
             return self._error(f"Dispatcher error: {str(e)}")
     
-    def _handle_backup(self, action: str, payload: Dict[str, Any]) -> Dict[str, Any]:
+    def _handle_backup(
+        self,
+        action: str,
+        payload: Dict[str, Any],
+        progress: Optional[ProgressSink] = None
+    ) -> Dict[str, Any]:
         """Handle backup service commands."""
         if action == "start":
             # Validate payload
             if "target_dir" not in payload:
                 return self._error("Backup validation failed: missing target_dir")
             
+            if "passkey" in payload:
+                return self._run_backup(payload, progress)
+            
             # Simulate successful backup initiation
             return {
                 "status": "success",
@@ -78,7 +97,45 @@ class Dispatcher:
         
         return self._error(f"Unknown backup action: {action}")
     
-    def _handle_restore(self, action: str, payload: Dict[str, Any]) -> Dict[str, Any]:
+    def _run_backup(self, payload: Dict[str, Any], progress: Optional[ProgressSink]) -> Dict[str, Any]:
+        """
+        Run services.backup.create_backup to completion (we are on a bridge
+        worker thread, not the UI thread), forwarding BackupTelemetry as
+        dicts to `progress`.
+        """
+        from .services.backup import create_backup, BackupError
+        
+        passkey = payload["passkey"]
+        if not isinstance(passkey, str) or not passkey:
+            return self._error("Backup validation failed: empty passkey")
+        
+        target_dir = Path(payload["target_dir"])
+        db_path = Path(payload.get("db_path") or DEFAULT_DB_PATH)
+        output_path = target_dir / f"vault-{time.strftime('%Y%m%d-%H%M%S')}.cvbak"
+        
+        telemetry = (lambda event: progress(asdict(event))) if progress else None
+        try:
+            target_dir.mkdir(parents=True, exist_ok=True)
+            asyncio.run(create_backup(
+                db_path, passkey, output_path,
+                telemetry_callback=telemetry, verify=True
+            ))
+        except (BackupError, OSError) as e:
+            return self._error(f"Backup failed: {e}")
+        
+        return {
+            "status": "success",
+            "task_id": payload.get("task_id", "backup_001"),
+            "message": "Backup complete",
+            "output_path": str(output_path)
+        }
+    
+    def _handle_restore(
+        self,
+        action: str,
+        payload: Dict[str, Any],
+        progress: Optional[ProgressSink] = None
+    ) -> Dict[str, Any]:
         """Handle restore service commands."""
         if action == "start":
             # Validate payload (FIXED: match Rust parameter name 'file_path')
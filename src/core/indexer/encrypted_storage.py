@@ -294,10 +294,20 @@ class EncryptedIndexerDB:
             self.connect()
         return self._conn.execute(sql, params)
     
+    @property
+    def in_transaction(self) -> bool:
+        """True while a transaction is open on the connection."""
+        return bool(self._conn and self._conn.in_transaction)
+    
     def commit(self) -> None:
         """Commit current transaction."""
         if self._conn:
             self._conn.commit()
+    
+    def rollback(self) -> None:
+        """Roll back current transaction."""
+        if self._conn:
+            self._conn.rollback()
 
 
 def get_encryption_key_from_keyring(
@@ -0,0 +1,293 @@
+"""
+EXTRACTION_CACHE.PY - Persistent Content-Addressed Extraction Cache
+Task 6.5 - Sprint 6 Background Services
+
+EventIdempotency keys on path + mtime + size, so a copied, renamed or
+touched file is extracted again. ExtractionCache keys results on the file
+CONTENT instead:
+- content_hash(): XXH3-128 (fallback: blake2b-128), streamed in 1 MiB
+  chunks - files are never read whole
+- Entries live in the index database (extraction_cache table), payload
+  zlib-compressed then encrypt_blob()'d (PyNaCl fallback; SQLCipher
+  encrypts the pages itself)
+- Key = content hash + the name/version of the backend that produced the
+  result (result.extractor/version), so backends sharing one extractor
+  class (DOCX: docx_rs batch vs python-docx) never overwrite each other
+  and a backend upgrade never serves stale text
+- Bounded by max_bytes, oldest entries evicted first (running total)
+
+Same connection and thread as FTSBatchWriter: put() joins the writer's
+open transaction and becomes durable with its next commit.
+"""
+
+import struct
+import time
+import zlib
+from pathlib import Path
+from typing import Any, Dict, Iterable, Iterator, List, Optional
+
+import orjson
+
+from .encrypted_storage import EncryptedIndexerDB
+from .extractors.result import ExtractionResult, TextSegment
+from ..utils.hashing import DEFAULT_CHUNK_SIZE, file_digest
+
+_LENGTH = struct.Struct("<I")
+
+_CACHE_DDL = """
+CREATE TABLE IF NOT EXISTS extraction_cache (
+    content_hash TEXT NOT NULL,
+    extractor TEXT NOT NULL,
+    version TEXT NOT NULL,
+    payload BLOB NOT NULL,
+    size_bytes INTEGER NOT NULL,
+    created_at REAL NOT NULL,
+    PRIMARY KEY (content_hash, extractor, version)
+)
+"""
+
+
+def content_hash(file_path: Path, chunk_size: int = DEFAULT_CHUNK_SIZE) -> str:
+    """
+    Streamed 128-bit content hash (see utils.hashing.file_digest).
+
+    Raises:
+        OSError: File unreadable
+    """
+    return file_digest(file_path, chunk_size)
+
+
+class ExtractionCache:
+    """
+    Content-hash → ExtractionResult cache inside the encrypted index.
+
+    Usage:
+        cache = ExtractionCache(db)
+        digest = content_hash(path)
+        result = cache.get(digest, extractor)
+        if result is None:
+            result = extractor.extract(path)
+            cache.put(digest, result)
+    """
+
+    DEFAULT_MAX_BYTES = 256 * 1024 * 1024
+    # Recount the stored total after this many puts: a put inside a
+    # transaction the writer rolls back leaves the running total off
+    RECOUNT_EVERY = 1000
+
+    def __init__(self, db: EncryptedIndexerDB, max_bytes: int = DEFAULT_MAX_BYTES):
+        """
+        Args:
+            db: EncryptedIndexerDB shared with FTSBatchWriter
+            max_bytes: Stored payload budget (compressed)
+        """
+        self.db = db
+        self.max_bytes = max_bytes
+        self._schema_ready = False
+        self._total_bytes: Optional[int] = None
+        self._puts_since_recount = 0
+
+        # Metrics
+        self.hits = 0
+        self.misses = 0
+        self.stores = 0
+        self.evictions = 0
+
+    def ensure_schema(self) -> None:
+        if self._schema_ready:
+            return
+        self.db.execute(_CACHE_DDL)
+        self.db.execute(
+            "CREATE INDEX IF NOT EXISTS idx_extraction_cache_age ON extraction_cache(created_at)"
+        )
+        self.db.commit()
+        self._schema_ready = True
+
+    @staticmethod
+    def _identity(extractor: Any) -> tuple:
+        """(EXTRACTOR_NAME, VERSION); class name / "" when not declared."""
+        name = getattr(extractor, "EXTRACTOR_NAME", None)
+        version = getattr(extractor, "VERSION", None)
+        return (
+            name if isinstance(name, str) else type(extractor).__name__,
+            version if isinstance(version, str) else "",
+        )
+
+    @classmethod
+    def _identities(cls, extractor: Any) -> List[tuple]:
+        """Every (name, version) the extractor's active backends produce."""
+        if callable(getattr(type(extractor), "cache_identities", None)):
+            return list(extractor.cache_identities())
+        return [cls._identity(extractor)]
+
+    @classmethod
+    def _result_identity(cls, extractor: Any, result: ExtractionResult) -> tuple:
+        """(name, version) of the backend that produced result."""
+        if result.extractor == ExtractionResult.extractor:  # Not filled in
+            return cls._identity(extractor)
+        return result.extractor, result.version
+
+    def get(self, digest: str, extractor: Any) -> Optional[ExtractionResult]:
+        """Cached result for this content from one of extractor's current backends, or None."""
+        self.ensure_schema()
+        for name, version in self._identities(extractor):
+            row = self.db.execute(
+                """
+                SELECT payload, size_bytes FROM extraction_cache
+                WHERE content_hash = ? AND extractor = ? AND version = ?
+                """,
+                (digest, name, version)
+            ).fetchone()
+            if row is None:
+                continue
+
+            try:
+                result = self._decode(bytes(row[0]))
+            except Exception as e:
+                # Undecryptable / corrupt entry: drop it, extract again
+                print(f"⚠️ [EXTRACTION_CACHE] Dropping unreadable entry {digest}: {e}")
+                self.db.execute(
+                    "DELETE FROM extraction_cache WHERE content_hash = ? AND extractor = ? AND version = ?",
+                    (digest, name, version)
+                )
+                if self._total_bytes is not None:
+                    self._total_bytes -= row[1]
+                continue
+
+            self.hits += 1
+            return result
+
+        self.misses += 1
+        return None
+
+    def put(
+        self,
+        digest: str,
+        extractor: Any,
+        result: ExtractionResult,
+        segments: Optional[Iterable[TextSegment]] = None
+    ) -> None:
+        """
+        Store a successful result (open transaction, no commit).
+
+        Args:
+            digest: content_hash() of the extracted file
+            extractor: Extractor that produced the result (cache identity)
+            result: Metadata/errors source; failed results are not cached
+            segments: Streaming mode - segments to store instead of
+                result.segments (compressed as they are consumed)
+        """
+        if not result.success:
+            return
+        self.ensure_schema()
+        name, version = self._result_identity(extractor, result)
+
+        payload = self.db.encrypt_blob(
+            self._encode(result, result.segments if segments is None else segments)
+        )
+        total = self._stored_total()
+        replaced = self.db.execute(
+            """
+            SELECT size_bytes FROM extraction_cache
+            WHERE content_hash = ? AND extractor = ? AND version = ?
+            """,
+            (digest, name, version)
+        ).fetchone()
+        self.db.execute(
+            """
+            INSERT OR REPLACE INTO extraction_cache
+                (content_hash, extractor, version, payload, size_bytes, created_at)
+            VALUES (?, ?, ?, ?, ?, ?)
+            """,
+            (digest, name, version, payload, len(payload), time.time())
+        )
+        self.stores += 1
+        self._total_bytes = total + len(payload) - (replaced[0] if replaced else 0)
+        self._puts_since_recount += 1
+        self._evict()
+
+    def _stored_total(self) -> int:
+        """Running payload total (recounted when unknown or every RECOUNT_EVERY puts)."""
+        if self._total_bytes is None or self._puts_since_recount >= self.RECOUNT_EVERY:
+            self._total_bytes = self.db.execute(
+                "SELECT COALESCE(SUM(size_bytes), 0) FROM extraction_cache"
+            ).fetchone()[0]
+            self._puts_since_recount = 0
+        return self._total_bytes
+
+    def _evict(self) -> None:
+        """Drop oldest entries until the payload total fits max_bytes."""
+        total = self._stored_total()
+        if total > self.max_bytes:
+            rows = self.db.execute(
+                "SELECT rowid, size_bytes FROM extraction_cache ORDER BY created_at"
+            ).fetchall()
+            for rowid, size in rows:
+                if total <= self.max_bytes:
+                    break
+                self.db.execute("DELETE FROM extraction_cache WHERE rowid = ?", (rowid,))
+                total -= size
+                self.evictions += 1
+        self._total_bytes = total
+
+    # -------------------------------------------------------------------
+    # PAYLOAD: zlib( [u32 len][orjson header] ([u32 len][orjson segment])* )
+    # -------------------------------------------------------------------
+
+    @staticmethod
+    def _encode(result: ExtractionResult, segments: Iterable[TextSegment]) -> bytes:
+        compressor = zlib.compressobj(level=1)
+        chunks = []
+
+        def emit(record: Dict[str, Any]) -> None:
+            data = orjson.dumps(record)
+            chunks.append(compressor.compress(_LENGTH.pack(len(data)) + data))
+
+        emit({
+            "metadata": result.metadata,
+            "processing_time_ms": result.processing_time_ms,
+            "file_size_bytes": result.file_size_bytes,
+            "truncated": result.truncated,
+            "extractor": result.extractor,
+            "version": result.version,
+        })
+        for seg in segments:
+            emit({"text": seg.text, "page": seg.page, "section": seg.section, "confidence": seg.confidence})
+        chunks.append(compressor.flush())
+        return b"".join(chunks)
+
+    def _decode(self, payload: bytes) -> ExtractionResult:
+        records = self._records(zlib.decompress(self.db.decrypt_blob(payload)))
+        header = next(records)
+        result = ExtractionResult(
+            metadata=header["metadata"],
+            processing_time_ms=header["processing_time_ms"],
+            file_size_bytes=header["file_size_bytes"],
+            truncated=header["truncated"],
+            extractor=header["extractor"],
+            version=header["version"],
+        )
+        result.metadata["cache_hit"] = True
+        result.segments = [TextSegment(**record) for record in records]
+        return result
+
+    @staticmethod
+    def _records(data: bytes) -> Iterator[Dict[str, Any]]:
+        view = memoryview(data)
+        offset = 0
+        while offset < len(view):
+            (length,) = _LENGTH.unpack_from(view, offset)
+            offset += _LENGTH.size
+            yield orjson.loads(view[offset:offset + length])
+            offset += length
+
+    def get_stats(self) -> Dict[str, int]:
+        if self._total_bytes is None and self._schema_ready:
+            self._stored_total()
+        return {
+            "hits": self.hits,
+            "misses": self.misses,
+            "stores": self.stores,
+            "evictions": self.evictions,
+            "size_bytes": self._total_bytes or 0,
+        }
@@ -0,0 +1,192 @@
+"""
+EXTRACTION_POOL.PY - Warm, Sandboxed Extraction Worker Processes
+Task 6.5 - Sprint 6 Background Services
+
+Used by ExtractionPipeline.process_many():
+- ProcessPoolExecutor workers stay alive between files (ExtractorRegistry
+  is built once per worker, fitz/docx imports are paid once)
+- Each worker applies SandboxExecutor limits to itself:
+  memory (RLIMIT_AS) at startup, wall-clock timeout per file (SIGALRM)
+- A crashed worker (BrokenProcessPool) only costs the files in flight;
+  the pool is rebuilt on next submit
+- submit_batch(): one task for several files of a batch-capable type
+  (DOCXExtractor.extract_batch), one pickled result list back
+
+Limits are Unix-only (same as SandboxExecutor's preexec_fn path); on
+Windows workers run without them.
+"""
+
+import os
+import signal
+import sys
+import time
+from concurrent.futures import Future, ProcessPoolExecutor
+from concurrent.futures.process import BrokenProcessPool
+from pathlib import Path
+from typing import List, Optional, Sequence
+
+from .extractors.result import ExtractionError, ExtractionResult
+from .sandbox import SandboxExecutor
+
+_HAS_ALARM = hasattr(signal, "setitimer")
+
+
+class _ExtractionTimeout(Exception):
+    pass
+
+
+def _on_alarm(signum, frame):
+    raise _ExtractionTimeout()
+
+
+def init_extraction_worker(memory_limit_mb: int) -> None:
+    """ProcessPoolExecutor initializer: apply limits, warm the registry."""
+    if sys.platform != "win32":
+        try:
+            import resource
+            mem_bytes = memory_limit_mb * 1024 * 1024
+            resource.setrlimit(resource.RLIMIT_AS, (mem_bytes, mem_bytes))
+        except (ImportError, ValueError, OSError) as e:
+            print(f"⚠️ [EXTRACTION_POOL] Memory limit not applied: {e}")
+    if _HAS_ALARM:
+        signal.signal(signal.SIGALRM, _on_alarm)
+
+    from .registry import ExtractorRegistry
+    ExtractorRegistry()
+
+
+def extract_in_worker(path: str, mime_type: str, timeout_seconds: float) -> ExtractionResult:
+    """
+    Worker task: extract one file.
+
+    Limit violations come back as non-recoverable errors (TIMEOUT /
+    MEMORY_LIMIT) so the pipeline quarantines the file - never raised.
+    """
+    from .registry import ExtractorRegistry
+
+    extractor = ExtractorRegistry().get_extractor(mime_type)
+    if extractor is None:
+        result = ExtractionResult()
+        result.add_error(ExtractionError.INVALID_FORMAT, f"No extractor for {mime_type}")
+        return result
+
+    start_time = time.perf_counter()
+    if _HAS_ALARM:
+        signal.setitimer(signal.ITIMER_REAL, timeout_seconds)
+    try:
+        return extractor.extract(Path(path))
+    except _ExtractionTimeout:
+        result = ExtractionResult(extractor=getattr(extractor, "EXTRACTOR_NAME", "unknown"))
+        result.add_error(
+            ExtractionError.TIMEOUT,
+            f"Extraction timeout: exceeded {timeout_seconds} seconds"
+        )
+    except MemoryError:
+        result = ExtractionResult(extractor=getattr(extractor, "EXTRACTOR_NAME", "unknown"))
+        result.add_error(ExtractionError.MEMORY_LIMIT, "Extraction exceeded worker memory limit")
+    finally:
+        if _HAS_ALARM:
+            signal.setitimer(signal.ITIMER_REAL, 0)
+
+    result.processing_time_ms = (time.perf_counter() - start_time) * 1000
+    return result
+
+
+def extract_batch_in_worker(
+    paths: Sequence[str],
+    mime_type: str,
+    timeout_seconds: float
+) -> List[ExtractionResult]:
+    """
+    Worker task: extract several files with one extractor call.
+
+    The timeout scales with the batch size; a limit violation fails the
+    whole batch (every file gets the TIMEOUT / MEMORY_LIMIT error).
+    """
+    from .registry import ExtractorRegistry
+
+    extractor = ExtractorRegistry().get_extractor(mime_type)
+    if extractor is None:
+        return [extract_in_worker(path, mime_type, timeout_seconds) for path in paths]
+
+    def failed(code: str, message: str) -> List[ExtractionResult]:
+        results = []
+        for _ in paths:
+            result = ExtractionResult(extractor=getattr(extractor, "EXTRACTOR_NAME", "unknown"))
+            result.add_error(code, message)
+            results.append(result)
+        return results
+
+    batch_timeout = timeout_seconds * len(paths)
+    if _HAS_ALARM:
+        signal.setitimer(signal.ITIMER_REAL, batch_timeout)
+    try:
+        # threads=1: the process pool already provides the parallelism
+        return extractor.extract_batch([Path(p) for p in paths], threads=1)
+    except _ExtractionTimeout:
+        return failed(
+            ExtractionError.TIMEOUT,
+            f"Extraction timeout: batch exceeded {batch_timeout} seconds"
+        )
+    except MemoryError:
+        return failed(ExtractionError.MEMORY_LIMIT, "Extraction exceeded worker memory limit")
+    finally:
+        if _HAS_ALARM:
+            signal.setitimer(signal.ITIMER_REAL, 0)
+
+
+class ExtractionWorkerPool:
+    """
+    Lazily started pool of warm extraction processes.
+
+    Usage:
+        pool = ExtractionWorkerPool(max_workers=4)
+        future = pool.submit(path, mime_type)
+        pool.shutdown()
+    """
+
+    def __init__(
+        self,
+        max_workers: Optional[int] = None,
+        sandbox: Optional[SandboxExecutor] = None
+    ):
+        """
+        Args:
+            max_workers: Worker processes (default: cpu_count - 1, min 1)
+            sandbox: Source of timeout/memory limits (default limits if None)
+        """
+        self.max_workers = max_workers or max(1, (os.cpu_count() or 2) - 1)
+        self.sandbox = sandbox or SandboxExecutor()
+        self._executor: Optional[ProcessPoolExecutor] = None
+
+    def submit(self, path: Path, mime_type: str) -> Future:
+        """Queue one file for extraction (Future resolves to ExtractionResult)."""
+        return self._submit(extract_in_worker, str(path), mime_type)
+
+    def submit_batch(self, paths: Sequence[Path], mime_type: str) -> Future:
+        """Queue several files as one task (Future resolves to a result list)."""
+        return self._submit(extract_batch_in_worker, [str(p) for p in paths], mime_type)
+
+    def _submit(self, fn, target, mime_type: str) -> Future:
+        if self._executor is None:
+            self._executor = ProcessPoolExecutor(
+                max_workers=self.max_workers,
+                initializer=init_extraction_worker,
+                initargs=(self.sandbox.memory_limit_mb,)
+            )
+        try:
+            return self._executor.submit(fn, target, mime_type, self.sandbox.timeout_seconds)
+        except BrokenProcessPool:
+            # A worker died (e.g. hard crash in a native parser): start fresh
+            self._reset()
+            return self._submit(fn, target, mime_type)
+
+    def _reset(self) -> None:
+        if self._executor is not None:
+            self._executor.shutdown(wait=False, cancel_futures=True)
+            self._executor = None
+
+    def shutdown(self, wait: bool = True) -> None:
+        if self._executor is not None:
+            self._executor.shutdown(wait=wait, cancel_futures=not wait)
+            self._executor = None
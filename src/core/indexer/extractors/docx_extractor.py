@@ -11,11 +11,15 @@ NOTE: Rust implementation (docx_rs) is preferred for production due to:
 - Lower memory footprint
 
 This fallback ensures tests can run immediately.
+
+Batches (extract_batch) go to the Rust module's extract_docx_batch when
+it is installed: a Rayon pool without the GIL, results returned as one
+flat text buffer + offset arrays instead of per-segment FFI objects.
 """
 
 import time
 from pathlib import Path
-from typing import Optional
+from typing import List, Optional, Sequence, Tuple
 
 try:
     from docx import Document
@@ -23,6 +27,13 @@ try:
 except ImportError:
     PYTHON_DOCX_AVAILABLE = False
 
+try:
+    import docx_extractor as docx_native  # Rust (docx_rs, maturin)
+    RUST_DOCX_AVAILABLE = hasattr(docx_native, "extract_docx_batch")
+except ImportError:
+    docx_native = None
+    RUST_DOCX_AVAILABLE = False
+
 from .result import ExtractionResult, TextSegment, ExtractionError
 
 
@@ -44,8 +55,11 @@ class DOCXExtractor:
     VERSION = "1.0.0-python-fallback"
     EXTRACTOR_NAME = "docx_python"
     
+    # pipeline: process_many hands DOCX files over in groups (extract_batch)
+    SUPPORTS_BATCH = True
+    
     def __init__(self):
-        if not PYTHON_DOCX_AVAILABLE:
+        if not PYTHON_DOCX_AVAILABLE and not RUST_DOCX_AVAILABLE:
             raise RuntimeError(
                 "python-docx not available. Install with: pip install python-docx"
             )
@@ -60,6 +74,9 @@ class DOCXExtractor:
         Returns:
             ExtractionResult with text segments and metadata
         """
+        if not PYTHON_DOCX_AVAILABLE:
+            return self.extract_batch([file_path])[0]
+        
         start_time = time.perf_counter()
         result = ExtractionResult(
             extractor=self.EXTRACTOR_NAME,
@@ -158,6 +175,85 @@ class DOCXExtractor:
             result.processing_time_ms = (time.perf_counter() - start_time) * 1000
         
         return result
+    
+    def cache_identities(self) -> List[Tuple[str, str]]:
+        """
+        (extractor, version) of the results this extractor can return now.
+        
+        ExtractionCache looks entries up under each: extract_batch()
+        returns docx_rs results, extract() python-docx ones.
+        """
+        identities = []
+        native = (
+            getattr(docx_native, "EXTRACTOR_NAME", None),
+            getattr(docx_native, "VERSION", None),
+        ) if RUST_DOCX_AVAILABLE else (None, None)
+        if all(isinstance(part, str) for part in native):
+            identities.append(native)
+        if PYTHON_DOCX_AVAILABLE:
+            identities.append((self.EXTRACTOR_NAME, self.VERSION))
+        return identities
+    
+    def extract_batch(
+        self,
+        file_paths: Sequence[Path],
+        threads: int = 0
+    ) -> List[ExtractionResult]:
+        """
+        Extract several DOCX files in one call.
+        
+        Args:
+            file_paths: DOCX files
+            threads: Rust worker threads (0 = one per CPU); ignored by the
+                python-docx fallback, which runs sequentially
+            
+        Returns:
+            One ExtractionResult per path, same order
+        """
+        if not RUST_DOCX_AVAILABLE:
+            return [self.extract(Path(p)) for p in file_paths]
+        
+        batch = docx_native.extract_docx_batch([str(p) for p in file_paths], threads)
+        return unpack_docx_batch(batch)
+
+
+def unpack_docx_batch(batch) -> List[ExtractionResult]:
+    """
+    Rebuild ExtractionResults from a docx_rs DocxBatch.
+    
+    Segment i is text[segment_offsets[i]:segment_offsets[i + 1]];
+    document d owns segments document_offsets[d]:document_offsets[d + 1].
+    """
+    text = batch.text
+    seg_offsets = memoryview(batch.segment_offsets).cast("Q")
+    kinds = batch.section_kinds
+    indices = memoryview(batch.section_indices).cast("I")
+    doc_offsets = memoryview(batch.document_offsets).cast("Q")
+    
+    results = []
+    for d, native in enumerate(batch.documents):
+        result = ExtractionResult(
+            metadata=dict(native.metadata),
+            processing_time_ms=native.processing_time_ms,
+            file_size_bytes=native.file_size_bytes,
+            errors=[
+                ExtractionError(code=e.code, message=e.message, recoverable=e.recoverable)
+                for e in native.errors
+            ],
+            truncated=native.truncated,
+            extractor=native.extractor,
+            version=native.version
+        )
+        for i in range(doc_offsets[d], doc_offsets[d + 1]):
+            kind = "table" if kinds[i] == ord("t") else "paragraph"
+            result.segments.append(TextSegment(
+                text=text[seg_offsets[i]:seg_offsets[i + 1]],
+                page=None,
+                section=f"{kind}_{indices[i]}",
+                confidence=1.0
+            ))
+        results.append(result)
+    return results
 
 
 def extract_docx(file_path: Path) -> ExtractionResult:
@@ -3,13 +3,34 @@
 //!
 //! Uses docx-rs for high-performance DOCX text extraction.
 //! Exposes to Python via PyO3 bindings.
+//!
+//! Fast path: the file is memory-mapped (no read_to_end copy) and
+//! word/document.xml is streamed straight out of the zip through a
+//! quick-xml pull parser - no document model is built. The parse runs
+//! with the GIL released (py.allow_threads), so several files can be
+//! extracted in parallel. The full docx-rs model is only a fallback when
+//! the streaming parse fails.
+//!
+//! Batch API: extract_docx_batch(paths, threads) fans files out over a
+//! Rayon pool without the GIL and returns one DocxBatch - a flat text
+//! buffer plus packed offset arrays instead of one pyclass per segment.
 
+use memmap2::Mmap;
 use pyo3::prelude::*;
-use pyo3::types::PyDict;
+use pyo3::types::{PyBytes, PyDict, PyList, PyString};
+use quick_xml::events::Event;
+use quick_xml::Reader;
+use rayon::prelude::*;
+use std::collections::HashMap;
 use std::fs::File;
-use std::io::Read;
+use std::io::{BufReader, Cursor};
+use std::sync::{Arc, Mutex, OnceLock};
 use std::time::Instant;
 
+const EXTRACTOR_NAME: &str = "docx_rust";
+const EXTRACTOR_VERSION: &str = "1.1.0";
+const DOCUMENT_PART: &str = "word/document.xml";
+
 /// Text segment with metadata
 #[pyclass]
 #[derive(Clone)]
@@ -83,97 +104,253 @@ struct ExtractionResult {
     version: String,
 }
 
-/// Extract text from DOCX file
-///
-/// Args:
-///     file_path: Path to DOCX file
-///
-/// Returns:
-///     ExtractionResult with text segments and metadata
-#[pyfunction]
-fn extract_docx(py: Python, file_path: String) -> PyResult<ExtractionResult> {
+// ---------------------------------------------------------------------------
+// Native extraction (pure Rust, runs without the GIL)
+// ---------------------------------------------------------------------------
+
+/// Body-level element a segment comes from
+#[derive(Clone, Copy, PartialEq)]
+enum BlockKind {
+    Paragraph,
+    Table,
+}
+
+/// Segment produced without touching Python objects
+struct NativeSegment {
+    text: String,
+    kind: BlockKind,
+    /// Index among the body's children
+    index: u32,
+}
+
+impl NativeSegment {
+    /// "paragraph_<idx>" / "table_<idx>"
+    fn section(&self) -> String {
+        match self.kind {
+            BlockKind::Paragraph => format!("paragraph_{}", self.index),
+            BlockKind::Table => format!("table_{}", self.index),
+        }
+    }
+}
+
+/// Extraction outcome converted to pyclasses once the GIL is reacquired
+struct NativeExtraction {
+    segments: Vec<NativeSegment>,
+    errors: Vec<ExtractionError>,
+    file_size_bytes: i64,
+    processing_time_ms: f64,
+    parser: &'static str,
+}
+
+impl NativeExtraction {
+    fn failed(start_time: Instant, file_size_bytes: i64, code: &str, message: String) -> Self {
+        NativeExtraction {
+            segments: vec![],
+            errors: vec![ExtractionError::new(code.to_string(), message, false)],
+            file_size_bytes,
+            processing_time_ms: start_time.elapsed().as_secs_f64() * 1000.0,
+            parser: "none",
+        }
+    }
+
+    /// with_segments=false: batch mode, text travels in DocxBatch instead
+    fn into_result(self, py: Python, with_segments: bool) -> ExtractionResult {
+        let metadata = PyDict::new(py);
+        // Failed extractions keep an empty metadata dict
+        if self.errors.is_empty() {
+            if let Err(e) = metadata.set_item("paragraph_count", self.segments.len()) {
+                eprintln!("Failed to set metadata: {}", e);
+            }
+            if let Err(e) = metadata.set_item("parser", self.parser) {
+                eprintln!("Failed to set metadata: {}", e);
+            }
+        }
+
+        ExtractionResult {
+            segments: if with_segments {
+                self.segments
+                    .into_iter()
+                    .map(|seg| {
+                        let section = seg.section();
+                        TextSegment::new(seg.text, None, Some(section), 1.0)
+                    })
+                    .collect()
+            } else {
+                vec![]
+            },
+            metadata: metadata.unbind(),
+            processing_time_ms: self.processing_time_ms,
+            file_size_bytes: self.file_size_bytes,
+            errors: self.errors,
+            truncated: false,
+            extractor: EXTRACTOR_NAME.to_string(),
+            version: EXTRACTOR_VERSION.to_string(),
+        }
+    }
+}
+
+/// Open, map and parse one DOCX file (no Python API calls allowed here)
+fn extract_native(file_path: &str) -> NativeExtraction {
     let start_time = Instant::now();
 
     // Get file size
-    let file_size = match std::fs::metadata(&file_path) {
+    let file_size = match std::fs::metadata(file_path) {
         Ok(metadata) => metadata.len() as i64,
         Err(_) => 0,
     };
 
-    // Create metadata dict
-    let metadata = PyDict::new(py);
-
-    // Try to read file
-    let mut file = match File::open(&file_path) {
+    let file = match File::open(file_path) {
         Ok(f) => f,
         Err(e) => {
             // File not found or permission denied
-            let error = ExtractionError::new(
-                "FILE_NOT_FOUND".to_string(),
+            return NativeExtraction::failed(
+                start_time,
+                file_size,
+                "FILE_NOT_FOUND",
                 format!("Failed to open file: {}", e),
-                false,
             );
+        }
+    };
 
-            return Ok(ExtractionResult {
-                segments: vec![],
-                metadata: metadata.unbind(),
-                processing_time_ms: start_time.elapsed().as_secs_f64() * 1000.0,
-                file_size_bytes: file_size,
-                errors: vec![error],
-                truncated: false,
-                extractor: "docx_rust".to_string(),
-                version: "1.0.0".to_string(),
-            });
+    // SAFETY: the mapping is read-only and dropped before returning. A file
+    // truncated by another process while mapped can SIGBUS - the same
+    // exposure the pipeline's sandboxed workers already contain.
+    let mmap = match unsafe { Mmap::map(&file) } {
+        Ok(m) => m,
+        Err(e) => {
+            return NativeExtraction::failed(
+                start_time,
+                file_size,
+                "READ_ERROR",
+                format!("Failed to read file: {}", e),
+            );
         }
     };
 
-    // Read file content
-    let mut buffer = Vec::new();
-    if let Err(e) = file.read_to_end(&mut buffer) {
-        let error = ExtractionError::new(
-            "READ_ERROR".to_string(),
-            format!("Failed to read file: {}", e),
-            false,
-        );
+    let (segments, parser) = match stream_segments(&mmap) {
+        Ok(segments) => (segments, "stream"),
+        Err(stream_err) => match model_segments(&mmap) {
+            Ok(segments) => (segments, "model"),
+            Err(e) => {
+                return NativeExtraction::failed(
+                    start_time,
+                    file_size,
+                    "CORRUPTED",
+                    format!("Failed to parse DOCX: {} (streaming: {})", e, stream_err),
+                );
+            }
+        },
+    };
 
-        return Ok(ExtractionResult {
-            segments: vec![],
-            metadata: metadata.unbind(),
-            processing_time_ms: start_time.elapsed().as_secs_f64() * 1000.0,
-            file_size_bytes: file_size,
-            errors: vec![error],
-            truncated: false,
-            extractor: "docx_rust".to_string(),
-            version: "1.0.0".to_string(),
-        });
+    NativeExtraction {
+        segments,
+        errors: vec![],
+        file_size_bytes: file_size,
+        processing_time_ms: start_time.elapsed().as_secs_f64() * 1000.0,
+        parser,
     }
+}
 
-    // Parse DOCX
-    let docx = match docx_rs::read_docx(&buffer) {
-        Ok(d) => d,
-        Err(e) => {
-            let error = ExtractionError::new(
-                "CORRUPTED".to_string(),
-                format!("Failed to parse DOCX: {}", e),
-                false,
-            );
+/// Fast path: pull-parse word/document.xml straight from the zip entry.
+///
+/// Produces the same segments as model_segments(): one per non-empty
+/// body paragraph ("paragraph_<idx>") and per table ("table_<idx>", cell
+/// texts separated by ' ', cells by '\t', rows by '\n').
+fn stream_segments(data: &[u8]) -> Result<Vec<NativeSegment>, String> {
+    let mut archive = zip::ZipArchive::new(Cursor::new(data)).map_err(|e| e.to_string())?;
+    let part = archive.by_name(DOCUMENT_PART).map_err(|e| e.to_string())?;
+
+    let mut reader = Reader::from_reader(BufReader::new(part));
+    reader.config_mut().trim_text(false);
+
+    let mut segments = Vec::new();
+    let mut buf = Vec::new();
+    let mut depth: usize = 0;
+    let mut body_depth: Option<usize> = None;
+    let mut child_idx: usize = 0;
+    let mut block: Option<(BlockKind, usize)> = None;
+    let mut in_text = false;
+    // Reused across blocks: one allocation grows to the largest block
+    let mut text = String::new();
+
+    loop {
+        match reader.read_event_into(&mut buf) {
+            Ok(Event::Start(e)) => {
+                depth += 1;
+                let name = e.local_name();
+                match name.as_ref() {
+                    b"body" if body_depth.is_none() => body_depth = Some(depth),
+                    b"t" if block.is_some() => in_text = true,
+                    local if body_depth.map_or(false, |b| depth == b + 1) => {
+                        if local != b"sectPr" {
+                            block = match local {
+                                b"p" => Some((BlockKind::Paragraph, child_idx)),
+                                b"tbl" => Some((BlockKind::Table, child_idx)),
+                                _ => None,
+                            };
+                            child_idx += 1;
+                        }
+                    }
+                    _ => {}
+                }
+            }
+            Ok(Event::Empty(e)) => {
+                // <w:p/> etc. directly in the body still take an index
+                if body_depth.map_or(false, |b| depth == b) && e.local_name().as_ref() != b"sectPr"
+                {
+                    child_idx += 1;
+                }
+            }
+            Ok(Event::Text(t)) if in_text => {
+                let unescaped = t.unescape().map_err(|e| e.to_string())?;
+                text.push_str(&unescaped);
+            }
+            Ok(Event::End(e)) => {
+                let name = e.local_name();
+                match (name.as_ref(), block) {
+                    (b"t", Some((kind, _))) => {
+                        in_text = false;
+                        if kind == BlockKind::Table {
+                            text.push(' ');
+                        }
+                    }
+                    (b"tc", Some((BlockKind::Table, _))) => text.push('\t'), // Tab between cells
+                    (b"tr", Some((BlockKind::Table, _))) => text.push('\n'), // Newline between rows
+                    _ => {}
+                }
 
-            return Ok(ExtractionResult {
-                segments: vec![],
-                metadata: metadata.unbind(),
-                processing_time_ms: start_time.elapsed().as_secs_f64() * 1000.0,
-                file_size_bytes: file_size,
-                errors: vec![error],
-                truncated: false,
-                extractor: "docx_rust".to_string(),
-                version: "1.0.0".to_string(),
-            });
+                if body_depth.map_or(false, |b| depth == b + 1) {
+                    if let Some((kind, idx)) = block.take() {
+                        if !text.trim().is_empty() {
+                            segments.push(NativeSegment {
+                                text: text.clone(),
+                                kind,
+                                index: idx as u32,
+                            });
+                        }
+                        text.clear();
+                    }
+                }
+                depth = depth.saturating_sub(1);
+            }
+            Ok(Event::Eof) => break,
+            Ok(_) => {}
+            Err(e) => return Err(format!("{} at byte {}", e, reader.buffer_position())),
         }
-    };
+        buf.clear();
+    }
+
+    if body_depth.is_none() {
+        return Err(format!("{} has no w:body", DOCUMENT_PART));
+    }
+    Ok(segments)
+}
 
-    // Extract text from document
+/// Fallback: build the full docx-rs model (handles parts the streaming
+/// parser rejects, at the cost of the whole document in memory)
+fn model_segments(data: &[u8]) -> Result<Vec<NativeSegment>, String> {
+    let docx = docx_rs::read_docx(data).map_err(|e| e.to_string())?;
     let mut segments = Vec::new();
-    let mut errors = Vec::new();
 
     // Extract paragraphs
     for (idx, child) in docx.document.children.iter().enumerate() {
@@ -193,12 +370,11 @@ fn extract_docx(py: Python, file_path: String) -> PyResult<ExtractionResult> {
 
                 // Only add non-empty paragraphs
                 if !para_text.trim().is_empty() {
-                    segments.push(TextSegment::new(
-                        para_text,
-                        None,
-                        Some(format!("paragraph_{}", idx)),
-                        1.0,
-                    ));
+                    segments.push(NativeSegment {
+                        text: para_text,
+                        kind: BlockKind::Paragraph,
+                        index: idx as u32,
+                    });
                 }
             }
             docx_rs::DocumentChild::Table(table) => {
@@ -227,12 +403,11 @@ fn extract_docx(py: Python, file_path: String) -> PyResult<ExtractionResult> {
                 }
 
                 if !table_text.trim().is_empty() {
-                    segments.push(TextSegment::new(
-                        table_text,
-                        None,
-                        Some(format!("table_{}", idx)),
-                        1.0,
-                    ));
+                    segments.push(NativeSegment {
+                        text: table_text,
+                        kind: BlockKind::Table,
+                        index: idx as u32,
+                    });
                 }
             }
             _ => {
@@ -241,31 +416,194 @@ fn extract_docx(py: Python, file_path: String) -> PyResult<ExtractionResult> {
         }
     }
 
-    // Add metadata
-    if let Err(e) = metadata.set_item("paragraph_count", segments.len()) {
-        eprintln!("Failed to set metadata: {}", e);
+    Ok(segments)
+}
+
+// ---------------------------------------------------------------------------
+// Python API
+// ---------------------------------------------------------------------------
+
+/// Extract text from DOCX file
+///
+/// The GIL is released while the file is mapped and parsed.
+///
+/// Args:
+///     file_path: Path to DOCX file
+///
+/// Returns:
+///     ExtractionResult with text segments and metadata
+#[pyfunction]
+fn extract_docx(py: Python, file_path: String) -> PyResult<ExtractionResult> {
+    let native = py.allow_threads(|| extract_native(&file_path));
+    Ok(native.into_result(py, true))
+}
+
+/// Packed result of extract_docx_batch
+///
+/// Segment i of the batch is text[segment_offsets[i]:segment_offsets[i+1]]
+/// (offsets in characters, so Python slices directly); document d owns
+/// segments document_offsets[d]..document_offsets[d+1]. Offset arrays are
+/// native-endian u64 bytes (memoryview(b).cast("Q")), section_indices u32
+/// ("I"); section_kinds holds b'p' (paragraph) or b't' (table) per segment.
+#[pyclass]
+struct DocxBatch {
+    #[pyo3(get)]
+    text: Py<PyString>,
+    #[pyo3(get)]
+    segment_offsets: Py<PyBytes>,
+    #[pyo3(get)]
+    section_kinds: Py<PyBytes>,
+    #[pyo3(get)]
+    section_indices: Py<PyBytes>,
+    #[pyo3(get)]
+    document_offsets: Py<PyBytes>,
+    /// One ExtractionResult per path (metadata/errors/timing, no segments)
+    #[pyo3(get)]
+    documents: Py<PyList>,
+}
+
+/// DocxBatch buffers before they become Python objects
+struct PackedSegments {
+    text: String,
+    segment_offsets: Vec<u8>,
+    section_kinds: Vec<u8>,
+    section_indices: Vec<u8>,
+    document_offsets: Vec<u8>,
+}
+
+impl PackedSegments {
+    /// Lay out the segments of `natives` as described on DocxBatch
+    fn build(natives: &[NativeExtraction]) -> Self {
+        let total_bytes: usize = natives
+            .iter()
+            .flat_map(|n| n.segments.iter())
+            .map(|seg| seg.text.len())
+            .sum();
+        let total_segments: usize = natives.iter().map(|n| n.segments.len()).sum();
+
+        let mut packed = PackedSegments {
+            text: String::with_capacity(total_bytes),
+            segment_offsets: Vec::with_capacity((total_segments + 1) * 8),
+            section_kinds: Vec::with_capacity(total_segments),
+            section_indices: Vec::with_capacity(total_segments * 4),
+            document_offsets: Vec::with_capacity((natives.len() + 1) * 8),
+        };
+
+        let mut chars: u64 = 0;
+        let mut segment_count: u64 = 0;
+        packed
+            .segment_offsets
+            .extend_from_slice(&chars.to_ne_bytes());
+        packed
+            .document_offsets
+            .extend_from_slice(&segment_count.to_ne_bytes());
+
+        for native in natives {
+            for seg in &native.segments {
+                packed.text.push_str(&seg.text);
+                chars += seg.text.chars().count() as u64;
+                packed
+                    .segment_offsets
+                    .extend_from_slice(&chars.to_ne_bytes());
+
+                packed.section_kinds.push(match seg.kind {
+                    BlockKind::Paragraph => b'p',
+                    BlockKind::Table => b't',
+                });
+                packed
+                    .section_indices
+                    .extend_from_slice(&seg.index.to_ne_bytes());
+                segment_count += 1;
+            }
+            packed
+                .document_offsets
+                .extend_from_slice(&segment_count.to_ne_bytes());
+        }
+        packed
+    }
+}
+
+impl DocxBatch {
+    fn pack(py: Python, natives: Vec<NativeExtraction>) -> PyResult<Self> {
+        let packed = PackedSegments::build(&natives);
+        let documents = PyList::empty(py);
+        for native in natives {
+            documents.append(Py::new(py, native.into_result(py, false))?)?;
+        }
+
+        Ok(DocxBatch {
+            text: PyString::new(py, &packed.text).unbind(),
+            segment_offsets: PyBytes::new(py, &packed.segment_offsets).unbind(),
+            section_kinds: PyBytes::new(py, &packed.section_kinds).unbind(),
+            section_indices: PyBytes::new(py, &packed.section_indices).unbind(),
+            document_offsets: PyBytes::new(py, &packed.document_offsets).unbind(),
+            documents: documents.unbind(),
+        })
+    }
+}
+
+/// Rayon pools by thread count, built on first use and kept for the
+/// process (extract_docx_batch runs once per worker batch)
+static SIZED_POOLS: OnceLock<Mutex<HashMap<usize, Arc<rayon::ThreadPool>>>> = OnceLock::new();
+
+fn sized_pool(threads: usize) -> PyResult<Arc<rayon::ThreadPool>> {
+    let mut pools = SIZED_POOLS
+        .get_or_init(|| Mutex::new(HashMap::new()))
+        .lock()
+        .unwrap_or_else(|poisoned| poisoned.into_inner());
+    if let Some(pool) = pools.get(&threads) {
+        return Ok(Arc::clone(pool));
     }
+    let pool = rayon::ThreadPoolBuilder::new()
+        .num_threads(threads)
+        .thread_name(move |i| format!("docx-rayon-{threads}-{i}"))
+        .build()
+        .map_err(|e| pyo3::exceptions::PyRuntimeError::new_err(e.to_string()))?;
+    let pool = Arc::new(pool);
+    pools.insert(threads, Arc::clone(&pool));
+    Ok(pool)
+}
 
-    let processing_time = start_time.elapsed().as_secs_f64() * 1000.0;
+/// Extract many DOCX files in parallel
+///
+/// Files are processed with the GIL released; results keep the order of
+/// `paths`. threads=0 uses Rayon's global pool, threads=1 runs on the
+/// calling thread, other sizes use a pool cached per size.
+///
+/// Args:
+///     paths: DOCX file paths
+///     threads: Rayon threads (0 = one per CPU)
+///
+/// Returns:
+///     DocxBatch (flat text buffer + offset arrays)
+#[pyfunction]
+#[pyo3(signature = (paths, threads=0))]
+fn extract_docx_batch(py: Python, paths: Vec<String>, threads: usize) -> PyResult<DocxBatch> {
+    let natives: Vec<NativeExtraction> = match threads {
+        0 => py.allow_threads(|| paths.par_iter().map(|path| extract_native(path)).collect()),
+        1 => py.allow_threads(|| paths.iter().map(|path| extract_native(path)).collect()),
+        n => {
+            let pool = sized_pool(n)?;
+            py.allow_threads(|| {
+                pool.install(|| paths.par_iter().map(|path| extract_native(path)).collect())
+            })
+        }
+    };
 
-    Ok(ExtractionResult {
-        segments,
-        metadata: metadata.unbind(),
-        processing_time_ms: processing_time,
-        file_size_bytes: file_size,
-        errors,
-        truncated: false,
-        extractor: "docx_rust".to_string(),
-        version: "1.0.0".to_string(),
-    })
+    DocxBatch::pack(py, natives)
 }
 
 /// Python module definition
 #[pymodule]
 fn docx_extractor(m: &Bound<'_, PyModule>) -> PyResult<()> {
     m.add_function(wrap_pyfunction!(extract_docx, m)?)?;
+    m.add_function(wrap_pyfunction!(extract_docx_batch, m)?)?;
+    // ExtractionCache identity of results from this module
+    m.add("EXTRACTOR_NAME", EXTRACTOR_NAME)?;
+    m.add("VERSION", EXTRACTOR_VERSION)?;
     m.add_class::<TextSegment>()?;
     m.add_class::<ExtractionError>()?;
     m.add_class::<ExtractionResult>()?;
+    m.add_class::<DocxBatch>()?;
     Ok(())
 }
@@ -8,7 +8,7 @@ Integrates with security foundation (PathGuard, InputValidator, SandboxExecutor)
 
 import time
 from pathlib import Path
-from typing import Optional
+from typing import Iterator, Optional, Tuple
 
 try:
     import fitz  # PyMuPDF
@@ -28,6 +28,7 @@ class PDFExtractor:
     - Metadata extraction (title, author, page count, etc.)
     - Graceful degradation for corrupted PDFs
     - Performance tracking
+    - Streaming (extract_stream) with a per-document character budget
     
     Security:
     - Should be called through SandboxExecutor for resource limits
@@ -38,11 +39,24 @@ class PDFExtractor:
     VERSION = "1.0.0"
     EXTRACTOR_NAME = "pdf_pymupdf"
     
-    def __init__(self):
+    # Per-document character budget (None = unlimited): the page that
+    # crosses it is cut mid-page at the budget, later pages are skipped,
+    # result.truncated is set and metadata["truncated_at_page"] names it
+    DEFAULT_MAX_CHARS = 20_000_000
+    
+    # pipeline: extract_stream() may feed FTSBatchWriter page by page
+    SUPPORTS_STREAMING = True
+    
+    def __init__(self, max_chars: Optional[int] = DEFAULT_MAX_CHARS):
+        """
+        Args:
+            max_chars: Character budget per document (None = unlimited)
+        """
         if not PYMUPDF_AVAILABLE:
             raise RuntimeError(
                 "PyMuPDF not available. Install with: pip install PyMuPDF>=1.26"
             )
+        self.max_chars = max_chars
     
     def extract(self, file_path: Path) -> ExtractionResult:
         """
@@ -58,7 +72,31 @@ class PDFExtractor:
             This method does NOT perform security checks.
             Caller must validate path and input before calling.
         """
-        start_time = time.perf_counter()
+        result, segments = self.extract_stream(file_path)
+        result.segments.extend(segments)
+        return result
+    
+    def extract_stream(
+        self,
+        file_path: Path,
+        max_chars: Optional[int] = None
+    ) -> Tuple[ExtractionResult, Iterator[TextSegment]]:
+        """
+        Streaming mode: yield one TextSegment per page.
+        
+        Only the current page's text is alive at any time, so a 2,000-page
+        PDF never builds segments/total_text in memory. The returned result
+        gets metadata, errors, truncated and processing_time_ms as the
+        iterator is consumed; result.segments stays empty.
+        
+        Args:
+            file_path: Path to PDF file
+            max_chars: Budget override (default: self.max_chars)
+            
+        Returns:
+            (result, segment iterator) - result is final once the
+            iterator is exhausted
+        """
         result = ExtractionResult(
             extractor=self.EXTRACTOR_NAME,
             version=self.VERSION
@@ -70,6 +108,17 @@ class PDFExtractor:
         except Exception:
             result.file_size_bytes = 0
         
+        budget = self.max_chars if max_chars is None else max_chars
+        return result, self._iter_pages(file_path, result, budget)
+    
+    def _iter_pages(
+        self,
+        file_path: Path,
+        result: ExtractionResult,
+        budget: Optional[int]
+    ) -> Iterator[TextSegment]:
+        start_time = time.perf_counter()
+        
         # Open PDF
         doc = None
         try:
@@ -81,7 +130,7 @@ class PDFExtractor:
                 recoverable=False
             )
             result.processing_time_ms = (time.perf_counter() - start_time) * 1000
-            return result
+            return
         except fitz.FileDataError as e:
             result.add_error(
                 ExtractionError.CORRUPTED,
@@ -89,7 +138,7 @@ class PDFExtractor:
                 recoverable=False
             )
             result.processing_time_ms = (time.perf_counter() - start_time) * 1000
-            return result
+            return
         except Exception as e:
             result.add_error(
                 ExtractionError.INVALID_FORMAT,
@@ -97,8 +146,9 @@ class PDFExtractor:
                 recoverable=False
             )
             result.processing_time_ms = (time.perf_counter() - start_time) * 1000
-            return result
+            return
         
+        yielded = 0
         try:
             # Extract metadata
             result.metadata = self._extract_metadata(doc)
@@ -110,22 +160,16 @@ class PDFExtractor:
                     "PDF is password protected",
                     recoverable=False
                 )
-                return result
+                return
             
-            # Extract text from each page
+            # Extract text page by page
+            remaining = budget
             page_count = len(doc)
             for page_num in range(page_count):
                 try:
-                    page = doc[page_num]
-                    text = page.get_text()
-                    
-                    # Only add non-empty pages
-                    if text.strip():
-                        result.segments.append(TextSegment(
-                            text=text,
-                            page=page_num + 1,  # 1-indexed for user display
-                            confidence=1.0
-                        ))
+                    page = doc.load_page(page_num)
+                    text = page.get_text("text")
+                    page = None  # release page resources before the next one
                 except Exception as e:
                     # Partial extraction: log error but continue
                     result.add_error(
@@ -134,23 +178,45 @@ class PDFExtractor:
                         recoverable=True
                     )
                     result.truncated = True
+                    continue
+                
+                # Only add non-empty pages
+                if not text.strip():
+                    continue
+                
+                if remaining is not None and len(text) > remaining:
+                    # Budget exhausted: keep what fits, skip the rest
+                    text = text[:remaining]
+                    result.truncated = True
+                    result.metadata["truncated_at_page"] = page_num + 1
+                    if text.strip():
+                        yielded += 1
+                        yield TextSegment(text=text, page=page_num + 1, confidence=1.0)
+                    break
+                
+                if remaining is not None:
+                    remaining -= len(text)
+                yielded += 1
+                yield TextSegment(
+                    text=text,
+                    page=page_num + 1,  # 1-indexed for user display
+                    confidence=1.0
+                )
             
             # If we got some segments despite errors, mark as partial success
-            if len(result.segments) > 0 and len(result.errors) > 0:
+            if yielded > 0 and len(result.errors) > 0:
                 result.truncated = True
                 
         except Exception as e:
             result.add_error(
                 ExtractionError.CORRUPTED,
                 f"Extraction failed: {e}",
-                recoverable=len(result.segments) > 0
+                recoverable=yielded > 0
             )
         finally:
             if doc:
                 doc.close()
             result.processing_time_ms = (time.perf_counter() - start_time) * 1000
-        
-        return result
     
     def _extract_metadata(self, doc: "fitz.Document") -> dict:
         """Extract metadata from PDF document"""
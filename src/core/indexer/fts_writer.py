@@ -0,0 +1,485 @@
+"""
+FTS_WRITER.PY - Group-Commit Writer for documents / document_content
+Task 6.5 - Sprint 6 Background Services
+
+Every commit on SQLCipher pays a page-encrypt + WAL fsync cycle; for
+small files that dominates indexing time. FTSBatchWriter writes rows into
+one open transaction and commits once per batch_size documents or once
+the oldest uncommitted document has waited max_delay_ms.
+
+Schema (ensure_schema()): documents.id keys one document_segments row per
+extracted segment; document_content is an external-content FTS5 index
+over those rows (rowid = segment id). Re-indexing a file diffs segment
+hashes, so a one-page edit re-tokenizes one page, never the whole file.
+
+Bulk import (bulk_import()):
+- FTS5 automerge disabled while loading (no incremental segment merges)
+- 'optimize' afterwards merges everything into one b-tree
+
+Single-writer: NOT thread-safe, call from the thread owning the db
+connection (ExtractionPipeline.process_many's caller thread).
+"""
+
+import hashlib
+import time
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Any, Dict, Iterable, Iterator, List, Optional, Tuple
+
+from .encrypted_storage import EncryptedIndexerDB
+from .extractors.result import ExtractionResult, TextSegment
+
+# documents.id is the stable key; one document_segments row per
+# ExtractionResult segment (page/paragraph); document_content is an
+# external-content FTS5 index over document_segments (text stored once)
+_DOCUMENTS_DDL = """
+CREATE TABLE IF NOT EXISTS documents (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    path TEXT UNIQUE,
+    filename TEXT,
+    mime_type TEXT,
+    total_chars INTEGER,
+    created_at TEXT,
+    content_hash TEXT
+)
+"""
+
+_SEGMENTS_DDL = """
+CREATE TABLE IF NOT EXISTS document_segments (
+    id INTEGER PRIMARY KEY,
+    doc_id INTEGER NOT NULL REFERENCES documents(id),
+    seg_no INTEGER NOT NULL,
+    seg_hash BLOB NOT NULL,
+    page INTEGER,
+    content TEXT NOT NULL
+)
+"""
+
+_SEGMENTS_INDEX_DDL = (
+    "CREATE INDEX IF NOT EXISTS idx_document_segments_doc ON document_segments(doc_id, seg_no)"
+)
+
+_FTS_DDL = """
+CREATE VIRTUAL TABLE {table} USING fts5(
+    content,
+    content='document_segments',
+    content_rowid='id'
+)
+"""
+
+
+def segment_hash(text: str) -> bytes:
+    """128-bit content hash used to diff segments across re-index."""
+    return hashlib.blake2b(text.encode("utf-8"), digest_size=16).digest()
+
+
+class FTSBatchWriter:
+    """Batched FTS5 writes with one commit per group."""
+
+    DEFAULT_BATCH_SIZE = 64
+    DEFAULT_MAX_DELAY_MS = 200
+    FTS_DEFAULT_AUTOMERGE = 4  # SQLite FTS5 default
+    FTS_TABLE = "document_content"
+
+    def __init__(
+        self,
+        db: EncryptedIndexerDB,
+        batch_size: int = DEFAULT_BATCH_SIZE,
+        max_delay_ms: int = DEFAULT_MAX_DELAY_MS
+    ):
+        """
+        Args:
+            db: EncryptedIndexerDB (documents + document_content tables)
+            batch_size: Commit after this many documents (1 = every write)
+            max_delay_ms: Commit once the oldest pending write is this old
+        """
+        self.db = db
+        self.batch_size = max(1, batch_size)
+        self.max_delay_s = max(0, max_delay_ms) / 1000.0
+
+        self._pending: List[Any] = []   # caller tokens in write order
+        self._first_write = 0.0          # monotonic time of oldest pending
+        self._schema_ready = False
+
+        # Bumped after every commit that can change search results
+        # (FTSSearchEngine invalidates its result cache on it)
+        self.commit_seq = 0
+
+        # Metrics
+        self.documents_written = 0
+        self.commits = 0
+        self.segments_indexed = 0   # tokenized into FTS
+        self.segments_reused = 0    # unchanged across re-index
+        self.segments_deleted = 0
+        self.documents_relinked = 0
+
+    # -------------------------------------------------------------------
+    # WRITES
+    # -------------------------------------------------------------------
+
+    def ensure_schema(self) -> None:
+        """
+        Create the content-linked schema, migrating the legacy layout.
+
+        The legacy document_content (standalone fts5(content), no key to
+        documents) cannot be linked to documents, so it is dropped;
+        affected files are re-indexed the next time they are processed.
+        """
+        if self._schema_ready:
+            return
+
+        self.db.execute(_DOCUMENTS_DDL)
+        columns = {row[1] for row in self.db.execute("PRAGMA table_info(documents)")}
+        if "content_hash" not in columns:
+            self.db.execute("ALTER TABLE documents ADD COLUMN content_hash TEXT")
+        self.db.execute(
+            "CREATE INDEX IF NOT EXISTS idx_documents_content_hash ON documents(content_hash)"
+        )
+        self.db.execute(_SEGMENTS_DDL)
+        self.db.execute(_SEGMENTS_INDEX_DDL)
+
+        row = self.db.execute(
+            "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = ?",
+            (self.FTS_TABLE,)
+        ).fetchone()
+        if row is not None and "content_rowid" not in row[0]:
+            print(f"⚠️ [FTS_WRITER] Dropping legacy unkeyed {self.FTS_TABLE}; files re-index on next change")
+            self.db.execute(f"DROP TABLE {self.FTS_TABLE}")
+            row = None
+        if row is None:
+            self.db.execute(_FTS_DDL.format(table=self.FTS_TABLE))
+
+        self.db.commit()
+        self.commit_seq += 1
+        self._schema_ready = True
+
+    def write(
+        self,
+        path: Path,
+        result: ExtractionResult,
+        token: Any = None,
+        segments: Optional[Iterable[TextSegment]] = None,
+        content_hash: Optional[str] = None
+    ) -> None:
+        """
+        Write one document into the open transaction (no commit).
+
+        Segments are diffed against the stored ones by content hash:
+        unchanged segments keep their FTS rows (just renumbered if they
+        moved), only new/changed text is tokenized, vanished segments are
+        removed from the index.
+
+        Args:
+            path: Indexed file
+            result: Extraction result to store
+            token: Returned by commit() once the rows are durable
+            segments: Streaming mode - consumed one at a time instead of
+                result.segments (e.g. PDFExtractor.extract_stream)
+            content_hash: Stored on the document row once its segments
+                are synced (see relink())
+
+        Raises:
+            Exception: From the driver or `segments`; everything this call
+                wrote is rolled back (SAVEPOINT), rows of earlier pending
+                documents stay in the transaction
+        """
+        self.ensure_schema()
+
+        # SAVEPOINT outside a transaction would start (and RELEASE commit)
+        # one of its own - open the group transaction first
+        if not self.db.in_transaction:
+            self.db.execute("BEGIN")
+        self.db.execute("SAVEPOINT doc")
+        try:
+            self._write_document(path, result, segments, content_hash)
+        except Exception:
+            self.db.execute("ROLLBACK TO doc")
+            self.db.execute("RELEASE doc")
+            raise
+        self.db.execute("RELEASE doc")
+
+        self._queue(token)
+        self.documents_written += 1
+
+    def _write_document(
+        self,
+        path: Path,
+        result: ExtractionResult,
+        segments: Optional[Iterable[TextSegment]],
+        content_hash: Optional[str]
+    ) -> None:
+        """write() body, run inside its per-document savepoint."""
+        # 1. Upsert document metadata (keeps documents.id stable across
+        #    re-index - segment rows reference it). content_hash is left
+        #    alone until step 3: relink() trusts it to mean "indexed"
+        abs_path = str(path.absolute())
+        self.db.execute(
+            """
+            INSERT INTO documents (path, filename, mime_type, total_chars, created_at)
+            VALUES (?, ?, ?, ?, ?)
+            ON CONFLICT(path) DO UPDATE SET
+                filename = excluded.filename,
+                mime_type = excluded.mime_type,
+                total_chars = excluded.total_chars,
+                created_at = excluded.created_at
+            """,
+            (
+                abs_path,
+                path.name,
+                result.extractor,
+                result.total_chars,
+                time.strftime('%Y-%m-%d %H:%M:%S')
+            )
+        )
+        doc_id = self.db.execute(
+            "SELECT id FROM documents WHERE path = ?", (abs_path,)
+        ).fetchone()[0]
+
+        # 2. Diff segments by hash, touch FTS only for what changed
+        if segments is None:
+            total_chars = self._sync_segments(doc_id, result.segments)
+        else:
+            total_chars = self._sync_segments(doc_id, segments)
+
+        # 3. Segments are in: record the content they came from
+        self.db.execute(
+            "UPDATE documents SET total_chars = ?, content_hash = ? WHERE id = ?",
+            (total_chars, content_hash, doc_id)
+        )
+
+    def relink(self, path: Path, content_hash: str, token: Any = None) -> bool:
+        """
+        Metadata-only indexing for content that is already indexed.
+
+        - Same path, same content (touch, mtime-only change): nothing to do
+        - Same content at a path that no longer exists (move / rename):
+          the document row is re-pointed at `path`, segments and FTS rows
+          are kept as they are
+
+        Returns:
+            True if `path` is now indexed with this content (token queued
+            like write()), False if the caller must write it
+        """
+        self.ensure_schema()
+        abs_path = str(path.absolute())
+        row = self.db.execute(
+            "SELECT content_hash FROM documents WHERE path = ?", (abs_path,)
+        ).fetchone()
+        if row is not None and row[0] == content_hash:
+            self._queue(token)
+            return True
+
+        moved = None
+        for doc_id, old_path in self.db.execute(
+            "SELECT id, path FROM documents WHERE content_hash = ? AND path != ?",
+            (content_hash, abs_path)
+        ).fetchall():
+            if not Path(old_path).exists():
+                moved = doc_id
+                break
+        if moved is None:
+            return False
+
+        if row is not None:
+            # Moved over an indexed file: the old occupant goes
+            self._delete_document(abs_path)
+        self.db.execute(
+            "UPDATE documents SET path = ?, filename = ? WHERE id = ?",
+            (abs_path, path.name, moved)
+        )
+        self.documents_relinked += 1
+        self._queue(token)
+        return True
+
+    def iter_segments(self, path: Path) -> Iterator[TextSegment]:
+        """Stored segments of `path` in order (read back one at a time)."""
+        cursor = self.db.execute(
+            """
+            SELECT s.content, s.page FROM document_segments s
+            JOIN documents d ON d.id = s.doc_id
+            WHERE d.path = ? ORDER BY s.seg_no
+            """,
+            (str(path.absolute()),)
+        )
+        for content, page in cursor:
+            yield TextSegment(text=content, page=page)
+
+    def _queue(self, token: Any) -> None:
+        if not self._pending:
+            self._first_write = time.monotonic()
+        self._pending.append(token)
+
+    def _sync_segments(self, doc_id: int, segments: Iterable[TextSegment]) -> int:
+        """Returns total characters written (segments consumed once)."""
+        # Stored: hash → [(segment rowid, seg_no)], several if text repeats
+        stored: Dict[bytes, List[Tuple[int, int]]] = {}
+        for seg_id, seg_no, seg_hash in self.db.execute(
+            "SELECT id, seg_no, seg_hash FROM document_segments WHERE doc_id = ? ORDER BY seg_no",
+            (doc_id,)
+        ):
+            stored.setdefault(bytes(seg_hash), []).append((seg_id, seg_no))
+
+        total_chars = 0
+        for seg_no, segment in enumerate(segments):
+            total_chars += len(segment.text)
+            seg_hash = segment_hash(segment.text)
+            matches = stored.get(seg_hash)
+            if matches:
+                seg_id, old_no = matches.pop(0)
+                if old_no != seg_no:
+                    # Moved, same text: renumber, FTS row untouched
+                    self.db.execute(
+                        "UPDATE document_segments SET seg_no = ?, page = ? WHERE id = ?",
+                        (seg_no, segment.page, seg_id)
+                    )
+                self.segments_reused += 1
+            else:
+                cursor = self.db.execute(
+                    """
+                    INSERT INTO document_segments (doc_id, seg_no, seg_hash, page, content)
+                    VALUES (?, ?, ?, ?, ?)
+                    """,
+                    (doc_id, seg_no, seg_hash, segment.page, segment.text)
+                )
+                self.db.execute(
+                    f"INSERT INTO {self.FTS_TABLE} (rowid, content) VALUES (?, ?)",
+                    (cursor.lastrowid, segment.text)
+                )
+                self.segments_indexed += 1
+
+        # Vanished segments: FTS 'delete' needs the indexed text
+        for matches in stored.values():
+            for seg_id, _ in matches:
+                self._delete_segment(seg_id)
+        return total_chars
+
+    def _delete_segment(self, seg_id: int) -> None:
+        self.db.execute(
+            f"""
+            INSERT INTO {self.FTS_TABLE} ({self.FTS_TABLE}, rowid, content)
+            SELECT 'delete', id, content FROM document_segments WHERE id = ?
+            """,
+            (seg_id,)
+        )
+        self.db.execute("DELETE FROM document_segments WHERE id = ?", (seg_id,))
+        self.segments_deleted += 1
+
+    def delete(self, path: Path, token: Any = None) -> bool:
+        """
+        Remove a document and its index rows (open transaction, no commit).
+
+        Returns:
+            True if the document existed
+        """
+        self.ensure_schema()
+        if not self._delete_document(str(path.absolute())):
+            return False
+        self._queue(token)
+        return True
+
+    def _delete_document(self, abs_path: str) -> bool:
+        row = self.db.execute(
+            "SELECT id FROM documents WHERE path = ?", (abs_path,)
+        ).fetchone()
+        if row is None:
+            return False
+
+        for (seg_id,) in self.db.execute(
+            "SELECT id FROM document_segments WHERE doc_id = ?", (row[0],)
+        ).fetchall():
+            self._delete_segment(seg_id)
+        self.db.execute("DELETE FROM documents WHERE id = ?", (row[0],))
+        return True
+
+    @property
+    def pending(self) -> int:
+        """Documents written but not yet committed."""
+        return len(self._pending)
+
+    def due(self) -> bool:
+        """True when the pending group should be committed now."""
+        if not self._pending:
+            return False
+        return (
+            len(self._pending) >= self.batch_size
+            or time.monotonic() - self._first_write >= self.max_delay_s
+        )
+
+    def seconds_until_due(self) -> Optional[float]:
+        """Time left before max_delay_ms expires (None = nothing pending)."""
+        if not self._pending:
+            return None
+        return max(0.0, self._first_write + self.max_delay_s - time.monotonic())
+
+    def commit(self) -> Tuple[List[Any], Optional[Exception]]:
+        """
+        Commit all pending documents in one transaction.
+
+        Returns:
+            (tokens, error): tokens of the documents in this group, and
+            None on success or the exception (group rolled back)
+        """
+        tokens, self._pending = self._pending, []
+        if not tokens:
+            return tokens, None
+
+        try:
+            self.db.commit()
+            self.commits += 1
+            self.commit_seq += 1
+            return tokens, None
+        except Exception as e:
+            try:
+                self.db.rollback()
+            except Exception:
+                pass
+            return tokens, e
+
+    def rollback(self) -> List[Any]:
+        """Discard all pending documents; returns their tokens."""
+        tokens, self._pending = self._pending, []
+        self.db.rollback()
+        return tokens
+
+    def commit_if_due(self) -> Tuple[List[Any], Optional[Exception]]:
+        """commit() when due(), else ([], None)."""
+        if self.due():
+            return self.commit()
+        return [], None
+
+    # -------------------------------------------------------------------
+    # BULK IMPORT (FTS5 merge control)
+    # -------------------------------------------------------------------
+
+    def set_automerge(self, level: int) -> None:
+        """FTS5 'automerge' option (0 = off, default 4)."""
+        self.db.execute(
+            f"INSERT INTO {self.FTS_TABLE} ({self.FTS_TABLE}, rank) VALUES ('automerge', ?)",
+            (level,)
+        )
+        self.db.commit()
+        self.commit_seq += 1  # Also commits whatever the caller had pending
+
+    def optimize(self) -> None:
+        """Merge all FTS5 segments into one (slow; run after bulk loads)."""
+        self.db.execute(
+            f"INSERT INTO {self.FTS_TABLE} ({self.FTS_TABLE}) VALUES ('optimize')"
+        )
+        self.db.commit()
+        self.commit_seq += 1
+
+    @contextmanager
+    def bulk_import(self, optimize: bool = True) -> Iterator["FTSBatchWriter"]:
+        """
+        Disable automerge for the duration, restore it and optimize after.
+
+        Pending documents are NOT committed here - the caller commits its
+        own groups (it owns the tokens) before leaving the block.
+        """
+        self.set_automerge(0)
+        try:
+            yield self
+        finally:
+            self.set_automerge(self.FTS_DEFAULT_AUTOMERGE)
+            if optimize:
+                self.optimize()
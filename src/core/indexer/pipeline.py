@@ -8,14 +8,22 @@ Connects PathGuard, Sandbox, Extractors, and SQLCipher into a
 unified data flow for non-blocking file processing.
 """
 
+import collections
 import time
 import logging
+from concurrent.futures import FIRST_COMPLETED, Future, wait
 from pathlib import Path
-from typing import Optional
+from typing import Deque, Dict, Iterable, Iterator, List, Optional, Tuple
 
 from .utils.idempotency import PipelineStatus, EventIdempotency, ProcessingRegistry
 from .registry import ExtractorRegistry
 from .encrypted_storage import EncryptedIndexerDB
+from .extraction_cache import ExtractionCache, content_hash
+from .extraction_pool import ExtractionWorkerPool
+from .fts_writer import FTSBatchWriter
+from .extractors.result import ExtractionResult
+from .sandbox import SandboxExecutor
+from ..utils.histogram import StageHistograms
 
 # Setup logging
 logger = logging.getLogger("indexer.pipeline")
@@ -28,20 +36,59 @@ class ExtractionPipeline:
     1. Idempotency Check (XXH3 metadata hash)
     2. Security Validation (PathGuard/Validator)
     3. MIME Routing (ExtractorRegistry)
+    3b. Content Dedup (XXH3 content hash): moved/touched file -> document
+        row re-linked; copy -> result from ExtractionCache
     4. Text Extraction (Specialized Engine)
     5. FTS5 Persistence (SQLCipher)
+    
+    Each stage records into a latency histogram (get_stats()["latency"]);
+    extraction is also broken down per extractor ("extraction.<name>",
+    from the extractor's own processing_time_ms).
     """
     
-    def __init__(self, db: EncryptedIndexerDB):
+    STAGES = ("idempotency", "mime_routing", "content_hash", "extraction", "fts_write", "fts_commit", "total")
+    
+    # process_many: PDFs are the memory-heavy type (PyMuPDF page buffers)
+    DEFAULT_MIME_LIMITS = {"application/pdf": 4}
+    
+    # process_many: files per task for extractors with SUPPORTS_BATCH
+    # (DOCX: one extract_batch call, one FFI round trip per group)
+    EXTRACT_BATCH_SIZE = 8
+    
+    def __init__(
+        self,
+        db: EncryptedIndexerDB,
+        sandbox: Optional[SandboxExecutor] = None,
+        group_commit_size: int = FTSBatchWriter.DEFAULT_BATCH_SIZE,
+        group_commit_ms: int = FTSBatchWriter.DEFAULT_MAX_DELAY_MS,
+        cache: Optional[ExtractionCache] = None,
+        max_workers: Optional[int] = None,
+        mime_limits: Optional[Dict[str, int]] = None
+    ):
         """
         Initialize the pipeline.
         
         Args:
             db: EncryptedIndexerDB instance for storage
+            sandbox: Timeout/memory limits for process_many workers
+            group_commit_size: process_many - documents per commit
+            group_commit_ms: process_many - max wait before a partial
+                group is committed
+            cache: Content-addressed extraction cache (default: one in db)
+            max_workers: process_many - default worker processes
+            mime_limits: process_many - default per-MIME caps, merged
+                over DEFAULT_MIME_LIMITS (ValueError if a cap is below 1)
         """
         self.db = db
+        self.fts_writer = FTSBatchWriter(db, group_commit_size, group_commit_ms)
+        self.cache = cache or ExtractionCache(db)
+        self.sandbox = sandbox or SandboxExecutor()
+        self._worker_pool: Optional[ExtractionWorkerPool] = None
+        self.max_workers = max_workers
+        self.mime_limits = self._check_mime_limits(dict(mime_limits or {}))
         self.registry = ExtractorRegistry()
         self.idempotency = ProcessingRegistry(ttl_seconds=3600)  # 1 hour TTL
+        self.latency = StageHistograms(*self.STAGES)
     
     def process_file(self, filepath: str | Path) -> PipelineStatus:
         """
@@ -53,57 +100,455 @@ class ExtractionPipeline:
         Returns:
             PipelineStatus indicating the result
         """
-        path = Path(filepath)
-        filename = path.name
-        
-        # 1. IDEMPOTENCY CHECK
-        event_key = EventIdempotency.generate_key(path)
-        if not self.idempotency.should_process(event_key):
-            logger.debug(f"⏭️ [PIPELINE] Skipping duplicate: {filename}")
+        with self.latency.time("total"):
+            return self._process_file(Path(filepath))
+    
+    def _process_file(self, path: Path) -> PipelineStatus:
+        event_key = self._admit(path)
+        if event_key is None:
             return PipelineStatus.INDEXED  # Already processed
         
-        self.idempotency.mark_processing(event_key)
-        
         try:
             # 2. SECURITY VALIDATION
             # PathGuard/Security check should happen here
             
             # 3. MIME ROUTING
-            mime_type = self._detect_mime_type(path)
-            extractor = self.registry.get_extractor(mime_type)
-            
+            mime_type, extractor = self._route(path)
             if not extractor:
-                logger.warning(f"⚠️ [PIPELINE] No extractor for {mime_type}: {filename}")
+                logger.warning(f"⚠️ [PIPELINE] No extractor for {mime_type}: {path.name}")
                 self.idempotency.mark_completed(event_key)
                 return PipelineStatus.DEGRADED
             
+            # 3b. CONTENT DEDUP
+            digest = self._content_hash(path)
+            handled, status = self._reuse(path, event_key, extractor, digest, group=False)
+            if handled:
+                return status
+            
             # 4. EXTRACTION
+            if getattr(extractor, "SUPPORTS_STREAMING", False) is True:
+                return self._process_stream(path, event_key, extractor, digest)
+            
             start_time = time.perf_counter()
             result = extractor.extract(path)
             duration_ms = (time.perf_counter() - start_time) * 1000
             
-            if not result.success:
-                logger.error(f"❌ [PIPELINE] Extraction failed for {filename}: {result.errors[0].message}")
-                if any(not err.recoverable for err in result.errors):
-                    self.idempotency.mark_failed(event_key)
-                    return PipelineStatus.QUARANTINED
-            
-            # 5. PERSISTENCE (SQLCipher FTS5)
-            try:
-                self._save_to_fts(path, result)
-                logger.info(f"✅ [PIPELINE] Indexed {filename} ({result.total_chars} chars) in {duration_ms:.2f}ms")
-                self.idempotency.mark_completed(event_key)
-                return PipelineStatus.INDEXED if result.success else PipelineStatus.DEGRADED
+            return self._complete(path, event_key, result, duration_ms, digest=digest, extractor=extractor)
                 
-            except Exception as e:
-                logger.error(f"❌ [PIPELINE] Database error for {filename}: {e}")
+        except Exception as e:
+            logger.error(f"🔥 [PIPELINE] Unexpected error processing {path.name}: {e}")
+            self.idempotency.mark_failed(event_key)
+            return PipelineStatus.RETRY
+    
+    def _admit(self, path: Path) -> Optional[str]:
+        """Step 1: idempotency check. Returns the event key, None = duplicate."""
+        with self.latency.time("idempotency"):
+            event_key = EventIdempotency.generate_key(path)
+            should_process = self.idempotency.should_process(event_key)
+        if not should_process:
+            logger.debug(f"⏭️ [PIPELINE] Skipping duplicate: {path.name}")
+            return None
+        
+        self.idempotency.mark_processing(event_key)
+        return event_key
+    
+    def _route(self, path: Path) -> Tuple[str, Optional[object]]:
+        """Step 3: MIME routing. Returns (mime_type, extractor or None)."""
+        with self.latency.time("mime_routing"):
+            mime_type = self._detect_mime_type(path)
+            return mime_type, self.registry.get_extractor(mime_type)
+    
+    def _content_hash(self, path: Path) -> Optional[str]:
+        """Step 3b: streamed content hash (None = unreadable, no dedup)."""
+        with self.latency.time("content_hash"):
+            try:
+                return content_hash(path)
+            except OSError:
+                return None
+    
+    def _reuse(
+        self,
+        path: Path,
+        event_key: str,
+        extractor,
+        digest: Optional[str],
+        group: bool
+    ) -> Tuple[bool, Optional[PipelineStatus]]:
+        """
+        Step 3b: index without extracting when the content is known.
+        
+        Returns:
+            (handled, status) - handled=False: extract as usual; in group
+            mode a handled file's status is None (settled on commit)
+        """
+        if digest is None:
+            return False, None
+        
+        token = (path, event_key, PipelineStatus.INDEXED)
+        if self.fts_writer.relink(path, digest, token=token if group else None):
+            logger.info(f"🔗 [PIPELINE] {path.name}: content already indexed, metadata updated")
+            if group:
+                return True, None
+            _, error = self.fts_writer.commit()
+            if error is not None:
+                raise error
+            self.idempotency.mark_completed(event_key)
+            return True, PipelineStatus.INDEXED
+        
+        cached = self.cache.get(digest, extractor)
+        if cached is None:
+            return False, None
+        logger.info(f"♻️ [PIPELINE] {path.name}: extraction cache hit")
+        return True, self._complete(path, event_key, cached, 0.0, group, digest, extractor, cached=True)
+    
+    def _complete(
+        self,
+        path: Path,
+        event_key: str,
+        result: ExtractionResult,
+        duration_ms: float,
+        group: bool = False,
+        digest: Optional[str] = None,
+        extractor=None,
+        cached: bool = False
+    ) -> Optional[PipelineStatus]:
+        """
+        Steps 4-5 after extraction: classify the result, persist it.
+        
+        group=True: rows join the writer's open transaction and None is
+        returned - the status is settled by _commit_group().
+        digest/extractor: a fresh successful result is stored in the
+        extraction cache (cached=True: it came from there).
+        """
+        filename = path.name
+        if not cached:
+            self.latency.record_ms("extraction", duration_ms)
+            self.latency.record_ms(f"extraction.{result.extractor}", result.processing_time_ms)
+        
+        if not result.success:
+            logger.error(f"❌ [PIPELINE] Extraction failed for {filename}: {result.errors[0].message}")
+            if any(not err.recoverable for err in result.errors):
                 self.idempotency.mark_failed(event_key)
-                return PipelineStatus.RETRY
-                
+                return PipelineStatus.QUARANTINED
+        
+        # 5. PERSISTENCE (SQLCipher FTS5)
+        status = PipelineStatus.INDEXED if result.success else PipelineStatus.DEGRADED
+        try:
+            with self.latency.time("fts_write"):
+                token = (path, event_key, status) if group else None
+                self.fts_writer.write(path, result, token=token, content_hash=digest)
+                if digest is not None and not cached:
+                    self.cache.put(digest, extractor, result)
+                if group:
+                    return None
+                self._commit_single()
+            logger.info(f"✅ [PIPELINE] Indexed {filename} ({result.total_chars} chars) in {duration_ms:.2f}ms")
+            self.idempotency.mark_completed(event_key)
+            return status
+            
+        except Exception as e:
+            logger.error(f"❌ [PIPELINE] Database error for {filename}: {e}")
+            self.idempotency.mark_failed(event_key)
+            return PipelineStatus.RETRY
+    
+    def _process_stream(
+        self,
+        path: Path,
+        event_key: str,
+        extractor,
+        digest: Optional[str] = None
+    ) -> PipelineStatus:
+        """
+        Steps 4-5 for streaming extractors (extract_stream): segments go
+        page by page into the writer's transaction, so peak memory is one
+        page, not the whole document. Extract + write share one timing
+        ("extraction"); a non-recoverable error rolls the rows back.
+        """
+        filename = path.name
+        start_time = time.perf_counter()
+        result, segments = extractor.extract_stream(path)
+        try:
+            self.fts_writer.write(path, result, segments=segments, content_hash=digest)
         except Exception as e:
-            logger.error(f"🔥 [PIPELINE] Unexpected error processing {filename}: {e}")
+            self.fts_writer.rollback()
+            logger.error(f"❌ [PIPELINE] Database error for {filename}: {e}")
             self.idempotency.mark_failed(event_key)
             return PipelineStatus.RETRY
+        duration_ms = (time.perf_counter() - start_time) * 1000
+        self.latency.record_ms("extraction", duration_ms)
+        self.latency.record_ms(f"extraction.{result.extractor}", result.processing_time_ms)
+        
+        if not result.success:
+            logger.error(f"❌ [PIPELINE] Extraction failed for {filename}: {result.errors[0].message}")
+            if any(not err.recoverable for err in result.errors):
+                self.fts_writer.rollback()
+                self.idempotency.mark_failed(event_key)
+                return PipelineStatus.QUARANTINED
+        
+        try:
+            if digest is not None:
+                # Read back from the segment table: still one page at a time
+                self.cache.put(digest, extractor, result, segments=self.fts_writer.iter_segments(path))
+            self._commit_single()
+        except Exception as e:
+            logger.error(f"❌ [PIPELINE] Database error for {filename}: {e}")
+            self.idempotency.mark_failed(event_key)
+            return PipelineStatus.RETRY
+        
+        if "truncated_at_page" in result.metadata:
+            logger.warning(f"⚠️ [PIPELINE] {filename} hit the character budget at page {result.metadata['truncated_at_page']}")
+        logger.info(f"✅ [PIPELINE] Indexed {filename} in {duration_ms:.2f}ms (streamed)")
+        self.idempotency.mark_completed(event_key)
+        return PipelineStatus.INDEXED if result.success else PipelineStatus.DEGRADED
+    
+    # -------------------------------------------------------------------
+    # PARALLEL EXTRACTION
+    # -------------------------------------------------------------------
+    
+    def process_many(
+        self,
+        filepaths: Iterable[str | Path],
+        max_workers: Optional[int] = None,
+        mime_limits: Optional[Dict[str, int]] = None,
+        bulk: bool = False
+    ) -> Iterator[Tuple[Path, PipelineStatus]]:
+        """
+        Process many files: parallel extraction, single writer.
+        
+        Extraction fans out to warm sandboxed worker processes
+        (ExtractionWorkerPool, SandboxExecutor limits). Idempotency, MIME
+        routing and every FTS write stay on the calling thread - the only
+        thread that touches self.db - so workers keep extracting while a
+        result is being written. Writes are group-committed (fts_writer:
+        group_commit_size documents or group_commit_ms); a file's status
+        is yielded once its group is durable.
+        
+        Files of batch-capable types (extractor.SUPPORTS_BATCH, e.g.
+        DOCX) are submitted EXTRACT_BATCH_SIZE at a time as one task; a
+        batch counts once against max_workers and the MIME cap.
+        
+        Paths are pulled lazily; at most 2 x max_workers x
+        EXTRACT_BATCH_SIZE files are in flight or waiting, so a 20K-file
+        folder never sits in memory.
+        Closing the generator early releases files still waiting or in
+        flight, so a later call processes them again.
+        
+        Args:
+            filepaths: Files to index (any iterable, consumed lazily)
+            max_workers: Worker processes (default: the constructor's
+                max_workers, else cpu_count - 1; kept across calls,
+                first value wins)
+            mime_limits: Max concurrent extractions per MIME type, merged
+                over DEFAULT_MIME_LIMITS and the constructor's mime_limits
+                (unlisted types: max_workers)
+            bulk: Large import - FTS5 automerge off while loading, then
+                'optimize' (see FTSBatchWriter.bulk_import)
+            
+        Yields:
+            (path, PipelineStatus) in completion order
+            
+        Raises:
+            ValueError: A mime_limits cap below 1
+        """
+        if bulk:
+            with self.fts_writer.bulk_import():
+                yield from self._process_many(filepaths, max_workers, mime_limits)
+        else:
+            yield from self._process_many(filepaths, max_workers, mime_limits)
+    
+    def _process_many(
+        self,
+        filepaths: Iterable[str | Path],
+        max_workers: Optional[int],
+        mime_limits: Optional[Dict[str, int]]
+    ) -> Iterator[Tuple[Path, PipelineStatus]]:
+        try:
+            yield from self._run_many(filepaths, max_workers, mime_limits)
+            yield from self._commit_group(force=True)
+        finally:
+            # Consumer stopped early: still settle what was written
+            if self.fts_writer.pending:
+                self._commit_group(force=True)
+    
+    def _run_many(
+        self,
+        filepaths: Iterable[str | Path],
+        max_workers: Optional[int],
+        mime_limits: Optional[Dict[str, int]]
+    ) -> Iterator[Tuple[Path, PipelineStatus]]:
+        limits = self._check_mime_limits(
+            {**self.DEFAULT_MIME_LIMITS, **self.mime_limits, **(mime_limits or {})}
+        )
+        pool = self._get_worker_pool(max_workers or self.max_workers)
+        workers = pool.max_workers
+        max_pending = workers * 2 * self.EXTRACT_BATCH_SIZE
+        
+        source = iter(filepaths)
+        source_done = False
+        waiting: Dict[str, Deque[Tuple[Path, str, Optional[str]]]] = {}
+        waiting_count = 0
+        in_flight = 0
+        batch_types: Dict[str, bool] = {}
+        running: Dict[str, int] = {}
+        futures: Dict[Future, Tuple[List[Tuple[Path, str, Optional[str]]], str, float]] = {}
+        
+        try:
+            while True:
+                # Pull files until the window is full (admission + routing inline)
+                while not source_done and waiting_count + in_flight < max_pending:
+                    try:
+                        path = Path(next(source))
+                    except StopIteration:
+                        source_done = True
+                        break
+                    
+                    event_key = self._admit(path)
+                    if event_key is None:
+                        yield path, PipelineStatus.INDEXED
+                        continue
+                    
+                    mime_type, extractor = self._route(path)
+                    if not extractor:
+                        logger.warning(f"⚠️ [PIPELINE] No extractor for {mime_type}: {path.name}")
+                        self.idempotency.mark_completed(event_key)
+                        yield path, PipelineStatus.DEGRADED
+                        continue
+                    
+                    # Content dedup inline too (hashing is sequential I/O)
+                    digest = self._content_hash(path)
+                    try:
+                        handled, status = self._reuse(path, event_key, extractor, digest, group=True)
+                    except Exception as e:
+                        logger.error(f"❌ [PIPELINE] Database error for {path.name}: {e}")
+                        self.idempotency.mark_failed(event_key)
+                        yield path, PipelineStatus.RETRY
+                        continue
+                    if handled:
+                        if status is not None:
+                            yield path, status
+                        continue
+                    
+                    if mime_type not in batch_types:
+                        batch_types[mime_type] = getattr(extractor, "SUPPORTS_BATCH", False) is True
+                    waiting.setdefault(mime_type, collections.deque()).append((path, event_key, digest))
+                    waiting_count += 1
+                
+                # Submit within total and per-MIME caps
+                for mime_type, queue in waiting.items():
+                    cap = limits.get(mime_type, workers)
+                    while queue and len(futures) < workers and running.get(mime_type, 0) < cap:
+                        if batch_types[mime_type]:
+                            items = [queue.popleft() for _ in range(min(len(queue), self.EXTRACT_BATCH_SIZE))]
+                            future = pool.submit_batch([item[0] for item in items], mime_type)
+                        else:
+                            items = [queue.popleft()]
+                            future = pool.submit(items[0][0], mime_type)
+                        waiting_count -= len(items)
+                        in_flight += len(items)
+                        running[mime_type] = running.get(mime_type, 0) + 1
+                        futures[future] = (items, mime_type, time.perf_counter())
+                
+                if not futures:
+                    if source_done and waiting_count == 0:
+                        return
+                    continue
+                
+                # Wake for the next result or the group-commit deadline
+                done, _ = wait(
+                    futures,
+                    timeout=self.fts_writer.seconds_until_due(),
+                    return_when=FIRST_COMPLETED
+                )
+                for future in done:
+                    items, mime_type, submitted = futures.pop(future)
+                    running[mime_type] -= 1
+                    in_flight -= len(items)
+                    yield from self._collect(future, items, submitted)
+                
+                yield from self._commit_group(force=False)
+        finally:
+            # Consumer closed the generator early (or an error): queued and
+            # in-flight files were never settled - let a later run take them
+            for future in futures:
+                future.cancel()
+            abandoned = [item for items, _, _ in futures.values() for item in items]
+            abandoned.extend(item for queue in waiting.values() for item in queue)
+            for _, event_key, _ in abandoned:
+                self.idempotency.release(event_key)
+    
+    def _commit_group(self, force: bool) -> List[Tuple[Path, PipelineStatus]]:
+        """Commit the writer's group (if due or forced) and settle statuses."""
+        with self.latency.time("fts_commit"):
+            if force:
+                tokens, error = self.fts_writer.commit()
+            else:
+                tokens, error = self.fts_writer.commit_if_due()
+        
+        if error is not None:
+            logger.error(f"❌ [PIPELINE] Group commit of {len(tokens)} documents failed: {error}")
+        
+        settled = []
+        for path, event_key, status in tokens:
+            if error is None:
+                self.idempotency.mark_completed(event_key)
+                settled.append((path, status))
+            else:
+                self.idempotency.mark_failed(event_key)
+                settled.append((path, PipelineStatus.RETRY))
+        return settled
+    
+    def _collect(
+        self,
+        future: Future,
+        items: List[Tuple[Path, str, Optional[str]]],
+        submitted: float
+    ) -> List[Tuple[Path, PipelineStatus]]:
+        """
+        Writer stage for one finished task (single file or batch).
+        
+        Returns statuses settled now; written files are settled later by
+        _commit_group().
+        """
+        duration_ms = (time.perf_counter() - submitted) * 1000
+        try:
+            results = future.result()
+            if not isinstance(results, list):
+                results = [results]
+        except Exception as e:
+            # Worker crashed (BrokenProcessPool) or result not picklable
+            for path, event_key, _ in items:
+                logger.error(f"🔥 [PIPELINE] Extraction worker failed for {path.name}: {e}")
+                self.idempotency.mark_failed(event_key)
+            return [(path, PipelineStatus.RETRY) for path, _, _ in items]
+        
+        settled = []
+        per_file_ms = duration_ms / len(items)
+        mime_type = self._detect_mime_type(items[0][0])
+        extractor = self.registry.get_extractor(mime_type)
+        for (path, event_key, digest), result in zip(items, results):
+            status = self._complete(path, event_key, result, per_file_ms, True, digest, extractor)
+            if status is not None:
+                settled.append((path, status))
+        return settled
+    
+    @staticmethod
+    def _check_mime_limits(limits: Dict[str, int]) -> Dict[str, int]:
+        """A cap below 1 would leave that MIME queue waiting forever."""
+        for mime_type, cap in limits.items():
+            if isinstance(cap, bool) or not isinstance(cap, int) or cap < 1:
+                raise ValueError(f"mime_limits[{mime_type!r}] must be a positive integer, got {cap!r}")
+        return limits
+    
+    def _get_worker_pool(self, max_workers: Optional[int]) -> ExtractionWorkerPool:
+        if self._worker_pool is None:
+            self._worker_pool = ExtractionWorkerPool(max_workers, self.sandbox)
+        return self._worker_pool
+    
+    def shutdown(self) -> None:
+        """Stop extraction worker processes (process_many)."""
+        if self._worker_pool is not None:
+            self._worker_pool.shutdown()
+            self._worker_pool = None
 
     def _detect_mime_type(self, path: Path) -> str:
         """Simple MIME detection based on extension for Task 6.5."""
@@ -118,31 +563,18 @@ class ExtractionPipeline:
         """Get pipeline metrics and status."""
         return {
             "idempotency": self.idempotency.get_stats(),
-            "supported_types": self.registry.get_supported_types()
+            "supported_types": self.registry.get_supported_types(),
+            "latency": self.latency.snapshot(),
+            "cache": self.cache.get_stats(),
+            "relinked": self.fts_writer.documents_relinked
         }
 
-    def _save_to_fts(self, path: Path, result: "ExtractionResult") -> None:
-        """
-        Save extraction result to SQLCipher FTS5 tables via EncryptedIndexerDB.
-        """
-        # 1. Insert/Update document metadata
-        # Using REPLACE to handle updates to already indexed files
-        sql_doc = """
-        INSERT OR REPLACE INTO documents (path, filename, mime_type, total_chars, created_at)
-        VALUES (?, ?, ?, ?, ?)
-        """
-        params_doc = (
-            str(path.absolute()),
-            path.name,
-            result.extractor,
-            result.total_chars,
-            time.strftime('%Y-%m-%d %H:%M:%S')
-        )
-        self.db.execute(sql_doc, params_doc)
-        
-        # 2. Insert into FTS5 content table
-        # We assume the content table is matched via path or just a general search index
-        sql_content = "INSERT INTO document_content (content) VALUES (?)"
-        self.db.execute(sql_content, (result.total_text,))
-        
-        self.db.commit()
+    def _commit_single(self) -> None:
+        """
+        Commit process_file's document right away (process_many groups
+        commits instead).
+        """
+        with self.latency.time("fts_commit"):
+            _, error = self.fts_writer.commit()
+        if error is not None:
+            raise error
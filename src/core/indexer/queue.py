@@ -7,12 +7,14 @@ SPEC: docs/03_SPECS/SPEC_TASK_6_3_INDEXER_QUEUE.md (FROZEN)
 Features:
 - Dual-trigger flush: 100 events OR 500ms timeout
 - SQLite WAL mode for crash safety
-- Idempotency via processed_events table
+- Idempotency via processed_events table (Bloom prefilter skips SQLite)
 - Pull model: get_next_batch() for downstream Indexer
 - Strict FIFO ordering
+- Multi-consumer mode: per-worker connections + lease-based batch claims
+- Bounded warm-up + background TTL compaction (flat startup time / DB size)
+- Binary batch envelope (orjson records, lazy decode, legacy JSON readable)
 """
 
-import json
 import os
 import sqlite3
 import threading
@@ -20,7 +22,12 @@ import time
 import uuid
 from collections import deque, OrderedDict
 from dataclasses import dataclass, field
-from typing import Any, Callable, Dict, List, Optional
+from typing import Any, Callable, Dict, List, Optional, Sequence
+
+from src.core.indexer.utils.batch_codec import decode_events, encode_events
+from src.core.indexer.utils.bloom import BloomFilter
+from src.core.services.scheduler import DeadlineScheduler, ScheduledTask, get_scheduler
+from src.core.utils.histogram import LatencyHistogram
 
 # Try to import EventBus for type hints
 try:
@@ -91,10 +98,12 @@ class Batch:
     """Represents a batch of events ready for processing"""
     batch_id: str
     created_at: float
-    events: List[Any]
+    events: Sequence[Any]  # list, or LazyEvents view (get_next_batch(lazy=True))
     event_count: int
     status: str = "pending"  # pending, processing, done
     attempts: int = 0
+    lease_expires: Optional[float] = None  # Unix timestamp, None = no lease
+    lease_owner: Optional[str] = None  # "pid:thread" of the claiming consumer
 
 
 @dataclass
@@ -115,8 +124,21 @@ class QueueMetrics:
     events_processed_total: int = 0
     events_duplicate_total: int = 0
     
-    # Performance
+    # Compaction (TTL pruning)
+    events_pruned_total: int = 0
+    batches_pruned_total: int = 0
+    
+    # Idempotency prefilter (Bloom)
+    bloom_hits_total: int = 0             # "maybe seen" → SQLite checked
+    bloom_misses_total: int = 0           # "definitely new" → SQLite skipped
+    bloom_false_positives_total: int = 0  # maybe seen, but not in SQLite
+    
+    # Performance (buffer → SQLite flush latency, since start)
     avg_flush_latency_ms: float = 0.0
+    flush_latency_p50_ms: float = 0.0
+    flush_latency_p95_ms: float = 0.0
+    flush_latency_p99_ms: float = 0.0
+    flush_latency_max_ms: float = 0.0
     
     # System
     uptime_seconds: float = 0.0
@@ -131,23 +153,40 @@ class IndexerQueue:
     High-performance batch processing queue with SQLite persistence.
     
     Features:
-    - Dual-trigger flush: batch_size OR timeout
+    - Dual-trigger flush: batch_size OR timeout (shared DeadlineScheduler)
     - WAL mode SQLite for crash safety
     - Idempotency via processed_events table
     - Pull model for downstream consumers
     - Strict FIFO ordering
+    - Multi-consumer mode: atomic lease claims, expired leases re-queued
     """
     
     # Default configuration
     DEFAULT_BATCH_SIZE = 100
     DEFAULT_FLUSH_TIMEOUT_MS = 500
     MAX_BATCH_SIZE = 1000
+    DEFAULT_LEASE_TIMEOUT_S = 300.0  # Crashed worker's batch re-queued after 5 min
+    DEFAULT_BLOOM_CAPACITY = 1_000_000  # ~1.2MB at 1% false positives
+    DEFAULT_BLOOM_ERROR_RATE = 0.01
+    DEFAULT_LRU_SIZE = 10000
+    DEFAULT_RETENTION_S = 7 * 24 * 3600.0  # Prune processed/done rows after 7 days
+    DEFAULT_COMPACTION_INTERVAL_S = 3600.0
+    COMPACTION_CHUNK_SIZE = 5000  # Rows per DELETE (keeps write lock short)
+    BUSY_TIMEOUT_MS = 5000  # SQLite write-lock wait between worker connections
     
     def __init__(
         self,
         db_path: str = "data/indexer_queue.db",
         batch_size: int = DEFAULT_BATCH_SIZE,
-        flush_timeout_ms: int = DEFAULT_FLUSH_TIMEOUT_MS
+        flush_timeout_ms: int = DEFAULT_FLUSH_TIMEOUT_MS,
+        multi_consumer: bool = False,
+        lease_timeout_s: float = DEFAULT_LEASE_TIMEOUT_S,
+        bloom_capacity: int = DEFAULT_BLOOM_CAPACITY,
+        bloom_error_rate: float = DEFAULT_BLOOM_ERROR_RATE,
+        warmup_limit: Optional[int] = None,
+        retention_s: Optional[float] = DEFAULT_RETENTION_S,
+        compaction_interval_s: float = DEFAULT_COMPACTION_INTERVAL_S,
+        scheduler: Optional[DeadlineScheduler] = None
     ):
         """
         Initialize IndexerQueue.
@@ -156,10 +195,30 @@ class IndexerQueue:
             db_path: Path to SQLite database file
             batch_size: Number of events to trigger flush (default: 100)
             flush_timeout_ms: Timeout in ms to trigger flush (default: 500)
+            multi_consumer: If True, each consumer thread claims batches on
+                its own SQLite connection instead of the shared one
+            lease_timeout_s: Seconds a claimed batch stays leased before it
+                becomes claimable again (crashed worker recovery)
+            bloom_capacity: Minimum processed_events count the Bloom
+                prefilter is sized for (grown on rebuild if exceeded)
+            bloom_error_rate: Target Bloom false-positive rate
+            warmup_limit: Most recent processed IDs loaded into the LRU on
+                start (default: LRU size)
+            retention_s: Age after which processed_events and 'done'
+                batches are pruned (None = keep forever, no compaction)
+            compaction_interval_s: Seconds between background compactions
+            scheduler: Runs the flush timeout (default: shared get_scheduler())
         """
         self.db_path = db_path
         self.batch_size = min(batch_size, self.MAX_BATCH_SIZE)
         self.flush_timeout_ms = flush_timeout_ms
+        self.multi_consumer = multi_consumer
+        self.lease_timeout_s = lease_timeout_s
+        self.bloom_capacity = bloom_capacity
+        self.bloom_error_rate = bloom_error_rate
+        self.warmup_limit = warmup_limit if warmup_limit is not None else self.DEFAULT_LRU_SIZE
+        self.retention_s = retention_s
+        self.compaction_interval_s = compaction_interval_s
         
         # In-memory buffer
         self._buffer: deque = deque()
@@ -167,27 +226,48 @@ class IndexerQueue:
         
         # Processed event IDs cache (for idempotency check)
         # MEMORY-SAFE: LRU cache with 10K limit (~1MB) instead of unbounded set
-        self._processed_ids: SecureLRUCache = SecureLRUCache(maxsize=10000)
+        self._processed_ids: SecureLRUCache = SecureLRUCache(maxsize=self.DEFAULT_LRU_SIZE)
         self._processed_ids_lock = threading.Lock()  # External lock for compound ops
         
+        # Bloom prefilter over processed_events: rules out "definitely new"
+        # IDs before the L2 SQLite check. Loaded/rebuilt in start().
+        self._bloom: Optional[BloomFilter] = None
+        
         # Metrics
         self._events_received = 0
         self._events_processed = 0
         self._events_duplicate = 0
-        self._flush_latencies: List[float] = []
+        self._bloom_hits = 0
+        self._bloom_misses = 0
+        self._bloom_false_positives = 0
+        self._events_pruned = 0
+        self._batches_pruned = 0
+        self._flush_latency = LatencyHistogram()
         self._metrics_lock = threading.Lock()
         self._start_time: Optional[float] = None
         
         # Lifecycle
         self._running = False
         self._stop_event = threading.Event()
-        self._flush_timer: Optional[threading.Timer] = None
+        self._scheduler = scheduler or get_scheduler()
+        self._flush_task: Optional[ScheduledTask] = None
         self._flush_lock = threading.Lock()
+        self._compaction_thread: Optional[threading.Thread] = None
         
         # SQLite connection (per-thread for safety)
         self._db_conn: Optional[sqlite3.Connection] = None
         self._db_lock = threading.Lock()
         
+        # Multi-consumer: one connection per worker thread (WAL readers
+        # run in parallel, claims serialize only on SQLite's write lock)
+        self._worker_local = threading.local()
+        self._worker_conns: List[sqlite3.Connection] = []
+        self._worker_conns_lock = threading.Lock()
+        
+        # Consumer wakeup: _flush_buffer notifies instead of consumers polling
+        self._batch_available = threading.Condition(threading.Lock())
+        self._batch_seq = 0  # Bumped per persisted batch (lost-wakeup guard)
+        
         # EventBus subscription
         self._eventbus: Optional[Any] = None
         self._subscription_id: Optional[str] = None
@@ -211,8 +291,20 @@ class IndexerQueue:
         # Load processed event IDs from DB (for crash recovery)
         self._load_processed_ids()
         
+        # Load persisted Bloom prefilter (rebuilt if missing/undersized)
+        self._load_bloom_filter()
+        
         # Start flush timer
         self._reset_flush_timer()
+        
+        # Start background TTL compaction
+        if self.retention_s is not None:
+            self._compaction_thread = threading.Thread(
+                target=self._compaction_loop,
+                name="IndexerQueue-Compaction",
+                daemon=True
+            )
+            self._compaction_thread.start()
     
     def stop(self, graceful: bool = True) -> None:
         """
@@ -228,9 +320,14 @@ class IndexerQueue:
         self._stop_event.set()
         
         # Cancel flush timer
-        if self._flush_timer:
-            self._flush_timer.cancel()
-            self._flush_timer = None
+        if self._flush_task:
+            self._flush_task.cancel()
+            self._flush_task = None
+        
+        # Stop compaction (wakes immediately via _stop_event)
+        if self._compaction_thread:
+            self._compaction_thread.join(timeout=2.0)
+            self._compaction_thread = None
         
         # Graceful: flush any remaining events
         if graceful:
@@ -245,6 +342,26 @@ class IndexerQueue:
             except:
                 pass
         
+        # Wake consumers blocked in get_next_batch()
+        with self._batch_available:
+            self._batch_available.notify_all()
+        
+        # Close worker connections (multi-consumer mode)
+        with self._worker_conns_lock:
+            for worker_conn in self._worker_conns:
+                try:
+                    worker_conn.close()
+                except Exception:
+                    pass
+            self._worker_conns.clear()
+        self._worker_local = threading.local()
+        
+        # Persist Bloom prefilter for fast restart
+        try:
+            self._save_bloom_filter()
+        except Exception as e:
+            print(f"[INDEXER] Failed to persist bloom filter: {e}")
+        
         # Close SQLite connection
         if self._db_conn:
             self._db_conn.close()
@@ -259,21 +376,46 @@ class IndexerQueue:
     # EVENTBUS INTEGRATION
     # -------------------------------------------------------------------
     
-    def subscribe_to_eventbus(self, bus: Any) -> str:
+    def subscribe_to_eventbus(
+        self,
+        bus: Any,
+        batch: bool = False,
+        max_delay_ms: Optional[int] = None,
+        capacity: Optional[int] = None
+    ) -> str:
         """
         Subscribe to EventBus to receive events.
         
         Args:
             bus: HeavyEventBus instance
+            batch: Receive lists of events (one bus callback per batch_size
+                events) instead of one callback per event
+            max_delay_ms: Batch mode - max time an event waits in the bus
+                buffer (default: flush_timeout_ms)
+            capacity: Credits advertised to the bus - max events in flight
+                to this queue (None = unlimited). With a bus in "block" or
+                "spool" overflow mode, a slow flush then slows producers
+                instead of losing events.
             
         Returns:
             subscription_id: UUID string for unsubscribe
         """
         self._eventbus = bus
-        self._subscription_id = bus.subscribe(
-            callback=self._on_event_received,
-            name="IndexerQueue"
-        )
+        if batch:
+            self._subscription_id = bus.subscribe(
+                callback=self._on_events_received,
+                name="IndexerQueue",
+                batch=True,
+                max_batch=self.batch_size,
+                max_delay_ms=max_delay_ms if max_delay_ms is not None else self.flush_timeout_ms,
+                capacity=capacity
+            )
+        else:
+            self._subscription_id = bus.subscribe(
+                callback=self._on_event_received,
+                name="IndexerQueue",
+                capacity=capacity
+            )
         return self._subscription_id
     
     def _on_event_received(self, event: Any) -> None:
@@ -282,7 +424,8 @@ class IndexerQueue:
         
         Uses dual-layer idempotency check:
         1. L1: In-memory LRU cache (fast, ~1MB limit)
-        2. L2: SQLite fallback (for old IDs evicted from cache)
+        2. L2: SQLite fallback (for old IDs evicted from cache),
+           skipped when the Bloom prefilter says "definitely new"
         
         Args:
             event: Event data (dict with event_id)
@@ -290,6 +433,61 @@ class IndexerQueue:
         if not self._running:
             return
         
+        entry = self._accept_event(event)
+        if entry is None:
+            return
+        
+        # Add to buffer
+        with self._buffer_lock:
+            self._buffer.append(entry)
+            
+            with self._metrics_lock:
+                self._events_received += 1
+            
+            # Check if we should flush
+            if len(self._buffer) >= self.batch_size:
+                self._flush_buffer()
+                self._reset_flush_timer()
+    
+    def _on_events_received(self, events: List[Any]) -> None:
+        """
+        Batch callback from EventBus (subscribe_to_eventbus(batch=True)).
+        
+        Same idempotency checks as _on_event_received, but the accepted
+        events enter the buffer under a single _buffer_lock acquire.
+        
+        Args:
+            events: Event data list, in publish order
+        """
+        if not self._running:
+            return
+        
+        entries = [entry for entry in map(self._accept_event, events) if entry is not None]
+        if not entries:
+            return
+        
+        with self._buffer_lock:
+            with self._metrics_lock:
+                self._events_received += len(entries)
+            
+            # Top the buffer up to batch_size and flush, so batches keep
+            # the same size as the per-event path
+            start = 0
+            while start < len(entries):
+                room = max(1, self.batch_size - len(self._buffer))
+                self._buffer.extend(entries[start:start + room])
+                start += room
+                if len(self._buffer) >= self.batch_size:
+                    self._flush_buffer()
+                    self._reset_flush_timer()
+    
+    def _accept_event(self, event: Any) -> Optional[Dict]:
+        """
+        Idempotency check + buffer entry for one event.
+        
+        Returns:
+            Buffer entry dict, or None if the event is a duplicate
+        """
         # Extract event_id for idempotency
         event_id = None
         if isinstance(event, dict):
@@ -305,32 +503,36 @@ class IndexerQueue:
             if event_id in self._processed_ids:
                 with self._metrics_lock:
                     self._events_duplicate += 1
-                return  # Skip duplicate (found in L1 cache)
+                return None  # Skip duplicate (found in L1 cache)
             
             # Layer 2: SQLite fallback for old events evicted from cache
-            if self._is_event_in_database(event_id):
+            bloom = self._bloom
+            if bloom is not None and event_id not in bloom:
+                # Never persisted: no DB round trip needed
+                with self._metrics_lock:
+                    self._bloom_misses += 1
+            elif self._is_event_in_database(event_id):
                 with self._metrics_lock:
                     self._events_duplicate += 1
-                return  # Skip duplicate (found in L2 database)
+                    if bloom is not None:
+                        self._bloom_hits += 1
+                return None  # Skip duplicate (found in L2 database)
+            elif bloom is not None:
+                with self._metrics_lock:
+                    self._bloom_hits += 1
+                    self._bloom_false_positives += 1
             
             # Mark as seen IMMEDIATELY (before adding to buffer)
             # This prevents duplicates from entering buffer before flush
             self._processed_ids.add(event_id)
+            if bloom is not None:
+                bloom.add(event_id)
         
-        # Add to buffer
-        with self._buffer_lock:
-            self._buffer.append({
-                "event_id": event_id,
-                "received_at": time.time(),
-                "data": event
-            })
-            
-            with self._metrics_lock:
-                self._events_received += 1
-            
-            # Check if we should flush
-            if len(self._buffer) >= self.batch_size:
-                self._flush_buffer()
+        return {
+            "event_id": event_id,
+            "received_at": time.time(),
+            "data": event
+        }
     
     def _is_event_in_database(self, event_id: str) -> bool:
         """
@@ -356,17 +558,22 @@ class IndexerQueue:
     # -------------------------------------------------------------------
     
     def _reset_flush_timer(self) -> None:
-        """Reset the flush timeout timer."""
-        if self._flush_timer:
-            self._flush_timer.cancel()
+        """
+        (Re)arm the flush timeout to now + flush_timeout_ms.
         
-        if self._running:
-            self._flush_timer = threading.Timer(
-                self.flush_timeout_ms / 1000.0,
-                self._on_flush_timeout
+        Called after every flush: a size-triggered flush just moves the
+        deadline forward (no thread created, no extra timer wakeup).
+        """
+        if not self._running:
+            return
+        
+        delay = self.flush_timeout_ms / 1000.0
+        if self._flush_task is None:
+            self._flush_task = self._scheduler.schedule(
+                delay, self._on_flush_timeout, name="IndexerQueue-Flush"
             )
-            self._flush_timer.daemon = True
-            self._flush_timer.start()
+        else:
+            self._flush_task.reschedule(delay)
     
     def _on_flush_timeout(self) -> None:
         """Called when flush timeout expires."""
@@ -401,6 +608,11 @@ class IndexerQueue:
         try:
             self._persist_batch(batch_id, events_list)
             
+            # Wake one waiting consumer
+            with self._batch_available:
+                self._batch_seq += 1
+                self._batch_available.notify()
+            
             # Update processed IDs cache
             with self._processed_ids_lock:
                 for event in events_list:
@@ -409,10 +621,7 @@ class IndexerQueue:
             # Update metrics
             with self._metrics_lock:
                 self._events_processed += len(events_list)
-                flush_latency = (time.time() - flush_start) * 1000
-                self._flush_latencies.append(flush_latency)
-                if len(self._flush_latencies) > 100:
-                    self._flush_latencies.pop(0)
+            self._flush_latency.record_ms((time.time() - flush_start) * 1000)
                     
         except Exception as e:
             # Put events back on error
@@ -424,26 +633,48 @@ class IndexerQueue:
     # SQLITE OPERATIONS
     # -------------------------------------------------------------------
     
+    def _open_connection(self) -> sqlite3.Connection:
+        """Open a new SQLite connection with queue pragmas applied."""
+        # Ensure directory exists
+        db_dir = os.path.dirname(self.db_path)
+        if db_dir and not os.path.exists(db_dir):
+            os.makedirs(db_dir, exist_ok=True)
+        
+        conn = sqlite3.connect(
+            self.db_path,
+            check_same_thread=False,
+            isolation_level=None  # Autocommit for explicit transaction control
+        )
+        
+        # Enable WAL mode for better concurrency
+        conn.execute("PRAGMA journal_mode=WAL")
+        conn.execute("PRAGMA synchronous=NORMAL")
+        conn.execute(f"PRAGMA busy_timeout={self.BUSY_TIMEOUT_MS}")
+        
+        return conn
+    
     def _get_connection(self) -> sqlite3.Connection:
         """Get SQLite connection (creating if needed)."""
         if self._db_conn is None:
-            # Ensure directory exists
-            db_dir = os.path.dirname(self.db_path)
-            if db_dir and not os.path.exists(db_dir):
-                os.makedirs(db_dir, exist_ok=True)
-            
-            self._db_conn = sqlite3.connect(
-                self.db_path,
-                check_same_thread=False,
-                isolation_level=None  # Autocommit for explicit transaction control
-            )
-            
-            # Enable WAL mode for better concurrency
-            self._db_conn.execute("PRAGMA journal_mode=WAL")
-            self._db_conn.execute("PRAGMA synchronous=NORMAL")
+            self._db_conn = self._open_connection()
             
         return self._db_conn
     
+    def _get_worker_connection(self) -> sqlite3.Connection:
+        """
+        Get the calling consumer thread's private connection.
+        
+        Multi-consumer mode only. Connections are tracked so stop()
+        can close them from the owning queue's thread.
+        """
+        conn = getattr(self._worker_local, "conn", None)
+        if conn is None:
+            conn = self._open_connection()
+            self._worker_local.conn = conn
+            with self._worker_conns_lock:
+                self._worker_conns.append(conn)
+        return conn
+    
     def _init_database(self) -> None:
         """Initialize SQLite database with schema."""
         conn = self._get_connection()
@@ -462,18 +693,25 @@ class IndexerQueue:
                     attempts INTEGER DEFAULT 0,
                     last_attempt REAL,
                     priority INTEGER DEFAULT 0,
+                    lease_owner TEXT,
+                    lease_expires REAL,
                     CHECK (status IN ('pending', 'processing', 'done'))
                 )
             """)
             
+            # Migrate pre-lease databases
+            cursor.execute("PRAGMA table_info(pending_batches)")
+            columns = {row[1] for row in cursor.fetchall()}
+            if "lease_owner" not in columns:
+                cursor.execute("ALTER TABLE pending_batches ADD COLUMN lease_owner TEXT")
+            if "lease_expires" not in columns:
+                cursor.execute("ALTER TABLE pending_batches ADD COLUMN lease_expires REAL")
+            
             # Create processed_events table
-            cursor.execute("""
-                CREATE TABLE IF NOT EXISTS processed_events (
-                    event_id TEXT PRIMARY KEY,
-                    batch_id TEXT NOT NULL,
-                    processed_at REAL NOT NULL
-                )
-            """)
+            # WITHOUT ROWID: the event_id PRIMARY KEY *is* the table B-tree,
+            # so each insert maintains one tree instead of rowid + PK index
+            cursor.execute(self._PROCESSED_EVENTS_DDL.format(name="processed_events"))
+            self._migrate_processed_events(cursor)
             
             # Create indexes
             cursor.execute("""
@@ -481,24 +719,246 @@ class IndexerQueue:
                 ON pending_batches(status, created_at)
             """)
             
+            # Bounded warm-up + TTL pruning scan by age
+            cursor.execute("""
+                CREATE INDEX IF NOT EXISTS idx_processed_events_processed_at 
+                ON processed_events(processed_at)
+            """)
+            
+            # Persisted Bloom prefilter (single row)
             cursor.execute("""
-                CREATE INDEX IF NOT EXISTS idx_processed_events_event_id 
-                ON processed_events(event_id)
+                CREATE TABLE IF NOT EXISTS idempotency_filter (
+                    id INTEGER PRIMARY KEY CHECK (id = 1),
+                    watermark REAL NOT NULL,
+                    filter_data BLOB NOT NULL,
+                    saved_at REAL NOT NULL
+                )
             """)
             
             conn.commit()
     
+    _PROCESSED_EVENTS_DDL = """
+        CREATE TABLE IF NOT EXISTS {name} (
+            event_id TEXT PRIMARY KEY,
+            batch_id TEXT NOT NULL,
+            processed_at REAL NOT NULL
+        ) WITHOUT ROWID
+    """
+    
+    _PROCESSED_EVENTS_INSERT = """
+        INSERT OR IGNORE INTO processed_events 
+        (event_id, batch_id, processed_at)
+        VALUES (?, ?, ?)
+    """
+    
+    def _migrate_processed_events(self, cursor: sqlite3.Cursor) -> None:
+        """
+        Upgrade pre-WITHOUT ROWID queue databases in place.
+        
+        Old layout: rowid table + redundant idx_processed_events_event_id
+        on the PRIMARY KEY column (two extra B-trees per insert).
+        MUST be called with _db_lock held.
+        """
+        cursor.execute("DROP INDEX IF EXISTS idx_processed_events_event_id")
+        
+        cursor.execute(
+            "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = 'processed_events'"
+        )
+        row = cursor.fetchone()
+        if row is None or "WITHOUT ROWID" in row[0].upper():
+            return
+        
+        try:
+            cursor.execute("BEGIN IMMEDIATE")
+            cursor.execute("DROP TABLE IF EXISTS processed_events_new")
+            cursor.execute(self._PROCESSED_EVENTS_DDL.format(name="processed_events_new"))
+            cursor.execute("""
+                INSERT OR IGNORE INTO processed_events_new (event_id, batch_id, processed_at)
+                SELECT event_id, batch_id, processed_at FROM processed_events
+            """)
+            cursor.execute("DROP TABLE processed_events")
+            cursor.execute("ALTER TABLE processed_events_new RENAME TO processed_events")
+            cursor.execute("COMMIT")
+        except Exception:
+            cursor.execute("ROLLBACK")
+            raise
+    
     def _load_processed_ids(self) -> None:
-        """Load processed event IDs from DB for crash recovery."""
+        """
+        Warm the LRU with the most recent processed event IDs.
+        
+        Bounded to warmup_limit rows via idx_processed_events_processed_at,
+        so startup cost is flat regardless of table size. Older IDs are
+        still covered by the Bloom prefilter + L2 SQLite check.
+        """
         conn = self._get_connection()
         
         with self._db_lock:
             cursor = conn.cursor()
-            cursor.execute("SELECT event_id FROM processed_events")
+            cursor.execute(
+                """
+                SELECT event_id FROM processed_events
+                ORDER BY processed_at DESC
+                LIMIT ?
+                """,
+                (self.warmup_limit,)
+            )
+            recent_ids = [row[0] for row in cursor]
             
+            # Oldest first so the newest end up most-recently-used
             with self._processed_ids_lock:
-                for row in cursor.fetchall():
-                    self._processed_ids.add(row[0])
+                for event_id in reversed(recent_ids):
+                    self._processed_ids.add(event_id)
+    
+    # -------------------------------------------------------------------
+    # COMPACTION (TTL)
+    # -------------------------------------------------------------------
+    
+    def _compaction_loop(self) -> None:
+        """Background thread: run compact() every compaction_interval_s."""
+        while not self._stop_event.wait(timeout=self.compaction_interval_s):
+            try:
+                self.compact()
+            except Exception as e:
+                print(f"[INDEXER] Compaction error: {type(e).__name__}: {e}")
+    
+    def compact(self, now: Optional[float] = None) -> Dict[str, int]:
+        """
+        Prune rows older than retention_s.
+        
+        Removes 'done' batches and processed_events whose batch is no
+        longer outstanding. Deletes run in COMPACTION_CHUNK_SIZE chunks so
+        producers/consumers are never blocked for long; freed pages are
+        reused by later inserts, keeping the file size flat.
+        
+        Args:
+            now: Reference time (default: time.time())
+            
+        Returns:
+            {"events_pruned": int, "batches_pruned": int}
+        """
+        if self.retention_s is None:
+            return {"events_pruned": 0, "batches_pruned": 0}
+        
+        cutoff = (now if now is not None else time.time()) - self.retention_s
+        
+        events_pruned = self._delete_in_chunks(
+            """
+            DELETE FROM processed_events WHERE event_id IN (
+                SELECT event_id FROM processed_events
+                WHERE processed_at < ?
+                  AND batch_id NOT IN (
+                      SELECT batch_id FROM pending_batches WHERE status != 'done'
+                  )
+                LIMIT ?
+            )
+            """,
+            cutoff
+        )
+        batches_pruned = self._delete_in_chunks(
+            """
+            DELETE FROM pending_batches WHERE batch_id IN (
+                SELECT batch_id FROM pending_batches
+                WHERE status = 'done'
+                  AND COALESCE(last_attempt, created_at) < ?
+                LIMIT ?
+            )
+            """,
+            cutoff
+        )
+        
+        with self._metrics_lock:
+            self._events_pruned += events_pruned
+            self._batches_pruned += batches_pruned
+        
+        return {"events_pruned": events_pruned, "batches_pruned": batches_pruned}
+    
+    def _delete_in_chunks(self, sql: str, cutoff: float) -> int:
+        """Repeat a chunked DELETE (params: cutoff, limit) until exhausted."""
+        conn = self._get_connection()
+        total = 0
+        
+        while True:
+            with self._db_lock:
+                cursor = conn.cursor()
+                cursor.execute(sql, (cutoff, self.COMPACTION_CHUNK_SIZE))
+                deleted = cursor.rowcount
+            total += deleted
+            if deleted < self.COMPACTION_CHUNK_SIZE:
+                return total
+    
+    def _load_bloom_filter(self) -> None:
+        """
+        Load the persisted Bloom prefilter and catch up on rows written
+        after it was saved (e.g. after a crash). Rebuilds from
+        processed_events when missing, corrupt, undersized or saturated.
+        """
+        conn = self._get_connection()
+        
+        with self._db_lock:
+            cursor = conn.cursor()
+            cursor.execute(
+                "SELECT watermark, filter_data FROM idempotency_filter WHERE id = 1"
+            )
+            row = cursor.fetchone()
+            
+            bloom = None
+            if row is not None:
+                try:
+                    bloom = BloomFilter.from_bytes(row[1])
+                except ValueError:
+                    bloom = None
+            
+            if bloom is not None and bloom.capacity >= self.bloom_capacity:
+                # Catch up: rows persisted after the last save
+                cursor.execute(
+                    "SELECT event_id FROM processed_events WHERE processed_at >= ?",
+                    (row[0],)
+                )
+                for (event_id,) in cursor:
+                    bloom.add(event_id)
+                if not bloom.saturated:
+                    self._bloom = bloom
+                    return
+            
+            self._bloom = self._rebuild_bloom_filter(cursor)
+    
+    def _rebuild_bloom_filter(self, cursor: sqlite3.Cursor) -> BloomFilter:
+        """
+        Build a fresh filter over all of processed_events.
+        
+        MUST be called with _db_lock held. Streams rows (no fetchall).
+        """
+        cursor.execute("SELECT COUNT(*) FROM processed_events")
+        row_count = cursor.fetchone()[0]
+        
+        bloom = BloomFilter(
+            capacity=max(self.bloom_capacity, row_count * 2),
+            error_rate=self.bloom_error_rate
+        )
+        cursor.execute("SELECT event_id FROM processed_events")
+        for (event_id,) in cursor:
+            bloom.add(event_id)
+        return bloom
+    
+    def _save_bloom_filter(self) -> None:
+        """Persist the Bloom prefilter with a processed_at watermark."""
+        if self._bloom is None or self._db_conn is None:
+            return
+        
+        conn = self._db_conn
+        with self._db_lock:
+            cursor = conn.cursor()
+            cursor.execute("SELECT MAX(processed_at) FROM processed_events")
+            watermark = cursor.fetchone()[0] or 0.0
+            cursor.execute(
+                """
+                INSERT OR REPLACE INTO idempotency_filter
+                (id, watermark, filter_data, saved_at)
+                VALUES (1, ?, ?, ?)
+                """,
+                (watermark, self._bloom.to_bytes(), time.time())
+            )
     
     def _persist_batch(self, batch_id: str, events: List[Dict]) -> None:
         """
@@ -516,8 +976,8 @@ class IndexerQueue:
             try:
                 cursor.execute("BEGIN TRANSACTION")
                 
-                # Insert batch
-                events_data = json.dumps([e["data"] for e in events]).encode("utf-8")
+                # Insert batch (binary envelope, see utils/batch_codec.py)
+                events_data = encode_events([e["data"] for e in events])
                 cursor.execute(
                     """
                     INSERT INTO pending_batches 
@@ -528,16 +988,12 @@ class IndexerQueue:
                 )
                 
                 # Insert processed events (for idempotency)
+                # One prepared statement, stepped per row inside the C loop
                 processed_at = time.time()
-                for event in events:
-                    cursor.execute(
-                        """
-                        INSERT OR IGNORE INTO processed_events 
-                        (event_id, batch_id, processed_at)
-                        VALUES (?, ?, ?)
-                        """,
-                        (event["event_id"], batch_id, processed_at)
-                    )
+                cursor.executemany(
+                    self._PROCESSED_EVENTS_INSERT,
+                    [(event["event_id"], batch_id, processed_at) for event in events]
+                )
                 
                 cursor.execute("COMMIT")
                 
@@ -549,95 +1005,148 @@ class IndexerQueue:
     # PULL MODEL INTERFACE
     # -------------------------------------------------------------------
     
-    def get_next_batch(self, timeout: float = 0.1) -> Optional[Batch]:
+    def get_next_batch(self, timeout: float = 0.1, lazy: bool = False) -> Optional[Batch]:
         """
         Get next pending batch for processing.
         
-        Pull model: Caller (Indexer) calls this to get work.
+        Pull model: Caller (Indexer) calls this to get work. Blocks on the
+        batch-available condition (signalled by _flush_buffer) instead of
+        polling SQLite.
         
         Args:
             timeout: Max seconds to wait for batch (default: 0.1s)
+            lazy: If True, Batch.events is a LazyEvents view decoded
+                per event on iteration instead of a materialized list
             
         Returns:
             Batch object or None if no batch available
         """
         deadline = time.time() + timeout
         
-        while time.time() < deadline:
-            batch = self._try_get_batch()
+        while True:
+            with self._batch_available:
+                seen_seq = self._batch_seq
+            
+            batch = self._try_get_batch(lazy)
             if batch:
                 return batch
-            time.sleep(0.01)
+            
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                return None
+            
+            with self._batch_available:
+                # A batch may have landed between the claim and this lock
+                if self._batch_seq == seen_seq:
+                    self._batch_available.wait(timeout=remaining)
+    
+    def _try_get_batch(self, lazy: bool = False) -> Optional[Batch]:
+        """
+        Try to claim a pending batch under a lease.
+        
+        Single atomic UPDATE ... RETURNING: oldest pending batch, or a
+        'processing' batch whose lease expired (its worker crashed).
+        """
+        if self.multi_consumer:
+            return self._claim_batch(self._get_worker_connection(), lazy)
+        
+        conn = self._get_connection()
+        with self._db_lock:
+            return self._claim_batch(conn, lazy)
+    
+    def _claim_batch(self, conn: sqlite3.Connection, lazy: bool = False) -> Optional[Batch]:
+        """Claim one batch on the given connection (see _try_get_batch)."""
+        now = time.time()
+        lease_expires = now + self.lease_timeout_s
+        lease_owner = self._lease_owner()
+        
+        cursor = conn.cursor()
+        cursor.execute(
+            """
+            UPDATE pending_batches
+            SET status = 'processing',
+                attempts = attempts + 1,
+                last_attempt = ?,
+                lease_owner = ?,
+                lease_expires = ?
+            WHERE batch_id = (
+                SELECT batch_id FROM pending_batches
+                WHERE status = 'pending'
+                   OR (status = 'processing' AND lease_expires < ?)
+                ORDER BY priority DESC, created_at ASC
+                LIMIT 1
+            )
+            RETURNING batch_id, created_at, event_count, events_data, attempts
+            """,
+            (now, lease_owner, lease_expires, now)
+        )
+        # fetchall() steps the statement to completion so autocommit fires
+        rows = cursor.fetchall()
+        if not rows:
+            return None
+        
+        batch_id, created_at, event_count, events_data, attempts = rows[0]
+        
+        # Parse events (envelope or legacy JSON)
+        events = decode_events(events_data, lazy=lazy)
         
-        return None
+        return Batch(
+            batch_id=batch_id,
+            created_at=created_at,
+            events=events,
+            event_count=event_count,
+            status="processing",
+            attempts=attempts,
+            lease_expires=lease_expires,
+            lease_owner=lease_owner
+        )
+    
+    @staticmethod
+    def _lease_owner() -> str:
+        """Lease identity of the calling consumer thread."""
+        return f"{os.getpid()}:{threading.get_ident()}"
     
-    def _try_get_batch(self) -> Optional[Batch]:
-        """Try to get and lock a pending batch."""
+    def extend_lease(self, batch_id: str, lease_owner: Optional[str] = None) -> bool:
+        """
+        Push a claimed batch's lease deadline forward.
+        
+        Long-running workers call this so their batch is not re-claimed.
+        
+        Args:
+            batch_id: Batch ID currently held by the caller
+            lease_owner: Batch.lease_owner when the batch was claimed on
+                another thread (default: the calling thread)
+            
+        Returns:
+            True if the caller still held the lease and it was extended;
+            False once the lease expired and another consumer re-claimed it
+        """
         conn = self._get_connection()
         
         with self._db_lock:
             cursor = conn.cursor()
-            
-            try:
-                cursor.execute("BEGIN TRANSACTION")
-                
-                # Get oldest pending batch
-                cursor.execute(
-                    """
-                    SELECT batch_id, created_at, event_count, events_data, attempts
-                    FROM pending_batches
-                    WHERE status = 'pending'
-                    ORDER BY priority DESC, created_at ASC
-                    LIMIT 1
-                    """
-                )
-                
-                row = cursor.fetchone()
-                if not row:
-                    cursor.execute("ROLLBACK")
-                    return None
-                
-                batch_id, created_at, event_count, events_data, attempts = row
-                
-                # Mark as processing
-                cursor.execute(
-                    """
-                    UPDATE pending_batches 
-                    SET status = 'processing', 
-                        attempts = attempts + 1,
-                        last_attempt = ?
-                    WHERE batch_id = ?
-                    """,
-                    (time.time(), batch_id)
-                )
-                
-                cursor.execute("COMMIT")
-                
-                # Parse events
-                events = json.loads(events_data.decode("utf-8"))
-                
-                return Batch(
-                    batch_id=batch_id,
-                    created_at=created_at,
-                    events=events,
-                    event_count=event_count,
-                    status="processing",
-                    attempts=attempts + 1
-                )
-                
-            except Exception as e:
-                cursor.execute("ROLLBACK")
-                raise e
+            cursor.execute(
+                """
+                UPDATE pending_batches
+                SET lease_expires = ?
+                WHERE batch_id = ? AND status = 'processing' AND lease_owner = ?
+                """,
+                (time.time() + self.lease_timeout_s, batch_id, lease_owner or self._lease_owner())
+            )
+            return cursor.rowcount > 0
     
-    def mark_batch_done(self, batch_id: str) -> bool:
+    def mark_batch_done(self, batch_id: str, lease_owner: Optional[str] = None) -> bool:
         """
         Mark batch as processed.
         
         Args:
             batch_id: Batch ID to mark as done
+            lease_owner: Batch.lease_owner when the batch was claimed on
+                another thread (default: the calling thread)
             
         Returns:
-            True if batch was found and updated
+            True if the caller held the batch's lease and it was updated;
+            False if the batch is unknown or another consumer re-claimed it
         """
         conn = self._get_connection()
         
@@ -646,10 +1155,12 @@ class IndexerQueue:
             cursor.execute(
                 """
                 UPDATE pending_batches 
-                SET status = 'done'
-                WHERE batch_id = ?
+                SET status = 'done',
+                    lease_owner = NULL,
+                    lease_expires = NULL
+                WHERE batch_id = ? AND lease_owner = ?
                 """,
-                (batch_id,)
+                (batch_id, lease_owner or self._lease_owner())
             )
             conn.commit()
             return cursor.rowcount > 0
@@ -662,17 +1173,16 @@ class IndexerQueue:
         """Get current metrics snapshot."""
         conn = self._get_connection()
         
+        # Before _metrics_lock: event callbacks take _buffer_lock → _metrics_lock
+        with self._buffer_lock:
+            buffer_size = len(self._buffer)
+        
         with self._metrics_lock:
             uptime = 0.0
             if self._start_time:
                 uptime = time.time() - self._start_time
             
-            avg_latency = 0.0
-            if self._flush_latencies:
-                avg_latency = sum(self._flush_latencies) / len(self._flush_latencies)
-            
-            with self._buffer_lock:
-                buffer_size = len(self._buffer)
+            latency = self._flush_latency.snapshot()
             
             # Query batch counts from DB
             with self._db_lock:
@@ -702,6 +1212,15 @@ class IndexerQueue:
                 events_received_total=self._events_received,
                 events_processed_total=self._events_processed,
                 events_duplicate_total=self._events_duplicate,
-                avg_flush_latency_ms=avg_latency,
+                bloom_hits_total=self._bloom_hits,
+                bloom_misses_total=self._bloom_misses,
+                bloom_false_positives_total=self._bloom_false_positives,
+                events_pruned_total=self._events_pruned,
+                batches_pruned_total=self._batches_pruned,
+                avg_flush_latency_ms=latency["mean_ms"],
+                flush_latency_p50_ms=latency["p50_ms"],
+                flush_latency_p95_ms=latency["p95_ms"],
+                flush_latency_p99_ms=latency["p99_ms"],
+                flush_latency_max_ms=latency["max_ms"],
                 uptime_seconds=uptime
             )
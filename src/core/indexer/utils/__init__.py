@@ -11,10 +11,16 @@ from .idempotency import (
     ProcessingRegistry,
     ProcessingRecord
 )
+from .bloom import BloomFilter
+from .batch_codec import LazyEvents, encode_events, decode_events
 
 __all__ = [
     "PipelineStatus",
     "EventIdempotency", 
     "ProcessingRegistry",
-    "ProcessingRecord"
+    "ProcessingRecord",
+    "BloomFilter",
+    "LazyEvents",
+    "encode_events",
+    "decode_events"
 ]
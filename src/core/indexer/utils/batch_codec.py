@@ -0,0 +1,176 @@
+"""
+BATCH_CODEC.PY - Binary Envelope for pending_batches.events_data
+Task 6.3 - Sprint 6 Background Services
+
+Format v1 (little-endian):
+    magic   b"IQEV"   4 bytes
+    version u8        = 1
+    count   u32       number of records
+    record* u32 length + orjson-encoded event
+
+The top bit of a record length (_STDLIB_JSON) marks a record orjson could
+not encode (e.g. ints beyond 64 bits): it holds stdlib json and is decoded
+with json.loads, since orjson.loads would turn those ints into floats.
+
+Features:
+- orjson per record (no whole-batch json.dumps/json.loads)
+- Lazy decode: events are parsed one at a time out of a memoryview
+- Legacy rows (plain JSON array) still readable
+"""
+
+import json
+import struct
+from collections.abc import Sequence
+from typing import Any, Iterator, List, Optional, Tuple
+
+import orjson
+
+MAGIC = b"IQEV"
+VERSION = 1
+
+_HEADER = struct.Struct("<4sBI")
+_LENGTH = struct.Struct("<I")
+
+_STDLIB_JSON = 0x80000000
+_LENGTH_MASK = _STDLIB_JSON - 1
+
+_ORJSON_OPTIONS = orjson.OPT_NON_STR_KEYS
+
+
+def _dumps(event: Any) -> bytes:
+    """Length-prefixed record: orjson first, tagged stdlib json for what it rejects."""
+    try:
+        record = orjson.dumps(event, option=_ORJSON_OPTIONS)
+        tag = 0
+    except TypeError:
+        record = json.dumps(event).encode("utf-8")
+        tag = _STDLIB_JSON
+    if len(record) > _LENGTH_MASK:
+        raise ValueError("Batch event too large for envelope record")
+    return _LENGTH.pack(len(record) | tag) + record
+
+
+def _loads(header: int, record: memoryview) -> Any:
+    if header & _STDLIB_JSON:
+        return json.loads(bytes(record))
+    return orjson.loads(record)
+
+
+def encode_events(events: List[Any]) -> bytes:
+    """
+    Encode events into a v1 envelope.
+
+    Args:
+        events: JSON-serializable event payloads (in FIFO order)
+
+    Returns:
+        Envelope bytes for pending_batches.events_data
+    """
+    parts = [_HEADER.pack(MAGIC, VERSION, len(events))]
+    parts.extend(_dumps(event) for event in events)
+    return b"".join(parts)
+
+
+def is_envelope(blob: bytes) -> bool:
+    """True if blob is a binary envelope (False = legacy JSON row)."""
+    return blob[:4] == MAGIC
+
+
+class LazyEvents(Sequence):
+    """
+    Read-only sequence view over an envelope.
+
+    Iteration decodes one record at a time. Random access builds a
+    record offset table on first use (lengths only, no decoding).
+    """
+
+    __slots__ = ("_view", "_count", "_offsets")
+
+    def __init__(self, blob: bytes):
+        """
+        Args:
+            blob: v1 envelope bytes
+
+        Raises:
+            ValueError: If blob is not a supported envelope
+        """
+        if len(blob) < _HEADER.size:
+            raise ValueError("Batch envelope too short")
+
+        magic, version, count = _HEADER.unpack_from(blob)
+        if magic != MAGIC:
+            raise ValueError("Not a batch envelope")
+        if version != VERSION:
+            raise ValueError(f"Unsupported batch envelope version: {version}")
+
+        self._view = memoryview(blob)
+        self._count = count
+        self._offsets: Optional[List[int]] = None
+
+    def __len__(self) -> int:
+        return self._count
+
+    def _records(self) -> Iterator[Tuple[int, memoryview]]:
+        view = self._view
+        offset = _HEADER.size
+        unpack_length = _LENGTH.unpack_from
+        for _ in range(self._count):
+            (header,) = unpack_length(view, offset)
+            length = header & _LENGTH_MASK
+            offset += _LENGTH.size
+            yield header, view[offset:offset + length]
+            offset += length
+
+    def __iter__(self) -> Iterator[Any]:
+        for header, record in self._records():
+            yield _loads(header, record)
+
+    def _build_offsets(self) -> List[int]:
+        offsets = []
+        offset = _HEADER.size
+        unpack_length = _LENGTH.unpack_from
+        for _ in range(self._count):
+            offsets.append(offset)
+            (header,) = unpack_length(self._view, offset)
+            offset += _LENGTH.size + (header & _LENGTH_MASK)
+        return offsets
+
+    def __getitem__(self, index):
+        if isinstance(index, slice):
+            return [self[i] for i in range(*index.indices(self._count))]
+
+        if index < 0:
+            index += self._count
+        if not 0 <= index < self._count:
+            raise IndexError("batch event index out of range")
+
+        if self._offsets is None:
+            self._offsets = self._build_offsets()
+
+        offset = self._offsets[index]
+        (header,) = _LENGTH.unpack_from(self._view, offset)
+        start = offset + _LENGTH.size
+        return _loads(header, self._view[start:start + (header & _LENGTH_MASK)])
+
+    def __repr__(self) -> str:
+        return f"LazyEvents(count={self._count})"
+
+
+def decode_events(blob: bytes, lazy: bool = False) -> Sequence:
+    """
+    Decode events_data from either format.
+
+    Args:
+        blob: pending_batches.events_data
+        lazy: Return a LazyEvents view instead of a list (envelopes only;
+            legacy JSON rows are always fully parsed)
+
+    Returns:
+        List of events, or LazyEvents when lazy=True
+    """
+    if is_envelope(blob):
+        events = LazyEvents(blob)
+        return events if lazy else list(events)
+
+    # Legacy: json.dumps(list).encode("utf-8") (stdlib keeps NaN/Infinity)
+    return json.loads(blob.decode("utf-8"))
@@ -0,0 +1,142 @@
+"""
+BLOOM.PY - Bloom Filter Prefilter for Idempotency Checks
+Task 6.3 - Sprint 6 Background Services
+
+Features:
+- "Definitely new" answers without touching SQLite
+- Double hashing over one blake2b digest (stable across runs → persistable)
+- Compact bytes serialization for the queue DB
+- Thread-safe for Python 3.14 No-GIL
+
+False negatives are impossible as long as every persisted ID was added;
+false positives fall through to the SQLite check.
+"""
+
+import hashlib
+import math
+import struct
+import threading
+from typing import Iterable, Tuple
+
+
+class BloomFilter:
+    """
+    Fixed-size Bloom filter over string keys.
+
+    Sized from (capacity, error_rate). Past capacity the false-positive
+    rate climbs; callers check `saturated` and rebuild larger.
+
+    Memory: capacity=1M, error_rate=1% → ~1.2MB
+    """
+
+    # Header: magic, version, capacity, error_rate, num_bits, num_hashes, item_count
+    _HEADER = struct.Struct("<4sBQdQIQ")
+    _MAGIC = b"BLM1"
+    _VERSION = 1
+
+    def __init__(self, capacity: int = 1_000_000, error_rate: float = 0.01):
+        """
+        Initialize an empty filter.
+
+        Args:
+            capacity: Expected number of distinct keys
+            error_rate: Target false-positive probability at capacity
+        """
+        capacity = max(1, capacity)
+        num_bits, num_hashes = self.optimal_params(capacity, error_rate)
+
+        self.capacity = capacity
+        self.error_rate = error_rate
+        self._num_bits = num_bits
+        self._num_hashes = num_hashes
+        self._bits = bytearray((num_bits + 7) // 8)
+        self._count = 0
+        self._lock = threading.Lock()
+
+    @staticmethod
+    def optimal_params(capacity: int, error_rate: float) -> Tuple[int, int]:
+        """Return (num_bits, num_hashes) for the requested sizing."""
+        num_bits = math.ceil(-capacity * math.log(error_rate) / (math.log(2) ** 2))
+        num_hashes = max(1, round(num_bits / capacity * math.log(2)))
+        return num_bits, num_hashes
+
+    def _positions(self, key: str) -> Iterable[int]:
+        """Kirsch-Mitzenmacher double hashing: h1 + i*h2 mod m."""
+        digest = hashlib.blake2b(key.encode("utf-8"), digest_size=16).digest()
+        h1 = int.from_bytes(digest[:8], "little")
+        h2 = int.from_bytes(digest[8:], "little") | 1
+        m = self._num_bits
+        return ((h1 + i * h2) % m for i in range(self._num_hashes))
+
+    def add(self, key: str) -> None:
+        """Add key to the filter."""
+        positions = list(self._positions(key))
+        with self._lock:
+            bits = self._bits
+            for pos in positions:
+                bits[pos >> 3] |= 1 << (pos & 7)
+            self._count += 1
+
+    def __contains__(self, key: str) -> bool:
+        """False = definitely never added. True = maybe added."""
+        positions = list(self._positions(key))
+        with self._lock:
+            bits = self._bits
+            for pos in positions:
+                if not bits[pos >> 3] & (1 << (pos & 7)):
+                    return False
+            return True
+
+    def __len__(self) -> int:
+        """Approximate number of keys added (duplicates counted)."""
+        with self._lock:
+            return self._count
+
+    @property
+    def saturated(self) -> bool:
+        """True once more keys were added than the filter was sized for."""
+        with self._lock:
+            return self._count > self.capacity
+
+    def clear(self) -> None:
+        with self._lock:
+            self._bits = bytearray(len(self._bits))
+            self._count = 0
+
+    def to_bytes(self) -> bytes:
+        """Serialize filter (header + bit array)."""
+        with self._lock:
+            header = self._HEADER.pack(
+                self._MAGIC, self._VERSION,
+                self.capacity, self.error_rate,
+                self._num_bits, self._num_hashes, self._count
+            )
+            return header + bytes(self._bits)
+
+    @classmethod
+    def from_bytes(cls, data: bytes) -> "BloomFilter":
+        """
+        Deserialize a filter produced by to_bytes().
+
+        Raises:
+            ValueError: If the blob is malformed or truncated
+        """
+        if len(data) < cls._HEADER.size:
+            raise ValueError("Bloom filter blob too short")
+
+        (magic, version, capacity, error_rate,
+         num_bits, num_hashes, count) = cls._HEADER.unpack_from(data)
+        if magic != cls._MAGIC or version != cls._VERSION:
+            raise ValueError("Unknown bloom filter format")
+
+        bloom = cls(capacity=capacity, error_rate=error_rate)
+        if (num_bits, num_hashes) != (bloom._num_bits, bloom._num_hashes):
+            raise ValueError("Bloom filter header inconsistent")
+
+        bits = data[cls._HEADER.size:]
+        if len(bits) != len(bloom._bits):
+            raise ValueError("Bloom filter blob truncated")
+
+        bloom._bits = bytearray(bits)
+        bloom._count = count
+        return bloom
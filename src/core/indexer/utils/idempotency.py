@@ -207,6 +207,13 @@ Phase 1:
                 record.retry_count += 1
                 record.timestamp = datetime.now()
     
+    def release(self, event_key: str) -> None:
+        """Forget an event still marked processing (abandoned, not failed)."""
+        with self._lock:
+            record = self._registry.get(event_key)
+            if record is not None and record.status == 'processing':
+                del self._registry[event_key]
+    
     def _cleanup_expired(self) -> None:
         """Remove records older than TTL."""
         cutoff = datetime.now() - timedelta(seconds=self.ttl)
@@ -4,17 +4,40 @@
 # ------------------------------------------------------------------------------
 
 import logging
+from typing import Optional
 from fastapi import FastAPI, HTTPException
 from pydantic import BaseModel
 from pathlib import Path
 from .security.kms import KMS
+from .security.background_verifier import BackgroundChainVerifier
 from .storage.adapter import StorageAdapter
+from .services.eventbus import HeavyEventBus
+from .services.backup import BACKUP_KEY_CACHE
+from .indexer.queue import IndexerQueue
+from .indexer.sandbox import SandboxExecutor
+from .indexer.pipeline import ExtractionPipeline
+from .indexer.encrypted_storage import EncryptedIndexerDB, get_encryption_key_from_keyring
+from .api.routes.events import router as events_router, register_metrics_source, unregister_metrics_source
+from ..utils.tuning import configure_tuning
 
 logging.basicConfig(level=logging.INFO)
 app = FastAPI()
+app.include_router(events_router)
 DB_PATH = Path("data/mds.db")
+INDEX_PATH = Path("data/index.db")
+
+# Worker counts / buffer sizes for this host (CONVERT_TUNING_* overrides)
+tuning = configure_tuning(data_dir=DB_PATH.parent)
+
 kms = KMS(DB_PATH)
-adapter = StorageAdapter(DB_PATH, kms)
+# Session Argon2id outputs of the vault passkey: zeroed on kms.lock()
+kms.register_key_cache(BACKUP_KEY_CACHE)
+adapter = StorageAdapter(DB_PATH, kms, **tuning.storage_adapter_kwargs())
+event_bus = HeavyEventBus(name="main", **tuning.eventbus_kwargs())
+indexer_queue = IndexerQueue(**tuning.indexer_queue_kwargs())
+chain_verifier = BackgroundChainVerifier(adapter, **tuning.chain_verifier_kwargs())
+sandbox = SandboxExecutor(**tuning.sandbox_kwargs())
+pipeline: Optional[ExtractionPipeline] = None
 
 class UnlockRequest(BaseModel):
     passkey: str
@@ -24,6 +47,25 @@ class EventRequest(BaseModel):
     id: str
     payload: dict
 
+@app.on_event("startup")
+async def startup():
+    global pipeline
+    event_bus.start()
+    indexer_queue.start()
+    # Bus events land in the persistent indexer queue (unsubscribed by stop())
+    indexer_queue.subscribe_to_eventbus(event_bus, batch=True)
+    # GET /events/metrics: p50/p95/p99/max of the live instances
+    register_metrics_source("eventbus", event_bus.metrics)
+    register_metrics_source("indexer_queue", indexer_queue.metrics)
+    key = get_encryption_key_from_keyring()
+    if key is None:
+        logging.warning("No index key (keyring / CONVERT_SQLCIPHER_KEY): indexing disabled")
+    else:
+        pipeline = ExtractionPipeline(
+            EncryptedIndexerDB(INDEX_PATH, key=key), sandbox=sandbox, **tuning.pipeline_kwargs()
+        )
+        register_metrics_source("pipeline", pipeline.get_stats)
+
 @app.post("/vault/init")
 async def init(req: UnlockRequest):
     await kms.initialize_vault(req.passkey)
@@ -45,3 +87,14 @@ async def save(req: EventRequest):
 @app.get("/events")
 async def get():
     return await adapter.get_events()
+
+@app.on_event("shutdown")
+async def shutdown():
+    for name in ("eventbus", "indexer_queue", "pipeline"):
+        unregister_metrics_source(name)
+    if pipeline is not None:
+        pipeline.shutdown()
+    indexer_queue.stop()
+    event_bus.stop()
+    chain_verifier.shutdown()
+    await adapter.close()
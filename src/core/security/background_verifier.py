@@ -2,30 +2,84 @@ import asyncio
 import threading
 import logging
 import sqlite3
+import time
 from concurrent.futures import ThreadPoolExecutor
-from typing import Optional, Dict, Any
+from dataclasses import dataclass
+from typing import Optional, Dict, Any, List, Tuple
 
 logger = logging.getLogger(__name__)
 
+# Checkpoints are signed under their own HKDF stream key
+CHECKPOINT_STREAM_ID = "__chain_verification_checkpoint__"
+
+_CHECKPOINT_DDL = """
+CREATE TABLE IF NOT EXISTS chain_verification_checkpoints (
+    stream_type TEXT NOT NULL,
+    stream_id TEXT NOT NULL,
+    last_seq INTEGER NOT NULL,
+    last_event_hmac TEXT NOT NULL,
+    verified_count INTEGER NOT NULL,
+    updated_at INTEGER NOT NULL,
+    hmac_key_version TEXT NOT NULL,
+    checkpoint_hmac TEXT NOT NULL,
+    PRIMARY KEY (stream_type, stream_id)
+)
+"""
+
+
+@dataclass
+class VerificationProgress:
+    """Passed to progress_callback after every batch (from a worker thread)."""
+    stream_type: str
+    stream_id: str
+    verified: int               # Events verified in this run, this stream
+    events_per_second: float
+    done: bool = False
+
+
+@dataclass
+class _Checkpoint:
+    last_seq: int
+    last_event_hmac: str
+    verified_count: int
+
+
 class BackgroundChainVerifier:
     """
     Non-blocking chain verifier for Python 3.14 No-GIL.
-    
+
     Strategy:
         - Verify incrementally (only new events since last check)
-        - Run in background thread pool
-        - Cache last verified sequence per stream
+        - Run in background thread pool (verify_all_async: streams sharded
+          across the workers)
+        - Batched reads (BATCH_SIZE rows per query, keyset on stream_sequence)
+        - Last verified sequence per stream persisted in the vault
+          (chain_verification_checkpoints), HMAC-signed, bound to the HMAC
+          of the last verified event: a forged, stale or rewound checkpoint
+          means the stream is verified again from sequence 0
     """
-    
+
+    BATCH_SIZE = 2000
+
     def __init__(self, storage_adapter, max_workers: int = 2):
         self.adapter = storage_adapter
+        self.max_workers = max_workers
         self.executor = ThreadPoolExecutor(
             max_workers=max_workers,
             thread_name_prefix="chain-verify"
         )
-        self._verification_cache: Dict[str, int] = {}
+        self._verification_cache: Dict[str, _Checkpoint] = {}
         self._lock = threading.Lock()
-    
+
+        # One connection per worker thread (closed on shutdown)
+        self._local = threading.local()
+        self._conns: List[sqlite3.Connection] = []
+        self._schema_ready = False
+
+    # -------------------------------------------------------------------
+    # ASYNC API
+    # -------------------------------------------------------------------
+
     async def verify_stream_async(
         self,
         stream_type: str,
@@ -34,101 +88,260 @@ class BackgroundChainVerifier:
     ) -> bool:
         """
         Non-blocking verification.
-        
+
         Returns:
             True if chain is valid, False otherwise
         """
-        key = f"{stream_type}:{stream_id}"
-        
-        # Check cache
-        with self._lock:
-            last_verified_seq = self._verification_cache.get(key, 0)
-        
-        # Verify only new events
-        loop = asyncio.get_event_loop()
+        loop = asyncio.get_running_loop()
         try:
-            result = await loop.run_in_executor(
+            return await loop.run_in_executor(
                 self.executor,
-                self._verify_incremental,
+                self._verify_stream,
                 stream_type,
                 stream_id,
-                last_verified_seq,
                 progress_callback
             )
-            
-            # Update cache on success
-            if result["valid"]:
-                with self._lock:
-                    self._verification_cache[key] = result["last_seq"]
-            
-            return result["valid"]
-        
         except Exception as e:
             logger.error(f"Background verification failed: {e}")
             return False
-    
+
+    async def verify_all_async(self, progress_callback: Optional[callable] = None) -> Dict[str, bool]:
+        """
+        Verify every stream in the vault, streams sharded across the executor.
+
+        Returns:
+            {"stream_type:stream_id": valid}
+        """
+        loop = asyncio.get_running_loop()
+        try:
+            streams = await loop.run_in_executor(self.executor, self._list_streams)
+        except Exception as e:
+            logger.error(f"Background verification failed: {e}")
+            return {}
+
+        # Round-robin shards: one task per worker, not one per stream
+        shards = [streams[i::self.max_workers] for i in range(self.max_workers)]
+        results = await asyncio.gather(*(
+            loop.run_in_executor(self.executor, self._verify_shard, shard, progress_callback)
+            for shard in shards if shard
+        ))
+        merged: Dict[str, bool] = {}
+        for shard_result in results:
+            merged.update(shard_result)
+        return merged
+
+    # -------------------------------------------------------------------
+    # WORKER SIDE
+    # -------------------------------------------------------------------
+
+    def _connection(self) -> sqlite3.Connection:
+        conn = getattr(self._local, "conn", None)
+        if conn is None:
+            conn = sqlite3.connect(str(self.adapter.db_path), check_same_thread=False)
+            conn.execute("PRAGMA busy_timeout=5000")
+            with self._lock:
+                if not self._schema_ready:
+                    conn.execute(_CHECKPOINT_DDL)
+                    conn.commit()
+                    self._schema_ready = True
+                self._conns.append(conn)
+            self._local.conn = conn
+        return conn
+
+    def _list_streams(self) -> List[Tuple[str, str]]:
+        return self._connection().execute(
+            "SELECT DISTINCT stream_type, stream_id FROM domain_events"
+        ).fetchall()
+
+    def _verify_shard(
+        self,
+        streams: List[Tuple[str, str]],
+        progress_callback: Optional[callable]
+    ) -> Dict[str, bool]:
+        results = {}
+        for stream_type, stream_id in streams:
+            try:
+                valid = self._verify_stream(stream_type, stream_id, progress_callback)
+            except Exception as e:
+                logger.error(f"Background verification failed ({stream_type}:{stream_id}): {e}")
+                valid = False
+            results[f"{stream_type}:{stream_id}"] = valid
+        return results
+
+    def _verify_stream(
+        self,
+        stream_type: str,
+        stream_id: str,
+        progress_callback: Optional[callable]
+    ) -> bool:
+        key = f"{stream_type}:{stream_id}"
+        with self._lock:
+            checkpoint = self._verification_cache.get(key)
+        if checkpoint is None:
+            checkpoint = self._load_checkpoint(stream_type, stream_id)
+
+        result = self._verify_incremental(stream_type, stream_id, checkpoint, progress_callback)
+        with self._lock:
+            self._verification_cache[key] = result["checkpoint"]
+        return result["valid"]
+
     def _verify_incremental(
         self,
         stream_type: str,
         stream_id: str,
-        start_seq: int,
+        start: _Checkpoint,
         progress_callback: Optional[callable]
     ) -> Dict[str, Any]:
         """
         Synchronous verification (runs in thread pool).
-        
+
         This is CPU-bound (HMAC + SHA3), so it runs in a worker thread
-        to avoid blocking the asyncio event loop.
+        to avoid blocking the asyncio event loop. The checkpoint is stored
+        after every batch, up to the last event that verified.
         """
-        # This runs in a background thread (Python 3.14 No-GIL)
-        # Use synchronous sqlite3 (not aiosqlite)
-        
-        conn = sqlite3.connect(str(self.adapter.db_path))
-        try:
-            cursor = conn.execute(
+        conn = self._connection()
+        verify = self.adapter.hmac_service.verify
+        checkpoint = start
+        total_verified = 0
+        valid = True
+        start_time = time.perf_counter()
+
+        while valid:
+            rows = conn.execute(
                 """
                 SELECT event_id, payload, event_hmac, stream_sequence, hmac_key_version
                 FROM domain_events
                 WHERE stream_type = ? AND stream_id = ? AND stream_sequence > ?
                 ORDER BY stream_sequence ASC
+                LIMIT ?
                 """,
-                (stream_type, stream_id, start_seq)
-            )
-            
-            valid = True
-            last_seq = start_seq
-            total_verified = 0
-            
-            for row in cursor:
-                event_id, payload, stored_hmac, seq, key_ver = row
-                
+                (stream_type, stream_id, checkpoint.last_seq, self.BATCH_SIZE)
+            ).fetchall()
+            if not rows:
+                break
+
+            last_good = None
+            batch_verified = 0
+            for event_id, payload, stored_hmac, seq, key_ver in rows:
                 # Verify HMAC (CPU-intensive)
-                # Note: We access self.adapter.hmac_service.verify which is thread-safe (pure python/stdlib)
-                if not self.adapter.hmac_service.verify(payload, stored_hmac, stream_id, key_ver):
+                # Note: hmac_service.verify is thread-safe (stdlib + locked key cache)
+                if not verify(payload, stored_hmac, stream_id, key_ver):
                     logger.warning(f"HMAC failed: {event_id}")
                     valid = False
                     break
-                
-                last_seq = seq
-                total_verified += 1
-                
-                # Report progress every 100 events
-                if progress_callback and total_verified % 100 == 0:
-                    # Callback might need to be thread-safe or scheduled on loop
-                    # For simplicity, we assume callback handles threading or is just logging
-                    try:
-                        progress_callback(total_verified)
-                    except Exception:
-                        pass
-            
-            return {
-                "valid": valid,
-                "last_seq": last_seq,
-                "total_verified": total_verified
-            }
-        finally:
-            conn.close()
-    
+                last_good = (seq, stored_hmac)
+                batch_verified += 1
+            total_verified += batch_verified
+
+            if last_good is not None:
+                checkpoint = _Checkpoint(
+                    last_seq=last_good[0],
+                    last_event_hmac=last_good[1],
+                    verified_count=checkpoint.verified_count + batch_verified
+                )
+                self._store_checkpoint(conn, stream_type, stream_id, checkpoint)
+
+            self._report(progress_callback, stream_type, stream_id, total_verified, start_time, done=False)
+            if len(rows) < self.BATCH_SIZE:
+                break
+
+        self._report(progress_callback, stream_type, stream_id, total_verified, start_time, done=True)
+        return {
+            "valid": valid,
+            "last_seq": checkpoint.last_seq,
+            "total_verified": total_verified,
+            "checkpoint": checkpoint
+        }
+
+    @staticmethod
+    def _report(progress_callback, stream_type, stream_id, verified, start_time, done) -> None:
+        if not progress_callback:
+            return
+        elapsed = time.perf_counter() - start_time
+        # Callback runs on the worker thread: it must be thread-safe
+        # (e.g. loop.call_soon_threadsafe) or just log
+        try:
+            progress_callback(VerificationProgress(
+                stream_type=stream_type,
+                stream_id=stream_id,
+                verified=verified,
+                events_per_second=verified / elapsed if elapsed > 0 else 0.0,
+                done=done
+            ))
+        except Exception:
+            pass
+
+    # -------------------------------------------------------------------
+    # CHECKPOINTS (vault table, HMAC-protected)
+    # -------------------------------------------------------------------
+
+    @staticmethod
+    def _checkpoint_message(stream_type: str, stream_id: str, cp: _Checkpoint) -> bytes:
+        return "\x00".join(
+            (stream_type, stream_id, str(cp.last_seq), cp.last_event_hmac, str(cp.verified_count))
+        ).encode("utf-8")
+
+    def _store_checkpoint(
+        self,
+        conn: sqlite3.Connection,
+        stream_type: str,
+        stream_id: str,
+        cp: _Checkpoint
+    ) -> None:
+        signature, version = self.adapter.hmac_service.sign(
+            self._checkpoint_message(stream_type, stream_id, cp), CHECKPOINT_STREAM_ID
+        )
+        conn.execute(
+            """
+            INSERT OR REPLACE INTO chain_verification_checkpoints
+                (stream_type, stream_id, last_seq, last_event_hmac, verified_count,
+                 updated_at, hmac_key_version, checkpoint_hmac)
+            VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+            """,
+            (stream_type, stream_id, cp.last_seq, cp.last_event_hmac, cp.verified_count,
+             int(time.time()), version, signature)
+        )
+        conn.commit()
+
+    def _load_checkpoint(self, stream_type: str, stream_id: str) -> _Checkpoint:
+        """Persisted checkpoint if authentic and still matching the chain, else sequence 0."""
+        fresh = _Checkpoint(last_seq=0, last_event_hmac="", verified_count=0)
+        conn = self._connection()
+        row = conn.execute(
+            """
+            SELECT last_seq, last_event_hmac, verified_count, hmac_key_version, checkpoint_hmac
+            FROM chain_verification_checkpoints WHERE stream_type = ? AND stream_id = ?
+            """,
+            (stream_type, stream_id)
+        ).fetchone()
+        if row is None:
+            return fresh
+
+        last_seq, last_event_hmac, verified_count, version, signature = row
+        cp = _Checkpoint(last_seq, last_event_hmac, verified_count)
+        if not self.adapter.hmac_service.verify(
+            self._checkpoint_message(stream_type, stream_id, cp), signature, CHECKPOINT_STREAM_ID, version
+        ):
+            logger.warning(f"Checkpoint HMAC failed: {stream_type}:{stream_id} - re-verifying from 0")
+            return fresh
+
+        # The checkpointed event must still be the one that was verified
+        current = conn.execute(
+            """
+            SELECT event_hmac FROM domain_events
+            WHERE stream_type = ? AND stream_id = ? AND stream_sequence = ?
+            """,
+            (stream_type, stream_id, last_seq)
+        ).fetchone()
+        if current is None or current[0] != last_event_hmac:
+            logger.warning(f"Checkpoint no longer matches chain: {stream_type}:{stream_id} - re-verifying from 0")
+            return fresh
+        return cp
+
     def shutdown(self):
         """Graceful shutdown of thread pool."""
         self.executor.shutdown(wait=True)
+        with self._lock:
+            for conn in self._conns:
+                conn.close()
+            self._conns = []
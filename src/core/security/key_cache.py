@@ -0,0 +1,102 @@
+"""
+Derived Key Cache - Bounded, Zeroize-on-Evict Key Schedule Cache.
+
+HMACService.sign/verify and StorageAdapter re-derive the same stream keys
+(HKDF / BLAKE2b) for every payload. DerivedKeyCache keeps the derived key
+per (key_version, stream_id) so the hot path does the MAC and nothing else.
+
+ADR-006 hygiene (see memory.py):
+- Every cached key lives in a SecureBytes and is zeroed when evicted
+  (LRU, maxsize), invalidated, or cleared
+- KMS.lock()/unlock() and HMACService.rotate_key() clear the cache, so
+  no derived key outlives the master key it came from
+- get_or_derive() hands out a bytes copy for the call at hand (an
+  eviction on another thread could zero the cached one mid-MAC); don't
+  keep it beyond that call
+"""
+import threading
+from collections import OrderedDict
+from typing import Callable, Hashable, Optional
+
+from .memory import SecureBytes
+
+
+class DerivedKeyCache:
+    """
+    Thread-safe LRU of derived keys.
+
+    Usage:
+        cache = DerivedKeyCache()
+        key = cache.get_or_derive(("v1", stream_id), lambda: hkdf(master, stream_id))
+        hmac.new(key, payload, hashlib.sha3_256)
+    """
+
+    DEFAULT_MAXSIZE = 1024  # ~32 KB of 32-byte keys
+
+    def __init__(self, maxsize: int = DEFAULT_MAXSIZE):
+        self.maxsize = maxsize
+        self._entries: "OrderedDict[Hashable, SecureBytes]" = OrderedDict()
+        self._lock = threading.Lock()
+        # Bumped by invalidate()/clear(): a derive() that straddles one
+        # (e.g. KMS.lock()) must not repopulate the cache
+        self._generation = 0
+
+        # Metrics
+        self.hits = 0
+        self.misses = 0
+        self.evictions = 0
+
+    def get_or_derive(self, key_id: Hashable, derive: Callable[[], bytes]) -> bytes:
+        """
+        Cached key for key_id, derive() on a miss.
+
+        Args:
+            key_id: e.g. (key_version, stream_id)
+            derive: Produces the key bytes (called outside the lock)
+
+        A key derived while the cache was invalidated is returned to this
+        caller only, never cached: it may come from the old master key.
+        """
+        with self._lock:
+            entry = self._entries.get(key_id)
+            if entry is not None:
+                self._entries.move_to_end(key_id)
+                self.hits += 1
+                return bytes(entry.data)
+            self.misses += 1
+            generation = self._generation
+
+        entry = SecureBytes(derive())
+        with self._lock:
+            if self._generation != generation:
+                key = bytes(entry.data)
+                entry.secure_delete()
+                return key
+            existing = self._entries.get(key_id)
+            if existing is not None:
+                # Derived concurrently by another thread: keep one copy
+                entry.secure_delete()
+                return bytes(existing.data)
+            key = bytes(entry.data)
+            self._entries[key_id] = entry
+            while len(self._entries) > self.maxsize:
+                _, evicted = self._entries.popitem(last=False)
+                evicted.secure_delete()
+                self.evictions += 1
+        return key
+
+    def invalidate(self, predicate: Optional[Callable[[Hashable], bool]] = None) -> int:
+        """Zero and drop entries whose key_id matches (all if None). Returns count."""
+        with self._lock:
+            self._generation += 1
+            doomed = [k for k in self._entries if predicate is None or predicate(k)]
+            for key_id in doomed:
+                self._entries.pop(key_id).secure_delete()
+        return len(doomed)
+
+    def clear(self) -> None:
+        """Zero every cached key (vault lock, key rotation)."""
+        self.invalidate()
+
+    def __len__(self) -> int:
+        return len(self._entries)
@@ -8,6 +8,8 @@ from typing import Optional
 from pathlib import Path
 from dataclasses import dataclass, asdict
 
+from .key_cache import DerivedKeyCache
+
 try:
     from nacl.secret import SecretBox
     from nacl.utils import random
@@ -37,6 +39,10 @@ class KMS:
             
         self._master_key: Optional[bytes] = None
         self._is_unlocked: bool = False
+        
+        # Keys derived from the master key; emptied (zeroed) on lock/unlock
+        self.key_cache = DerivedKeyCache()
+        self._key_caches = [self.key_cache]
 
     @property
     def is_unlocked(self) -> bool:
@@ -45,6 +51,21 @@ class KMS:
     @property
     def master_key(self) -> Optional[bytes]:
         return self._master_key
+    
+    def register_key_cache(self, cache: DerivedKeyCache) -> None:
+        """Clear `cache` whenever the vault is locked or (re-)unlocked."""
+        if cache not in self._key_caches:
+            self._key_caches.append(cache)
+    
+    def _clear_key_caches(self) -> None:
+        for cache in self._key_caches:
+            cache.clear()
+    
+    def lock(self) -> None:
+        """Forget the master key and zero every derived key."""
+        self._clear_key_caches()
+        self._master_key = None
+        self._is_unlocked = False
 
     def initialize(self, passphrase: str) -> bool:
         if not HAS_CRYPTO: raise RuntimeError("Crypto libraries missing.")
@@ -79,7 +100,9 @@ class KMS:
     def unlock(self, passphrase: str) -> bool:
         if not HAS_CRYPTO: return False
         if not self.storage_path.exists(): return False
-            
+        
+        # Keys derived from a previous unlock must not survive it
+        self._clear_key_caches()
         try:
             keystore = self._load_keystore()
             salt = bytes.fromhex(keystore.salt)
@@ -4,14 +4,24 @@
 # COVERAGE: Database backup/restore with encryption
 # ------------------------------------------------------------------------------
 
+import hashlib
+import json
 import os
 import shutil
+import sqlite3
+import struct
+import tempfile
+import time
+from dataclasses import dataclass, field
 from pathlib import Path
-from typing import Optional, Callable
+from typing import Any, AsyncIterator, Callable, Dict, Iterable, Iterator, List, Optional
 import asyncio
 
+from ..security.key_cache import DerivedKeyCache
+
 # Crypto imports
 try:
+    import nacl.bindings
     import nacl.secret
     import nacl.utils
     import nacl.pwhash
@@ -44,6 +54,337 @@ class BackupCryptoUnavailableError(BackupCryptoError):
     pass
 
 
+# ------------------------------------------------------------------------------
+# STREAM FORMAT (v2)
+#
+#   MAGIC(7) | version(1) | salt(16) | opslimit(u64) | memlimit(u64) |
+#   chunk_size(u32) | secretstream header(24)
+#   then per chunk: [u32 length][XChaCha20-Poly1305 secretstream chunk]
+#
+# The fixed header is the associated data of the first chunk, the last
+# chunk carries TAG_FINAL (truncation is detected). Legacy v1 files
+# (salt | SecretBox message) have no magic and are still restored.
+# ------------------------------------------------------------------------------
+
+STREAM_MAGIC = b"CVBAKSS"
+STREAM_VERSION = 2
+DELTA_VERSION = 3  # Incremental page delta (see INCREMENTAL BACKUP)
+DEFAULT_CHUNK_SIZE = 1024 * 1024  # Plaintext bytes per secretstream chunk
+MIN_REPORT_INTERVAL = 0.1  # Seconds between throttled progress reports
+
+_HEADER = struct.Struct("<7sB16sQQI")
+_CHUNK_LEN = struct.Struct("<I")
+
+# Argon2id outputs for this session, keyed by (salt, limits, passkey
+# fingerprint): a chain of incremental backups runs the KDF once.
+# Registered with the app's KMS (main.py), so locking the vault also
+# zeroes these.
+BACKUP_KEY_CACHE = DerivedKeyCache(maxsize=8)
+
+
+def _check_kdf_limits(opslimit: int, memlimit: int) -> None:
+    """
+    Header limits are read before anything is authenticated: a crafted
+    file must not make Argon2id run for hours or allocate unbounded memory.
+    """
+    argon2id = nacl.pwhash.argon2id
+    if not (argon2id.OPSLIMIT_MIN <= opslimit <= argon2id.OPSLIMIT_SENSITIVE):
+        raise BackupIntegrityError(f"Corrupted backup header: opslimit {opslimit} out of range")
+    if not (argon2id.MEMLIMIT_MIN <= memlimit <= argon2id.MEMLIMIT_SENSITIVE):
+        raise BackupIntegrityError(f"Corrupted backup header: memlimit {memlimit} out of range")
+
+
+def _derive_key(passkey: str, salt: bytes, opslimit: int, memlimit: int) -> bytes:
+    password = passkey.encode('utf-8')
+    fingerprint = hashlib.blake2b(password, key=salt, digest_size=16).digest()
+    return BACKUP_KEY_CACHE.get_or_derive(
+        (salt, opslimit, memlimit, fingerprint),
+        lambda: nacl.pwhash.argon2id.kdf(
+            size=nacl.secret.SecretBox.KEY_SIZE,
+            password=password,
+            salt=salt,
+            opslimit=opslimit,
+            memlimit=memlimit
+        )
+    )
+
+
+@dataclass
+class BackupTelemetry:
+    """Passed to telemetry_callback (throttled, plus one per phase change)."""
+    phase: str                          # snapshot | read | kdf | encrypt | decrypt | write | verify | done
+    percent: int
+    message: str
+    bytes_done: int                     # Of the current phase
+    bytes_total: int
+    bytes_per_second: float
+    eta_seconds: Optional[float]        # Whole operation, from the current rate
+    phase_seconds: Dict[str, float] = field(default_factory=dict)
+
+
+class _Progress:
+    """
+    One backup/restore operation: percent + measured throughput for
+    progress_callback(percent, message), BackupTelemetry for
+    telemetry_callback, per-phase wall time. Byte reports are throttled
+    to MIN_REPORT_INTERVAL; phase changes always go out.
+    """
+
+    def __init__(
+        self,
+        callback: Optional[Callable[[int, str], None]],
+        telemetry_callback: Optional[Callable[[BackupTelemetry], None]] = None
+    ):
+        self.callback = callback
+        self.telemetry_callback = telemetry_callback
+        self.phase_seconds: Dict[str, float] = {}
+        self._carved: Dict[str, float] = {}
+        self.name = ""
+        self.start = self.end = 0
+        self.total_bytes = 0
+        self.pending_bytes = 0
+        self.done_bytes = 0
+        self._t0 = self._last_report = time.perf_counter()
+
+    def _close_phase(self) -> None:
+        if self.name:
+            # Time already attributed to a sub-phase (write) is not counted twice
+            elapsed = time.perf_counter() - self._t0 - self._carved.pop(self.name, 0.0)
+            self.phase_seconds[self.name] = self.phase_seconds.get(self.name, 0.0) + elapsed
+
+    def phase(
+        self,
+        name: str,
+        percent: int,
+        message: str,
+        total_bytes: int = 0,
+        end: Optional[int] = None,
+        pending_bytes: int = 0
+    ) -> None:
+        """
+        Start a phase covering percent..end over total_bytes (pending_bytes:
+        bytes of later phases, for the ETA).
+        """
+        self._close_phase()
+        self.name = name
+        self.start = percent
+        self.end = percent if end is None else end
+        self.total_bytes = total_bytes
+        self.pending_bytes = pending_bytes
+        self.done_bytes = 0
+        self._t0 = time.perf_counter()
+        self._emit(percent, message, 0.0)
+
+    def add_time(self, name: str, seconds: float) -> None:
+        """Attribute part of the current phase's wall time to `name`."""
+        self.phase_seconds[name] = self.phase_seconds.get(name, 0.0) + seconds
+        self._carved[self.name] = self._carved.get(self.name, 0.0) + seconds
+
+    def report(self, done_bytes: int, verb: str) -> None:
+        if not (self.callback or self.telemetry_callback):
+            return
+        self.done_bytes = done_bytes
+        now = time.perf_counter()
+        if now - self._last_report < MIN_REPORT_INTERVAL and done_bytes < self.total_bytes:
+            return
+        elapsed = now - self._t0
+        rate = done_bytes / elapsed if elapsed > 0 else 0.0
+        total = max(self.total_bytes, 1)
+        percent = self.start + (self.end - self.start) * min(done_bytes, total) // total
+        self._emit(
+            percent,
+            f"{verb}... {done_bytes / (1024 * 1024):.1f} MiB ({rate / (1024 * 1024):.1f} MiB/s)",
+            rate
+        )
+
+    def done(self, message: str) -> None:
+        self._close_phase()
+        self.name = ""
+        self.total_bytes = self.pending_bytes = self.done_bytes = 0
+        self._emit(100, message, 0.0, phase="done")
+
+    def _emit(self, percent: int, message: str, rate: float, phase: Optional[str] = None) -> None:
+        self._last_report = time.perf_counter()
+        if self.callback:
+            self.callback(percent, message)
+        if self.telemetry_callback:
+            remaining = max(self.total_bytes - self.done_bytes, 0) + self.pending_bytes
+            self.telemetry_callback(BackupTelemetry(
+                phase=phase or self.name,
+                percent=percent,
+                message=message,
+                bytes_done=self.done_bytes,
+                bytes_total=self.total_bytes,
+                bytes_per_second=rate,
+                eta_seconds=remaining / rate if rate > 0 else (0.0 if not remaining else None),
+                phase_seconds={k: round(v, 4) for k, v in self.phase_seconds.items()}
+            ))
+
+
+def _snapshot(db_path: Path, snapshot_path: Path) -> bool:
+    """
+    Consistent copy of a live database via SQLite's online backup API
+    (WAL content included, writers not blocked for the whole copy).
+
+    Returns:
+        False if db_path is not an SQLite database (caller copies bytes)
+    """
+    try:
+        src = sqlite3.connect(f"{db_path.absolute().as_uri()}?mode=ro", uri=True)
+    except sqlite3.Error:
+        return False
+    try:
+        fd = os.open(snapshot_path, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o600)
+        os.close(fd)
+        dst = sqlite3.connect(snapshot_path)
+        try:
+            src.backup(dst, pages=1024)
+        finally:
+            dst.close()
+        return True
+    except sqlite3.DatabaseError:
+        return False
+    finally:
+        src.close()
+
+
+async def _push_stream(
+    out,
+    key: bytes,
+    header: bytes,
+    pieces: Iterable[bytes],
+    progress: Optional[_Progress] = None,
+    report_bytes: bool = True
+) -> None:
+    """
+    Write header, secretstream header and one chunk per piece (each at most
+    the chunk_size recorded in header). The last piece is tagged FINAL.
+    Time spent in write/fsync is reported as the "write" phase.
+    """
+    state = nacl.bindings.crypto_secretstream_xchacha20poly1305_state()
+    out.write(header)
+    out.write(nacl.bindings.crypto_secretstream_xchacha20poly1305_init_push(state, key))
+    
+    ad = header
+    done_bytes = 0
+    pieces = iter(pieces)
+    chunk = next(pieces, b"")
+    while True:
+        next_chunk = next(pieces, None)
+        tag = (
+            nacl.bindings.crypto_secretstream_xchacha20poly1305_TAG_FINAL
+            if next_chunk is None else
+            nacl.bindings.crypto_secretstream_xchacha20poly1305_TAG_MESSAGE
+        )
+        encrypted = nacl.bindings.crypto_secretstream_xchacha20poly1305_push(state, chunk, ad, tag)
+        t_write = time.perf_counter()
+        out.write(_CHUNK_LEN.pack(len(encrypted)))
+        out.write(encrypted)
+        ad = None
+        
+        done_bytes += len(chunk)
+        if progress:
+            progress.add_time("write", time.perf_counter() - t_write)
+            if report_bytes:
+                progress.report(done_bytes, "Encrypting")
+        if next_chunk is None:
+            break
+        chunk = next_chunk
+        await asyncio.sleep(0)  # Let the event loop breathe between chunks
+    
+    t_write = time.perf_counter()
+    out.flush()
+    os.fsync(out.fileno())
+    if progress:
+        progress.add_time("write", time.perf_counter() - t_write)
+
+
+async def _pull_stream(
+    f,
+    header: bytes,
+    key: bytes,
+    chunk_size: int,
+    progress: Optional[_Progress] = None,
+    verb: str = "Decrypting"
+) -> AsyncIterator[bytes]:
+    """
+    Decrypted chunks after header (already read from f), in order.
+    Raises BackupIntegrityError on forgery, truncation or trailing data.
+    """
+    stream_header = f.read(nacl.bindings.crypto_secretstream_xchacha20poly1305_HEADERBYTES)
+    state = nacl.bindings.crypto_secretstream_xchacha20poly1305_state()
+    try:
+        nacl.bindings.crypto_secretstream_xchacha20poly1305_init_pull(state, stream_header, key)
+    except Exception as e:
+        raise BackupIntegrityError(f"Corrupted backup header: {e}")
+    
+    max_chunk = chunk_size + nacl.bindings.crypto_secretstream_xchacha20poly1305_ABYTES
+    done_bytes = f.tell()
+    ad = header
+    while True:
+        length_bytes = f.read(_CHUNK_LEN.size)
+        if len(length_bytes) < _CHUNK_LEN.size:
+            raise BackupIntegrityError("Backup truncated: final chunk missing")
+        (length,) = _CHUNK_LEN.unpack(length_bytes)
+        encrypted = f.read(length) if length <= max_chunk else b""
+        if len(encrypted) != length or length == 0:
+            raise BackupIntegrityError("Corrupted backup: bad chunk length")
+        try:
+            plaintext, tag = nacl.bindings.crypto_secretstream_xchacha20poly1305_pull(state, encrypted, ad)
+        except Exception as e:
+            raise BackupIntegrityError(f"Decryption failed - wrong passkey or corrupted backup: {e}")
+        ad = None
+        
+        yield plaintext
+        
+        done_bytes += _CHUNK_LEN.size + length
+        if progress:
+            progress.report(done_bytes, verb)
+        if tag == nacl.bindings.crypto_secretstream_xchacha20poly1305_TAG_FINAL:
+            break
+        await asyncio.sleep(0)
+    
+    if f.read(1):
+        raise BackupIntegrityError("Corrupted backup: data after final chunk")
+
+
+def _staging_dir(db_path: Path) -> Path:
+    """
+    Private (0700) directory for the plaintext snapshot.
+
+    Created next to the vault, on the disk that already holds the
+    plaintext - never beside the backup target, which is often removable
+    or cloud-synced media where secure_wipe_file() guarantees nothing.
+    Falls back to the system temp directory if the vault's is read-only.
+    """
+    try:
+        return Path(tempfile.mkdtemp(prefix=".backup-", dir=db_path.absolute().parent))
+    except OSError:
+        return Path(tempfile.mkdtemp(prefix="convert-backup-"))
+
+
+def _discard_staging(staging: Optional[Path]) -> None:
+    """Wipe everything staged (snapshot, SQLite journal) and the directory."""
+    if staging is None or not staging.exists():
+        return
+    for path in staging.iterdir():
+        secure_wipe_file(path)
+    shutil.rmtree(staging, ignore_errors=True)
+
+
+def _read_pieces(f, size: int) -> Iterator[bytes]:
+    while True:
+        piece = f.read(size)
+        if not piece:
+            return
+        yield piece
+
+
+def _open_private(path: Path):
+    fd = os.open(path, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o600)
+    return os.fdopen(fd, 'wb')
+
+
 # ------------------------------------------------------------------------------
 # BACKUP CREATION
 # ------------------------------------------------------------------------------
@@ -52,16 +393,27 @@ async def create_backup(
     db_path: Path | str,
     passkey: str,
     output_path: Path | str,
-    progress_callback: Optional[Callable[[int, str], None]] = None
+    progress_callback: Optional[Callable[[int, str], None]] = None,
+    chunk_size: int = DEFAULT_CHUNK_SIZE,
+    telemetry_callback: Optional[Callable[[BackupTelemetry], None]] = None,
+    verify: bool = False
 ) -> bool:
     """
     Create an encrypted backup of the database.
     
+    Streams a consistent snapshot through secretstream in chunk_size
+    pieces: memory use is one chunk, not the vault size.
+    
     Args:
         db_path: Path to the source database file
         passkey: Encryption passkey
         output_path: Path where backup file will be created
-        progress_callback: Optional callback(percent, message) for progress updates
+        progress_callback: Optional callback(percent, message) for progress
+            updates; messages carry measured MiB/s
+        chunk_size: Plaintext bytes per encrypted chunk
+        telemetry_callback: Optional callback(BackupTelemetry): bytes, rate,
+            ETA and per-phase timing (snapshot, kdf, encrypt, write, verify)
+        verify: Decrypt the written file once more before publishing it
     
     Returns:
         bool: True if backup created successfully
@@ -75,50 +427,53 @@ async def create_backup(
     
     db_path = Path(db_path)
     output_path = Path(output_path)
+    partial_path = output_path.with_name(f".{output_path.name}.partial")
+    staging = None
     
+    progress = _Progress(progress_callback, telemetry_callback)
     try:
-        if progress_callback:
-            progress_callback(0, "Starting backup...")
+        progress.phase("snapshot", 0, "Starting backup...")
         
-        # Read source database
-        with open(db_path, 'rb') as f:
-            plaintext = f.read()
+        # Consistent snapshot (falls back to the raw file for non-SQLite input)
+        staging = _staging_dir(db_path)
+        snapshot_path = staging / "snapshot.db"
+        source_path = snapshot_path if _snapshot(db_path, snapshot_path) else db_path
+        total_bytes = source_path.stat().st_size
         
-        if progress_callback:
-            progress_callback(25, "Encrypting...")
+        progress.phase("kdf", 5, "Deriving key...", pending_bytes=total_bytes * (2 if verify else 1))
         
         # Derive encryption key from passkey
         salt = nacl.utils.random(nacl.pwhash.argon2id.SALTBYTES)
-        key = nacl.pwhash.argon2id.kdf(
-            size=nacl.secret.SecretBox.KEY_SIZE,
-            password=passkey.encode('utf-8'),
-            salt=salt,
-            opslimit=nacl.pwhash.argon2id.OPSLIMIT_MODERATE,
-            memlimit=nacl.pwhash.argon2id.MEMLIMIT_MODERATE
-        )
-        
-        if progress_callback:
-            progress_callback(50, "Encrypting data...")
+        opslimit = nacl.pwhash.argon2id.OPSLIMIT_MODERATE
+        memlimit = nacl.pwhash.argon2id.MEMLIMIT_MODERATE
+        key = _derive_key(passkey, salt, opslimit, memlimit)
+        header = _HEADER.pack(STREAM_MAGIC, STREAM_VERSION, salt, opslimit, memlimit, chunk_size)
         
-        # Encrypt the database content
-        box = nacl.secret.SecretBox(key)
-        ciphertext = box.encrypt(plaintext)
+        progress.phase(
+            "encrypt", 10, "Encrypting...", total_bytes,
+            end=90 if verify else 99, pending_bytes=total_bytes if verify else 0
+        )
+        with open(source_path, 'rb') as src, _open_private(partial_path) as out:
+            await _push_stream(out, key, header, _read_pieces(src, chunk_size), progress)
         
-        if progress_callback:
-            progress_callback(75, "Writing backup file...")
+        if verify:
+            progress.phase("verify", 90, "Verifying backup...", partial_path.stat().st_size, end=99)
+            with open(partial_path, 'rb') as f:
+                async for _ in _pull_stream(f, f.read(_HEADER.size), key, chunk_size, progress, "Verifying"):
+                    pass
         
-        # Write encrypted backup (salt + ciphertext)
-        with open(output_path, 'wb') as f:
-            f.write(salt)
-            f.write(ciphertext)
+        os.replace(partial_path, output_path)
         
-        if progress_callback:
-            progress_callback(100, "Backup complete")
+        progress.done("Backup complete")
         
         return True
         
     except Exception as e:
         raise BackupError(f"Failed to create backup: {e}")
+    finally:
+        _discard_staging(staging)
+        if partial_path.exists():
+            partial_path.unlink()
 
 
 # ------------------------------------------------------------------------------
@@ -129,16 +484,22 @@ async def restore_backup(
     backup_path: Path | str,
     passkey: str,
     output_path: Path | str,
-    progress_callback: Optional[Callable[[int, str], None]] = None
+    progress_callback: Optional[Callable[[int, str], None]] = None,
+    telemetry_callback: Optional[Callable[[BackupTelemetry], None]] = None
 ) -> bool:
     """
     Restore a database from an encrypted backup.
     
+    Streamed (v2) backups are decrypted chunk by chunk into a temporary
+    file that replaces output_path only once the final chunk verified;
+    a wrong passkey or corrupted/truncated file leaves output_path as is.
+    
     Args:
         backup_path: Path to the backup file
         passkey: Decryption passkey
         output_path: Path where database will be restored
         progress_callback: Optional callback(percent, message) for progress updates
+        telemetry_callback: Optional callback(BackupTelemetry) (kdf, decrypt, write)
     
     Returns:
         bool: True if restore successful
@@ -152,54 +513,434 @@ async def restore_backup(
     
     backup_path = Path(backup_path)
     output_path = Path(output_path)
+    partial_path = output_path.with_name(f".{output_path.name}.restoring")
     
+    progress = _Progress(progress_callback, telemetry_callback)
     try:
-        if progress_callback:
-            progress_callback(0, "Reading backup...")
+        total_bytes = backup_path.stat().st_size
+        progress.phase("read", 0, "Reading backup...", pending_bytes=total_bytes)
         
-        # Read encrypted backup
         with open(backup_path, 'rb') as f:
-            salt = f.read(nacl.pwhash.argon2id.SALTBYTES)
-            ciphertext = f.read()
+            head = f.read(_HEADER.size)
+            if head[:len(STREAM_MAGIC)] == STREAM_MAGIC:
+                await _restore_stream(f, head, total_bytes, passkey, partial_path, progress)
+            else:
+                f.seek(0)
+                _restore_legacy(f, passkey, partial_path, progress)
         
-        if progress_callback:
-            progress_callback(25, "Deriving key...")
+        os.replace(partial_path, output_path)
         
-        # Derive decryption key from passkey
-        key = nacl.pwhash.argon2id.kdf(
-            size=nacl.secret.SecretBox.KEY_SIZE,
-            password=passkey.encode('utf-8'),
-            salt=salt,
-            opslimit=nacl.pwhash.argon2id.OPSLIMIT_MODERATE,
-            memlimit=nacl.pwhash.argon2id.MEMLIMIT_MODERATE
-        )
+        progress.done("Restore complete")
         
-        if progress_callback:
-            progress_callback(50, "Decrypting...")
+        return True
         
-        # Decrypt the backup
-        box = nacl.secret.SecretBox(key)
-        try:
-            plaintext = box.decrypt(ciphertext)
-        except Exception as e:
-            raise BackupIntegrityError(f"Decryption failed - wrong passkey or corrupted backup: {e}")
+    except BackupIntegrityError:
+        raise
+    except Exception as e:
+        raise BackupError(f"Failed to restore backup: {e}")
+    finally:
+        if partial_path.exists():
+            secure_wipe_file(partial_path)
+
+
+async def _restore_stream(
+    f,
+    header: bytes,
+    total_bytes: int,
+    passkey: str,
+    partial_path: Path,
+    progress: _Progress
+) -> None:
+    if len(header) < _HEADER.size:
+        raise BackupIntegrityError("Truncated backup header")
+    magic, version, salt, opslimit, memlimit, chunk_size = _HEADER.unpack(header)
+    if version == DELTA_VERSION:
+        raise BackupError("Incremental backup file - restore its chain with restore_incremental_backup")
+    if version != STREAM_VERSION:
+        raise BackupError(f"Unsupported backup format version {version}")
+    
+    _check_kdf_limits(opslimit, memlimit)
+    
+    progress.phase("kdf", 5, "Deriving key...", pending_bytes=total_bytes)
+    key = _derive_key(passkey, salt, opslimit, memlimit)
+    
+    progress.phase("decrypt", 10, "Decrypting...", total_bytes, end=99)
+    with _open_private(partial_path) as out:
+        async for plaintext in _pull_stream(f, header, key, chunk_size, progress):
+            t_write = time.perf_counter()
+            out.write(plaintext)
+            progress.add_time("write", time.perf_counter() - t_write)
+        t_write = time.perf_counter()
+        out.flush()
+        os.fsync(out.fileno())
+        progress.add_time("write", time.perf_counter() - t_write)
+
+
+def _restore_legacy(
+    f,
+    passkey: str,
+    partial_path: Path,
+    progress: _Progress
+) -> None:
+    """v1: salt | SecretBox(whole database) - read in one piece."""
+    salt = f.read(nacl.pwhash.argon2id.SALTBYTES)
+    ciphertext = f.read()
+    
+    progress.phase("kdf", 25, "Deriving key...")
+    key = _derive_key(
+        passkey, salt,
+        nacl.pwhash.argon2id.OPSLIMIT_MODERATE,
+        nacl.pwhash.argon2id.MEMLIMIT_MODERATE
+    )
+    
+    progress.phase("decrypt", 50, "Decrypting...")
+    box = nacl.secret.SecretBox(key)
+    try:
+        plaintext = box.decrypt(ciphertext)
+    except Exception as e:
+        raise BackupIntegrityError(f"Decryption failed - wrong passkey or corrupted backup: {e}")
+    
+    progress.phase("write", 75, "Writing database...")
+    with _open_private(partial_path) as out:
+        out.write(plaintext)
+
+
+# ------------------------------------------------------------------------------
+# INCREMENTAL BACKUP
+#
+# chain_dir/
+#   manifest.cvman   MANIFEST_MAGIC(7) | version(1) | salt(16) | opslimit(u64) |
+#                    memlimit(u64) | SecretBox([u32 len][json][page hashes])
+#   000000.cvdelta   base: every page of the snapshot
+#   000001.cvdelta   only the pages whose keyed hash changed since 000000
+#   ...
+#
+# A delta file is the v2 stream with version DELTA_VERSION and _DELTA
+# (sequence, page_size, page_count) appended to the header; its plaintext
+# is [u32 page_no][page] records, never split across chunks. The manifest
+# lists each file with its BLAKE2b digest, so restore replays exactly the
+# chain that was written. All files of a chain share the base salt: the
+# KDF runs once per session (BACKUP_KEY_CACHE).
+# ------------------------------------------------------------------------------
+
+MANIFEST_NAME = "manifest.cvman"
+MANIFEST_MAGIC = b"CVBAKMF"
+MANIFEST_VERSION = 1
+
+_MANIFEST_HEADER = struct.Struct("<7sB16sQQ")
+_DELTA = struct.Struct("<III")
+_PAGE_NO = struct.Struct("<I")
+_PAGE_HASH_SIZE = 16
+_DEFAULT_PAGE_SIZE = 4096
+
+
+def _page_size(path: Path) -> int:
+    """Page size from the SQLite header (4096 for anything else)."""
+    with open(path, 'rb') as f:
+        head = f.read(18)
+    if len(head) == 18 and head.startswith(b"SQLite format 3\x00"):
+        size = int.from_bytes(head[16:18], 'big')
+        size = 65536 if size == 1 else size
+        if 512 <= size <= 65536 and size & (size - 1) == 0:
+            return size
+    return _DEFAULT_PAGE_SIZE
+
+
+def _file_digest(path: Path) -> str:
+    h = hashlib.blake2b(digest_size=32)
+    with open(path, 'rb') as f:
+        for piece in _read_pieces(f, DEFAULT_CHUNK_SIZE):
+            h.update(piece)
+    return h.hexdigest()
+
+
+def _read_manifest(chain_dir: Path, passkey: str) -> Optional[Dict[str, Any]]:
+    path = chain_dir / MANIFEST_NAME
+    if not path.exists():
+        return None
+    data = path.read_bytes()
+    if len(data) < _MANIFEST_HEADER.size:
+        raise BackupIntegrityError("Truncated backup manifest")
+    magic, version, salt, opslimit, memlimit = _MANIFEST_HEADER.unpack_from(data)
+    if magic != MANIFEST_MAGIC or version != MANIFEST_VERSION:
+        raise BackupError(f"Not a backup manifest: {path}")
+    _check_kdf_limits(opslimit, memlimit)
+    
+    key = _derive_key(passkey, salt, opslimit, memlimit)
+    try:
+        plaintext = nacl.secret.SecretBox(key).decrypt(data[_MANIFEST_HEADER.size:])
+    except Exception as e:
+        raise BackupIntegrityError(f"Manifest decryption failed - wrong passkey or corrupted manifest: {e}")
+    
+    (json_len,) = _CHUNK_LEN.unpack_from(plaintext)
+    manifest = json.loads(plaintext[_CHUNK_LEN.size:_CHUNK_LEN.size + json_len])
+    manifest["page_hashes"] = plaintext[_CHUNK_LEN.size + json_len:]
+    manifest["key"] = key
+    manifest["salt"], manifest["opslimit"], manifest["memlimit"] = salt, opslimit, memlimit
+    return manifest
+
+
+def _write_manifest(chain_dir: Path, manifest: Dict[str, Any]) -> None:
+    body = json.dumps({"page_size": manifest["page_size"], "entries": manifest["entries"]}).encode('utf-8')
+    plaintext = _CHUNK_LEN.pack(len(body)) + body + manifest["page_hashes"]
+    header = _MANIFEST_HEADER.pack(
+        MANIFEST_MAGIC, MANIFEST_VERSION, manifest["salt"], manifest["opslimit"], manifest["memlimit"]
+    )
+    
+    path = chain_dir / MANIFEST_NAME
+    partial_path = chain_dir / f".{MANIFEST_NAME}.partial"
+    with _open_private(partial_path) as out:
+        out.write(header)
+        out.write(nacl.secret.SecretBox(manifest["key"]).encrypt(plaintext))
+        out.flush()
+        os.fsync(out.fileno())
+    os.replace(partial_path, path)
+
+
+def _changed_pages(
+    src,
+    page_size: int,
+    chunk_size: int,
+    hash_key: bytes,
+    old_hashes: bytes,
+    new_hashes: bytearray,
+    stats: Dict[str, int],
+    progress: _Progress
+) -> Iterator[bytes]:
+    """Scan the snapshot page by page; yield chunks of changed-page records."""
+    record_size = _PAGE_NO.size + page_size
+    chunk = bytearray()
+    page_no = 0
+    scanned = 0
+    for piece in _read_pieces(src, max(page_size, chunk_size // page_size * page_size)):
+        for offset in range(0, len(piece), page_size):
+            page = piece[offset:offset + page_size]
+            page_no += 1
+            digest = hashlib.blake2b(page, key=hash_key, digest_size=_PAGE_HASH_SIZE).digest()
+            new_hashes += digest
+            at = (page_no - 1) * _PAGE_HASH_SIZE
+            if old_hashes[at:at + _PAGE_HASH_SIZE] == digest:
+                continue
+            
+            if len(chunk) + record_size > chunk_size:
+                yield bytes(chunk)
+                chunk.clear()
+            chunk += _PAGE_NO.pack(page_no)
+            chunk += page
+            stats["changed_pages"] += 1
+        scanned += len(piece)
+        progress.report(scanned, "Scanning pages")
+    stats["page_count"] = page_no
+    if chunk or not stats["changed_pages"]:
+        yield bytes(chunk)
+
+
+async def create_incremental_backup(
+    db_path: Path | str,
+    passkey: str,
+    chain_dir: Path | str,
+    progress_callback: Optional[Callable[[int, str], None]] = None,
+    chunk_size: int = DEFAULT_CHUNK_SIZE,
+    telemetry_callback: Optional[Callable[[BackupTelemetry], None]] = None
+) -> Dict[str, Any]:
+    """
+    Add a backup to the chain in chain_dir (created, with a full base, on
+    first use): only pages that changed since the previous backup of the
+    chain are encrypted and written.
+    
+    Args:
+        db_path: Path to the source database file
+        passkey: Encryption passkey (must match the chain's)
+        chain_dir: Directory holding manifest.cvman and the delta files
+        progress_callback: Optional callback(percent, message) for progress updates
+        chunk_size: Plaintext bytes per encrypted chunk
+        telemetry_callback: Optional callback(BackupTelemetry) (snapshot, kdf,
+            encrypt = page scan, write)
+    
+    Returns:
+        The manifest entry: {"sequence", "file", "digest", "page_size",
+        "page_count", "changed_pages", "created_at"}
+    
+    Raises:
+        BackupIntegrityError: If the existing manifest does not verify
+        BackupError: If backup creation fails
+    """
+    if not HAS_NACL:
+        raise BackupCryptoUnavailableError("nacl library not available")
+    
+    db_path = Path(db_path)
+    chain_dir = Path(chain_dir)
+    chain_dir.mkdir(parents=True, exist_ok=True)
+    partial_path = chain_dir / ".delta.partial"
+    staging = None
+    
+    progress = _Progress(progress_callback, telemetry_callback)
+    try:
+        progress.phase("snapshot", 0, "Starting incremental backup...")
+        
+        staging = _staging_dir(db_path)
+        snapshot_path = staging / "snapshot.db"
+        source_path = snapshot_path if _snapshot(db_path, snapshot_path) else db_path
+        page_size = _page_size(source_path)
+        total_bytes = source_path.stat().st_size
+        
+        progress.phase("kdf", 5, "Deriving key...", pending_bytes=total_bytes)
+        
+        manifest = _read_manifest(chain_dir, passkey)
+        if manifest is None:
+            salt = nacl.utils.random(nacl.pwhash.argon2id.SALTBYTES)
+            opslimit = nacl.pwhash.argon2id.OPSLIMIT_MODERATE
+            memlimit = nacl.pwhash.argon2id.MEMLIMIT_MODERATE
+            manifest = {
+                "salt": salt, "opslimit": opslimit, "memlimit": memlimit,
+                "key": _derive_key(passkey, salt, opslimit, memlimit),
+                "page_size": page_size, "entries": [], "page_hashes": b""
+            }
+        # A page size change (VACUUM) invalidates every page hash
+        old_hashes = manifest["page_hashes"] if manifest["page_size"] == page_size else b""
+        
+        key = manifest["key"]
+        hash_key = hashlib.blake2b(key, person=b"cvbak-pagehash", digest_size=32).digest()
+        sequence = len(manifest["entries"])
+        chunk_size = max(chunk_size, _PAGE_NO.size + page_size)
+        
+        page_count = -(-total_bytes // page_size)
+        header = _HEADER.pack(
+            STREAM_MAGIC, DELTA_VERSION, manifest["salt"], manifest["opslimit"], manifest["memlimit"], chunk_size
+        ) + _DELTA.pack(sequence, page_size, page_count)
+        
+        new_hashes = bytearray()
+        stats = {"changed_pages": 0, "page_count": 0}
+        progress.phase("encrypt", 10, "Scanning pages...", total_bytes, end=95)
+        with open(source_path, 'rb') as src, _open_private(partial_path) as out:
+            pieces = _changed_pages(src, page_size, chunk_size, hash_key, old_hashes, new_hashes, stats, progress)
+            await _push_stream(out, key, header, pieces, progress, report_bytes=False)
+        
+        progress.phase("write", 97, "Updating manifest...")
+        
+        entry = {
+            "sequence": sequence,
+            "file": f"{sequence:06d}.cvdelta",
+            "digest": _file_digest(partial_path),
+            "page_size": page_size,
+            "page_count": stats["page_count"],
+            "changed_pages": stats["changed_pages"],
+            "created_at": int(time.time())
+        }
+        # Delta first, then the manifest that references it: a crash in
+        # between leaves an unreferenced file, overwritten next time
+        os.replace(partial_path, chain_dir / entry["file"])
+        manifest["entries"].append(entry)
+        manifest["page_size"] = page_size
+        manifest["page_hashes"] = bytes(new_hashes)
+        _write_manifest(chain_dir, manifest)
+        
+        progress.done(f"Backup complete ({stats['changed_pages']} of {stats['page_count']} pages)")
+        
+        return entry
+        
+    except BackupIntegrityError:
+        raise
+    except Exception as e:
+        raise BackupError(f"Failed to create incremental backup: {e}")
+    finally:
+        _discard_staging(staging)
+        if partial_path.exists():
+            partial_path.unlink()
+
+
+async def restore_incremental_backup(
+    chain_dir: Path | str,
+    passkey: str,
+    output_path: Path | str,
+    progress_callback: Optional[Callable[[int, str], None]] = None,
+    upto: Optional[int] = None,
+    telemetry_callback: Optional[Callable[[BackupTelemetry], None]] = None
+) -> bool:
+    """
+    Restore a database by replaying base + deltas of the chain in chain_dir.
+    
+    Args:
+        chain_dir: Directory written by create_incremental_backup
+        passkey: Decryption passkey
+        output_path: Path where database will be restored
+        progress_callback: Optional callback(percent, message) for progress updates
+        upto: Last sequence to replay (None = latest)
+        telemetry_callback: Optional callback(BackupTelemetry) (kdf, decrypt, write)
+    
+    Returns:
+        bool: True if restore successful
+    
+    Raises:
+        BackupIntegrityError: If a file is missing, altered or out of order
+        BackupError: If restore fails
+    """
+    if not HAS_NACL:
+        raise BackupCryptoUnavailableError("nacl library not available")
+    
+    chain_dir = Path(chain_dir)
+    output_path = Path(output_path)
+    partial_path = output_path.with_name(f".{output_path.name}.restoring")
+    
+    progress = _Progress(progress_callback, telemetry_callback)
+    try:
+        progress.phase("kdf", 0, "Reading manifest...")
         
-        if progress_callback:
-            progress_callback(75, "Writing database...")
+        manifest = _read_manifest(chain_dir, passkey)
+        if manifest is None or not manifest["entries"]:
+            raise BackupError(f"No backup chain in {chain_dir}")
+        entries: List[Dict[str, Any]] = manifest["entries"]
+        if upto is not None:
+            entries = entries[:upto + 1]
+        key = manifest["key"]
         
-        # Write restored database
-        with open(output_path, 'wb') as f:
-            f.write(plaintext)
+        total_bytes = sum((chain_dir / e["file"]).stat().st_size for e in entries if (chain_dir / e["file"]).exists())
+        progress.phase("decrypt", 5, "Replaying chain...", total_bytes, end=99)
+        done_before = 0
         
-        if progress_callback:
-            progress_callback(100, "Restore complete")
+        with _open_private(partial_path) as out:
+            for sequence, entry in enumerate(entries):
+                path = chain_dir / entry["file"]
+                if not path.exists() or _file_digest(path) != entry["digest"]:
+                    raise BackupIntegrityError(f"Backup chain broken at {entry['file']}")
+                
+                with open(path, 'rb') as f:
+                    header = f.read(_HEADER.size + _DELTA.size)
+                    if len(header) < _HEADER.size + _DELTA.size:
+                        raise BackupIntegrityError(f"Truncated delta header: {entry['file']}")
+                    magic, version, salt, _, _, chunk_size = _HEADER.unpack_from(header)
+                    delta_sequence, page_size, page_count = _DELTA.unpack_from(header, _HEADER.size)
+                    if magic != STREAM_MAGIC or version != DELTA_VERSION or delta_sequence != sequence:
+                        raise BackupIntegrityError(f"Unexpected file in backup chain: {entry['file']}")
+                    
+                    record_size = _PAGE_NO.size + page_size
+                    async for plaintext in _pull_stream(f, header, key, chunk_size):
+                        t_write = time.perf_counter()
+                        for at in range(0, len(plaintext), record_size):
+                            (page_no,) = _PAGE_NO.unpack_from(plaintext, at)
+                            out.seek((page_no - 1) * page_size)
+                            out.write(plaintext[at + _PAGE_NO.size:at + record_size])
+                        progress.add_time("write", time.perf_counter() - t_write)
+                        progress.report(done_before + f.tell(), "Replaying chain")
+                    out.truncate(page_count * page_size)
+                done_before += path.stat().st_size
+            
+            out.flush()
+            os.fsync(out.fileno())
+        
+        os.replace(partial_path, output_path)
+        
+        progress.done(f"Restore complete ({len(entries)} backups replayed)")
         
         return True
         
     except BackupIntegrityError:
         raise
     except Exception as e:
-        raise BackupError(f"Failed to restore backup: {e}")
+        raise BackupError(f"Failed to restore incremental backup: {e}")
+    finally:
+        if partial_path.exists():
+            secure_wipe_file(partial_path)
 
 
 # ------------------------------------------------------------------------------
@@ -222,11 +963,15 @@ def secure_wipe_file(path: Path | str) -> None:
         # Get file size
         file_size = path.stat().st_size
         
-        # Overwrite with random data (3 passes)
+        # Overwrite with random data (3 passes, chunked: multi-GB safe)
         with open(path, 'r+b') as f:
             for _ in range(3):
                 f.seek(0)
-                f.write(os.urandom(file_size))
+                remaining = file_size
+                while remaining > 0:
+                    n = min(remaining, DEFAULT_CHUNK_SIZE)
+                    f.write(os.urandom(n))
+                    remaining -= n
                 f.flush()
                 os.fsync(f.fileno())
         
@@ -5,16 +5,43 @@ Task 6.2 - Sprint 6 Background Services
 SPEC: docs/03_SPECS/SPEC_TASK_6_2_EVENTBUS.md (FROZEN)
 
 Implementation Status: GREEN PHASE DAY 1
+
+Batch subscribers (subscribe(..., batch=True)): the dispatcher buffers
+events per subscription and hands the callback a list once max_batch
+events accumulate or the oldest has waited max_delay_ms - one executor
+submit per batch instead of per event.
+
+Sharded mode (shards > 1): each producer thread is pinned to one shard
+with its own lock, bounded deque and counters, so publishers on No-GIL
+builds never contend on a single queue lock. Order is preserved per
+producer (a thread always publishes into the same shard).
+
+Flow control (overflow="block" / "spool", single-queue only): instead of
+dropping the oldest event when the queue is full, publish() waits up to
+publish_timeout_s for room (then raises EventBusFull), or appends the
+event to an on-disk EventSpool replayed FIFO once the queue drains
+(dict events only; at-least-once across restarts).
+Subscribers can advertise capacity=N (credits): the dispatcher never has
+more than N undelivered events in flight for them, so a slow consumer
+backs up into the bus queue instead of the executor's unbounded backlog.
 """
 
 import collections
+import itertools
 import os
 import threading
 import time
 import uuid
 from concurrent.futures import ThreadPoolExecutor, Future
 from dataclasses import dataclass, field
-from typing import Any, Callable, Dict, List, Optional
+from typing import Any, Callable, Dict, List, Optional, Tuple
+
+from ..utils.histogram import LatencyHistogram
+from .spool import EventSpool
+
+
+class EventBusFull(Exception):
+    """publish() timed out waiting for queue space (overflow="block")."""
 
 
 @dataclass
@@ -28,6 +55,84 @@ class EventEnvelope:
     publish_time: float = field(default_factory=time.time)
 
 
+@dataclass
+class _SpooledEnvelope(EventEnvelope):
+    """Envelope replayed from the spool: commit() spool_offset once delivered."""
+    spool_offset: int = 0
+
+
+class _SpoolAck:
+    """
+    Delivery tracker for one drained chunk holding spooled events.
+    
+    `pending` counts holders (dispatcher, submitted callbacks, batch
+    buffers) still owing a callback for the chunk; the spool offset is
+    committed once it and every older chunk reach 0. Guarded by _queue_lock.
+    """
+    
+    __slots__ = ("offset", "pending")
+    
+    def __init__(self, offset: int):
+        self.offset = offset
+        self.pending = 1  # The dispatcher, until the chunk is fully handed out
+
+
+class _Shard:
+    """
+    One producer shard (sharded mode).
+    
+    Envelopes are stored as (event_id, event) tuples - no dataclass
+    allocation on the hot path. Counters are guarded by the shard lock
+    the producer already holds, and summed in HeavyEventBus.metrics().
+    """
+    
+    __slots__ = ("index", "lock", "queue", "maxlen", "seq", "published", "dropped")
+    
+    def __init__(self, index: int, maxlen: int):
+        self.index = index
+        self.lock = threading.Lock()
+        self.queue: collections.deque = collections.deque(maxlen=maxlen)
+        self.maxlen = maxlen
+        self.seq = 0
+        self.published = 0
+        self.dropped = 0
+
+
+class _BatchSubscription:
+    """
+    Subscriber receiving lists of events (dispatcher-owned buffer).
+    
+    Only the dispatcher thread touches `buffer`/`deadline`.
+    """
+    
+    __slots__ = (
+        "sub_id", "callback", "name", "max_batch", "max_delay_s", "buffer", "deadline",
+        "appended", "submitted", "spool_acks", "closed"
+    )
+    
+    def __init__(
+        self,
+        sub_id: str,
+        callback: Callable,
+        name: str,
+        max_batch: int,
+        max_delay_s: float
+    ):
+        self.sub_id = sub_id
+        self.callback = callback
+        self.name = name
+        self.max_batch = max_batch
+        self.max_delay_s = max_delay_s
+        self.buffer: List[Any] = []
+        self.deadline = 0.0  # monotonic time the oldest buffered event is due
+        # Spool mode: (start, end, ack) over events ever appended, so a
+        # chunk is acked only once every batch holding it has run
+        self.appended = 0
+        self.submitted = 0
+        self.spool_acks: List[Tuple[int, int, _SpoolAck]] = []
+        self.closed = False  # Unsubscribed (guarded by _queue_lock)
+
+
 @dataclass
 class EventBusMetrics:
     """Real-time metrics for EventBus"""
@@ -39,6 +144,11 @@ class EventBusMetrics:
     events_processed: int = 0
     events_dropped: int = 0
     
+    # Flow control (overflow="block"/"spool")
+    events_spooled: int = 0
+    spool_depth: int = 0
+    publish_timeouts: int = 0
+    
     # Queue
     queue_size_current: int = 0
     queue_size_max: int = 10000
@@ -46,8 +156,12 @@ class EventBusMetrics:
     # Subscribers
     subscribers_active: int = 0
     
-    # Performance
+    # Performance (subscriber callback latency, since start)
     avg_processing_time_ms: float = 0.0
+    processing_p50_ms: float = 0.0
+    processing_p95_ms: float = 0.0
+    processing_p99_ms: float = 0.0
+    processing_max_ms: float = 0.0
     
     # System
     uptime_seconds: float = 0.0
@@ -59,17 +173,40 @@ class HeavyEventBus:
     High-performance event bus with backpressure support.
     
     Features:
-    - Bounded queue with drop-oldest backpressure
+    - Bounded queue with drop-oldest backpressure (or blocking/spooling)
+    - Credit-limited subscribers (capacity=N)
     - ThreadPoolExecutor for subscriber dispatch
     - Thread-safe operations for Python 3.14 No-GIL
     - Graceful shutdown with pending event handling
+    - Optional sharded multi-producer queue (lock per shard)
     """
     
+    # Dispatcher drains up to this many envelopes per queue/shard lock acquire
+    DRAIN_CHUNK = 256
+    
+    # Batch subscriber defaults (matches IndexerQueue.DEFAULT_BATCH_SIZE)
+    DEFAULT_MAX_BATCH = 100
+    DEFAULT_MAX_DELAY_MS = 50
+    
+    # Dispatcher idle wait when nothing is buffered
+    IDLE_WAIT_S = 0.1
+    
+    # Overflow policies when the queue is full
+    OVERFLOW_DROP_OLDEST = "drop_oldest"
+    OVERFLOW_BLOCK = "block"
+    OVERFLOW_SPOOL = "spool"
+    
+    DEFAULT_PUBLISH_TIMEOUT_S = 5.0
+    
     def __init__(
         self,
         max_queue_size: int = 200000,  # 200K buffer for 20s of peak load
         max_workers: Optional[int] = None,
-        name: str = "default"
+        name: str = "default",
+        shards: Optional[int] = None,
+        overflow: str = OVERFLOW_DROP_OLDEST,
+        publish_timeout_s: float = DEFAULT_PUBLISH_TIMEOUT_S,
+        spool_path: Optional[str] = None
     ):
         """
         Initialize EventBus.
@@ -78,27 +215,82 @@ class HeavyEventBus:
             max_queue_size: Maximum events in queue (backpressure threshold)
             max_workers: Worker threads in pool (None = auto)
             name: Bus identifier for logging/metrics
+            shards: Producer shards (None/1 = single queue). Capacity is
+                split evenly; drop-oldest applies per shard.
+            overflow: Full-queue policy - "drop_oldest", "block" (publish
+                waits up to publish_timeout_s) or "spool" (spill to
+                spool_path). block/spool require a single queue.
+            publish_timeout_s: Block mode - max wait before EventBusFull
+            spool_path: Spool mode - spool file (resumed if it exists).
+                Events must be JSON dicts: they are replayed as parsed
+                JSON, so dataclasses etc. would come back as plain dicts.
+            
+        Raises:
+            ValueError: Unknown overflow policy, block/spool with shards,
+                or spool without spool_path
         """
+        if overflow not in (self.OVERFLOW_DROP_OLDEST, self.OVERFLOW_BLOCK, self.OVERFLOW_SPOOL):
+            raise ValueError(f"Unknown overflow policy: {overflow}")
+        if overflow != self.OVERFLOW_DROP_OLDEST and (shards or 1) > 1:
+            raise ValueError(f"overflow={overflow!r} requires a single queue (shards=1)")
+        if overflow == self.OVERFLOW_SPOOL and not spool_path:
+            raise ValueError("overflow='spool' requires spool_path")
+        
         self.name = name
         self.max_queue_size = max_queue_size
         self.max_workers = max_workers or (os.cpu_count() or 4) * 2
+        self.shard_count = min(256, max(1, shards or 1))  # shard index = 2 hex digits in IDs
         
         # Queue with backpressure (deque maxlen auto-drops oldest)
         self._queue: collections.deque = collections.deque(maxlen=max_queue_size)
         self._queue_lock = threading.Lock()
         self._queue_not_empty = threading.Condition(self._queue_lock)
+        self._queue_not_full = threading.Condition(self._queue_lock)
+        
+        # Flow control (block/spool: the deque is only filled up to max_queue_size)
+        self.overflow = overflow
+        self.publish_timeout_s = publish_timeout_s
+        self._spool: Optional[EventSpool] = None
+        if overflow == self.OVERFLOW_SPOOL:
+            self._spool = EventSpool(spool_path)
+        self._events_spooled = 0
+        # Drained chunks with spooled events, oldest first, until delivered
+        self._spool_acks: collections.deque = collections.deque()
+        self._publish_timeouts = 0
+        
+        # Sharded mode: per-shard queues, thread → shard pinning
+        self._shards: List[_Shard] = []
+        if self.shard_count > 1:
+            per_shard = -(-max_queue_size // self.shard_count)  # ceil
+            self._shards = [_Shard(i, per_shard) for i in range(self.shard_count)]
+        self._shard_local = threading.local()
+        self._shard_assign = itertools.count()
+        self._shard_assign_lock = threading.Lock()
+        # Dispatcher wakeup: producers only touch the Event while it sleeps
+        self._dispatcher_idle = False
+        self._shards_not_empty = threading.Event()
+        # Monotonic IDs, UUID v4 shaped: random per-bus prefix + shard/seq
+        prefix = uuid.uuid4().hex
+        self._id_prefix = f"{prefix[:8]}-{prefix[8:12]}-4{prefix[13:16]}-{'89ab'[int(prefix[16], 16) & 3]}{prefix[17:20]}"
         
         # Subscribers: {subscription_id: (callback, name)}
         self._subscribers: Dict[str, tuple] = {}
+        # Batch subscribers: {subscription_id: _BatchSubscription}
+        self._batch_subscribers: Dict[str, _BatchSubscription] = {}
         self._subscribers_lock = threading.Lock()
         
+        # Credits: {subscription_id: events the subscriber can still accept}
+        self._credits: Dict[str, int] = {}
+        self._credits_available = threading.Condition()
+        
         # Metrics - thread-safe counters
+        # (published/dropped are guarded by _queue_lock, held by publish anyway)
         self._events_published = 0
         self._events_processed = 0
         self._events_dropped = 0
         self._metrics_lock = threading.Lock()
         self._start_time: Optional[float] = None
-        self._processing_times: List[float] = []
+        self._processing_latency = LatencyHistogram()
         
         # Lifecycle
         self._running = False
@@ -114,8 +306,16 @@ class HeavyEventBus:
             event: Event data (typically FileBatchEvent from Watchdog)
             
         Returns:
-            event_id: UUID v4 string for tracking
+            event_id: UUID v4 string for tracking (sharded mode: UUID v4
+                shaped, monotonic per shard)
+            
+        Raises:
+            EventBusFull: overflow="block" and no room within publish_timeout_s
+            TypeError: overflow="spool" and event is not a dict
         """
+        if self._shards:
+            return self._publish_sharded(event)
+        
         # Generate UUID v4 for tracking
         event_id = str(uuid.uuid4())
         
@@ -133,45 +333,174 @@ class HeavyEventBus:
         )
         
         with self._queue_lock:
-            # Check if we'll trigger backpressure
-            was_full = len(self._queue) >= self.max_queue_size
-            
-            # Append to queue (deque maxlen auto-drops oldest)
-            self._queue.append(envelope)
-            
-            # Track dropped events for backpressure
-            if was_full:
-                with self._metrics_lock:
+            if self.overflow == self.OVERFLOW_DROP_OLDEST:
+                # Check if we'll trigger backpressure
+                was_full = len(self._queue) >= self.max_queue_size
+                
+                # Append to queue (deque maxlen auto-drops oldest)
+                self._queue.append(envelope)
+                
+                # Track dropped events for backpressure
+                if was_full:
                     self._events_dropped += 1
+            elif self.overflow == self.OVERFLOW_BLOCK:
+                self._wait_for_room_locked()
+                self._queue.append(envelope)
+            else:
+                # Replay hands back parsed JSON: only dicts round-trip
+                if not isinstance(event, dict):
+                    raise TypeError(
+                        f"overflow='spool' requires dict events, got {type(event).__name__}"
+                    )
+                self._reopen_spool_locked()
+                # Once spooling, everything goes to the spool until replay
+                # catches up - keeps FIFO order across memory and disk
+                if self._spool.depth or len(self._queue) >= self.max_queue_size:
+                    self._spool.append([event_id, batch_id, envelope.timestamp, event])
+                    self._events_spooled += 1
+                else:
+                    self._queue.append(envelope)
             
             # Update metrics
-            with self._metrics_lock:
-                self._events_published += 1
+            self._events_published += 1
             
             # Signal dispatcher
             self._queue_not_empty.notify()
         
         return event_id
     
+    def _wait_for_room_locked(self) -> None:
+        """Block mode: wait (holding _queue_lock via the Condition) for space."""
+        if len(self._queue) < self.max_queue_size:
+            return
+        
+        deadline = time.monotonic() + self.publish_timeout_s
+        while len(self._queue) >= self.max_queue_size:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                self._publish_timeouts += 1
+                raise EventBusFull(
+                    f"EventBus '{self.name}' full ({self.max_queue_size} events) "
+                    f"for {self.publish_timeout_s}s"
+                )
+            self._queue_not_full.wait(timeout=remaining)
+    
+    def _reopen_spool_locked(self) -> None:
+        """Spool closed by stop(): resume it from the committed offset."""
+        if not self._spool.closed:
+            return
+        self._spool = EventSpool(str(self._spool.path))
+        self._spool_acks.clear()
+        # Envelopes read through the old handle are replayed from disk again
+        kept = [env for env in self._queue if not isinstance(env, _SpooledEnvelope)]
+        self._queue.clear()
+        self._queue.extend(kept)
+    
+    def _replay_spool_locked(self) -> None:
+        """Spool mode: refill the queue from disk once it is half empty."""
+        room = self.max_queue_size - len(self._queue)
+        if not self._spool.depth or room < self.max_queue_size // 2:
+            return
+        
+        try:
+            records = self._spool.pop_many(room)
+        except (OSError, ValueError) as e:
+            print(f"[EVENTBUS] Spool replay error: {type(e).__name__}: {e}")
+            return
+        
+        for end_offset, (event_id, batch_id, timestamp, event) in records:
+            self._queue.append(_SpooledEnvelope(
+                event_id=event_id,
+                batch_id=batch_id,
+                timestamp=timestamp,
+                event=event,
+                spool_offset=end_offset
+            ))
+    
+    def _current_shard(self) -> _Shard:
+        """Shard pinned to the calling thread (assigned round-robin)."""
+        shard = getattr(self._shard_local, "shard", None)
+        if shard is None:
+            with self._shard_assign_lock:
+                index = next(self._shard_assign) % self.shard_count
+            shard = self._shards[index]
+            self._shard_local.shard = shard
+        return shard
+    
+    def _publish_sharded(self, event: Any) -> str:
+        """Sharded publish: one uncontended lock, no UUID/dataclass per event."""
+        shard = self._current_shard()
+        
+        with shard.lock:
+            shard.seq += 1
+            event_id = f"{self._id_prefix}-{shard.index:02x}{shard.seq:010x}"
+            
+            # deque maxlen auto-drops oldest
+            if len(shard.queue) >= shard.maxlen:
+                shard.dropped += 1
+            shard.queue.append((event_id, event))
+            shard.published += 1
+        
+        # Lock release above orders this read after the append, so a
+        # dispatcher that re-checked the shards before going idle sees it
+        if self._dispatcher_idle:
+            self._shards_not_empty.set()
+        
+        return event_id
+    
+    def _queued_count(self) -> int:
+        """Events waiting for dispatch (all shards)."""
+        if not self._shards:
+            with self._queue_lock:
+                return len(self._queue) + (self._spool.depth if self._spool else 0)
+        
+        total = 0
+        for shard in self._shards:
+            with shard.lock:
+                total += len(shard.queue)
+        return total
+    
     def subscribe(
         self,
         callback: Callable[[Any], None],
-        name: str = ""
+        name: str = "",
+        batch: bool = False,
+        max_batch: int = DEFAULT_MAX_BATCH,
+        max_delay_ms: int = DEFAULT_MAX_DELAY_MS,
+        capacity: Optional[int] = None
     ) -> str:
         """
         Subscribe to receive events.
         
         Args:
-            callback: Function to call with each event
+            callback: Function to call with each event (batch=True: with a
+                list of events, in publish order)
             name: Optional subscriber name for debugging
+            batch: Deliver lists of events in one call
+            max_batch: Batch mode - deliver once this many are buffered
+            max_delay_ms: Batch mode - max time an event waits in the buffer
+            capacity: Credits - max events dispatched to this subscriber but
+                not yet handled (None = unlimited). Batch mode counts
+                buffered events too, so capacity should be >= max_batch.
             
         Returns:
             subscription_id: Unique ID for unsubscribe
         """
         subscription_id = str(uuid.uuid4())
+        name = name or callback.__name__
         
         with self._subscribers_lock:
-            self._subscribers[subscription_id] = (callback, name or callback.__name__)
+            if batch:
+                self._batch_subscribers[subscription_id] = _BatchSubscription(
+                    subscription_id, callback, name,
+                    max(1, max_batch), max(0, max_delay_ms) / 1000.0
+                )
+            else:
+                self._subscribers[subscription_id] = (callback, name)
+            
+            if capacity is not None:
+                with self._credits_available:
+                    self._credits[subscription_id] = max(1, capacity)
         
         return subscription_id
     
@@ -185,11 +514,25 @@ class HeavyEventBus:
         Returns:
             True if subscription was found and removed
         """
+        with self._credits_available:
+            self._credits.pop(subscription_id, None)
+            self._credits_available.notify_all()
+        
         with self._subscribers_lock:
             if subscription_id in self._subscribers:
                 del self._subscribers[subscription_id]
                 return True
+            # Batch mode: events still buffered for it are discarded
+            sub = self._batch_subscribers.pop(subscription_id, None)
+        if sub is None:
             return False
+        if self._spool:
+            with self._queue_lock:
+                sub.closed = True
+                for _, _, ack in sub.spool_acks:
+                    self._release_spool_ack_locked(ack)
+                sub.spool_acks = []
+        return True
     
     def metrics(self) -> EventBusMetrics:
         """
@@ -203,26 +546,43 @@ class HeavyEventBus:
             if self._start_time:
                 uptime = time.time() - self._start_time
             
-            avg_time = 0.0
-            if self._processing_times:
-                avg_time = sum(self._processing_times) / len(self._processing_times)
+            latency = self._processing_latency.snapshot()
             
             with self._queue_lock:
                 queue_size = len(self._queue)
+                published = self._events_published
+                dropped = self._events_dropped
+                spooled = self._events_spooled
+                spool_depth = self._spool.depth if self._spool else 0
+                publish_timeouts = self._publish_timeouts
+            
+            # Aggregate per-shard counters
+            for shard in self._shards:
+                with shard.lock:
+                    queue_size += len(shard.queue)
+                    published += shard.published
+                    dropped += shard.dropped
             
             with self._subscribers_lock:
-                sub_count = len(self._subscribers)
+                sub_count = len(self._subscribers) + len(self._batch_subscribers)
             
             return EventBusMetrics(
                 bus_name=self.name,
                 timestamp=time.time(),
-                events_published=self._events_published,
+                events_published=published,
                 events_processed=self._events_processed,
-                events_dropped=self._events_dropped,
+                events_dropped=dropped,
+                events_spooled=spooled,
+                spool_depth=spool_depth,
+                publish_timeouts=publish_timeouts,
                 queue_size_current=queue_size,
                 queue_size_max=self.max_queue_size,
                 subscribers_active=sub_count,
-                avg_processing_time_ms=avg_time * 1000,
+                avg_processing_time_ms=latency["mean_ms"],
+                processing_p50_ms=latency["p50_ms"],
+                processing_p95_ms=latency["p95_ms"],
+                processing_p99_ms=latency["p99_ms"],
+                processing_max_ms=latency["max_ms"],
                 uptime_seconds=uptime,
                 worker_threads_active=self.max_workers if self._executor else 0
             )
@@ -236,6 +596,10 @@ class HeavyEventBus:
         if self._running:
             return
         
+        if self._spool:
+            with self._queue_lock:
+                self._reopen_spool_locked()
+        
         self._running = True
         self._stop_event.clear()
         self._start_time = time.time()
@@ -248,9 +612,9 @@ class HeavyEventBus:
         
         # Start dispatcher thread
         self._dispatcher_thread = threading.Thread(
-            target=self._dispatch_worker,
+            target=self._dispatch_sharded_worker if self._shards else self._dispatch_worker,
             name=f"EventBus-{self.name}-Dispatcher",
-            daemon=False
+            daemon=True  # An unclean exit (no stop()) must not hang the interpreter
         )
         self._dispatcher_thread.start()
     
@@ -269,9 +633,8 @@ class HeavyEventBus:
             # Wait for queue to drain BEFORE stopping dispatcher
             deadline = time.time() + timeout
             while time.time() < deadline:
-                with self._queue_lock:
-                    if len(self._queue) == 0:
-                        break
+                if self._queued_count() == 0:
+                    break
                 time.sleep(0.01)
             
             # Also wait for executor to finish pending tasks
@@ -285,6 +648,10 @@ class HeavyEventBus:
         # Wake up dispatcher if waiting
         with self._queue_lock:
             self._queue_not_empty.notify_all()
+            self._queue_not_full.notify_all()
+        self._shards_not_empty.set()
+        with self._credits_available:
+            self._credits_available.notify_all()
         
         # Stop dispatcher thread
         if self._dispatcher_thread:
@@ -295,6 +662,11 @@ class HeavyEventBus:
         if self._executor:
             self._executor.shutdown(wait=graceful, cancel_futures=not graceful)
             self._executor = None
+        
+        # Undelivered spool records stay on disk for the next start
+        if self._spool:
+            with self._queue_lock:
+                self._spool.close()
     
     @property
     def is_running(self) -> bool:
@@ -303,39 +675,255 @@ class HeavyEventBus:
     
     def _dispatch_worker(self) -> None:
         """Background thread that dispatches events to subscribers"""
+        chunk = self.DRAIN_CHUNK
+        
         while not self._stop_event.is_set():
-            envelope: Optional[EventEnvelope] = None
+            events: List[Any] = []
+            spool_offset: Optional[int] = None
             
-            # Wait for event
+            # Credit-limited subscribers full: leave events queued (backpressure)
+            allowance = self._credit_allowance(chunk)
+            if allowance == 0:
+                self._wait_for_credits()
+                self._flush_due_batches(time.monotonic())
+                continue
+            
+            # Wait for event (or the next batch deadline)
             with self._queue_not_empty:
+                if self._spool:
+                    self._replay_spool_locked()
+                
                 while len(self._queue) == 0 and not self._stop_event.is_set():
-                    self._queue_not_empty.wait(timeout=0.1)
+                    wait = self._next_batch_wait()
+                    if wait <= 0:
+                        break
+                    self._queue_not_empty.wait(timeout=wait)
                 
                 if self._stop_event.is_set() and len(self._queue) == 0:
                     break
                 
-                if len(self._queue) > 0:
+                for _ in range(min(len(self._queue), allowance)):
                     envelope = self._queue.popleft()
+                    events.append(envelope.event)
+                    if type(envelope) is _SpooledEnvelope:
+                        spool_offset = envelope.spool_offset
+                
+                if events and self.overflow == self.OVERFLOW_BLOCK:
+                    self._queue_not_full.notify_all()
             
-            if envelope is None:
-                continue
+            ack = None
+            if spool_offset is not None:
+                ack = _SpoolAck(spool_offset)
+                with self._queue_lock:
+                    self._spool_acks.append(ack)
+            if events:
+                self._dispatch_events(events, ack)
+            if ack is not None:
+                # Handed out: committed once the last callback holding it finishes
+                self._release_spool_ack(ack)
+            self._flush_due_batches(time.monotonic())
+        
+        self._flush_due_batches(None)
+    
+    def _dispatch_sharded_worker(self) -> None:
+        """Sharded-mode dispatcher: drains shards round-robin in chunks."""
+        chunk = self.DRAIN_CHUNK
+        
+        while True:
+            drained = 0
+            allowance = chunk
+            for shard in self._shards:
+                allowance = self._credit_allowance(chunk)
+                if allowance == 0:
+                    break
+                with shard.lock:
+                    queue = shard.queue
+                    take = min(len(queue), allowance)
+                    items = [queue.popleft() for _ in range(take)]
+                if items:
+                    self._dispatch_events([event for _, event in items])
+                drained += take
             
-            # Dispatch to all subscribers via thread pool
-            with self._subscribers_lock:
-                subscribers_copy = list(self._subscribers.items())
+            self._flush_due_batches(time.monotonic())
             
-            for sub_id, (callback, name) in subscribers_copy:
-                if self._executor:
+            if drained:
+                continue
+            if self._stop_event.is_set():
+                break
+            if allowance == 0:
+                self._wait_for_credits()
+                continue
+            
+            # Idle: publish a flag, re-check, then sleep until a producer sets the Event
+            self._shards_not_empty.clear()
+            self._dispatcher_idle = True
+            if self._queued_count() == 0 and not self._stop_event.is_set():
+                wait = self._next_batch_wait()
+                if wait > 0:
+                    self._shards_not_empty.wait(timeout=wait)
+            self._dispatcher_idle = False
+        
+        self._flush_due_batches(None)
+    
+    def _dispatch_events(self, events: List[Any], ack: Optional[_SpoolAck] = None) -> None:
+        """
+        Dispatch drained events: per-event submits + batch buffering.
+        
+        ack (spool mode): held by every callback that will see these events.
+        """
+        with self._subscribers_lock:
+            subscribers_copy = list(self._subscribers.items())
+            batch_subscribers = list(self._batch_subscribers.values())
+        
+        limited = self._charge_credits(
+            [sub_id for sub_id, _ in subscribers_copy] +
+            [sub.sub_id for sub in batch_subscribers],
+            len(events)
+        )
+        
+        if ack is not None and self._executor:
+            with self._queue_lock:
+                ack.pending += len(subscribers_copy) * len(events)
+                for sub in batch_subscribers:
+                    if not sub.closed:
+                        sub.spool_acks.append((sub.appended, sub.appended + len(events), ack))
+                        ack.pending += 1
+        
+        for sub_id, (callback, name) in subscribers_copy:
+            if self._executor:
+                credit_id = sub_id if sub_id in limited else None
+                for event in events:
                     self._executor.submit(
                         self._safe_execute_callback,
                         callback,
-                        envelope.event
+                        event,
+                        credit_id,
+                        ack
                     )
+        
+        if not batch_subscribers:
+            return
+        
+        now = time.monotonic()
+        for sub in batch_subscribers:
+            if not sub.buffer:
+                sub.deadline = now + sub.max_delay_s
+            sub.buffer.extend(events)
+            sub.appended += len(events)
+            while len(sub.buffer) >= sub.max_batch:
+                ready = sub.buffer[:sub.max_batch]
+                del sub.buffer[:sub.max_batch]
+                self._submit_batch(sub, ready)
+                sub.deadline = now + sub.max_delay_s
+    
+    def _submit_batch(self, sub: _BatchSubscription, events: List[Any]) -> None:
+        if not self._executor:
+            return
+        start = sub.submitted
+        sub.submitted += len(events)
+        acks = None
+        if sub.spool_acks:
+            acks = self._take_batch_acks(sub, start, sub.submitted)
+        self._executor.submit(
+            self._safe_execute_batch_callback, sub.callback, events, sub.sub_id, acks
+        )
+    
+    # -------------------------------------------------------------------------
+    # Spool acks (overflow="spool": commit offsets after delivery)
+    # -------------------------------------------------------------------------
+    
+    def _take_batch_acks(self, sub: _BatchSubscription, start: int, end: int) -> List[_SpoolAck]:
+        """Acks of chunks overlapping events [start, end) of sub: held by the batch."""
+        with self._queue_lock:
+            acks = []
+            kept = []
+            for entry in sub.spool_acks:
+                chunk_start, chunk_end, ack = entry
+                if chunk_start < end:
+                    ack.pending += 1
+                    acks.append(ack)
+                if chunk_end <= end:
+                    self._release_spool_ack_locked(ack)  # Fully out of the buffer
+                else:
+                    kept.append(entry)
+            sub.spool_acks = kept
+            return acks
+    
+    def _release_spool_ack(self, ack: _SpoolAck) -> None:
+        with self._queue_lock:
+            self._release_spool_ack_locked(ack)
+    
+    def _release_spool_ack_locked(self, ack: _SpoolAck) -> None:
+        """Drop one hold; commit the offset of every delivered chunk prefix."""
+        ack.pending -= 1
+        offset = None
+        acks = self._spool_acks
+        while acks and acks[0].pending == 0:
+            offset = acks.popleft().offset
+        if offset is not None and not self._spool.closed:
+            self._spool.commit(offset)
+    
+    def _flush_due_batches(self, now: Optional[float]) -> None:
+        """Deliver batch buffers past their deadline (now=None: flush all)."""
+        with self._subscribers_lock:
+            batch_subscribers = list(self._batch_subscribers.values())
+        
+        for sub in batch_subscribers:
+            if sub.buffer and (now is None or now >= sub.deadline):
+                ready, sub.buffer = sub.buffer, []
+                self._submit_batch(sub, ready)
+    
+    def _next_batch_wait(self) -> float:
+        """Seconds until the earliest batch deadline (IDLE_WAIT_S if none)."""
+        with self._subscribers_lock:
+            deadlines = [
+                sub.deadline for sub in self._batch_subscribers.values() if sub.buffer
+            ]
+        if not deadlines:
+            return self.IDLE_WAIT_S
+        return min(self.IDLE_WAIT_S, min(deadlines) - time.monotonic())
+    
+    # -------------------------------------------------------------------------
+    # Credits (subscribe(..., capacity=N))
+    # -------------------------------------------------------------------------
+    
+    def _credit_allowance(self, limit: int) -> int:
+        """Events the dispatcher may hand out now (capped by the lowest credit)."""
+        with self._credits_available:
+            if not self._credits:
+                return limit
+            return max(0, min(limit, min(self._credits.values())))
+    
+    def _wait_for_credits(self) -> None:
+        """Sleep until a credit is returned (or the next batch deadline)."""
+        wait = max(0.0, self._next_batch_wait())
+        with self._credits_available:
+            if self._stop_event.is_set() or min(self._credits.values(), default=1) > 0:
+                return
+            self._credits_available.wait(timeout=wait)
+    
+    def _charge_credits(self, sub_ids: List[str], count: int) -> set:
+        """Take `count` credits from each limited subscriber; returns their IDs."""
+        with self._credits_available:
+            if not self._credits:
+                return set()
+            limited = {sub_id for sub_id in sub_ids if sub_id in self._credits}
+            for sub_id in limited:
+                self._credits[sub_id] -= count
+            return limited
+    
+    def _release_credits(self, sub_id: str, count: int) -> None:
+        with self._credits_available:
+            if sub_id in self._credits:
+                self._credits[sub_id] += count
+                self._credits_available.notify_all()
     
     def _safe_execute_callback(
         self,
         callback: Callable,
-        event: Any
+        event: Any,
+        credit_id: Optional[str] = None,
+        ack: Optional[_SpoolAck] = None
     ) -> None:
         """Execute callback with exception isolation"""
         start_time = time.time()
@@ -351,7 +939,37 @@ class HeavyEventBus:
             
             with self._metrics_lock:
                 self._events_processed += 1
-                # Keep rolling average (last 100)
-                self._processing_times.append(processing_time)
-                if len(self._processing_times) > 100:
-                    self._processing_times.pop(0)
+            self._processing_latency.record_ms(processing_time * 1000)
+            
+            if credit_id is not None:
+                self._release_credits(credit_id, 1)
+            if ack is not None:
+                self._release_spool_ack(ack)
+    
+    def _safe_execute_batch_callback(
+        self,
+        callback: Callable,
+        events: List[Any],
+        credit_id: Optional[str] = None,
+        acks: Optional[List[_SpoolAck]] = None
+    ) -> None:
+        """Execute batch callback with exception isolation"""
+        start_time = time.time()
+        
+        try:
+            callback(events)
+        except Exception as e:
+            print(f"[EVENTBUS] Batch subscriber error: {type(e).__name__}: {e}")
+        finally:
+            processing_time = time.time() - start_time
+            
+            with self._metrics_lock:
+                self._events_processed += len(events)
+            self._processing_latency.record_ms(processing_time * 1000)
+            
+            if credit_id is not None:
+                self._release_credits(credit_id, len(events))
+            if acks:
+                with self._queue_lock:
+                    for ack in acks:
+                        self._release_spool_ack_locked(ack)
@@ -0,0 +1,382 @@
+"""
+FTS_ENGINE.PY - Ranked Full-Text Search over the Encrypted Index
+Task 7.1 - Sprint 7 Search UI (SPEC_TASK_7_1_SEARCH_UI.md)
+
+Query path for the document_content FTS5 index written by
+indexer/fts_writer.py (rowid = document_segments.id, joined to documents):
+
+- parse_query(): as-you-type input → FTS5 MATCH expression. "quoted
+  phrases", explicit prefix*, and the word being typed becomes a prefix
+  query. Every term is quoted, so FTS5 operators and SQL in the input are
+  plain text.
+- bm25 ranking (FTS5 `rank`), snippet() with <mark> highlighting; the
+  snippet text is HTML-escaped, only the <mark> tags are markup
+- Keyset pagination: the cursor is the (rank, rowid) of the last hit, so
+  page N costs the same as page 1 and never skips/duplicates on ties
+- LRU of recent (query, filter, cursor, limit) → result page, keyed on
+  the writer's commit_seq (+ PRAGMA data_version for commits from other
+  connections): any commit invalidates every cached page
+
+The SQL text is constant (parameters only), so sqlite3's per-connection
+statement cache keeps each query prepared across keystrokes.
+
+Single-reader: call from the thread owning `db` - a connection of its own
+(WAL: reads never wait for the indexer's commits), not the writer's.
+Cached pages hold decrypted snippets: clear_cache() on vault lock.
+"""
+
+import base64
+import html
+import re
+import struct
+import threading
+import time
+from collections import OrderedDict
+from dataclasses import asdict, dataclass, replace
+from typing import Any, Dict, List, Optional, Tuple
+
+from ...indexer.encrypted_storage import EncryptedIndexerDB
+from ...indexer.fts_writer import FTSBatchWriter
+from ...utils.histogram import LatencyHistogram
+
+MARK_OPEN = "<mark>"
+MARK_CLOSE = "</mark>"
+ELLIPSIS = "…"
+SNIPPET_TOKENS = 16
+
+# Highlight sentinels: snippet() emits these, escaping runs, then they
+# become <mark> tags (user text can never inject markup)
+_HL_OPEN = "\x02"
+_HL_CLOSE = "\x03"
+
+# A 1-letter prefix matches most of a 100K-document vocabulary
+MIN_PREFIX_CHARS = 2
+MAX_TERMS = 16
+
+DEFAULT_LIMIT = 20
+MAX_LIMIT = 100
+DEFAULT_CACHE_SIZE = 256
+
+# file_type filter → filename suffix (LIKE pattern)
+FILE_TYPES = {"pdf": "%.pdf", "docx": "%.docx"}
+
+# Quoted phrase (closing quote optional while typing) or bare token
+_TOKEN = re.compile(r'"([^"]*)("?)|(\S+)')
+_WORD = re.compile(r"\w+")
+
+_CURSOR = struct.Struct("<dqq")  # rank, rowid, total
+
+_SEARCH_SQL = """
+SELECT s.id, d.id, d.path, d.filename, s.page, d.created_at, c.rank,
+       snippet(document_content, 0, ?6, ?7, ?8, ?9)
+FROM document_content c
+JOIN document_segments s ON s.id = c.rowid
+JOIN documents d ON d.id = s.doc_id
+WHERE document_content MATCH ?1
+  AND (?2 IS NULL OR d.filename LIKE ?2)
+  AND (?3 IS NULL OR (c.rank, c.rowid) > (?3, ?4))
+ORDER BY c.rank, c.rowid
+LIMIT ?5
+"""
+
+# Unfiltered count stays inside the FTS index: the writer keeps
+# document_content and document_segments in step, so the joins only
+# matter when filtering by filename
+_COUNT_ALL_SQL = """
+SELECT count(*) FROM document_content WHERE document_content MATCH ?1
+"""
+
+_COUNT_SQL = """
+SELECT count(*)
+FROM document_content c
+JOIN document_segments s ON s.id = c.rowid
+JOIN documents d ON d.id = s.doc_id
+WHERE document_content MATCH ?1
+  AND d.filename LIKE ?2
+"""
+
+
+def _quote(words: List[str]) -> str:
+    return '"' + " ".join(words) + '"'
+
+
+def parse_query(text: str) -> str:
+    """
+    User input → FTS5 MATCH expression ("" = nothing searchable).
+
+    - bare words are ANDed: `vault backup` → "vault" "backup"
+    - "quoted phrase" → adjacent words, in order
+    - `word*` → prefix; the last word is a prefix too while it is being
+      typed (input not ending in whitespace), if >= MIN_PREFIX_CHARS
+    - punctuation splits words the way the unicode61 tokenizer does
+      (`e-mail` → phrase "e mail")
+    """
+    tokens = list(_TOKEN.finditer(text or ""))[:MAX_TERMS]
+    typing = bool(text) and not text[-1].isspace()
+
+    terms = []
+    for n, token in enumerate(tokens):
+        phrase, closed, bare = token.group(1), token.group(2), token.group(3)
+        words = _WORD.findall((phrase if bare is None else bare).lower())
+        if not words:
+            continue
+
+        last = n == len(tokens) - 1
+        if bare is not None:
+            prefix = bare.endswith("*") or (last and typing)
+        else:
+            prefix = last and typing and not closed  # still inside the quotes
+        if prefix and len(words[-1]) < MIN_PREFIX_CHARS:
+            prefix = False
+        terms.append(_quote(words) + ("*" if prefix else ""))
+    return " ".join(terms)
+
+
+def _render_snippet(raw: str) -> str:
+    escaped = html.escape(raw or "", quote=False)
+    return escaped.replace(_HL_OPEN, MARK_OPEN).replace(_HL_CLOSE, MARK_CLOSE)
+
+
+def _file_type(filename: str) -> str:
+    return filename.rsplit(".", 1)[-1].lower() if "." in filename else ""
+
+
+def encode_cursor(rank: float, rowid: int, total: int) -> str:
+    return base64.urlsafe_b64encode(_CURSOR.pack(rank, rowid, total)).decode("ascii")
+
+
+def decode_cursor(cursor: str) -> Tuple[float, int, int]:
+    """
+    Raises:
+        ValueError: Not a cursor returned by search()
+    """
+    try:
+        return _CURSOR.unpack(base64.urlsafe_b64decode(cursor.encode("ascii")))
+    except (struct.error, ValueError, UnicodeError):
+        raise ValueError("Invalid search cursor") from None
+
+
+@dataclass(frozen=True)
+class SearchHit:
+    """One matching segment (page / paragraph) of a document."""
+    file_id: int
+    file_path: str
+    file_name: str
+    file_type: str          # "pdf" | "docx" | ...
+    page: Optional[int]
+    segment_id: int
+    snippet: str            # HTML: escaped text + <mark> tags
+    rank: float             # bm25, lower = more relevant
+    modified_at: str        # documents.created_at (last indexed)
+
+
+@dataclass(frozen=True)
+class SearchPage:
+    """search() result (SearchResponse of the spec + pagination)."""
+    query: str
+    results: List[SearchHit]
+    total: int
+    next_cursor: Optional[str]
+    query_time_ms: float
+    cached: bool = False
+
+    def to_dict(self) -> Dict[str, Any]:
+        return asdict(self)
+
+
+class FTSSearchEngine:
+    """
+    Ranked, paginated search with a hot-result cache.
+
+    Usage:
+        engine = FTSSearchEngine(reader_db, writer=pipeline.fts_writer)
+        page = engine.search("vault backu")
+        more = engine.search("vault backu", cursor=page.next_cursor)
+    """
+
+    def __init__(
+        self,
+        db: EncryptedIndexerDB,
+        writer: Optional[FTSBatchWriter] = None,
+        cache_size: int = DEFAULT_CACHE_SIZE,
+        snippet_tokens: int = SNIPPET_TOKENS
+    ):
+        """
+        Args:
+            db: Read connection to the index (schema from FTSBatchWriter)
+            writer: The index's writer - its commit_seq invalidates the
+                cache (None: PRAGMA data_version only)
+            cache_size: Result pages kept (0 = no cache)
+            snippet_tokens: Max tokens per snippet
+        """
+        self.db = db
+        self.writer = writer
+        self.cache_size = max(0, cache_size)
+        self.snippet_tokens = max(1, min(64, snippet_tokens))  # FTS5 limit: 64
+
+        # (match, file_type, cursor, limit) → SearchPage, all computed at
+        # index _cache_generation
+        self._cache: "OrderedDict[tuple, SearchPage]" = OrderedDict()
+        self._cache_generation: Optional[tuple] = None
+        self._cache_lock = threading.Lock()
+
+        # Metrics
+        self.searches = 0
+        self.cache_hits = 0
+        self.cache_misses = 0
+        self.cache_invalidations = 0
+        self.latency = LatencyHistogram()
+
+    # -------------------------------------------------------------------
+    # SEARCH
+    # -------------------------------------------------------------------
+
+    def search(
+        self,
+        query: str,
+        limit: int = DEFAULT_LIMIT,
+        cursor: Optional[str] = None,
+        file_type: Optional[str] = None
+    ) -> SearchPage:
+        """
+        One page of hits, best first.
+
+        Args:
+            query: Raw user input (see parse_query)
+            limit: Hits per page (1..MAX_LIMIT)
+            cursor: next_cursor of the previous page
+            file_type: "pdf" | "docx" | "all"/None
+
+        Raises:
+            ValueError: Invalid cursor or unknown file_type
+        """
+        start = time.perf_counter()
+        match = parse_query(query)
+        limit = max(1, min(MAX_LIMIT, limit))
+        if file_type in (None, "", "all"):
+            pattern = None
+        elif file_type in FILE_TYPES:
+            pattern = FILE_TYPES[file_type]
+        else:
+            raise ValueError(f"Unknown file_type: {file_type}")
+        after = decode_cursor(cursor) if cursor else None
+
+        self.searches += 1
+        if not match:
+            return self._timed(SearchPage(query, [], 0, None, 0.0), start)
+
+        key = (match, pattern, cursor, limit)
+        generation = self._generation()
+        page = self._cache_get(key, generation)
+        if page is not None:
+            return self._timed(replace(page, query=query, cached=True), start)
+
+        page = self._run(query, match, pattern, after, limit)
+        self._cache_put(key, generation, page)
+        return self._timed(page, start)
+
+    def _run(
+        self,
+        query: str,
+        match: str,
+        pattern: Optional[str],
+        after: Optional[Tuple[float, int, int]],
+        limit: int
+    ) -> SearchPage:
+        if after is None:
+            if pattern is None:
+                total = self.db.execute(_COUNT_ALL_SQL, (match,)).fetchone()[0]
+            else:
+                total = self.db.execute(_COUNT_SQL, (match, pattern)).fetchone()[0]
+            after_rank = after_rowid = None
+        else:
+            after_rank, after_rowid, total = after
+
+        # One extra row tells whether there is a next page
+        rows = self.db.execute(
+            _SEARCH_SQL,
+            (match, pattern, after_rank, after_rowid, limit + 1,
+             _HL_OPEN, _HL_CLOSE, ELLIPSIS, self.snippet_tokens)
+        ).fetchall()
+
+        hits = [
+            SearchHit(
+                file_id=doc_id,
+                file_path=path,
+                file_name=filename,
+                file_type=_file_type(filename),
+                page=page,
+                segment_id=seg_id,
+                snippet=_render_snippet(snippet),
+                rank=rank,
+                modified_at=created_at,
+            )
+            for seg_id, doc_id, path, filename, page, created_at, rank, snippet in rows[:limit]
+        ]
+        next_cursor = None
+        if len(rows) > limit:
+            last = hits[-1]
+            next_cursor = encode_cursor(last.rank, last.segment_id, total)
+        return SearchPage(query, hits, total, next_cursor, 0.0)
+
+    def _timed(self, page: SearchPage, start: float) -> SearchPage:
+        elapsed_ms = (time.perf_counter() - start) * 1000
+        self.latency.record_ms(elapsed_ms)
+        return replace(page, query_time_ms=elapsed_ms)
+
+    # -------------------------------------------------------------------
+    # CACHE
+    # -------------------------------------------------------------------
+
+    def _generation(self) -> tuple:
+        """Changes whenever committed index content may have."""
+        seq = self.writer.commit_seq if self.writer is not None else 0
+        data_version = self.db.execute("PRAGMA data_version").fetchone()[0]
+        return (seq, data_version)
+
+    def _cache_get(self, key: tuple, generation: tuple) -> Optional[SearchPage]:
+        if not self.cache_size:
+            return None
+        with self._cache_lock:
+            if generation != self._cache_generation:
+                # Index changed: every cached page is stale
+                if self._cache:
+                    self._cache.clear()
+                    self.cache_invalidations += 1
+                self._cache_generation = generation
+            page = self._cache.get(key)
+            if page is None:
+                self.cache_misses += 1
+                return None
+            self._cache.move_to_end(key)
+            self.cache_hits += 1
+            return page
+
+    def _cache_put(self, key: tuple, generation: tuple, page: SearchPage) -> None:
+        if not self.cache_size:
+            return
+        with self._cache_lock:
+            if generation != self._cache_generation:
+                return  # Invalidated while this query ran
+            self._cache[key] = page
+            self._cache.move_to_end(key)
+            while len(self._cache) > self.cache_size:
+                self._cache.popitem(last=False)
+
+    def clear_cache(self) -> None:
+        """Drop every cached page (vault lock)."""
+        with self._cache_lock:
+            self._cache.clear()
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Metrics (register_metrics_source("search", engine.get_stats))."""
+        with self._cache_lock:
+            cached_pages = len(self._cache)
+        return {
+            "searches": self.searches,
+            "cache_hits": self.cache_hits,
+            "cache_misses": self.cache_misses,
+            "cache_invalidations": self.cache_invalidations,
+            "cached_pages": cached_pages,
+            "latency": self.latency.snapshot(),
+        }
@@ -0,0 +1,429 @@
+"""
+ReconciliationScanner - Startup Crawl for WatchdogService
+Sprint 6 Background Services
+
+WatchdogService only sees changes made while it runs. On start, the
+scanner walks watch_path and diffs every file's (size, mtime_ns) against
+the snapshot of the previous scan, then emits synthetic FileEvent batches
+(created / modified / deleted) through the same on_batch_ready callback.
+
+Features:
+- Parallel os.scandir: a thread pool lists and stats directories
+  (both release the GIL); the scanning thread owns all SQLite writes
+- Snapshot keyed by (dir, name): one indexed lookup per directory, and
+  unchanged files cost no write at all
+- Resumable cursor: the directory frontier is persisted and committed
+  together with the batches it produced, so an interrupted scan (stop(),
+  crash) continues where the last delivered batch left off
+- Throttled: at most max_events_per_second, batches of batch_size, so a
+  1M-file first crawl cannot flood HeavyEventBus
+
+Delivery is at-least-once: a batch delivered just before a crash is
+emitted again on resume, and files changed while the watcher was live are
+re-reported on the next start (the snapshot only moves with scans).
+Downstream EventIdempotency (path + mtime + size) drops both cheaply.
+
+Symlinks are not followed (no cycles, no escaping watch_path).
+"""
+
+import os
+import sqlite3
+import threading
+import time
+from collections import deque
+from concurrent.futures import FIRST_COMPLETED, Future, ThreadPoolExecutor, wait
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Callable, Dict, List, Optional, Set, Tuple
+
+from .watchdog import FileEvent
+
+_SNAPSHOT_DDL = """
+CREATE TABLE IF NOT EXISTS watch_snapshot (
+    dir TEXT NOT NULL,
+    name TEXT NOT NULL,
+    size INTEGER NOT NULL,
+    mtime_ns INTEGER NOT NULL,
+    PRIMARY KEY (dir, name)
+) WITHOUT ROWID
+"""
+
+# Frontier of the scan in progress: done=0 queued, done=1 listed,
+# done=2 unreadable (its whole subtree keeps its snapshot rows)
+_SCAN_DIRS_DDL = """
+CREATE TABLE IF NOT EXISTS watch_scan_dirs (
+    dir TEXT PRIMARY KEY,
+    done INTEGER NOT NULL DEFAULT 0
+) WITHOUT ROWID
+"""
+
+_SCAN_STATE_DDL = """
+CREATE TABLE IF NOT EXISTS watch_scan_state (
+    id INTEGER PRIMARY KEY CHECK (id = 1),
+    scan_id INTEGER NOT NULL,
+    started_at REAL NOT NULL,
+    completed_at REAL
+)
+"""
+
+# (dir, files [(name, size, mtime_ns)] or None if unreadable, subdirs)
+_Listing = Tuple[str, Optional[List[Tuple[str, int, int]]], List[str]]
+
+
+def _list_dir(root: str, rel: str) -> _Listing:
+    """Worker task: list one directory (relative to root) and stat its files."""
+    files: List[Tuple[str, int, int]] = []
+    subdirs: List[str] = []
+    try:
+        with os.scandir(os.path.join(root, rel) if rel else root) as entries:
+            for entry in entries:
+                try:
+                    if entry.is_dir(follow_symlinks=False):
+                        subdirs.append(f"{rel}/{entry.name}" if rel else entry.name)
+                    elif entry.is_file(follow_symlinks=False):
+                        st = entry.stat(follow_symlinks=False)
+                        files.append((entry.name, st.st_size, st.st_mtime_ns))
+                except OSError:
+                    continue  # Vanished between listing and stat
+    except OSError as e:
+        print(f"⚠️ [RECONCILER] Cannot list '{rel or '.'}': {e}")
+        return rel, None, []
+    return rel, files, subdirs
+
+
+@dataclass
+class ScanStats:
+    """Outcome of one ReconciliationScanner.run()."""
+    scan_id: int = 0
+    resumed: bool = False
+    completed: bool = False
+    dirs_scanned: int = 0
+    files_seen: int = 0
+    created: int = 0
+    modified: int = 0
+    deleted: int = 0
+    batches: int = 0
+    duration_s: float = 0.0
+
+
+class ReconciliationScanner:
+    """
+    Snapshot diff of watch_path against the last completed scan.
+
+    Usage:
+        scanner = ReconciliationScanner(watch_path, "data/watch_snapshot.db")
+        stats = scanner.run(on_batch_ready)   # blocking
+        # or: WatchdogService(watch_path, ..., reconciler=scanner)
+    """
+
+    DEFAULT_BATCH_SIZE = 1000
+    DEFAULT_MAX_EVENTS_PER_SECOND = 20_000
+    CHECKPOINT_DIRS = 500  # Commit the cursor at least this often, even with no changes
+
+    def __init__(
+        self,
+        watch_path: str,
+        db_path: str = "data/watch_snapshot.db",
+        workers: Optional[int] = None,
+        batch_size: int = DEFAULT_BATCH_SIZE,
+        max_events_per_second: Optional[float] = DEFAULT_MAX_EVENTS_PER_SECOND
+    ):
+        """
+        Args:
+            watch_path: Directory to reconcile (same as WatchdogService's)
+            db_path: SQLite snapshot + cursor (excluded from the scan if it
+                lives inside watch_path)
+            workers: scandir threads (default: 2 x cpu_count, 4..16)
+            batch_size: Events per emitted batch
+            max_events_per_second: Emission rate limit (None = unthrottled)
+        """
+        self.watch_path = Path(watch_path).as_posix().rstrip("/")
+        self.db_path = db_path
+        self.workers = workers or max(4, min(16, (os.cpu_count() or 2) * 2))
+        self.batch_size = batch_size
+        self.max_events_per_second = max_events_per_second
+
+        self._conn: Optional[sqlite3.Connection] = None
+        self._run_lock = threading.Lock()
+        self._excluded = self._db_files_in_tree()
+        self.stats = ScanStats()
+
+        # Per-run state
+        self._buffer: List[FileEvent] = []
+        self._dirs_since_checkpoint = 0
+        self._next_emit = 0.0
+
+    def _db_files_in_tree(self) -> Set[Tuple[str, str]]:
+        """(dir, name) of the snapshot DB and its WAL/SHM files, if inside watch_path."""
+        try:
+            rel = Path(os.path.abspath(self.db_path)).relative_to(os.path.abspath(self.watch_path))
+        except ValueError:
+            return set()
+        rel_dir = rel.parent.as_posix()
+        rel_dir = "" if rel_dir == "." else rel_dir
+        return {(rel_dir, rel.name + suffix) for suffix in ("", "-wal", "-shm", "-journal")}
+
+    # -------------------------------------------------------------------
+    # SQLITE
+    # -------------------------------------------------------------------
+
+    def _connect(self) -> sqlite3.Connection:
+        if self._conn is None:
+            db_dir = os.path.dirname(self.db_path)
+            if db_dir:
+                os.makedirs(db_dir, exist_ok=True)
+            conn = sqlite3.connect(self.db_path, check_same_thread=False)
+            conn.execute("PRAGMA journal_mode=WAL")
+            conn.execute("PRAGMA synchronous=NORMAL")
+            conn.execute(_SNAPSHOT_DDL)
+            conn.execute(_SCAN_DIRS_DDL)
+            conn.execute(_SCAN_STATE_DDL)
+            conn.commit()
+            self._conn = conn
+        return self._conn
+
+    def _begin_scan(self) -> Tuple[deque, bool]:
+        """Resume the interrupted scan or start a new one -> (frontier, resumed)."""
+        conn = self._connect()
+        row = conn.execute(
+            "SELECT scan_id, completed_at FROM watch_scan_state WHERE id = 1"
+        ).fetchone()
+
+        if row is not None and row[1] is None:
+            self.stats.scan_id = row[0]
+            pending = conn.execute("SELECT dir FROM watch_scan_dirs WHERE done = 0").fetchall()
+            return deque(d for (d,) in pending), True
+
+        self.stats.scan_id = (row[0] if row else 0) + 1
+        conn.execute("DELETE FROM watch_scan_dirs")
+        conn.execute("INSERT INTO watch_scan_dirs (dir) VALUES ('')")
+        conn.execute(
+            "INSERT OR REPLACE INTO watch_scan_state (id, scan_id, started_at, completed_at) "
+            "VALUES (1, ?, ?, NULL)",
+            (self.stats.scan_id, time.time())
+        )
+        conn.commit()
+        return deque([""]), False
+
+    def _finish_scan(self) -> None:
+        conn = self._connect()
+        conn.execute("UPDATE watch_scan_state SET completed_at = ? WHERE id = 1", (time.time(),))
+        conn.execute("DELETE FROM watch_scan_dirs")
+        conn.commit()
+
+    # -------------------------------------------------------------------
+    # SCAN
+    # -------------------------------------------------------------------
+
+    def run(
+        self,
+        on_batch_ready: Optional[Callable[[List[FileEvent]], None]],
+        stop_event: Optional[threading.Event] = None
+    ) -> ScanStats:
+        """
+        Reconcile the tree (blocking; one run at a time).
+
+        Args:
+            on_batch_ready: Receives synthetic FileEvent batches
+            stop_event: Set to interrupt; undelivered work is rolled back
+                and picked up by the next run()
+
+        Returns:
+            ScanStats of this run (also kept in self.stats)
+        """
+        stop_event = stop_event or threading.Event()
+        with self._run_lock:
+            start_time = time.perf_counter()
+            self.stats = ScanStats()
+            self._buffer = []
+            self._dirs_since_checkpoint = 0
+            self._next_emit = time.monotonic()
+
+            frontier, self.stats.resumed = self._begin_scan()
+            try:
+                if self._crawl(frontier, on_batch_ready, stop_event) \
+                        and self._sweep_vanished_dirs(on_batch_ready, stop_event) \
+                        and self._checkpoint(on_batch_ready, stop_event, force=True):
+                    self._finish_scan()
+                    self.stats.completed = True
+            finally:
+                if not self.stats.completed:
+                    self._connect().rollback()
+                self._buffer = []
+                self.stats.duration_s = time.perf_counter() - start_time
+        return self.stats
+
+    def _crawl(
+        self,
+        frontier: deque,
+        on_batch_ready: Optional[Callable[[List[FileEvent]], None]],
+        stop_event: threading.Event
+    ) -> bool:
+        """List directories in parallel until the frontier is empty (False = stopped)."""
+        max_in_flight = self.workers * 4
+        in_flight: Dict[Future, str] = {}
+        pool = ThreadPoolExecutor(max_workers=self.workers, thread_name_prefix="Reconcile")
+        try:
+            while frontier or in_flight:
+                if stop_event.is_set():
+                    return False
+                while frontier and len(in_flight) < max_in_flight:
+                    rel = frontier.popleft()
+                    in_flight[pool.submit(_list_dir, self.watch_path, rel)] = rel
+
+                done, _ = wait(in_flight, return_when=FIRST_COMPLETED)
+                for future in done:
+                    del in_flight[future]
+                    frontier.extend(self._apply(*future.result()))
+                    if not self._checkpoint(on_batch_ready, stop_event):
+                        return False
+            return True
+        finally:
+            pool.shutdown(wait=True, cancel_futures=True)
+
+    def _apply(
+        self,
+        rel: str,
+        files: Optional[List[Tuple[str, int, int]]],
+        subdirs: List[str]
+    ) -> List[str]:
+        """Diff one listing against the snapshot -> newly queued subdirs."""
+        conn = self._connect()
+        self.stats.dirs_scanned += 1
+        self._dirs_since_checkpoint += 1
+
+        if files is not None:
+            known = {
+                name: (size, mtime_ns)
+                for name, size, mtime_ns in conn.execute(
+                    "SELECT name, size, mtime_ns FROM watch_snapshot WHERE dir = ?", (rel,)
+                )
+            }
+            now = time.time()
+            upserts = []
+            for name, size, mtime_ns in files:
+                if (rel, name) in self._excluded:
+                    continue
+                self.stats.files_seen += 1
+                previous = known.pop(name, None)
+                if previous == (size, mtime_ns):
+                    continue
+                if previous is None:
+                    self.stats.created += 1
+                    event_type = "created"
+                else:
+                    self.stats.modified += 1
+                    event_type = "modified"
+                upserts.append((rel, name, size, mtime_ns))
+                self._buffer.append(FileEvent(self._abs(rel, name), event_type, now))
+
+            for name in known:
+                self.stats.deleted += 1
+                self._buffer.append(FileEvent(self._abs(rel, name), "deleted", now))
+
+            if upserts:
+                conn.executemany("INSERT OR REPLACE INTO watch_snapshot VALUES (?, ?, ?, ?)", upserts)
+            if known:
+                conn.executemany(
+                    "DELETE FROM watch_snapshot WHERE dir = ? AND name = ?",
+                    [(rel, name) for name in known]
+                )
+        else:
+            # Unreadable (files is None): keep its snapshot rows (and its
+            # subtree's, see _sweep_vanished_dirs), no deletes reported
+            conn.execute("UPDATE watch_scan_dirs SET done = 2 WHERE dir = ?", (rel,))
+            return []
+
+        queued = []
+        for subdir in subdirs:
+            cursor = conn.execute("INSERT OR IGNORE INTO watch_scan_dirs (dir) VALUES (?)", (subdir,))
+            if cursor.rowcount == 1:
+                queued.append(subdir)
+        conn.execute("UPDATE watch_scan_dirs SET done = 1 WHERE dir = ?", (rel,))
+        return queued
+
+    def _sweep_vanished_dirs(
+        self,
+        on_batch_ready: Optional[Callable[[List[FileEvent]], None]],
+        stop_event: threading.Event
+    ) -> bool:
+        """
+        Files under directories this scan never reached (removed trees) -> deleted.
+
+        Directories below an unreadable one were not reached either, but
+        may still exist: they are skipped.
+        """
+        conn = self._connect()
+        vanished = conn.execute(
+            "SELECT DISTINCT dir FROM watch_snapshot AS s "
+            "WHERE dir NOT IN (SELECT dir FROM watch_scan_dirs) "
+            "AND NOT EXISTS (SELECT 1 FROM watch_scan_dirs AS u WHERE u.done = 2 "
+            "AND (u.dir = '' OR substr(s.dir, 1, length(u.dir) + 1) = u.dir || '/'))"
+        ).fetchall()
+
+        for (rel,) in vanished:
+            if stop_event.is_set():
+                return False
+            now = time.time()
+            names = conn.execute("SELECT name FROM watch_snapshot WHERE dir = ?", (rel,)).fetchall()
+            for (name,) in names:
+                self.stats.deleted += 1
+                self._buffer.append(FileEvent(self._abs(rel, name), "deleted", now))
+            conn.execute("DELETE FROM watch_snapshot WHERE dir = ?", (rel,))
+            self._dirs_since_checkpoint += 1
+            if not self._checkpoint(on_batch_ready, stop_event):
+                return False
+        return True
+
+    def _abs(self, rel: str, name: str) -> str:
+        return f"{self.watch_path}/{rel}/{name}" if rel else f"{self.watch_path}/{name}"
+
+    # -------------------------------------------------------------------
+    # EMISSION + CURSOR
+    # -------------------------------------------------------------------
+
+    def _checkpoint(
+        self,
+        on_batch_ready: Optional[Callable[[List[FileEvent]], None]],
+        stop_event: threading.Event,
+        force: bool = False
+    ) -> bool:
+        """
+        Emit the buffered events (throttled, batch_size at a time), then
+        commit: the cursor only moves past work that was delivered.
+
+        Returns:
+            False if stopped (nothing committed, next run re-emits)
+        """
+        if stop_event.is_set():
+            return False
+        if not force and len(self._buffer) < self.batch_size \
+                and self._dirs_since_checkpoint < self.CHECKPOINT_DIRS:
+            return True
+
+        pending, self._buffer = self._buffer, []
+        for i in range(0, len(pending), self.batch_size):
+            if i and stop_event.is_set():
+                return False
+            batch = pending[i:i + self.batch_size]
+            if self.max_events_per_second:
+                delay = self._next_emit - time.monotonic()
+                if delay > 0 and stop_event.wait(delay):
+                    return False
+                self._next_emit = max(self._next_emit, time.monotonic()) \
+                    + len(batch) / self.max_events_per_second
+            if on_batch_ready:
+                try:
+                    on_batch_ready(batch)
+                except Exception as e:
+                    print(f"[RECONCILER] Error in batch callback: {e}")
+            self.stats.batches += 1
+
+        self._connect().commit()
+        self._dirs_since_checkpoint = 0
+        return True
+
+    def close(self) -> None:
+        if self._conn is not None:
+            self._conn.close()
+            self._conn = None
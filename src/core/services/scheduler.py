@@ -0,0 +1,195 @@
+"""
+DeadlineScheduler - Shared Timer Thread for Background Services
+Sprint 6 Background Services
+
+One thread runs the deadlines of every registered component (IndexerQueue
+flush timeout, WatchdogService batch flush, ...) instead of each owning a
+sleeping thread or re-creating threading.Timer per interval.
+
+Features:
+- heapq of deadlines; reschedule() is O(log n) with lazy invalidation
+  (stale heap entries are skipped), so pushing a deadline forward after
+  a size-triggered flush costs no thread and no wakeup
+- Idle with no tasks = blocked on a Condition (zero wakeups)
+- Exception isolation: a failing callback never kills the thread
+
+Callbacks run ON the scheduler thread: keep them short. A component with
+slow callbacks should be given its own DeadlineScheduler instance.
+
+Thread-safe for Python 3.14 No-GIL.
+"""
+
+import heapq
+import itertools
+import threading
+import time
+from typing import Callable, List, Optional, Tuple
+
+
+class ScheduledTask:
+    """Handle returned by DeadlineScheduler.schedule()."""
+
+    __slots__ = ("callback", "name", "interval_s", "deadline", "cancelled", "_scheduler")
+
+    def __init__(
+        self,
+        scheduler: "DeadlineScheduler",
+        callback: Callable[[], None],
+        name: str,
+        interval_s: Optional[float]
+    ):
+        self._scheduler = scheduler
+        self.callback = callback
+        self.name = name
+        self.interval_s = interval_s
+        self.deadline = 0.0  # monotonic
+        self.cancelled = False
+
+    def reschedule(self, delay_s: float) -> None:
+        """Move the deadline to now + delay_s (earlier or later)."""
+        self._scheduler._push(self, time.monotonic() + delay_s)
+
+    def cancel(self) -> None:
+        """Never run again (safe to call from the callback itself)."""
+        self._scheduler._cancel(self)
+
+
+class DeadlineScheduler:
+    """
+    Single-thread deadline scheduler.
+
+    Usage:
+        scheduler = get_scheduler()
+        task = scheduler.schedule(0.5, on_timeout, name="IndexerQueue-Flush")
+        task.reschedule(0.5)   # push forward
+        task.cancel()
+    """
+
+    def __init__(self, name: str = "Scheduler"):
+        """
+        Args:
+            name: Thread name (thread starts lazily on first schedule())
+        """
+        self.name = name
+        self._heap: List[Tuple[float, int, ScheduledTask]] = []
+        self._seq = itertools.count()
+        self._cond = threading.Condition(threading.Lock())
+        self._thread: Optional[threading.Thread] = None
+        self._stopped = False
+
+        # Metrics
+        self.runs = 0
+        self.errors = 0
+
+    def schedule(
+        self,
+        delay_s: float,
+        callback: Callable[[], None],
+        name: str = "",
+        interval_s: Optional[float] = None
+    ) -> ScheduledTask:
+        """
+        Run callback once after delay_s (interval_s: then every interval_s,
+        measured from the end of the previous run). A one-shot task that
+        already ran can be re-armed with reschedule().
+
+        Returns:
+            ScheduledTask handle (reschedule/cancel)
+        """
+        task = ScheduledTask(self, callback, name or callback.__name__, interval_s)
+        self._push(task, time.monotonic() + delay_s)
+        return task
+
+    def _push(self, task: ScheduledTask, deadline: float) -> None:
+        with self._cond:
+            if task.cancelled or self._stopped:
+                return
+            task.deadline = deadline
+            # Old entries stay in the heap and are skipped when popped
+            heapq.heappush(self._heap, (deadline, next(self._seq), task))
+            self._ensure_thread()
+            if self._heap[0][2] is task:
+                self._cond.notify()
+
+    def _cancel(self, task: ScheduledTask) -> None:
+        with self._cond:
+            task.cancelled = True
+
+    def _ensure_thread(self) -> None:
+        """MUST be called with _cond held."""
+        if self._thread is None or not self._thread.is_alive():
+            self._thread = threading.Thread(target=self._run, name=self.name, daemon=True)
+            self._thread.start()
+
+    @property
+    def pending(self) -> int:
+        """Armed deadlines (stale heap entries excluded)."""
+        with self._cond:
+            return sum(
+                1 for deadline, _, task in self._heap
+                if not task.cancelled and deadline == task.deadline
+            )
+
+    def shutdown(self, timeout: float = 1.0) -> None:
+        """Stop the thread; outstanding tasks never run."""
+        with self._cond:
+            self._stopped = True
+            self._heap.clear()
+            self._cond.notify()
+            thread = self._thread
+        if thread and thread is not threading.current_thread():
+            thread.join(timeout=timeout)
+
+    def _next_due(self) -> Optional[ScheduledTask]:
+        """Block until a live task is due (None = shutdown)."""
+        with self._cond:
+            while not self._stopped:
+                if not self._heap:
+                    self._cond.wait()
+                    continue
+
+                deadline, _, task = self._heap[0]
+                if task.cancelled or deadline != task.deadline:
+                    heapq.heappop(self._heap)  # stale entry
+                    continue
+
+                wait = deadline - time.monotonic()
+                if wait > 0:
+                    self._cond.wait(timeout=wait)
+                    continue
+
+                heapq.heappop(self._heap)
+                return task
+            return None
+
+    def _run(self) -> None:
+        while True:
+            task = self._next_due()
+            if task is None:
+                return
+
+            scheduled_for = task.deadline
+            try:
+                task.callback()
+            except Exception as e:
+                self.errors += 1
+                print(f"[SCHEDULER] Task '{task.name}' error: {type(e).__name__}: {e}")
+            self.runs += 1
+
+            # Repeat unless the callback cancelled/rescheduled it
+            if task.interval_s is not None and task.deadline == scheduled_for:
+                self._push(task, time.monotonic() + task.interval_s)
+
+
+# Process-wide default instance
+_default_scheduler: Optional[DeadlineScheduler] = None
+_default_lock = threading.Lock()
+
+
+def get_scheduler() -> DeadlineScheduler:
+    """Shared scheduler used by components unless given their own."""
+    global _default_scheduler
+    with _default_lock:
+        if _default_scheduler is None:
+            _default_scheduler = DeadlineScheduler(name="BackgroundScheduler")
+        return _default_scheduler
@@ -0,0 +1,185 @@
+"""
+EventSpool - On-disk Overflow Spool for HeavyEventBus
+Task 6.2 - Sprint 6 Background Services
+
+Used by HeavyEventBus(overflow="spool"): when the in-memory queue is
+full, envelopes are appended here instead of dropping the oldest, and
+the dispatcher replays them (FIFO) once subscribers catch up.
+
+File format: repeated [u32 length][orjson record]. append() writes each
+record through to the OS (a process crash keeps it). pop_many() only
+moves an in-memory read cursor; the bus calls commit() with a record's
+end offset once every subscriber callback for it has finished, and only
+that committed offset is stored in the sidecar "<path>.offset" file -
+after an fsync of the spool, at most every COMMIT_INTERVAL_S. A crash
+before the commit is stored replays the records on restart
+(at-least-once). A torn final record (crash mid-append) is truncated away
+on resume. The spool file is truncated once fully drained and committed.
+
+NOT thread-safe on its own: HeavyEventBus calls it under _queue_lock.
+"""
+
+import os
+import struct
+import time
+from pathlib import Path
+from typing import Any, List, Optional, Tuple
+
+import orjson
+
+_LENGTH = struct.Struct("<I")
+
+
+class EventSpool:
+    """Append-only FIFO of JSON records backed by a file."""
+
+    COMMIT_INTERVAL_S = 0.2  # coalesces offset-file rewrites while draining
+
+    def __init__(self, path: str):
+        """
+        Open (or resume) a spool.
+
+        Args:
+            path: Spool file path (parent directory created if missing)
+        """
+        self.path = Path(path)
+        self.path.parent.mkdir(parents=True, exist_ok=True)
+        self._offset_path = Path(f"{path}.offset")
+
+        self._file = open(self.path, "a+b")
+        self._committed_offset = self._load_offset()
+        self._read_offset = self._committed_offset
+        self._depth = self._count_records()
+        self._stored_offset = self._committed_offset
+        self._last_store = 0.0
+
+    def _load_offset(self) -> int:
+        try:
+            offset = int(self._offset_path.read_text() or 0)
+        except (OSError, ValueError):
+            return 0
+        return min(offset, self.path.stat().st_size)
+
+    def _store_offset(self) -> None:
+        # Records the offset vouches for must be on disk before it moves
+        os.fsync(self._file.fileno())
+        tmp = Path(f"{self._offset_path}.tmp")
+        tmp.write_text(str(self._committed_offset))
+        os.replace(tmp, self._offset_path)
+        self._stored_offset = self._committed_offset
+        self._last_store = time.monotonic()
+
+    def _read_record_locked(self, size: int) -> Optional[bytes]:
+        """Next record body at the file position, None at EOF or a torn record."""
+        start = self._file.tell()
+        header = self._file.read(_LENGTH.size)
+        if len(header) < _LENGTH.size:
+            return None
+        (length,) = _LENGTH.unpack(header)
+        if start + _LENGTH.size + length > size:
+            return None
+        return self._file.read(length)
+
+    def _truncate_tail(self, offset: int) -> None:
+        """Drop a torn/corrupt record and everything after it."""
+        self._file.truncate(offset)
+        self._depth = 0
+
+    def _count_records(self) -> int:
+        """Records between the committed offset and EOF (startup only)."""
+        count = 0
+        size = os.fstat(self._file.fileno()).st_size
+        self._file.seek(self._read_offset)
+        while True:
+            start = self._file.tell()
+            if self._read_record_locked(size) is None:
+                if start < size:
+                    self._file.truncate(start)  # Torn final append
+                break
+            count += 1
+        return count
+
+    @property
+    def depth(self) -> int:
+        """Records waiting for replay."""
+        return self._depth
+
+    @property
+    def size_bytes(self) -> int:
+        """Current spool file size."""
+        return self.path.stat().st_size
+
+    def append(self, record: Any) -> None:
+        """Append one JSON-serializable record."""
+        data = orjson.dumps(record, option=orjson.OPT_NON_STR_KEYS)
+        self._file.seek(0, os.SEEK_END)
+        self._file.write(_LENGTH.pack(len(data)) + data)
+        self._file.flush()
+        self._depth += 1
+
+    def pop_many(self, limit: int) -> List[Tuple[int, Any]]:
+        """
+        Read up to `limit` records, oldest first, as (end_offset, record).
+
+        Records stay on disk until commit(end_offset). A short or invalid
+        record is truncated (with anything after it) and ends the read.
+        """
+        if self._depth == 0 or limit <= 0:
+            return []
+
+        size = os.fstat(self._file.fileno()).st_size
+        self._file.seek(self._read_offset)
+
+        records = []
+        while len(records) < limit and self._depth:
+            start = self._file.tell()
+            data = self._read_record_locked(size)
+            try:
+                record = orjson.loads(data) if data is not None else None
+            except orjson.JSONDecodeError:
+                data = None
+            if data is None:
+                self._truncate_tail(start)
+                break
+            records.append((self._file.tell(), record))
+            self._depth -= 1
+
+        if records:
+            self._read_offset = records[-1][0]
+        return records
+
+    def commit(self, offset: int) -> None:
+        """
+        Mark every record ending at or before `offset` as delivered.
+
+        Stored at most every COMMIT_INTERVAL_S (and on close). Truncates
+        the spool - storing offset 0 at once - when everything read is
+        committed and nothing is left to replay.
+        """
+        if offset <= self._committed_offset:
+            return
+        self._committed_offset = min(offset, self._read_offset)
+        if self._depth == 0 and self._committed_offset == self._read_offset:
+            # Fully drained: reclaim disk space
+            self._file.truncate(0)
+            self._committed_offset = self._read_offset = 0
+            self._store_offset()
+        elif time.monotonic() - self._last_store >= self.COMMIT_INTERVAL_S:
+            self._store_offset()
+
+    @property
+    def closed(self) -> bool:
+        return self._file.closed
+
+    def flush(self) -> None:
+        """Push buffered appends to the OS."""
+        if not self._file.closed:
+            self._file.flush()
+
+    def close(self) -> None:
+        """Store the committed offset, close the file (records kept for resume)."""
+        if not self._file.closed:
+            self._file.flush()
+            if self._committed_offset != self._stored_offset:
+                self._store_offset()
+            self._file.close()
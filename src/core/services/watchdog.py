@@ -3,10 +3,12 @@ Watchdog Service - File System Monitor with Debouncing
 Sprint 6.1 - Background Services Core
 
 Responsibilities:
-1. Observe filesystem events (create/modify/delete)
-2. Normalize events (debounce, batch, deduplicate)
+1. Observe filesystem events (create/modify/delete/move)
+2. Normalize events (debounce, batch, compact per path)
 3. Emit clean events to Queue
 4. Lifecycle-safe (start/stop with no zombie threads)
+5. Optional startup reconciliation (changes made while stopped), see
+   services/reconciler.py - the snapshot SQLite lives there
 
 Does NOT:
 - Read file contents
@@ -18,19 +20,39 @@ import threading
 import time
 import uuid
 from pathlib import Path
-from typing import Callable, Set, Optional, List, Dict
+from typing import TYPE_CHECKING, Callable, Set, Optional, List, Dict, Tuple
 from dataclasses import dataclass, field
 from watchdog.observers import Observer
 from watchdog.events import FileSystemEventHandler, FileSystemEvent
 
+from .scheduler import DeadlineScheduler, ScheduledTask, get_scheduler
+
+if TYPE_CHECKING:
+    from .reconciler import ReconciliationScanner
+
 
 @dataclass
 class FileEvent:
     """Normalized file event with POSIX path"""
     path: str  # Always POSIX format (forward slashes)
-    event_type: str  # 'created', 'modified', 'deleted'
+    event_type: str  # 'created', 'modified', 'deleted', 'moved'
     timestamp: float
     batch_id: str = field(default_factory=lambda: str(uuid.uuid4()))
+    src_path: Optional[str] = None  # 'moved' only: previous path (POSIX)
+
+
+# Compaction: (pending type, new type) -> folded type, None = nothing left.
+# Pairs not listed: the new type wins. 'moved' + change stays 'moved' -
+# the indexer re-links by content hash and re-extracts only if it differs.
+_FOLD: Dict[Tuple[str, str], Optional[str]] = {
+    ("created", "modified"): "created",
+    ("created", "deleted"): None,       # Never existed as far as the index knows
+    ("modified", "created"): "modified",
+    ("deleted", "created"): "modified",  # Replaced in place
+    ("deleted", "modified"): "modified",
+    ("moved", "modified"): "moved",
+    ("moved", "created"): "moved",
+}
 
 
 class WatchdogService:
@@ -46,19 +68,32 @@ class WatchdogService:
         watch_path: str,
         debounce_ms: int = 1000,
         on_batch_ready: Optional[Callable[[List[FileEvent]], None]] = None,
-        max_batch_size: int = 5000
+        max_batch_size: int = 5000,
+        scheduler: Optional[DeadlineScheduler] = None,
+        reconciler: Optional["ReconciliationScanner"] = None,
+        max_wait_ms: Optional[int] = None
     ):
         """
         Initialize Watchdog service.
         
         Args:
             watch_path: Directory to monitor
-            debounce_ms: Milliseconds to wait before emitting batch
+            debounce_ms: Milliseconds of silence before emitting batch
+                (reset by every event)
             on_batch_ready: Callback function for processed batches
             max_batch_size: Safety valve - force emit if exceeded
+            scheduler: Runs the debounce flush (default: shared get_scheduler()).
+                on_batch_ready runs on its thread - pass a dedicated
+                DeadlineScheduler if the callback is slow.
+            reconciler: Startup scan of watch_path against its last
+                snapshot; its synthetic batches also go to on_batch_ready
+                (from the reconcile thread, undebounced)
+            max_wait_ms: Cap on how long a continuous burst can hold a
+                batch back, from its first event (default: 5 x debounce_ms)
         """
         self.watch_path = Path(watch_path).as_posix()  # Normalize to POSIX
         self.debounce_ms = debounce_ms
+        self.max_wait_ms = max_wait_ms if max_wait_ms is not None else debounce_ms * 5
         self.on_batch_ready = on_batch_ready
         self.max_batch_size = max_batch_size
         
@@ -67,12 +102,23 @@ class WatchdogService:
         self._event_details: Dict[str, FileEvent] = {}
         self._lock = threading.Lock()
         
-        # Debounce timer tracking
+        # Compaction metrics (raw events in vs FileEvents out)
+        self._events_received = 0
+        self._events_flushed = 0      # Raw events covered by emitted batches
+        self._events_emitted = 0
+        self._batches_emitted = 0
+        self._window_events = 0       # Raw events folded into the pending batch
+        
+        # Debounce timer tracking (monotonic)
+        self._first_event_time: float = 0.0
         self._last_event_time: float = 0.0
         
         # Lifecycle management
         self._observer: Optional[Observer] = None
-        self._flush_thread: Optional[threading.Thread] = None
+        self._scheduler = scheduler or get_scheduler()
+        self._flush_task: Optional[ScheduledTask] = None
+        self._reconciler = reconciler
+        self._reconcile_thread: Optional[threading.Thread] = None
         self._running = False
         self._stop_event = threading.Event()
         
@@ -81,34 +127,134 @@ class WatchdogService:
         """Check if service is currently running"""
         return self._running
         
-    def _on_file_event(self, file_path: str, event_type: str):
+    def _on_file_event(self, file_path: str, event_type: str, src_path: Optional[str] = None):
         """
         Internal handler for file system events.
-        Deduplicates and stores events for batching.
+        Compacts per path and stores events for batching.
         
         Args:
-            file_path: Path to the file (will be normalized to POSIX)
-            event_type: Type of event (created/modified/deleted)
+            file_path: Path to the file (will be normalized to POSIX);
+                for 'moved', the destination
+            event_type: Type of event (created/modified/deleted/moved)
+            src_path: 'moved' only - path the file was moved from
         """
         # Normalize path to POSIX format (forward slashes only)
         normalized_path = Path(file_path).as_posix()
         current_time = time.time()
         
         with self._lock:
-            # Reset debounce timer on each new event
-            self._last_event_time = current_time
-            
-            # Deduplicate by normalized path
-            self._pending_events.add(normalized_path)
-            self._event_details[normalized_path] = FileEvent(
-                path=normalized_path,
-                event_type=event_type,
-                timestamp=current_time
-            )
+            # Reset debounce timer on each new event; the deadline itself is
+            # pushed forward lazily by _on_flush_deadline (no heap entry per event)
+            self._last_event_time = time.monotonic()
+            
+            # First pending event arms the flush deadline (idle = no wakeups)
+            if not self._pending_events:
+                self._first_event_time = self._last_event_time
+                if self._flush_task:
+                    self._flush_task.reschedule(self.debounce_ms / 1000.0)
+            
+            self._events_received += 1
+            self._window_events += 1
+            if event_type == "moved" and src_path is not None:
+                self._fold_move_unsafe(Path(src_path).as_posix(), normalized_path, current_time)
+            else:
+                self._fold_unsafe(normalized_path, event_type, current_time)
             
             # Safety valve: force emit if batch too large
             if len(self._pending_events) >= self.max_batch_size:
                 self._flush_batch_unsafe()  # Called inside lock
+                
+    # -------------------------------------------------------------------
+    # COMPACTION (caller holds _lock): one pending FileEvent per path
+    # -------------------------------------------------------------------
+    
+    def _store_unsafe(self, event: FileEvent) -> None:
+        self._pending_events.add(event.path)
+        self._event_details[event.path] = event
+        
+    def _drop_unsafe(self, path: str) -> Optional[FileEvent]:
+        self._pending_events.discard(path)
+        return self._event_details.pop(path, None)
+        
+    def _fold_unsafe(self, path: str, event_type: str, now: float) -> None:
+        """Fold a create/modify/delete into the path's pending event."""
+        pending = self._event_details.get(path)
+        if pending is None:
+            self._store_unsafe(FileEvent(path=path, event_type=event_type, timestamp=now))
+            return
+            
+        if pending.event_type == "moved" and event_type == "deleted":
+            # Renamed, then deleted: both the old and the new path are gone
+            self._orphan_source_unsafe(pending, now)
+            self._store_unsafe(FileEvent(path=path, event_type="deleted", timestamp=now))
+            return
+            
+        folded = _FOLD.get((pending.event_type, event_type), event_type)
+        if folded is None:
+            self._drop_unsafe(path)
+            return
+        self._store_unsafe(FileEvent(
+            path=path,
+            event_type=folded,
+            timestamp=now,
+            src_path=pending.src_path if folded == "moved" else None
+        ))
+        
+    def _fold_move_unsafe(self, src: str, dest: str, now: float) -> None:
+        """
+        Fold src -> dest into one event at dest:
+        created+moved -> created, moved+moved -> one move from the
+        original path, moved back to the original path -> modified.
+        """
+        pending = self._drop_unsafe(src)
+        if pending is not None and pending.event_type == "created":
+            event = FileEvent(path=dest, event_type="created", timestamp=now)
+        else:
+            origin = pending.src_path if pending is not None and pending.event_type == "moved" else src
+            if origin == dest:
+                event = FileEvent(path=dest, event_type="modified", timestamp=now)
+            else:
+                event = FileEvent(path=dest, event_type="moved", timestamp=now, src_path=origin)
+                
+        # Whatever was pending at dest is overwritten by the move
+        replaced = self._event_details.get(dest)
+        if replaced is not None and replaced.event_type == "moved" and replaced.src_path != event.src_path:
+            self._orphan_source_unsafe(replaced, now)
+        self._store_unsafe(event)
+        
+    def _orphan_source_unsafe(self, moved: FileEvent, now: float) -> None:
+        """A pending move's file is gone: report its original path deleted."""
+        # A pending event at the original path is a newer file living there
+        if moved.src_path not in self._event_details:
+            self._store_unsafe(FileEvent(path=moved.src_path, event_type="deleted", timestamp=now))
+            
+    def _take_batch_unsafe(self) -> List[FileEvent]:
+        """Pending events as a batch; clears pending, updates compaction stats."""
+        batch = list(self._event_details.values())
+        self._pending_events.clear()
+        self._event_details.clear()
+        
+        if batch:
+            self._events_flushed += self._window_events
+            self._events_emitted += len(batch)
+            self._batches_emitted += 1
+            self._window_events = 0
+        return batch
+        
+    def get_stats(self) -> Dict[str, float]:
+        """
+        Compaction stats. compaction_ratio = share of raw events that
+        emitted batches did NOT have to forward (0.0 = no folding).
+        """
+        with self._lock:
+            flushed = self._events_flushed
+            return {
+                "events_received": self._events_received,
+                "events_emitted": self._events_emitted,
+                "batches_emitted": self._batches_emitted,
+                "pending": len(self._pending_events),
+                "compaction_ratio": 1.0 - self._events_emitted / flushed if flushed else 0.0,
+            }
             
     def _flush_batch_unsafe(self):
         """
@@ -118,15 +264,7 @@ class WatchdogService:
         if not self._pending_events:
             return
             
-        # Collect batch
-        batch = [
-            self._event_details[path] 
-            for path in self._pending_events
-        ]
-        
-        # Clear pending
-        self._pending_events.clear()
-        self._event_details.clear()
+        batch = self._take_batch_unsafe()
         
         # Emit batch (callback may be slow, but we're in safety valve mode)
         if self.on_batch_ready and batch:
@@ -144,15 +282,7 @@ class WatchdogService:
             if not self._pending_events:
                 return
                 
-            # Collect batch
-            batch = [
-                self._event_details[path] 
-                for path in self._pending_events
-            ]
-            
-            # Clear pending
-            self._pending_events.clear()
-            self._event_details.clear()
+            batch = self._take_batch_unsafe()
             
         # Emit batch (outside lock to prevent deadlock)
         if self.on_batch_ready and batch:
@@ -162,23 +292,31 @@ class WatchdogService:
                 # Log but don't crash the service
                 print(f"[WATCHDOG] Error in batch callback: {e}")
                 
-    def _flush_loop(self):
+    def _on_flush_deadline(self):
         """
-        Background thread that periodically flushes batches.
-        Runs until stop_event is set.
+        Scheduler callback: flush once debounce_ms passed without a new
+        event, or max_wait_ms since the first pending one; otherwise re-arm
+        for whichever comes first. Idle: armed by the next event only.
         """
-        while not self._stop_event.is_set():
-            # Wait for debounce period or stop signal
-            if self._stop_event.wait(timeout=self.debounce_ms / 1000.0):
-                break
-                
-            # Flush any pending events
-            self._flush_batch()
+        if self._stop_event.is_set():
+            return
+        with self._lock:
+            if not self._pending_events:
+                return
+            due = min(
+                self._last_event_time + self.debounce_ms / 1000.0,
+                self._first_event_time + self.max_wait_ms / 1000.0
+            )
+            remaining = due - time.monotonic()
+            if remaining > 0 and self._flush_task:
+                self._flush_task.reschedule(remaining)
+                return
+        self._flush_batch()
             
     def start(self):
         """
         Start watching the file system.
-        Spawns observer and flush threads.
+        Spawns the observer thread; flushes run on the shared scheduler.
         """
         if self._running:
             return
@@ -186,13 +324,12 @@ class WatchdogService:
         self._running = True
         self._stop_event.clear()
         
-        # Start flush thread
-        self._flush_thread = threading.Thread(
-            target=self._flush_loop,
-            daemon=False,  # Explicitly non-daemon for clean shutdown
-            name="WatchdogFlushThread"
+        # Register flush deadline (armed by the first event)
+        self._flush_task = self._scheduler.schedule(
+            self.debounce_ms / 1000.0,
+            self._on_flush_deadline,
+            name="WatchdogFlush"
         )
-        self._flush_thread.start()
         
         # Start file system observer
         event_handler = _WatchdogEventHandler(self._on_file_event)
@@ -200,6 +337,28 @@ class WatchdogService:
         self._observer.schedule(event_handler, self.watch_path, recursive=True)
         self._observer.start()
         
+        # Reconcile AFTER the observer is live: nothing falls between the two
+        if self._reconciler:
+            self._reconcile_thread = threading.Thread(
+                target=self._run_reconciler,
+                name="WatchdogReconcile",
+                daemon=True
+            )
+            self._reconcile_thread.start()
+            
+    def _run_reconciler(self):
+        """Reconcile thread: one startup scan, interrupted by stop()."""
+        try:
+            stats = self._reconciler.run(self.on_batch_ready, self._stop_event)
+            state = "complete" if stats.completed else "interrupted (resumes next start)"
+            print(
+                f"[WATCHDOG] Reconciliation {state}: {stats.dirs_scanned} dirs, "
+                f"+{stats.created} ~{stats.modified} -{stats.deleted} "
+                f"in {stats.duration_s:.1f}s"
+            )
+        except Exception as e:
+            print(f"[WATCHDOG] Reconciliation failed: {type(e).__name__}: {e}")
+        
     def stop(self):
         """
         Stop watching and clean up threads.
@@ -219,10 +378,15 @@ class WatchdogService:
             self._observer.join(timeout=2.0)
             self._observer = None
             
-        # Wait for flush thread
-        if self._flush_thread:
-            self._flush_thread.join(timeout=2.0)
-            self._flush_thread = None
+        # Reconcile scan stops at its next batch boundary (rolled back, resumable)
+        if self._reconcile_thread:
+            self._reconcile_thread.join(timeout=5.0)
+            self._reconcile_thread = None
+            
+        # Cancel flush deadline (a run in progress finishes under _lock)
+        if self._flush_task:
+            self._flush_task.cancel()
+            self._flush_task = None
             
         # Final flush
         self._flush_batch()
@@ -231,7 +395,7 @@ class WatchdogService:
 class _WatchdogEventHandler(FileSystemEventHandler):
     """Internal event handler that bridges watchdog to our service"""
     
-    def __init__(self, callback: Callable[[str, str], None]):
+    def __init__(self, callback: Callable[..., None]):
         super().__init__()
         self.callback = callback
         
@@ -246,3 +410,8 @@ class _WatchdogEventHandler(FileSystemEventHandler):
     def on_deleted(self, event: FileSystemEvent):
         if not event.is_directory:
             self.callback(event.src_path, "deleted")
+            
+    def on_moved(self, event: FileSystemEvent):
+        # Directory moves also arrive as one moved event per contained file
+        if not event.is_directory:
+            self.callback(event.dest_path, "moved", event.src_path)
@@ -3,28 +3,73 @@
 # Licensed under PolyForm Noncommercial 1.0.
 # ------------------------------------------------------------------------------
 
+import asyncio
 import aiosqlite
 import orjson
 import logging
 import time
-import hashlib
+from contextlib import asynccontextmanager
 from pathlib import Path
-from typing import List, Dict, Any
+from typing import Any, AsyncIterator, Dict, Iterable, List, Optional, Tuple
 from ..security.kms import KMS
 from ..security.encryption import EncryptionService, TamperDetectedError
 
 logger = logging.getLogger(__name__)
 
+# domain_events.enc_key_id of rows written by this adapter
+ENC_KEY_ID = "v1"
+
+# (stream_type, stream_id, payload)
+EventRecord = Tuple[str, str, Dict[str, Any]]
+
+_PRAGMAS = (
+    "PRAGMA journal_mode=WAL",
+    "PRAGMA synchronous=NORMAL",     # WAL: durable at checkpoint, never corrupt
+    "PRAGMA busy_timeout=5000",
+    "PRAGMA temp_store=MEMORY",
+    "PRAGMA cache_size=-16000",      # 16 MB page cache per connection
+)
+
 class StorageAdapter:
-    def __init__(self, db_path: Path, kms: KMS):
+    """
+    Encrypted event store (domain_events).
+
+    Connections are opened once and kept: one writer, `read_connections`
+    WAL readers (reads never queue behind a commit). Writes group-commit:
+    save_event()/save_events() calls that arrive while a commit is in
+    flight are written together in the next transaction.
+    """
+
+    DEFAULT_READ_CONNECTIONS = 2
+    DEFAULT_FETCH_SIZE = 256
+
+    def __init__(self, db_path: Path, kms: KMS, read_connections: int = DEFAULT_READ_CONNECTIONS):
         self.db_path = db_path
         self.kms = kms
+        self.read_connections = max(1, read_connections)
         self._init_done = False
 
+        self._writer: Optional[aiosqlite.Connection] = None
+        self._readers: Optional[asyncio.Queue] = None
+        self._reader_conns: List[aiosqlite.Connection] = []
+        self._connect_lock = asyncio.Lock()
+
+        # Group commit: [(rows, future)] waiting for the next transaction
+        self._write_lock = asyncio.Lock()
+        self._pending: List[Tuple[List[tuple], asyncio.Future]] = []
+
+    async def _open(self) -> aiosqlite.Connection:
+        db = await aiosqlite.connect(self.db_path)
+        for pragma in _PRAGMAS:
+            await db.execute(pragma)
+        return db
+
     async def _ensure_schema(self):
         if self._init_done: return
-        self.db_path.parent.mkdir(parents=True, exist_ok=True)
-        async with aiosqlite.connect(self.db_path) as db:
+        async with self._connect_lock:
+            if self._init_done: return
+            self.db_path.parent.mkdir(parents=True, exist_ok=True)
+            db = await self._open()
             # Matches Schema Rev 2 (ADR-002 Rev 2)
             await db.execute("""
                 CREATE TABLE IF NOT EXISTS domain_events (
@@ -35,69 +80,210 @@ class StorageAdapter:
                     enc_algorithm TEXT DEFAULT 'XChaCha20-Poly1305',
                     enc_key_id TEXT DEFAULT 'v1',
                     enc_nonce BLOB,              -- 24 bytes
-                    
+
                     event_hmac BLOB NOT NULL,    -- HMAC-SHA3-256 (Chain)
                     event_hash BLOB,             -- Current Hash (Simplification)
                     timestamp INTEGER NOT NULL,
-                    
+
                     quarantine INTEGER DEFAULT 0,
                     tamper_reason TEXT
                 )
             """)
+            await db.execute(
+                "CREATE INDEX IF NOT EXISTS idx_domain_events_stream ON domain_events(stream_id, event_id)"
+            )
             await db.commit()
-        self._init_done = True
+            self._writer = db
 
-    async def save_event(self, stream_type: str, stream_id: str, payload: Dict) -> int:
+            self._readers = asyncio.Queue()
+            for _ in range(self.read_connections):
+                reader = await self._open()
+                await reader.execute("PRAGMA query_only=1")
+                self._reader_conns.append(reader)
+                self._readers.put_nowait(reader)
+            self._init_done = True
+
+    @asynccontextmanager
+    async def _reader(self) -> AsyncIterator[aiosqlite.Connection]:
+        await self._ensure_schema()
+        db = await self._readers.get()
+        try:
+            yield db
+        finally:
+            self._readers.put_nowait(db)
+
+    def _keys(self, action: str) -> Tuple[bytes, bytes]:
         # Check vault is unlocked and get master key
-        if not self.kms.is_unlocked or self.kms._master_key is None:
-            raise RuntimeError("Vault Locked: Must unlock vault before saving events")
-        
-        # Derive DEK and HMAC key from master key
-        dek, hmac_key = EncryptionService.derive_keys(self.kms._master_key)
+        master_key = self.kms._master_key
+        if not self.kms.is_unlocked or master_key is None:
+            raise RuntimeError(f"Vault Locked: Must unlock vault before {action} events")
+        # DEK + HMAC key, derived once per unlock (KMS.lock() zeroes them)
+        keys = self.kms.key_cache.get_or_derive(
+            (ENC_KEY_ID, "domain_events"),
+            lambda: b"".join(EncryptionService.derive_keys(master_key))
+        )
+        return keys[:32], keys[32:]
+
+    async def save_event(self, stream_type: str, stream_id: str, payload: Dict) -> int:
+        return (await self.save_events([(stream_type, stream_id, payload)]))[0]
+
+    async def save_events(self, events: Iterable[EventRecord]) -> List[int]:
+        """
+        Encrypt and store events in one transaction (shared with any
+        concurrent callers). Returns event_ids in input order.
+        """
+        dek, hmac_key = self._keys("saving")
         await self._ensure_schema()
-        
-        json_bytes = orjson.dumps(payload)
-        
-        # Encrypt + Chain HMAC
-        enc_blob, nonce, event_hmac = EncryptionService.encrypt_event(dek, hmac_key, json_bytes)
-        
-        async with aiosqlite.connect(self.db_path) as db:
-            cur = await db.execute(
-                """INSERT INTO domain_events 
-               (stream_type, stream_id, payload, enc_nonce, event_hmac, timestamp) 
+
+        now = int(time.time())
+        rows = []
+        for stream_type, stream_id, payload in events:
+            # Encrypt + Chain HMAC
+            enc_blob, nonce, event_hmac = EncryptionService.encrypt_event(dek, hmac_key, orjson.dumps(payload))
+            rows.append((stream_type, stream_id, enc_blob, nonce, event_hmac, now))
+        if not rows:
+            return []
+
+        future = asyncio.get_running_loop().create_future()
+        entry = (rows, future)
+        self._pending.append(entry)
+        try:
+            async with self._write_lock:
+                # An earlier caller's commit may already have taken our rows
+                if not future.done():
+                    batch, self._pending = self._pending, []
+                    await self._commit_shielded(batch)
+        except asyncio.CancelledError:
+            # Cancelled while waiting for the lock: don't let the next
+            # commit write rows nobody will get the ids for
+            self._pending = [p for p in self._pending if p is not entry]
+            raise
+        return await future
+
+    async def _commit_shielded(self, batch: List[Tuple[List[tuple], asyncio.Future]]) -> None:
+        """
+        Run _commit to completion even if this caller is cancelled.
+
+        The batch holds other callers' rows and futures, and _write_lock
+        must stay held until the transaction is closed; the cancellation
+        is re-raised once the commit is done.
+        """
+        commit = asyncio.ensure_future(self._commit(batch))
+        cancelled = False
+        while not commit.done():
+            try:
+                await asyncio.shield(commit)
+            except asyncio.CancelledError:
+                cancelled = True
+        if cancelled:
+            raise asyncio.CancelledError
+        commit.result()
+
+    async def _commit(self, batch: List[Tuple[List[tuple], asyncio.Future]]) -> None:
+        """Write every pending caller's rows as one transaction (caller holds _write_lock)."""
+        db = self._writer
+        rows = [row for caller_rows, _ in batch for row in caller_rows]
+        try:
+            # IMMEDIATE: sole writer for the whole insert, so AUTOINCREMENT
+            # ids of this transaction are consecutive
+            await db.execute("BEGIN IMMEDIATE")
+            await db.executemany(
+                """INSERT INTO domain_events
+               (stream_type, stream_id, payload, enc_nonce, event_hmac, timestamp)
                VALUES (?, ?, ?, ?, ?, ?)""",
-                (stream_type, stream_id, enc_blob, nonce, event_hmac, int(time.time()))
+                rows
             )
+            async with db.execute("SELECT last_insert_rowid()") as cur:
+                (last_id,) = await cur.fetchone()
             await db.commit()
-            return cur.lastrowid
+        except BaseException as e:
+            # Also on cancellation: never leave BEGIN IMMEDIATE open or a
+            # caller waiting on a future nobody will set
+            await db.rollback()
+            error = e if isinstance(e, Exception) else RuntimeError(
+                f"Group commit interrupted: {type(e).__name__}"
+            )
+            for _, future in batch:
+                if not future.done():
+                    future.set_exception(error)
+            if error is not e:
+                raise
+            return
+
+        next_id = last_id - len(rows) + 1
+        for caller_rows, future in batch:
+            if not future.done():  # Caller may have been cancelled meanwhile
+                future.set_result(list(range(next_id, next_id + len(caller_rows))))
+            next_id += len(caller_rows)
+
+    async def iter_events(
+        self,
+        limit: Optional[int] = None,
+        before_id: Optional[int] = None,
+        stream_id: Optional[str] = None,
+        fetch_size: int = DEFAULT_FETCH_SIZE
+    ) -> AsyncIterator[Dict]:
+        """
+        Decrypted events, newest first, fetched `fetch_size` rows at a time.
+
+        Args:
+            limit: Max events (None = all)
+            before_id: Keyset paging - only events with event_id < before_id
+                (pass the last id seen to continue)
+            stream_id: Only this stream
+        """
+        dek, hmac_key = self._keys("reading")
+
+        # SELECT matching the Rev 2 Schema
+        query = "SELECT event_id, stream_type, payload, enc_nonce, event_hmac, timestamp FROM domain_events WHERE quarantine=0"
+        params: List[Any] = []
+        if before_id is not None:
+            query += " AND event_id < ?"
+            params.append(before_id)
+        if stream_id is not None:
+            query += " AND stream_id = ?"
+            params.append(stream_id)
+        query += " ORDER BY event_id DESC"
+        if limit is not None:
+            query += " LIMIT ?"
+            params.append(limit)
+
+        async with self._reader() as db:
+            async with db.execute(query, params) as cur:
+                while True:
+                    rows = await cur.fetchmany(fetch_size)
+                    if not rows:
+                        break
+                    for row in rows:
+                        event = self._decode(row, dek, hmac_key)
+                        if event is not None:
+                            yield event
+
+    @staticmethod
+    def _decode(row: tuple, dek: bytes, hmac_key: bytes) -> Optional[Dict]:
+        eid, stype, payload, nonce, ehmac, ts = row
+        try:
+            if nonce:
+                # Decrypt + Verify Chain
+                plain = EncryptionService.decrypt_event(dek, hmac_key, payload, nonce, ehmac)
+                return {"id": eid, "type": stype, "payload": orjson.loads(plain)}
+            # Legacy (Rule #13)
+            return {"id": eid, "type": stype, "payload": orjson.loads(payload), "_legacy": True}
+        except TamperDetectedError as e:
+            logger.critical(f"QUARANTINE EVENT {eid}: {e}")
+            # In real app: UPDATE domain_events SET quarantine=1...
+            return None
 
     async def get_events(self, limit: int = 100) -> List[Dict]:
-        # Check vault is unlocked and get master key
-        if not self.kms.is_unlocked or self.kms._master_key is None:
-            raise RuntimeError("Vault Locked: Must unlock vault before reading events")
-        
-        # Derive DEK and HMAC key from master key
-        dek, hmac_key = EncryptionService.derive_keys(self.kms._master_key)
-        await self._ensure_schema()
-        
-        results = []
-        async with aiosqlite.connect(self.db_path) as db:
-            # SELECT matching the Rev 2 Schema
-            query = "SELECT event_id, stream_type, payload, enc_nonce, event_hmac, timestamp FROM domain_events WHERE quarantine=0 ORDER BY timestamp DESC LIMIT ?"
-            async with db.execute(query, (limit,)) as cur:
-                async for row in cur:
-                    eid, stype, payload, nonce, ehmac, ts = row
-                    try:
-                        if nonce:
-                            # Decrypt + Verify Chain
-                            plain = EncryptionService.decrypt_event(dek, hmac_key, payload, nonce, ehmac)
-                            data = orjson.loads(plain)
-                            results.append({"id": eid, "type": stype, "payload": data})
-                        else:
-                            # Legacy (Rule #13)
-                            results.append({"id": eid, "type": stype, "payload": orjson.loads(payload), "_legacy": True})
-                    except TamperDetectedError as e:
-                        logger.critical(f"QUARANTINE EVENT {eid}: {e}")
-                        # In real app: UPDATE domain_events SET quarantine=1...
-                        continue
-        return results
+        return [event async for event in self.iter_events(limit=limit)]
+
+    async def close(self) -> None:
+        async with self._connect_lock:
+            for db in self._reader_conns:
+                await db.close()
+            if self._writer is not None:
+                await self._writer.close()
+            self._reader_conns = []
+            self._writer = None
+            self._readers = None
+            self._init_done = False
@@ -0,0 +1,46 @@
+"""
+HASHING.PY - Streamed File Content Hashing
+Sprint 6 Background Services (shared by watcher + indexer)
+
+file_digest() hashes in fixed-size chunks through one reused buffer, so
+memory stays flat for multi-GB files. XXH3-128 when xxhash is installed
+(same optional dependency as indexer.utils.idempotency), blake2b-128
+otherwise; the algorithm is part of the returned string so digests from
+different backends never compare equal.
+"""
+
+import hashlib
+from pathlib import Path
+
+try:
+    import xxhash
+    XXH3_AVAILABLE = True
+except ImportError:
+    XXH3_AVAILABLE = False
+
+DEFAULT_CHUNK_SIZE = 1024 * 1024
+
+
+def file_digest(file_path: str | Path, chunk_size: int = DEFAULT_CHUNK_SIZE) -> str:
+    """
+    Content hash of a file ("xxh3_128:<hex>" or "blake2b:<hex>").
+
+    Raises:
+        OSError: File unreadable
+    """
+    if XXH3_AVAILABLE:
+        hasher = xxhash.xxh3_128()
+        prefix = "xxh3_128"
+    else:
+        hasher = hashlib.blake2b(digest_size=16)
+        prefix = "blake2b"
+
+    buffer = bytearray(chunk_size)
+    view = memoryview(buffer)
+    with open(file_path, "rb") as f:
+        while True:
+            n = f.readinto(buffer)
+            if not n:
+                break
+            hasher.update(view[:n])
+    return f"{prefix}:{hasher.hexdigest()}"
@@ -0,0 +1,174 @@
+"""
+HISTOGRAM.PY - Low-overhead Latency Histograms (HDR-style)
+Task 6.2/6.3/6.5 - Sprint 6 Background Services (shared metrics)
+
+Log-linear buckets over integer microseconds: values below 128us are
+exact, above that each power of two is split into 64 linear sub-buckets
+(~1.6% worst-case relative error). record_ms() is O(1) with no allocation;
+percentiles scan the fixed bucket array. Replaces rolling
+list.append()/pop(0) averages.
+
+Thread-safe for Python 3.14 No-GIL.
+"""
+
+import threading
+import time
+from contextlib import contextmanager
+from typing import Dict, Iterator, List, Optional
+
+_SUB_BITS = 7
+_SUB_COUNT = 1 << _SUB_BITS          # 128 exact buckets
+_HALF = _SUB_COUNT >> 1              # 64 sub-buckets per power of two
+_MAX_US = 3_600_000_000              # values clamp at 1 hour
+
+
+def _bucket_index(value_us: int) -> int:
+    if value_us < _SUB_COUNT:
+        return value_us
+    shift = value_us.bit_length() - _SUB_BITS
+    return _SUB_COUNT + (shift - 1) * _HALF + ((value_us >> shift) - _HALF)
+
+
+def _bucket_upper(index: int) -> int:
+    """Highest value (us) mapped to bucket `index`."""
+    if index < _SUB_COUNT:
+        return index
+    shift = (index - _SUB_COUNT) // _HALF + 1
+    sub = (index - _SUB_COUNT) % _HALF + _HALF
+    return ((sub + 1) << shift) - 1
+
+
+_NUM_BUCKETS = _bucket_index(_MAX_US) + 1
+
+
+class LatencyHistogram:
+    """
+    Fixed-size latency histogram (milliseconds in, milliseconds out).
+
+    Usage:
+        hist = LatencyHistogram()
+        hist.record_ms(12.5)
+        with hist.time():
+            work()
+        hist.percentile(99)  # → ms
+    """
+
+    __slots__ = ("_counts", "_count", "_sum_us", "_max_us", "_lock")
+
+    def __init__(self):
+        self._counts: List[int] = [0] * _NUM_BUCKETS
+        self._count = 0
+        self._sum_us = 0
+        self._max_us = 0
+        self._lock = threading.Lock()
+
+    def record_ms(self, value_ms: float) -> None:
+        """Record one latency sample in milliseconds."""
+        value_us = min(_MAX_US, max(0, int(value_ms * 1000)))
+        index = _bucket_index(value_us)
+        with self._lock:
+            self._counts[index] += 1
+            self._count += 1
+            self._sum_us += value_us
+            if value_us > self._max_us:
+                self._max_us = value_us
+
+    @contextmanager
+    def time(self) -> Iterator[None]:
+        """Record the duration of the with-block."""
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.record_ms((time.perf_counter() - start) * 1000)
+
+    @property
+    def count(self) -> int:
+        with self._lock:
+            return self._count
+
+    def percentile(self, pct: float) -> float:
+        """
+        Value at percentile `pct` (0-100) in ms; 0.0 when empty.
+
+        Reports the bucket's upper bound, capped at the observed max.
+        """
+        with self._lock:
+            return self._percentiles_locked((pct,))[0]
+
+    def _percentiles_locked(self, pcts) -> List[float]:
+        if not self._count:
+            return [0.0] * len(pcts)
+
+        targets = [max(1, -(-self._count * pct // 100)) for pct in pcts]
+        results: List[Optional[float]] = [None] * len(pcts)
+        seen = 0
+        for index, bucket in enumerate(self._counts):
+            if not bucket:
+                continue
+            seen += bucket
+            for i, target in enumerate(targets):
+                if results[i] is None and seen >= target:
+                    results[i] = min(_bucket_upper(index), self._max_us) / 1000
+            if all(r is not None for r in results):
+                break
+        return [r if r is not None else self._max_us / 1000 for r in results]
+
+    def snapshot(self) -> Dict[str, float]:
+        """count, mean/p50/p95/p99/max in ms (one consistent view)."""
+        with self._lock:
+            p50, p95, p99 = self._percentiles_locked((50, 95, 99))
+            mean = self._sum_us / self._count / 1000 if self._count else 0.0
+            return {
+                "count": self._count,
+                "mean_ms": mean,
+                "p50_ms": p50,
+                "p95_ms": p95,
+                "p99_ms": p99,
+                "max_ms": self._max_us / 1000,
+            }
+
+    def reset(self) -> None:
+        with self._lock:
+            self._counts = [0] * _NUM_BUCKETS
+            self._count = 0
+            self._sum_us = 0
+            self._max_us = 0
+
+
+class StageHistograms:
+    """
+    Named LatencyHistograms, one per pipeline stage.
+
+    Usage:
+        stages = StageHistograms()
+        with stages.time("extraction"):
+            ...
+        stages.snapshot()  # → {"extraction": {...}}
+    """
+
+    def __init__(self, *stages: str):
+        self._lock = threading.Lock()
+        self._histograms: Dict[str, LatencyHistogram] = {
+            stage: LatencyHistogram() for stage in stages
+        }
+
+    def get(self, stage: str) -> LatencyHistogram:
+        """Histogram for `stage` (created on first use)."""
+        hist = self._histograms.get(stage)
+        if hist is None:
+            with self._lock:
+                hist = self._histograms.setdefault(stage, LatencyHistogram())
+        return hist
+
+    def record_ms(self, stage: str, value_ms: float) -> None:
+        self.get(stage).record_ms(value_ms)
+
+    def time(self, stage: str):
+        """Context manager recording into `stage`."""
+        return self.get(stage).time()
+
+    def snapshot(self) -> Dict[str, Dict[str, float]]:
+        with self._lock:
+            items = list(self._histograms.items())
+        return {stage: hist.snapshot() for stage, hist in items}
@@ -14,68 +14,129 @@ MDS v3.14 Compliance: Rule #6 (Async/Threaded), Rule #26 (Context Preservation)
 """
 
 import asyncio
-import hashlib
 import time
+from collections import OrderedDict
 from pathlib import Path
-from typing import Dict, Optional, Set
+from typing import Optional, Set, Tuple
 from watchdog.observers import Observer
 from watchdog.events import FileSystemEventHandler, FileSystemEvent
 
-from src.core.utils.paths import PathManager
+from src.core.utils.hashing import file_digest
+from src.core.utils.paths import get_asset_path
 
 
 class WatcherHandler(FileSystemEventHandler):
     """
     Handles file system events with hash-based loop prevention.
     
-    Maintains an in-memory cache of file hashes to avoid responding to
-    changes triggered by the app itself.
+    Remembers the app's own writes to avoid responding to changes
+    triggered by the app itself:
+    - add_pending_write() (before writing): the next change of the path's
+      size/mtime_ns is ours, within PENDING_WRITE_TTL_S
+    - add_self_write() (after writing): the path's (size, mtime_ns,
+      content hash) is ours; only hashed when size and mtime_ns match
+    Every other event costs one stat(), never a read.
     """
     
+    MAX_SELF_WRITES = 256       # remembered self-writes (oldest dropped)
+    MAX_TRACKED_PATHS = 4096    # debounce entries (oldest dropped)
+    PENDING_WRITE_TTL_S = 10.0  # announced write that never lands stops suppressing
+    
     def __init__(self, on_event_callback):
         super().__init__()
         self.on_event_callback = on_event_callback
         self._ignore_hashes: Set[str] = set()
-        self._last_processed: Dict[str, float] = {}
+        # path -> (size, mtime_ns, hash) of a pending self-write
+        self._self_writes: "OrderedDict[str, Tuple[int, int, Optional[str]]]" = OrderedDict()
+        # path -> ((size, mtime_ns) before the write or None, expiry) of an announced write
+        self._pending_writes: "OrderedDict[str, Tuple[Optional[Tuple[int, int]], float]]" = OrderedDict()
+        # path -> monotonic time of last processed event (oldest first)
+        self._last_processed: "OrderedDict[str, float]" = OrderedDict()
         self._debounce_seconds = 0.5
     
     def _get_file_hash(self, path: Path) -> Optional[str]:
-        """Calculate SHA256 hash of file content."""
+        """Content hash, read in chunks (XXH3 when available)."""
         try:
-            with open(path, 'rb') as f:
-                return hashlib.sha256(f.read()).hexdigest()
+            return file_digest(path)
         except Exception:
             return None
     
+    def _is_self_write(self, path: Path) -> bool:
+        """True (and forgotten) if this event is our own recorded write."""
+        key = str(path)
+        entry = self._self_writes.get(key)
+        pending = self._pending_writes.get(key)
+        if entry is None and pending is None and not self._ignore_hashes:
+            return False
+        
+        try:
+            stat = path.stat()
+        except OSError:
+            return False
+        
+        if pending is not None:
+            before, expires = pending
+            if time.monotonic() > expires:
+                del self._pending_writes[key]
+            elif (stat.st_size, stat.st_mtime_ns) != before:
+                del self._pending_writes[key]  # One-time ignore
+                return True
+        
+        if entry is not None:
+            size, mtime_ns, file_hash = entry
+            if (stat.st_size, stat.st_mtime_ns) != (size, mtime_ns):
+                return False  # changed since our write: real event
+            if file_hash is None or self._get_file_hash(path) == file_hash:
+                del self._self_writes[key]  # One-time ignore
+                return True
+            return False
+        
+        # Legacy add_ignore_hash() entries carry no stat: must hash
+        if self._ignore_hashes:
+            file_hash = self._get_file_hash(path)
+            if file_hash and file_hash in self._ignore_hashes:
+                self._ignore_hashes.discard(file_hash)  # One-time ignore
+                return True
+        return False
+    
     def _should_process(self, event: FileSystemEvent) -> bool:
         """
         Determine if event should be processed.
         
         Returns False if:
         - Event is from a directory
-        - File hash matches ignored set (self-write)
+        - File matches a recorded self-write (loop prevention)
         - Event fired too soon after previous (debounce)
         """
         if event.is_directory:
             return False
         
         path = Path(event.src_path)
-        now = time.time()
+        now = time.monotonic()
         
         # Debounce: ignore rapid-fire events
         last_time = self._last_processed.get(event.src_path, 0)
         if now - last_time < self._debounce_seconds:
             return False
         
-        # Hash check: ignore if we just wrote this file
-        file_hash = self._get_file_hash(path)
-        if file_hash and file_hash in self._ignore_hashes:
-            self._ignore_hashes.discard(file_hash)  # One-time ignore
+        # Self-write check: ignore if we just wrote this file
+        if self._is_self_write(path):
             return False
         
         self._last_processed[event.src_path] = now
+        self._last_processed.move_to_end(event.src_path)
+        self._prune_last_processed(now)
         return True
     
+    def _prune_last_processed(self, now: float) -> None:
+        """Entries past the debounce window are useless: drop them (oldest first)."""
+        cutoff = now - self._debounce_seconds
+        while self._last_processed:
+            oldest_path, oldest_time = next(iter(self._last_processed.items()))
+            if oldest_time >= cutoff and len(self._last_processed) <= self.MAX_TRACKED_PATHS:
+                break
+            del self._last_processed[oldest_path]
+    
     def on_modified(self, event: FileSystemEvent):
         """Handle file modification events."""
         if self._should_process(event):
@@ -92,8 +153,37 @@ class WatcherHandler(FileSystemEventHandler):
             self.on_event_callback('deleted', event.src_path)
     
     def add_ignore_hash(self, file_hash: str):
-        """Mark a file hash to be ignored on next event (loop prevention)."""
+        """
+        Mark a file hash to be ignored on next event (loop prevention).
+        
+        Prefer add_self_write(): a bare hash forces every event to be hashed.
+        """
         self._ignore_hashes.add(file_hash)
+    
+    def add_pending_write(self, path: Path) -> None:
+        """Announce a write about to happen: its first visible change is ignored."""
+        try:
+            stat = path.stat()
+            before = (stat.st_size, stat.st_mtime_ns)
+        except OSError:
+            before = None  # Not created yet
+        key = str(path)
+        self._pending_writes[key] = (before, time.monotonic() + self.PENDING_WRITE_TTL_S)
+        self._pending_writes.move_to_end(key)
+        while len(self._pending_writes) > self.MAX_SELF_WRITES:
+            self._pending_writes.popitem(last=False)
+    
+    def add_self_write(self, path: Path) -> None:
+        """Record path's current (size, mtime_ns, hash) as our own finished write."""
+        try:
+            stat = path.stat()
+        except OSError:
+            return
+        key = str(path)
+        self._self_writes[key] = (stat.st_size, stat.st_mtime_ns, self._get_file_hash(path))
+        self._self_writes.move_to_end(key)
+        while len(self._self_writes) > self.MAX_SELF_WRITES:
+            self._self_writes.popitem(last=False)
 
 
 class AssetWatcher:
@@ -108,7 +198,7 @@ class AssetWatcher:
     """
     
     def __init__(self, watch_path: Optional[Path] = None):
-        self.watch_path = watch_path or (PathManager.get_app_root() / "assets")
+        self.watch_path = watch_path or get_asset_path("assets")
         self.observer: Optional[Observer] = None
         self.handler: Optional[WatcherHandler] = None
         self._is_running = False
@@ -167,12 +257,11 @@ class AssetWatcher:
         """
         Mark the next write to this file to be ignored.
         
-        Call this before writing a file to prevent self-triggering.
+        Call this before writing a file to prevent self-triggering (a
+        write already finished can use handler.add_self_write()).
         """
         if self.handler:
-            file_hash = self.handler._get_file_hash(file_path)
-            if file_hash:
-                self.handler.add_ignore_hash(file_hash)
+            self.handler.add_pending_write(Path(file_path))
 
 
 if __name__ == "__main__":
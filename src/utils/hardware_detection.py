@@ -0,0 +1,158 @@
+"""
+HARDWARE_DETECTION.PY - Host Capabilities for Startup Tuning
+
+detect_hardware() answers four questions, stdlib only (psutil used when
+installed, never required):
+    - logical CPU cores (affinity-aware where the OS exposes it)
+    - total physical RAM
+    - disk type under the data directory: "ssd", "hdd" or "unknown"
+      (Linux: /sys/dev/block/<maj:min>/queue/rotational; elsewhere unknown)
+    - free-threaded Python (3.13t+ build, GIL actually disabled at runtime)
+
+Every probe degrades to a conservative fallback instead of raising:
+startup must never fail because /sys is missing or a call is sandboxed.
+"""
+
+import ctypes
+import os
+import platform
+import sys
+import sysconfig
+from dataclasses import asdict, dataclass
+from pathlib import Path
+from typing import Any, Dict, Optional
+
+DISK_SSD = "ssd"
+DISK_HDD = "hdd"
+DISK_UNKNOWN = "unknown"
+
+# Used when the RAM probe fails: assume a low-end laptop
+FALLBACK_RAM_BYTES = 4 * 1024 ** 3
+
+
+@dataclass(frozen=True)
+class HardwareInfo:
+    """Snapshot of the host, taken once at startup."""
+    cpu_count: int
+    ram_bytes: int
+    disk_type: str                  # "ssd" | "hdd" | "unknown"
+    free_threaded: bool             # Py_GIL_DISABLED build with the GIL off
+    gil_disabled_build: bool        # Py_GIL_DISABLED build (GIL may be re-enabled)
+    python_version: str
+    platform: str
+
+    @property
+    def ram_gb(self) -> float:
+        return self.ram_bytes / 1024 ** 3
+
+    def to_dict(self) -> Dict[str, Any]:
+        info = asdict(self)
+        info["ram_gb"] = round(self.ram_gb, 1)
+        return info
+
+
+def cpu_count() -> int:
+    """Cores this process may run on (sched affinity / cgroup-pinned), >= 1."""
+    if hasattr(os, "process_cpu_count"):  # 3.13+
+        count = os.process_cpu_count()
+    elif hasattr(os, "sched_getaffinity"):
+        try:
+            count = len(os.sched_getaffinity(0))
+        except OSError:
+            count = os.cpu_count()
+    else:
+        count = os.cpu_count()
+    return max(1, count or 1)
+
+
+def total_ram_bytes() -> int:
+    """Physical RAM in bytes (FALLBACK_RAM_BYTES if it cannot be read)."""
+    try:
+        import psutil
+        return int(psutil.virtual_memory().total)
+    except Exception:
+        pass
+
+    if sys.platform == "win32":
+        class _MemoryStatusEx(ctypes.Structure):
+            _fields_ = [
+                ("dwLength", ctypes.c_ulong),
+                ("dwMemoryLoad", ctypes.c_ulong),
+                ("ullTotalPhys", ctypes.c_ulonglong),
+                ("ullAvailPhys", ctypes.c_ulonglong),
+                ("ullTotalPageFile", ctypes.c_ulonglong),
+                ("ullAvailPageFile", ctypes.c_ulonglong),
+                ("ullTotalVirtual", ctypes.c_ulonglong),
+                ("ullAvailVirtual", ctypes.c_ulonglong),
+                ("ullAvailExtendedVirtual", ctypes.c_ulonglong),
+            ]
+        try:
+            status = _MemoryStatusEx()
+            status.dwLength = ctypes.sizeof(_MemoryStatusEx)
+            if ctypes.windll.kernel32.GlobalMemoryStatusEx(ctypes.byref(status)):
+                return int(status.ullTotalPhys)
+        except Exception:
+            pass
+        return FALLBACK_RAM_BYTES
+
+    # Linux / macOS / BSD
+    try:
+        return int(os.sysconf("SC_PAGE_SIZE") * os.sysconf("SC_PHYS_PAGES"))
+    except (ValueError, OSError, AttributeError):
+        return FALLBACK_RAM_BYTES
+
+
+def disk_type(path: Path) -> str:
+    """
+    "ssd"/"hdd" for the block device holding `path` (nearest existing
+    parent), "unknown" where it can't be told (non-Linux, network/overlay
+    filesystems, containers without /sys).
+    """
+    if not sys.platform.startswith("linux"):
+        return DISK_UNKNOWN
+    path = Path(path).absolute()
+    while not path.exists() and path != path.parent:
+        path = path.parent
+    try:
+        dev = os.stat(path).st_dev
+        device = Path(f"/sys/dev/block/{os.major(dev)}:{os.minor(dev)}").resolve()
+        # Partitions have no queue/: the disk is the parent directory
+        for candidate in (device, device.parent):
+            rotational = candidate / "queue" / "rotational"
+            if rotational.exists():
+                return DISK_HDD if rotational.read_text().strip() == "1" else DISK_SSD
+    except (OSError, ValueError):
+        pass
+    return DISK_UNKNOWN
+
+
+def gil_disabled_build() -> bool:
+    """Interpreter compiled free-threaded (python3.13t / 3.14t)."""
+    return bool(sysconfig.get_config_var("Py_GIL_DISABLED"))
+
+
+def is_free_threaded() -> bool:
+    """Free-threaded build AND the GIL is off right now (PYTHON_GIL=0, no C ext re-enabled it)."""
+    if not gil_disabled_build():
+        return False
+    is_gil_enabled = getattr(sys, "_is_gil_enabled", None)
+    return is_gil_enabled is not None and not is_gil_enabled()
+
+
+def detect_hardware(data_dir: Optional[Path] = None) -> HardwareInfo:
+    """
+    Probe the host.
+
+    Args:
+        data_dir: Where the vault/index live - its disk decides "ssd"/"hdd"
+            (default: ./data)
+    """
+    return HardwareInfo(
+        cpu_count=cpu_count(),
+        ram_bytes=total_ram_bytes(),
+        disk_type=disk_type(data_dir if data_dir is not None else Path("data")),
+        free_threaded=is_free_threaded(),
+        gil_disabled_build=gil_disabled_build(),
+        python_version=platform.python_version(),
+        platform=sys.platform,
+    )
@@ -0,0 +1,253 @@
+"""
+TUNING.PY - Hardware-Aware Startup Tuning Profile
+
+Worker counts and buffer sizes derived once from detect_hardware(), so a
+4-core/8 GB laptop and a 32-core workstation each get sensible values
+instead of one hard-coded set.
+
+Rules (c = cores, r = RAM GB, ft = free-threaded, hdd = spinning data disk):
+    eventbus_workers           clamp(c*2, 4, 32)     (was c*2, unbounded)
+    eventbus_queue_size        50K r<4 | 100K r<8 | 200K r<32 | 500K
+    eventbus_shards            ft: min(c, 16)  else 1 (one lock is uncontended under the GIL)
+    indexer_batch_size         hdd: 500  else 100    (fewer fsyncs per event)
+    indexer_flush_timeout_ms   hdd: 1000 else 500
+    indexer_multi_consumer     ft and c >= 4
+    sandbox_memory_limit_mb    clamp(RAM/16, 256, 2048)   (512 on 8 GB)
+    extraction_workers         clamp(c-1, 1, RAM/2 / sandbox cap)
+    pdf_concurrency            clamp(r/2, 1, extraction_workers)  (3 on 4 cores/8 GB)
+    chain_verifier_workers     ft: clamp(c/2, 2, 8)  else 2 (HMAC loop holds the GIL)
+    storage_read_connections   hdd: 2  else clamp(c/2, 2, 8)
+
+Overrides, lowest to highest precedence: derived → `overrides` (app
+config) → CONVERT_TUNING_<FIELD> environment variables. The active
+profile is reported under "tuning" by GET /events/metrics.
+
+Usage (startup):
+    profile = configure_tuning(overrides=config.get("tuning"))
+    bus = HeavyEventBus(name="main", **profile.eventbus_kwargs())
+    queue = IndexerQueue(**profile.indexer_queue_kwargs())
+    pipeline = ExtractionPipeline(db, sandbox=sandbox, **profile.pipeline_kwargs())
+"""
+
+import os
+import threading
+from dataclasses import dataclass, field, fields
+from pathlib import Path
+from typing import Any, Dict, Mapping, Optional
+
+from .hardware_detection import DISK_HDD, HardwareInfo, detect_hardware
+
+ENV_PREFIX = "CONVERT_TUNING_"
+
+SOURCE_DERIVED = "derived"
+SOURCE_CONFIG = "config"
+SOURCE_ENV = "env"
+
+_TRUE = {"1", "true", "yes", "on"}
+_FALSE = {"0", "false", "no", "off"}
+
+
+def _clamp(value: int, low: int, high: int) -> int:
+    return max(low, min(high, value))
+
+
+@dataclass
+class TuningProfile:
+    """Derived parameters + where each value came from."""
+    eventbus_workers: int
+    eventbus_queue_size: int
+    eventbus_shards: int
+    indexer_batch_size: int
+    indexer_flush_timeout_ms: int
+    indexer_multi_consumer: bool
+    sandbox_memory_limit_mb: int
+    extraction_workers: int
+    pdf_concurrency: int
+    chain_verifier_workers: int
+    storage_read_connections: int
+
+    hardware: Optional[HardwareInfo] = field(default=None, compare=False)
+    sources: Dict[str, str] = field(default_factory=dict, compare=False)
+
+    @classmethod
+    def parameter_names(cls) -> list:
+        return [f.name for f in fields(cls) if f.name not in ("hardware", "sources")]
+
+    # -------------------------------------------------------------------
+    # COMPONENT KWARGS
+    # -------------------------------------------------------------------
+
+    def eventbus_kwargs(self) -> Dict[str, Any]:
+        """HeavyEventBus(...) - overflow="block"/"spool" callers must pass shards=1."""
+        return {
+            "max_workers": self.eventbus_workers,
+            "max_queue_size": self.eventbus_queue_size,
+            "shards": self.eventbus_shards,
+        }
+
+    def indexer_queue_kwargs(self) -> Dict[str, Any]:
+        """IndexerQueue(...)"""
+        return {
+            "batch_size": self.indexer_batch_size,
+            "flush_timeout_ms": self.indexer_flush_timeout_ms,
+            "multi_consumer": self.indexer_multi_consumer,
+        }
+
+    def sandbox_kwargs(self) -> Dict[str, Any]:
+        """SandboxExecutor(...)"""
+        return {"memory_limit_mb": self.sandbox_memory_limit_mb}
+
+    def pipeline_kwargs(self) -> Dict[str, Any]:
+        """ExtractionPipeline(db, ...) - process_many defaults"""
+        return {
+            "max_workers": self.extraction_workers,
+            "mime_limits": {"application/pdf": self.pdf_concurrency},
+        }
+
+    def chain_verifier_kwargs(self) -> Dict[str, Any]:
+        """BackgroundChainVerifier(adapter, ...)"""
+        return {"max_workers": self.chain_verifier_workers}
+
+    def storage_adapter_kwargs(self) -> Dict[str, Any]:
+        """StorageAdapter(db_path, kms, ...)"""
+        return {"read_connections": self.storage_read_connections}
+
+    # -------------------------------------------------------------------
+    # REPORTING
+    # -------------------------------------------------------------------
+
+    def snapshot(self) -> Dict[str, Any]:
+        """Metrics view: hardware, chosen parameters, per-parameter source."""
+        return {
+            "hardware": self.hardware.to_dict() if self.hardware else None,
+            "parameters": {name: getattr(self, name) for name in self.parameter_names()},
+            "sources": dict(self.sources),
+        }
+
+
+def derive_parameters(hw: HardwareInfo) -> Dict[str, Any]:
+    """Rule table of the module docstring, applied to `hw`."""
+    cores = hw.cpu_count
+    ram_gb = hw.ram_gb
+    ram_mb = hw.ram_bytes // (1024 * 1024)
+    hdd = hw.disk_type == DISK_HDD
+    ft = hw.free_threaded
+
+    if ram_gb < 4:
+        queue_size = 50_000
+    elif ram_gb < 8:
+        queue_size = 100_000
+    elif ram_gb < 32:
+        queue_size = 200_000
+    else:
+        queue_size = 500_000
+
+    sandbox_mb = _clamp(ram_mb // 16, 256, 2048)
+    # Every extraction worker may grow to the sandbox cap: keep the sum
+    # within half of RAM
+    extraction_workers = _clamp(cores - 1, 1, max(1, (ram_mb // 2) // sandbox_mb))
+
+    return {
+        "eventbus_workers": _clamp(cores * 2, 4, 32),
+        "eventbus_queue_size": queue_size,
+        "eventbus_shards": min(cores, 16) if ft else 1,
+        "indexer_batch_size": 500 if hdd else 100,
+        "indexer_flush_timeout_ms": 1000 if hdd else 500,
+        "indexer_multi_consumer": ft and cores >= 4,
+        "sandbox_memory_limit_mb": sandbox_mb,
+        "extraction_workers": extraction_workers,
+        "pdf_concurrency": _clamp(int(ram_gb // 2), 1, extraction_workers),
+        "chain_verifier_workers": _clamp(cores // 2, 2, 8) if ft else 2,
+        "storage_read_connections": 2 if hdd else _clamp(cores // 2, 2, 8),
+    }
+
+
+def _coerce(name: str, value: Any, kind: type) -> Any:
+    """Config/env value → field type. Raises ValueError on bad input."""
+    if kind is bool:
+        if isinstance(value, bool):
+            return value
+        text = str(value).strip().lower()
+        if text in _TRUE:
+            return True
+        if text in _FALSE:
+            return False
+        raise ValueError(f"Tuning override {name}: expected a boolean, got {value!r}")
+    try:
+        number = int(value)
+    except (TypeError, ValueError):
+        raise ValueError(f"Tuning override {name}: expected an integer, got {value!r}") from None
+    if isinstance(value, bool) or number < 1:
+        raise ValueError(f"Tuning override {name}: must be a positive integer, got {value!r}")
+    return number
+
+
+def build_profile(
+    hardware: Optional[HardwareInfo] = None,
+    overrides: Optional[Mapping[str, Any]] = None,
+    environ: Optional[Mapping[str, str]] = None,
+    data_dir: Optional[Path] = None
+) -> TuningProfile:
+    """
+    Derive a profile and apply overrides.
+
+    Args:
+        hardware: Host info (default: detect_hardware(data_dir))
+        overrides: {parameter: value} from the app config
+        environ: CONVERT_TUNING_* lookup (default: os.environ)
+        data_dir: Disk probed for ssd/hdd when hardware is None
+
+    Raises:
+        ValueError: Unknown parameter in `overrides`, or a value that is
+            not a positive integer / boolean
+    """
+    hw = hardware or detect_hardware(data_dir)
+    values = derive_parameters(hw)
+    sources = dict.fromkeys(values, SOURCE_DERIVED)
+    kinds = {f.name: (bool if f.type in (bool, "bool") else int) for f in fields(TuningProfile)}
+
+    unknown = set(overrides or {}) - set(values)
+    if unknown:
+        raise ValueError(f"Unknown tuning parameter(s): {', '.join(sorted(unknown))}")
+    for name, value in (overrides or {}).items():
+        values[name] = _coerce(name, value, kinds[name])
+        sources[name] = SOURCE_CONFIG
+
+    env = os.environ if environ is None else environ
+    for name in values:
+        raw = env.get(ENV_PREFIX + name.upper())
+        if raw is not None and raw != "":
+            values[name] = _coerce(ENV_PREFIX + name.upper(), raw, kinds[name])
+            sources[name] = SOURCE_ENV
+
+    return TuningProfile(**values, hardware=hw, sources=sources)
+
+
+# -------------------------------------------------------------------
+# ACTIVE PROFILE (process-wide)
+# -------------------------------------------------------------------
+
+_active: Optional[TuningProfile] = None
+_active_lock = threading.Lock()
+
+
+def configure_tuning(
+    overrides: Optional[Mapping[str, Any]] = None,
+    data_dir: Optional[Path] = None,
+    hardware: Optional[HardwareInfo] = None
+) -> TuningProfile:
+    """Build the profile once at startup and make it the active one."""
+    global _active
+    profile = build_profile(hardware=hardware, overrides=overrides, data_dir=data_dir)
+    with _active_lock:
+        _active = profile
+    return profile
+
+
+def get_tuning_profile() -> TuningProfile:
+    """Active profile (derived without overrides if configure_tuning() never ran)."""
+    global _active
+    with _active_lock:
+        if _active is None:
+            _active = build_profile()
+        return _active
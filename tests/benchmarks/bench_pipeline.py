@@ -0,0 +1,452 @@
+"""
+BENCH_PIPELINE.PY - Indexing Pipeline Benchmark + Regression Gate
+
+Scenarios:
+    storm     Event storm: HeavyEventBus → IndexerQueue (batch subscription)
+              → consumer claims. events/s, publish→claim latency, drops.
+    pipeline  Synthetic PDF/DOCX corpus: Watchdog → EventBus → IndexerQueue
+              → ExtractionPipeline → FTS5. docs/s, per-stage latency
+              percentiles, FTS sanity query.
+
+Results are one JSON document: "metrics" is a flat {name: value} map, the
+gate compares it against a stored baseline (GATES: direction + absolute
+slack, so sub-millisecond jitter never fails a run). Peak RSS is the
+process high-water mark after each scenario.
+
+Usage:
+    python -m tests.benchmarks.bench_pipeline --docs 200 --size-kb 32 \\
+        --event-rate 500 --out bench.json --baseline tests/benchmarks/baseline.json
+    # Record a new baseline (on the CI runner, real extractors installed):
+    python -m tests.benchmarks.bench_pipeline --update-baseline
+
+No baseline is committed: numbers from a developer machine or with the
+corpus stub extractors say nothing about the CI runner. Without one the
+run reports its results and exits 0.
+
+Exit codes: 0 = pass, 1 = regression, 2 = baseline not comparable
+(different parameters, extractors or host - re-record it).
+"""
+
+import argparse
+import json
+import os
+import platform
+import sys
+import tempfile
+import threading
+import time
+from pathlib import Path
+from typing import Any, Dict, List, Optional, Tuple
+
+from src.core.services.eventbus import HeavyEventBus
+from src.core.indexer.queue import IndexerQueue
+from src.core.indexer.pipeline import ExtractionPipeline
+from src.core.indexer.encrypted_storage import EncryptedIndexerDB
+from src.core.indexer.extractors import docx_extractor, pdf_extractor
+from src.core.utils.histogram import LatencyHistogram, StageHistograms
+
+from .corpus import DOCX_MIME, PDF_MIME, CorpusTextExtractor, WordSource, generate_corpus
+
+SCHEMA_VERSION = 1
+DEFAULT_BASELINE = Path(__file__).with_name("baseline.json")
+DEFAULT_THRESHOLD = 0.20
+
+# Gated metrics: name -> (direction, absolute slack). A change must exceed
+# both threshold * baseline and the slack to count as a regression.
+GATES: Dict[str, Tuple[str, float]] = {
+    "storm.events_per_s": ("higher", 0.0),
+    "storm.latency_p95_ms": ("lower", 5.0),
+    "storm.events_dropped": ("lower", 0.0),
+    "pipeline.docs_per_s": ("higher", 0.0),
+    "pipeline.end_to_end_p95_ms": ("lower", 25.0),
+    "pipeline.extraction_p95_ms": ("lower", 1.0),
+    "pipeline.fts_commit_p95_ms": ("lower", 1.0),
+    "peak_rss_mb": ("lower", 16.0),
+}
+
+# Baseline must match on these for the numbers to mean anything
+_COMPARABLE_KEYS = ("params", "extractors")
+# ... and on these host fields (not the full platform string: a kernel
+# patch release on the runner image would invalidate every baseline)
+_COMPARABLE_HOST = ("cpu_count", "system", "machine")
+
+BUS_DRAIN_TIMEOUT_S = 60.0
+
+
+def peak_rss_mb() -> Optional[float]:
+    """Process peak RSS (ru_maxrss: KB on Linux, bytes on macOS)."""
+    try:
+        import resource
+    except ImportError:  # Windows
+        try:
+            import psutil
+            return psutil.Process().memory_info().peak_wset / (1024 * 1024)
+        except Exception:
+            return None
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    if sys.platform == "darwin":
+        return peak / (1024 * 1024)
+    return peak / 1024
+
+
+def _pace(start: float, n: int, rate: float) -> None:
+    """Sleep until event n of a `rate`/s schedule is due (rate <= 0: no pacing)."""
+    if rate <= 0:
+        return
+    delay = start + n / rate - time.perf_counter()
+    if delay > 0:
+        time.sleep(delay)
+
+
+# -------------------------------------------------------------------
+# SCENARIO: EVENT STORM
+# -------------------------------------------------------------------
+
+def run_event_storm(workdir: Path, events: int, rate: float) -> Dict[str, Any]:
+    """Publish `events` at `rate`/s, consume every persisted batch."""
+    bus = HeavyEventBus(name="bench-storm")
+    queue = IndexerQueue(db_path=str(workdir / "storm_queue.db"), retention_s=None)
+    latency = LatencyHistogram()
+    consumed = [0]
+    done = threading.Event()
+
+    def consume():
+        while not done.is_set() or consumed[0] < events:
+            batch = queue.get_next_batch(timeout=0.2)
+            if batch is None:
+                # Dropped events never arrive: stop once the rest has
+                if done.is_set() and (
+                    consumed[0] + bus.metrics().events_dropped >= events
+                    or time.perf_counter() > drain_deadline[0]
+                ):
+                    return
+                continue
+            now = time.perf_counter()
+            for event in batch.events:
+                latency.record_ms((now - event["t"]) * 1000)
+            consumed[0] += batch.event_count
+            queue.mark_batch_done(batch.batch_id)
+
+    drain_deadline = [float("inf")]
+    queue.start()
+    bus.start()
+    queue.subscribe_to_eventbus(bus, batch=True)
+    consumer = threading.Thread(target=consume, name="bench-storm-consumer", daemon=True)
+    consumer.start()
+
+    try:
+        start = time.perf_counter()
+        for n in range(events):
+            _pace(start, n, rate)
+            bus.publish({"event_id": f"storm-{n}", "t": time.perf_counter()})
+        publish_s = time.perf_counter() - start
+
+        drain_deadline[0] = time.perf_counter() + BUS_DRAIN_TIMEOUT_S
+        done.set()
+        consumer.join(timeout=BUS_DRAIN_TIMEOUT_S + 1)
+        elapsed = time.perf_counter() - start
+        dropped = bus.metrics().events_dropped
+    finally:
+        bus.stop()
+        queue.stop()
+
+    snap = latency.snapshot()
+    return {
+        "events": events,
+        "consumed": consumed[0],
+        "events_dropped": dropped,
+        "publish_s": publish_s,
+        "elapsed_s": elapsed,
+        "events_per_s": consumed[0] / elapsed if elapsed > 0 else 0.0,
+        "latency_ms": snap,
+        "peak_rss_mb": peak_rss_mb(),
+    }
+
+
+# -------------------------------------------------------------------
+# SCENARIO: END-TO-END PIPELINE
+# -------------------------------------------------------------------
+
+def install_extractors(pipeline: ExtractionPipeline) -> Dict[str, str]:
+    """
+    Real extractors where their library is installed, CorpusTextExtractor
+    otherwise. Returns {mime: extractor name} for the results.
+    """
+    available = {
+        PDF_MIME: pdf_extractor.PYMUPDF_AVAILABLE,
+        DOCX_MIME: docx_extractor.PYTHON_DOCX_AVAILABLE or docx_extractor.RUST_DOCX_AVAILABLE,
+    }
+    names = {}
+    for mime, ok in available.items():
+        extractor = pipeline.registry.get_extractor(mime) if ok else None
+        if extractor is None:
+            extractor = CorpusTextExtractor(mime)
+            pipeline.registry._extractors[mime] = extractor
+        names[mime] = getattr(extractor, "EXTRACTOR_NAME", type(extractor).__name__)
+    return names
+
+
+def run_pipeline(
+    workdir: Path,
+    docs: int,
+    size_kb: int,
+    rate: float,
+    seed: int,
+    debounce_ms: int = 50
+) -> Dict[str, Any]:
+    """Index a generated corpus, events injected through the watchdog."""
+    from src.core.services.watchdog import WatchdogService  # needs the watchdog package
+
+    files = generate_corpus(workdir, docs, size_kb, seed=seed)
+    probe = WordSource(seed).words(1)[0]  # first word written: must be searchable
+
+    stages = StageHistograms("watchdog", "eventbus_queue", "pipeline", "end_to_end")
+    injected: Dict[str, float] = {}
+    statuses: Dict[str, int] = {}
+    extractors: Dict[str, str] = {}
+    pipeline_latency: Dict[str, Any] = {}
+    fts_hits = [0]
+    ready = threading.Event()
+    finished = threading.Event()
+    seq = [0]
+
+    bus = HeavyEventBus(name="bench-pipeline")
+    queue = IndexerQueue(db_path=str(workdir / "pipeline_queue.db"), retention_s=None)
+
+    def on_batch_ready(batch):
+        now = time.perf_counter()
+        for event in batch:
+            stages.record_ms("watchdog", (now - injected[event.path]) * 1000)
+            seq[0] += 1
+            bus.publish({
+                "event_id": f"file-{seq[0]}",
+                "path": event.path,
+                "injected_at": injected[event.path],
+                "published_at": now,
+            })
+
+    def consume():
+        # Single writer: the db connection belongs to this thread
+        db = EncryptedIndexerDB(workdir / "bench_index.db", key=b"0" * 32)
+        db.connect()
+        pipeline = ExtractionPipeline(db)
+        pipeline.fts_writer.ensure_schema()
+        extractors.update(install_extractors(pipeline))
+        ready.set()
+        try:
+            indexed = 0
+            deadline = time.perf_counter() + BUS_DRAIN_TIMEOUT_S + docs / max(rate, 1.0)
+            while indexed < docs and time.perf_counter() < deadline:
+                batch = queue.get_next_batch(timeout=0.2)
+                if batch is None:
+                    continue
+                for event in batch.events:
+                    claimed = time.perf_counter()
+                    stages.record_ms("eventbus_queue", (claimed - event["published_at"]) * 1000)
+                    status = pipeline.process_file(event["path"])
+                    now = time.perf_counter()
+                    stages.record_ms("pipeline", (now - claimed) * 1000)
+                    stages.record_ms("end_to_end", (now - event["injected_at"]) * 1000)
+                    statuses[status.name] = statuses.get(status.name, 0) + 1
+                    indexed += 1
+                queue.mark_batch_done(batch.batch_id)
+            pipeline_latency.update(pipeline.latency.snapshot())
+            fts_hits[0] = db.execute(
+                "SELECT COUNT(*) FROM document_content WHERE document_content MATCH ?", (probe,)
+            ).fetchone()[0]
+        finally:
+            pipeline.shutdown()
+            db.close()
+            finished.set()
+
+    watchdog = WatchdogService(str(workdir / "corpus"), debounce_ms=debounce_ms, on_batch_ready=on_batch_ready)
+    queue.start()
+    bus.start()
+    queue.subscribe_to_eventbus(bus, batch=True)
+    consumer = threading.Thread(target=consume, name="bench-pipeline-consumer", daemon=True)
+    consumer.start()
+    ready.wait(timeout=30)
+    watchdog.start()
+
+    try:
+        start = time.perf_counter()
+        for n, (path, _mime) in enumerate(files):
+            _pace(start, n, rate)
+            posix = path.as_posix()
+            injected[posix] = time.perf_counter()
+            # Same entry point the observer's handler calls
+            watchdog._on_file_event(posix, "created")
+        finished.wait()
+        elapsed = time.perf_counter() - start
+    finally:
+        watchdog.stop()
+        bus.stop()
+        queue.stop()
+
+    indexed = sum(statuses.values())
+    return {
+        "docs": docs,
+        "indexed": indexed,
+        "statuses": statuses,
+        "elapsed_s": elapsed,
+        "docs_per_s": indexed / elapsed if elapsed > 0 else 0.0,
+        "corpus_mb": sum(p.stat().st_size for p, _ in files) / (1024 * 1024),
+        "stages_ms": stages.snapshot(),
+        "pipeline_stages_ms": pipeline_latency,
+        "extractors": extractors,
+        "fts_probe": {"term": probe, "hits": fts_hits[0]},
+        "peak_rss_mb": peak_rss_mb(),
+    }
+
+
+# -------------------------------------------------------------------
+# RESULTS + GATE
+# -------------------------------------------------------------------
+
+def flatten_metrics(storm: Dict[str, Any], pipe: Dict[str, Any]) -> Dict[str, float]:
+    """The gated numbers, as one flat map."""
+    stages = pipe["stages_ms"]
+    pipe_stages = pipe["pipeline_stages_ms"]
+    return {
+        "storm.events_per_s": storm["events_per_s"],
+        "storm.latency_p95_ms": storm["latency_ms"]["p95_ms"],
+        "storm.events_dropped": storm["events_dropped"],
+        "pipeline.docs_per_s": pipe["docs_per_s"],
+        "pipeline.watchdog_p95_ms": stages["watchdog"]["p95_ms"],
+        "pipeline.eventbus_queue_p95_ms": stages["eventbus_queue"]["p95_ms"],
+        "pipeline.end_to_end_p95_ms": stages["end_to_end"]["p95_ms"],
+        "pipeline.extraction_p95_ms": pipe_stages.get("extraction", {}).get("p95_ms", 0.0),
+        "pipeline.fts_commit_p95_ms": pipe_stages.get("fts_commit", {}).get("p95_ms", 0.0),
+        "peak_rss_mb": pipe["peak_rss_mb"] or 0.0,
+    }
+
+
+def compare(
+    results: Dict[str, Any],
+    baseline: Dict[str, Any],
+    threshold: float = DEFAULT_THRESHOLD
+) -> List[Dict[str, Any]]:
+    """
+    Gated metrics that regressed by more than `threshold` (relative) and
+    their GATES slack (absolute). Metrics missing on either side are skipped.
+
+    Raises:
+        ValueError: Baseline recorded with other parameters/extractors or
+            on another kind of host
+    """
+    for key in _COMPARABLE_KEYS:
+        if results.get(key) != baseline.get(key):
+            raise ValueError(
+                f"Baseline not comparable ({key}): {baseline.get(key)} != {results.get(key)}"
+            )
+    host, base_host = results.get("host") or {}, baseline.get("host") or {}
+    for key in _COMPARABLE_HOST:
+        if host.get(key) != base_host.get(key):
+            raise ValueError(
+                f"Baseline not comparable (host.{key}): {base_host.get(key)} != {host.get(key)}"
+            )
+
+    regressions = []
+    current, base = results["metrics"], baseline["metrics"]
+    for name, (direction, slack) in GATES.items():
+        if name not in current or name not in base:
+            continue
+        new, old = current[name], base[name]
+        allowed = max(abs(old) * threshold, slack)
+        worse = (old - new) if direction == "higher" else (new - old)
+        if worse > allowed:
+            regressions.append({
+                "metric": name,
+                "baseline": old,
+                "current": new,
+                "change": (new - old) / old if old else float("inf"),
+            })
+    return regressions
+
+
+def run(args: argparse.Namespace) -> Dict[str, Any]:
+    with tempfile.TemporaryDirectory(prefix="convert-bench-") as tmp:
+        workdir = Path(tmp)
+        storm = run_event_storm(workdir, args.storm_events, args.storm_rate)
+        pipe = run_pipeline(workdir, args.docs, args.size_kb, args.event_rate, args.seed)
+
+    return {
+        "schema": SCHEMA_VERSION,
+        "recorded_at": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+        "host": {
+            "python": platform.python_version(),
+            "platform": platform.platform(),
+            "system": platform.system(),
+            "machine": platform.machine(),
+            "cpu_count": os.cpu_count(),
+        },
+        "params": {
+            "docs": args.docs,
+            "size_kb": args.size_kb,
+            "event_rate": args.event_rate,
+            "storm_events": args.storm_events,
+            "storm_rate": args.storm_rate,
+            "seed": args.seed,
+        },
+        "extractors": pipe["extractors"],
+        "metrics": flatten_metrics(storm, pipe),
+        "scenarios": {"storm": storm, "pipeline": pipe},
+    }
+
+
+def _parse_args(argv: Optional[List[str]]) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Indexing pipeline benchmark + regression gate")
+    parser.add_argument("--docs", type=int, default=200, help="Corpus documents (default: 200)")
+    parser.add_argument("--size-kb", type=int, default=32, help="Text per document in KB (default: 32)")
+    parser.add_argument("--event-rate", type=float, default=0, help="Watchdog events/s (0 = unpaced)")
+    parser.add_argument("--storm-events", type=int, default=50_000, help="Event storm size (default: 50000)")
+    parser.add_argument("--storm-rate", type=float, default=0, help="Storm events/s (0 = unpaced)")
+    parser.add_argument("--seed", type=int, default=1337)
+    parser.add_argument("--out", type=Path, help="Write results JSON here")
+    parser.add_argument("--baseline", type=Path, default=DEFAULT_BASELINE)
+    parser.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD,
+                        help="Allowed relative regression (default: 0.20)")
+    parser.add_argument("--update-baseline", action="store_true", help="Store results as the new baseline")
+    return parser.parse_args(argv)
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    args = _parse_args(argv)
+    results = run(args)
+    text = json.dumps(results, indent=2, sort_keys=True)
+    if args.out:
+        args.out.write_text(text + "\n")
+
+    pipe = results["scenarios"]["pipeline"]
+    print(f"📊 [BENCH] storm {results['metrics']['storm.events_per_s']:,.0f} events/s, "
+          f"pipeline {results['metrics']['pipeline.docs_per_s']:,.1f} docs/s, "
+          f"peak RSS {results['metrics']['peak_rss_mb']:.0f} MB")
+    if pipe["indexed"] < pipe["docs"] or pipe["fts_probe"]["hits"] == 0:
+        print(f"⚠️ [BENCH] Incomplete run: {pipe['indexed']}/{pipe['docs']} indexed, "
+              f"FTS probe {pipe['fts_probe']}")
+        return 1
+
+    if args.update_baseline:
+        args.baseline.write_text(text + "\n")
+        print(f"✅ [BENCH] Baseline written: {args.baseline}")
+        return 0
+
+    if not args.baseline.exists():
+        print(f"⚠️ [BENCH] No baseline at {args.baseline} (record one with --update-baseline)")
+        return 0
+    try:
+        regressions = compare(results, json.loads(args.baseline.read_text()), args.threshold)
+    except ValueError as e:
+        print(f"⚠️ [BENCH] {e}")
+        return 2
+
+    for r in regressions:
+        print(f"❌ [BENCH] {r['metric']}: {r['baseline']:.2f} → {r['current']:.2f} ({r['change']:+.0%})")
+    if regressions:
+        return 1
+    print(f"✅ [BENCH] No regression beyond {args.threshold:.0%}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,206 @@
+"""
+CORPUS.PY - Deterministic Synthetic Documents for Benchmarks
+
+Same seed + parameters = byte-identical corpus, so runs on one machine
+compare like with like. PDFs are written by hand (uncompressed text
+content streams, valid xref), DOCX as a minimal OOXML package - no
+third-party writer needed. Both open in PyMuPDF / python-docx.
+
+CorpusTextExtractor reads the text back without those libraries; the
+benchmark uses it when the real extractor for a type is unavailable and
+records that in the results ("extractors"), so baselines never mix the two.
+"""
+
+import random
+import re
+import time
+import zipfile
+from pathlib import Path
+from typing import List, Tuple
+
+from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+
+# Vocabulary: frequent words for realistic FTS posting lists, plus a
+# seeded tail of rare tokens
+_COMMON = (
+    "vault note secret index backup stream event chain search query page "
+    "document sync folder memory token cipher journal draft meeting report"
+).split()
+
+PDF_MIME = "application/pdf"
+DOCX_MIME = "application/vnd.openxmlformats-officedocument.wordprocessingml.document"
+
+
+class WordSource:
+    """Seeded word stream (Zipf-ish: common words dominate)."""
+
+    def __init__(self, seed: int, rare_words: int = 5000):
+        self._rng = random.Random(seed)
+        self._rare = [f"term{n:05d}" for n in range(rare_words)]
+
+    def words(self, count: int) -> List[str]:
+        rng = self._rng
+        return [
+            rng.choice(_COMMON) if rng.random() < 0.7 else rng.choice(self._rare)
+            for _ in range(count)
+        ]
+
+    def lines(self, size_bytes: int, words_per_line: int = 12) -> List[str]:
+        lines, total = [], 0
+        while total < size_bytes:
+            line = " ".join(self.words(words_per_line))
+            lines.append(line)
+            total += len(line) + 1
+        return lines
+
+
+# -------------------------------------------------------------------
+# PDF
+# -------------------------------------------------------------------
+
+_LINES_PER_PAGE = 60
+
+
+def write_pdf(path: Path, lines: List[str]) -> None:
+    """Minimal PDF 1.4: one Helvetica text stream per page."""
+    pages = [lines[i:i + _LINES_PER_PAGE] for i in range(0, len(lines), _LINES_PER_PAGE)] or [[]]
+    page_ids = [4 + 2 * n for n in range(len(pages))]
+
+    objects = {
+        1: b"<< /Type /Catalog /Pages 2 0 R >>",
+        2: b"<< /Type /Pages /Kids [" + b" ".join(b"%d 0 R" % i for i in page_ids)
+           + b"] /Count %d >>" % len(pages),
+        3: b"<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>",
+    }
+    for page_id, page_lines in zip(page_ids, pages):
+        text = "".join(f"({line}) '\n" for line in page_lines)
+        stream = f"BT /F1 9 Tf 11 TL 40 800 Td\n{text}ET".encode("latin-1")
+        objects[page_id] = (
+            b"<< /Type /Page /Parent 2 0 R /MediaBox [0 0 595 842] "
+            b"/Resources << /Font << /F1 3 0 R >> >> /Contents %d 0 R >>" % (page_id + 1)
+        )
+        objects[page_id + 1] = b"<< /Length %d >>\nstream\n%s\nendstream" % (len(stream), stream)
+
+    out = bytearray(b"%PDF-1.4\n")
+    offsets = {}
+    for obj_id in sorted(objects):
+        offsets[obj_id] = len(out)
+        out += b"%d 0 obj\n%s\nendobj\n" % (obj_id, objects[obj_id])
+    xref = len(out)
+    out += b"xref\n0 %d\n0000000000 65535 f \n" % (len(objects) + 1)
+    for obj_id in sorted(objects):
+        out += b"%010d 00000 n \n" % offsets[obj_id]
+    out += b"trailer\n<< /Size %d /Root 1 0 R >>\nstartxref\n%d\n%%%%EOF\n" % (len(objects) + 1, xref)
+    path.write_bytes(bytes(out))
+
+
+# -------------------------------------------------------------------
+# DOCX
+# -------------------------------------------------------------------
+
+_CONTENT_TYPES = (
+    '<?xml version="1.0" encoding="UTF-8" standalone="yes"?>'
+    '<Types xmlns="http://schemas.openxmlformats.org/package/2006/content-types">'
+    '<Default Extension="rels" ContentType="application/vnd.openxmlformats-package.relationships+xml"/>'
+    '<Default Extension="xml" ContentType="application/xml"/>'
+    '<Override PartName="/word/document.xml" '
+    'ContentType="application/vnd.openxmlformats-officedocument.wordprocessingml.document.main+xml"/>'
+    '</Types>'
+)
+_RELS = (
+    '<?xml version="1.0" encoding="UTF-8" standalone="yes"?>'
+    '<Relationships xmlns="http://schemas.openxmlformats.org/package/2006/relationships">'
+    '<Relationship Id="rId1" '
+    'Type="http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument" '
+    'Target="word/document.xml"/>'
+    '</Relationships>'
+)
+_W_NS = "http://schemas.openxmlformats.org/wordprocessingml/2006/main"
+
+
+def write_docx(path: Path, lines: List[str]) -> None:
+    """Minimal OOXML package: one paragraph per line."""
+    body = "".join(f"<w:p><w:r><w:t>{line}</w:t></w:r></w:p>" for line in lines)
+    document = (
+        '<?xml version="1.0" encoding="UTF-8" standalone="yes"?>'
+        f'<w:document xmlns:w="{_W_NS}"><w:body>{body}</w:body></w:document>'
+    )
+    with zipfile.ZipFile(path, "w", zipfile.ZIP_DEFLATED) as zf:
+        zf.writestr("[Content_Types].xml", _CONTENT_TYPES)
+        zf.writestr("_rels/.rels", _RELS)
+        zf.writestr("word/document.xml", document)
+
+
+def generate_corpus(
+    root: Path,
+    docs: int,
+    size_kb: int,
+    pdf_ratio: float = 0.5,
+    seed: int = 1337
+) -> List[Tuple[Path, str]]:
+    """
+    Write `docs` documents of ~size_kb text each under root/corpus.
+
+    Returns:
+        [(path, mime_type)] in generation order
+    """
+    words = WordSource(seed)
+    rng = random.Random(seed)
+    corpus_dir = root / "corpus"
+    corpus_dir.mkdir(parents=True, exist_ok=True)
+
+    files = []
+    for n in range(docs):
+        lines = words.lines(size_kb * 1024)
+        if rng.random() < pdf_ratio:
+            path = corpus_dir / f"doc_{n:06d}.pdf"
+            write_pdf(path, lines)
+            files.append((path, PDF_MIME))
+        else:
+            path = corpus_dir / f"doc_{n:06d}.docx"
+            write_docx(path, lines)
+            files.append((path, DOCX_MIME))
+    return files
+
+
+# -------------------------------------------------------------------
+# FALLBACK EXTRACTOR
+# -------------------------------------------------------------------
+
+_PDF_LINE = re.compile(rb"\((.*?)\) '")
+_DOCX_TEXT = re.compile(r"<w:t[^>]*>(.*?)</w:t>")
+
+
+class CorpusTextExtractor:
+    """Reads text back from write_pdf / write_docx output (no PyMuPDF/python-docx)."""
+
+    VERSION = "bench-1"
+
+    def __init__(self, mime_type: str):
+        self.mime_type = mime_type
+        self.EXTRACTOR_NAME = "corpus_pdf" if mime_type == PDF_MIME else "corpus_docx"
+
+    def extract(self, file_path: Path) -> ExtractionResult:
+        start = time.perf_counter()
+        file_path = Path(file_path)
+        if self.mime_type == PDF_MIME:
+            data = file_path.read_bytes()
+            pages = data.split(b"/Type /Page ")[1:] or [data]
+            segments = [
+                TextSegment(text="\n".join(m.decode("latin-1") for m in _PDF_LINE.findall(chunk)), page=n + 1)
+                for n, chunk in enumerate(pages)
+            ]
+        else:
+            with zipfile.ZipFile(file_path) as zf:
+                xml = zf.read("word/document.xml").decode("utf-8")
+            segments = [TextSegment(text="\n".join(_DOCX_TEXT.findall(xml)))]
+        return ExtractionResult(
+            segments=[s for s in segments if s.text],
+            metadata={"extractor": self.EXTRACTOR_NAME},
+            processing_time_ms=(time.perf_counter() - start) * 1000,
+            file_size_bytes=file_path.stat().st_size,
+            errors=[],
+            truncated=False,
+            extractor=self.EXTRACTOR_NAME,
+            version=self.VERSION
+        )
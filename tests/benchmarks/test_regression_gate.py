@@ -0,0 +1,116 @@
+"""
+Regression gate (bench_pipeline.compare) + benchmark smoke run.
+
+The smoke run is marked `benchmark`: deselect with -m "not benchmark".
+"""
+
+import copy
+import zipfile
+
+import pytest
+
+from tests.benchmarks.bench_pipeline import GATES, compare
+from tests.benchmarks.corpus import (
+    DOCX_MIME, PDF_MIME, CorpusTextExtractor, generate_corpus
+)
+
+
+def _results(**metrics):
+    base = {
+        "params": {"docs": 10, "size_kb": 4, "seed": 1},
+        "extractors": {PDF_MIME: "corpus_pdf"},
+        "host": {"cpu_count": 8, "system": "Linux", "machine": "x86_64", "platform": "Linux-6.1"},
+        "metrics": {
+            "storm.events_per_s": 10_000.0,
+            "storm.latency_p95_ms": 50.0,
+            "storm.events_dropped": 0,
+            "pipeline.docs_per_s": 100.0,
+            "pipeline.end_to_end_p95_ms": 600.0,
+            "peak_rss_mb": 64.0,
+        },
+    }
+    base["metrics"].update(metrics)
+    return base
+
+
+def test_gate_passes_within_threshold():
+    baseline = _results()
+    current = _results(**{"pipeline.docs_per_s": 85.0, "storm.latency_p95_ms": 58.0})
+    assert compare(current, baseline, threshold=0.2) == []
+
+
+def test_gate_flags_throughput_and_latency_regressions():
+    baseline = _results()
+    current = _results(**{"pipeline.docs_per_s": 70.0, "pipeline.end_to_end_p95_ms": 900.0})
+    regressed = {r["metric"]: r for r in compare(current, baseline, threshold=0.2)}
+    assert set(regressed) == {"pipeline.docs_per_s", "pipeline.end_to_end_p95_ms"}
+    assert round(regressed["pipeline.docs_per_s"]["change"], 6) == -0.3
+
+
+def test_gate_improvements_never_fail():
+    baseline = _results()
+    current = _results(**{"pipeline.docs_per_s": 300.0, "peak_rss_mb": 32.0})
+    assert compare(current, baseline) == []
+
+
+def test_gate_absolute_slack_and_drops():
+    baseline = _results(**{"storm.latency_p95_ms": 1.0})
+    # +300% but within the 5 ms slack
+    assert compare(_results(**{"storm.latency_p95_ms": 4.0}), baseline) == []
+    # Zero baseline: any dropped event is a regression
+    dropped = compare(_results(**{"storm.events_dropped": 3, "storm.latency_p95_ms": 1.0}), baseline)
+    assert [r["metric"] for r in dropped] == ["storm.events_dropped"]
+
+
+def test_gate_rejects_incomparable_baseline():
+    baseline = _results()
+    current = copy.deepcopy(baseline)
+    current["extractors"] = {PDF_MIME: "pdf_pymupdf"}
+    with pytest.raises(ValueError):
+        compare(current, baseline)
+
+
+def test_gate_rejects_other_host():
+    baseline = _results()
+    # Kernel patch release only: still comparable
+    current = copy.deepcopy(baseline)
+    current["host"]["platform"] = "Linux-6.2"
+    assert compare(current, baseline) == []
+
+    current["host"]["cpu_count"] = 1
+    with pytest.raises(ValueError, match="cpu_count"):
+        compare(current, baseline)
+    with pytest.raises(ValueError, match="host"):
+        compare(_results(), {**baseline, "host": {}})
+
+
+def test_gated_metrics_have_direction():
+    assert all(direction in ("higher", "lower") for direction, _ in GATES.values())
+
+
+def test_corpus_is_deterministic_and_readable(tmp_path):
+    first = generate_corpus(tmp_path / "a", docs=4, size_kb=2, seed=7)
+    second = generate_corpus(tmp_path / "b", docs=4, size_kb=2, seed=7)
+    assert [p.read_bytes() for p, _ in first] == [p.read_bytes() for p, _ in second]
+
+    for path, mime in first:
+        if mime == DOCX_MIME:
+            assert zipfile.is_zipfile(path)
+        else:
+            assert path.read_bytes().startswith(b"%PDF-1.4")
+        result = CorpusTextExtractor(mime).extract(path)
+        assert result.segments and sum(len(s.text) for s in result.segments) >= 2048 * 0.9
+
+
+@pytest.mark.benchmark
+def test_benchmark_smoke(tmp_path):
+    pytest.importorskip("watchdog")
+    from tests.benchmarks.bench_pipeline import run_event_storm, run_pipeline
+
+    storm = run_event_storm(tmp_path, events=2000, rate=0)
+    assert storm["consumed"] + storm["events_dropped"] == 2000
+
+    pipe = run_pipeline(tmp_path, docs=6, size_kb=4, rate=0, seed=3)
+    assert pipe["indexed"] == 6
+    assert pipe["fts_probe"]["hits"] > 0
+    assert pipe["stages_ms"]["end_to_end"]["count"] == 6
@@ -148,3 +148,44 @@ def test_T25_04_docx_extraction_performance(sample_docx):
     p50 = times[49]
     p95 = times[94]
     
+
+
+def test_T25_05_unpack_docx_batch():
+    """T25.05: DocxBatch flat buffer + offsets -> one ExtractionResult per file"""
+    from array import array
+    from types import SimpleNamespace
+    from src.core.indexer.extractors.docx_extractor import unpack_docx_batch
+    
+    texts = ["Hello World", "a\tb\n", "Xin chào"]
+    offsets = array("Q", [0])
+    for text in texts:
+        offsets.append(offsets[-1] + len(text))
+    
+    def native(**kwargs):
+        fields = dict(metadata={"paragraph_count": 0}, processing_time_ms=1.0, file_size_bytes=10,
+                      errors=[], truncated=False, extractor="docx_rust", version="1.1.0")
+        fields.update(kwargs)
+        return SimpleNamespace(**fields)
+    
+    batch = SimpleNamespace(
+        text="".join(texts),
+        segment_offsets=offsets.tobytes(),
+        section_kinds=b"ptp",
+        section_indices=array("I", [0, 1, 0]).tobytes(),
+        document_offsets=array("Q", [0, 2, 2, 3]).tobytes(),
+        documents=[
+            native(metadata={"paragraph_count": 2}),
+            native(errors=[SimpleNamespace(code="CORRUPTED", message="bad zip", recoverable=False)]),
+            native(metadata={"paragraph_count": 1}),
+        ]
+    )
+    
+    results = unpack_docx_batch(batch)
+    
+    assert len(results) == 3
+    assert [(s.text, s.section) for s in results[0].segments] == [("Hello World", "paragraph_0"), ("a\tb\n", "table_1")]
+    assert results[1].segments == [] and results[1].errors[0].code == "CORRUPTED"
+    assert results[2].segments[0].text == "Xin chào"
+    assert results[2].extractor == "docx_rust"
+    
+    print(f"\n   ✅ T25.05: Batch of 3 unpacked ({len(batch.text)} chars)")
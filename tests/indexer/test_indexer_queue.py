@@ -9,6 +9,12 @@ Test Categories:
 - T01-T04: Core functionality
 - T05-T07: Reliability
 - T08-T10: Performance & Resilience
+- T11-T13: Multi-consumer (lease claims, wakeup)
+- T14-T16: Bloom prefilter (L2 skip, persistence)
+- T17-T18: Bounded warm-up, TTL compaction
+- T19-T20, T23: Binary batch envelope (legacy rows, lazy decode, big ints)
+- T21: processed_events WITHOUT ROWID migration
+- T22: Batched EventBus subscription (in multi-consumer group)
 """
 
 import gc
@@ -20,18 +26,20 @@ import threading
 import time
 import unittest
 from pathlib import Path
+from typing import Any, Dict, List
 from unittest.mock import Mock, MagicMock, patch
 
 import pytest
 
 # Import will be available after implementation
 try:
-    from src.core.indexer.queue import IndexerQueue, Batch, QueueMetrics
+    from src.core.indexer.queue import IndexerQueue, Batch, QueueMetrics, SecureLRUCache
 except ImportError:
     # Stub for RED phase
     IndexerQueue = None
     Batch = None
     QueueMetrics = None
+    SecureLRUCache = None
 
 try:
     from src.core.services.eventbus import HeavyEventBus
@@ -428,6 +436,494 @@ class TestIndexerQueuePerformance(unittest.TestCase):
         print("\n   ✅ T10: Graceful shutdown persists pending events")
 
 
+# ===================================================================
+# NHÓM 4: MULTI-CONSUMER (T11-T13)
+# ===================================================================
+
+class TestIndexerQueueMultiConsumer(unittest.TestCase):
+    """Lease-based multi-worker consumer tests"""
+    
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp()
+        self.db_path = os.path.join(self.temp_dir, "test_queue.db")
+    
+    def tearDown(self):
+        import shutil
+        try:
+            shutil.rmtree(self.temp_dir)
+        except:
+            pass
+
+    @pytest.mark.indexer_performance
+    def test_T11_parallel_workers_claim_each_batch_once(self):
+        """T11: N workers song song, mỗi batch chỉ được claim 1 lần"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=10, multi_consumer=True)
+        queue.start()
+        
+        for i in range(200):
+            queue._on_event_received({
+                "event_id": f"event-{i:03d}",
+                "data": f"file_{i}.md"
+            })
+        
+        claimed: List[str] = []
+        claimed_lock = threading.Lock()
+        
+        def worker():
+            while True:
+                batch = queue.get_next_batch(timeout=0.2)
+                if batch is None:
+                    return
+                with claimed_lock:
+                    claimed.append(batch.batch_id)
+                queue.mark_batch_done(batch.batch_id)
+        
+        workers = [threading.Thread(target=worker) for _ in range(4)]
+        for t in workers:
+            t.start()
+        for t in workers:
+            t.join(timeout=5.0)
+        
+        self.assertEqual(len(claimed), 20, "All 20 batches should be claimed")
+        self.assertEqual(len(set(claimed)), 20, "No batch may be claimed twice")
+        self.assertEqual(queue.metrics().done_batches, 20)
+        
+        queue.stop()
+        print("\n   ✅ T11: 4 workers drained 20 batches without double claims")
+
+    @pytest.mark.indexer_resilience
+    def test_T12_expired_lease_is_requeued(self):
+        """T12: Worker crash → lease hết hạn → batch được claim lại"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=10, lease_timeout_s=0.1)
+        queue.start()
+        
+        for i in range(10):
+            queue._on_event_received({
+                "event_id": f"event-{i:03d}",
+                "data": f"file_{i}.md"
+            })
+        
+        first = queue.get_next_batch(timeout=0.1)
+        self.assertIsNotNone(first)
+        
+        # Simulated crash: never mark_batch_done, lease still live
+        self.assertIsNone(queue.get_next_batch(timeout=0.05))
+        
+        time.sleep(0.15)
+        retry = queue.get_next_batch(timeout=0.1)
+        
+        self.assertIsNotNone(retry, "Expired lease should be claimable again")
+        self.assertEqual(retry.batch_id, first.batch_id)
+        self.assertEqual(retry.attempts, 2)
+        
+        queue.stop()
+        print("\n   ✅ T12: Expired lease re-queued")
+
+    @pytest.mark.indexer_resilience
+    def test_T24_stale_owner_cannot_extend_or_complete(self):
+        """T24: Lease hết hạn + consumer khác claim lại → worker cũ không extend/done được"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=10, lease_timeout_s=0.1)
+        queue.start()
+        
+        for i in range(10):
+            queue._on_event_received({"event_id": f"event-{i:03d}", "data": i})
+        
+        stale = queue.get_next_batch(timeout=0.1)
+        self.assertTrue(queue.extend_lease(stale.batch_id))
+        time.sleep(0.15)
+        
+        reclaimed = []
+        other = threading.Thread(target=lambda: reclaimed.append(queue.get_next_batch(timeout=0.1)))
+        other.start()
+        other.join()
+        self.assertEqual(reclaimed[0].batch_id, stale.batch_id)
+        self.assertNotEqual(reclaimed[0].lease_owner, stale.lease_owner)
+        
+        self.assertFalse(queue.extend_lease(stale.batch_id))
+        self.assertFalse(queue.mark_batch_done(stale.batch_id))
+        self.assertEqual(queue.metrics().processing_batches, 1)
+        
+        # The new owner's handle, used from this thread
+        self.assertTrue(queue.mark_batch_done(reclaimed[0].batch_id, reclaimed[0].lease_owner))
+        self.assertEqual(queue.metrics().done_batches, 1)
+        
+        queue.stop()
+        print("\n   ✅ T24: Stale lease owner rejected")
+
+    @pytest.mark.indexer_performance
+    def test_T22_batch_subscription_end_to_end(self):
+        """T22: subscribe_to_eventbus(batch=True) - bus giao list, queue tạo batch 100"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=100)
+        bus = HeavyEventBus(max_queue_size=10000, name="batch_e2e")
+        
+        queue.start()
+        queue.subscribe_to_eventbus(bus, batch=True)
+        bus.start()
+        
+        for i in range(500):
+            bus.publish({"event_id": f"event-{i:03d}", "data": i})
+        
+        deadline = time.time() + 3.0
+        while time.time() < deadline and queue.metrics().events_processed_total < 500:
+            time.sleep(0.01)
+        
+        bus.stop()
+        metrics = queue.metrics()
+        queue.stop()
+        
+        self.assertEqual(metrics.events_processed_total, 500)
+        self.assertEqual(metrics.pending_batches, 5, "500 events → 5 batches of 100")
+        print("\n   ✅ T22: Batched bus → queue delivery")
+
+    @pytest.mark.indexer_core
+    def test_T13_blocked_consumer_woken_by_flush(self):
+        """T13: Consumer đang chờ được đánh thức ngay khi flush"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=10, multi_consumer=True)
+        queue.start()
+        
+        result: Dict[str, Any] = {}
+        
+        def consumer():
+            start = time.time()
+            result["batch"] = queue.get_next_batch(timeout=2.0)
+            result["waited"] = time.time() - start
+        
+        t = threading.Thread(target=consumer)
+        t.start()
+        time.sleep(0.1)
+        
+        for i in range(10):
+            queue._on_event_received({
+                "event_id": f"event-{i:03d}",
+                "data": f"file_{i}.md"
+            })
+        
+        t.join(timeout=3.0)
+        
+        self.assertIsNotNone(result.get("batch"), "Consumer should receive the batch")
+        self.assertLess(result["waited"], 1.0, "Consumer should wake on flush, not timeout")
+        
+        queue.stop()
+        print(f"\n   ✅ T13: Consumer woke after {result['waited'] * 1000:.0f}ms")
+
+
+# ===================================================================
+# NHÓM 5: BLOOM PREFILTER (T14-T16)
+# ===================================================================
+
+class TestIndexerQueueBloomPrefilter(unittest.TestCase):
+    """Bloom prefilter in front of the L2 SQLite idempotency check"""
+    
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp()
+        self.db_path = os.path.join(self.temp_dir, "test_queue.db")
+    
+    def tearDown(self):
+        import shutil
+        try:
+            shutil.rmtree(self.temp_dir)
+        except:
+            pass
+
+    @pytest.mark.indexer_performance
+    def test_T14_new_events_skip_sqlite(self):
+        """T14: Event mới (bloom miss) không chạm SQLite"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=100)
+        queue.start()
+        
+        with patch.object(queue, "_is_event_in_database", return_value=False) as l2:
+            for i in range(50):
+                queue._on_event_received({
+                    "event_id": f"event-{i:03d}",
+                    "data": f"file_{i}.md"
+                })
+            self.assertEqual(l2.call_count, 0, "Bloom miss must not query SQLite")
+        
+        metrics = queue.metrics()
+        self.assertEqual(metrics.bloom_misses_total, 50)
+        self.assertEqual(metrics.bloom_hits_total, 0)
+        
+        queue.stop()
+        print("\n   ✅ T14: 50 new events, 0 SQLite lookups")
+
+    @pytest.mark.indexer_resilience
+    def test_T15_evicted_duplicate_still_detected(self):
+        """T15: ID bị đẩy khỏi LRU vẫn bị chặn qua bloom hit → SQLite"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=10)
+        queue.start()
+        queue._processed_ids = SecureLRUCache(maxsize=5)
+        
+        for i in range(20):
+            queue._on_event_received({
+                "event_id": f"event-{i:03d}",
+                "data": f"file_{i}.md"
+            })
+        
+        # event-000 is long gone from the 5-entry LRU
+        queue._on_event_received({"event_id": "event-000", "data": "file_0.md"})
+        
+        metrics = queue.metrics()
+        self.assertEqual(metrics.events_duplicate_total, 1)
+        self.assertEqual(metrics.bloom_hits_total, 1)
+        self.assertEqual(metrics.bloom_false_positives_total, 0)
+        
+        queue.stop()
+        print("\n   ✅ T15: Evicted duplicate caught via bloom → SQLite")
+
+    @pytest.mark.indexer_resilience
+    def test_T16_filter_persisted_and_caught_up(self):
+        """T16: Bloom filter được lưu khi stop và bắt kịp sau crash"""
+        queue1 = IndexerQueue(db_path=self.db_path, batch_size=10)
+        queue1.start()
+        for i in range(10):
+            queue1._on_event_received({"event_id": f"a-{i}", "data": i})
+        queue1.stop(graceful=True)
+        
+        # Rows written after the save (simulated crash, no save)
+        conn = sqlite3.connect(self.db_path)
+        conn.execute(
+            "INSERT INTO processed_events (event_id, batch_id, processed_at) "
+            "VALUES ('late-1', 'b', ?)",
+            (time.time() + 1,)
+        )
+        conn.commit()
+        saved = conn.execute("SELECT COUNT(*) FROM idempotency_filter").fetchone()[0]
+        conn.close()
+        self.assertEqual(saved, 1, "Filter should be persisted on stop")
+        
+        queue2 = IndexerQueue(db_path=self.db_path, batch_size=10)
+        queue2.start()
+        self.assertIn("a-3", queue2._bloom)
+        self.assertIn("late-1", queue2._bloom, "Catch-up should add post-save rows")
+        
+        queue2.stop()
+        print("\n   ✅ T16: Bloom filter reloaded with catch-up")
+
+
+# ===================================================================
+# NHÓM 6: WARM-UP & COMPACTION (T17-T18)
+# ===================================================================
+
+class TestIndexerQueueCompaction(unittest.TestCase):
+    """Bounded startup warm-up and TTL compaction"""
+    
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp()
+        self.db_path = os.path.join(self.temp_dir, "test_queue.db")
+    
+    def tearDown(self):
+        import shutil
+        try:
+            shutil.rmtree(self.temp_dir)
+        except:
+            pass
+
+    @pytest.mark.indexer_performance
+    def test_T17_warmup_loads_only_most_recent(self):
+        """T17: start() chỉ nạp N event_id gần nhất vào LRU"""
+        queue1 = IndexerQueue(db_path=self.db_path)
+        queue1.start()
+        queue1.stop()
+        
+        conn = sqlite3.connect(self.db_path)
+        conn.executemany(
+            "INSERT INTO processed_events (event_id, batch_id, processed_at) VALUES (?, 'b', ?)",
+            [(f"event-{i:04d}", 1000.0 + i) for i in range(1000)]
+        )
+        conn.commit()
+        conn.close()
+        
+        queue2 = IndexerQueue(db_path=self.db_path, warmup_limit=100)
+        queue2.start()
+        
+        self.assertEqual(len(queue2._processed_ids), 100)
+        self.assertIn("event-0999", queue2._processed_ids)
+        self.assertNotIn("event-0000", queue2._processed_ids)
+        
+        queue2.stop()
+        print("\n   ✅ T17: Warm-up bounded to 100 most recent IDs")
+
+    @pytest.mark.indexer_resilience
+    def test_T18_compaction_prunes_done_rows_only(self):
+        """T18: compact() xoá batch 'done' cũ, giữ batch còn pending"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=10, retention_s=60.0)
+        queue.start()
+        
+        for i in range(20):
+            queue._on_event_received({"event_id": f"event-{i:03d}", "data": i})
+        
+        done = queue.get_next_batch(timeout=0.1)
+        queue.mark_batch_done(done.batch_id)
+        
+        # Nothing is old enough yet
+        self.assertEqual(queue.compact()["batches_pruned"], 0)
+        
+        result = queue.compact(now=time.time() + 120.0)
+        self.assertEqual(result["batches_pruned"], 1)
+        self.assertEqual(result["events_pruned"], 10)
+        
+        metrics = queue.metrics()
+        self.assertEqual(metrics.done_batches, 0)
+        self.assertEqual(metrics.pending_batches, 1, "Pending batch must survive")
+        self.assertEqual(metrics.batches_pruned_total, 1)
+        
+        conn = sqlite3.connect(self.db_path)
+        remaining = conn.execute("SELECT COUNT(*) FROM processed_events").fetchone()[0]
+        conn.close()
+        self.assertEqual(remaining, 10, "Events of the pending batch must survive")
+        
+        queue.stop()
+        print("\n   ✅ T18: Compaction pruned done batch, kept pending one")
+
+
+# ===================================================================
+# NHÓM 7: BINARY BATCH ENVELOPE (T19-T20)
+# ===================================================================
+
+class TestIndexerQueueBatchEnvelope(unittest.TestCase):
+    """Versioned binary events_data format"""
+    
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp()
+        self.db_path = os.path.join(self.temp_dir, "test_queue.db")
+    
+    def tearDown(self):
+        import shutil
+        try:
+            shutil.rmtree(self.temp_dir)
+        except:
+            pass
+
+    @pytest.mark.indexer_resilience
+    def test_T19_legacy_json_rows_still_readable(self):
+        """T19: Batch cũ (JSON thuần) vẫn đọc được sau nâng cấp"""
+        queue = IndexerQueue(db_path=self.db_path)
+        queue.start()
+        
+        legacy = [{"event_id": "old-1", "sequence": 0}, {"event_id": "old-2", "sequence": 1}]
+        conn = sqlite3.connect(self.db_path)
+        conn.execute(
+            "INSERT INTO pending_batches (batch_id, created_at, event_count, events_data, status) "
+            "VALUES ('legacy', ?, 2, ?, 'pending')",
+            (time.time(), json.dumps(legacy).encode("utf-8"))
+        )
+        conn.commit()
+        conn.close()
+        
+        batch = queue.get_next_batch(timeout=0.1)
+        
+        self.assertIsNotNone(batch)
+        self.assertEqual(list(batch.events), legacy)
+        
+        queue.stop()
+        print("\n   ✅ T19: Legacy JSON batch decoded")
+
+    @pytest.mark.indexer_performance
+    def test_T20_lazy_batch_iteration(self):
+        """T20: get_next_batch(lazy=True) giải mã từng event khi duyệt"""
+        queue = IndexerQueue(db_path=self.db_path, batch_size=10)
+        queue.start()
+        
+        for i in range(10):
+            queue._on_event_received({"event_id": f"event-{i:03d}", "sequence": i})
+        
+        conn = sqlite3.connect(self.db_path)
+        blob = conn.execute("SELECT events_data FROM pending_batches").fetchone()[0]
+        conn.close()
+        self.assertEqual(blob[:4], b"IQEV", "New batches use the binary envelope")
+        
+        batch = queue.get_next_batch(timeout=0.1, lazy=True)
+        
+        self.assertEqual(len(batch.events), 10)
+        self.assertEqual(batch.events[7]["sequence"], 7)
+        self.assertEqual(batch.events[-1]["sequence"], 9)
+        self.assertEqual([e["sequence"] for e in batch.events], list(range(10)))
+        
+        queue.stop()
+        print("\n   ✅ T20: Lazy envelope iteration + random access")
+
+    @pytest.mark.indexer_resilience
+    def test_T23_big_ints_round_trip_exactly(self):
+        """T23: Số nguyên > 64-bit (orjson không mã hóa được) không bị đổi thành float"""
+        from src.core.indexer.utils.batch_codec import decode_events, encode_events
+        
+        events = [{"sequence": 0, "size": 2**70}, {"sequence": 1}, {"sequence": 2, "ids": [-(2**65)]}]
+        blob = encode_events(events)
+        
+        self.assertEqual(decode_events(blob), events)
+        lazy = decode_events(blob, lazy=True)
+        self.assertEqual(lazy[0]["size"], 2**70)
+        self.assertIsInstance(lazy[0]["size"], int)
+        self.assertEqual(lazy[2]["ids"], [-(2**65)])
+        self.assertEqual(list(lazy), events)
+        
+        print("\n   ✅ T23: >64-bit ints survive the envelope")
+
+
+# ===================================================================
+# NHÓM 8: PROCESSED_EVENTS LAYOUT (T21)
+# ===================================================================
+
+class TestIndexerQueueSchemaMigration(unittest.TestCase):
+    """WITHOUT ROWID processed_events + migration of old queue DBs"""
+    
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp()
+        self.db_path = os.path.join(self.temp_dir, "test_queue.db")
+    
+    def tearDown(self):
+        import shutil
+        try:
+            shutil.rmtree(self.temp_dir)
+        except:
+            pass
+
+    @pytest.mark.indexer_resilience
+    def test_T21_legacy_processed_events_migrated(self):
+        """T21: DB cũ (rowid + index thừa) được migrate, giữ nguyên dữ liệu"""
+        conn = sqlite3.connect(self.db_path)
+        conn.execute("""
+            CREATE TABLE processed_events (
+                event_id TEXT PRIMARY KEY,
+                batch_id TEXT NOT NULL,
+                processed_at REAL NOT NULL
+            )
+        """)
+        conn.execute("CREATE INDEX idx_processed_events_event_id ON processed_events(event_id)")
+        conn.executemany(
+            "INSERT INTO processed_events VALUES (?, 'old-batch', ?)",
+            [(f"old-{i}", float(i)) for i in range(50)]
+        )
+        conn.commit()
+        conn.close()
+        
+        queue = IndexerQueue(db_path=self.db_path, batch_size=10)
+        queue.start()
+        
+        for i in range(10):
+            queue._on_event_received({"event_id": f"new-{i}", "data": i})
+        queue._on_event_received({"event_id": "old-0", "data": 0})
+        
+        metrics = queue.metrics()
+        queue.stop()
+        
+        conn = sqlite3.connect(self.db_path)
+        table_sql = conn.execute(
+            "SELECT sql FROM sqlite_master WHERE name = 'processed_events'"
+        ).fetchone()[0]
+        redundant = conn.execute(
+            "SELECT COUNT(*) FROM sqlite_master WHERE name = 'idx_processed_events_event_id'"
+        ).fetchone()[0]
+        total = conn.execute("SELECT COUNT(*) FROM processed_events").fetchone()[0]
+        conn.close()
+        
+        self.assertIn("WITHOUT ROWID", table_sql.upper())
+        self.assertEqual(redundant, 0, "Redundant PK index should be dropped")
+        self.assertEqual(total, 60, "Migrated rows + new batch rows")
+        self.assertEqual(metrics.events_duplicate_total, 1, "Migrated IDs still deduplicate")
+        print("\n   ✅ T21: processed_events migrated to WITHOUT ROWID")
+
+
 # ===================================================================
 # MAIN RUNNER
 # ===================================================================
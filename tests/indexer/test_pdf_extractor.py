@@ -203,3 +203,27 @@ def test_T24_06_empty_pdf_handling(tmp_path):
     assert result.metadata["page_count"] == 1
     
     print(f"\n   ✅ T24.06: Empty PDF handled correctly")
+
+
+@pytest.mark.skipif(not PYMUPDF_AVAILABLE, reason="PyMuPDF not installed")
+def test_T24_07_streaming_char_budget(sample_pdf):
+    """T24.07: extract_stream yields pages lazily and stops at the budget"""
+    from src.core.indexer.extractors.pdf_extractor import PDFExtractor
+    
+    extractor = PDFExtractor()
+    full = extractor.extract(sample_pdf)
+    budget = len(full.segments[0].text) + 5
+    
+    result, segments = extractor.extract_stream(sample_pdf, max_chars=budget)
+    first = next(segments)
+    assert first.page == 1
+    assert result.segments == []  # nothing retained in streaming mode
+    
+    rest = list(segments)
+    assert len(rest) == 1 and rest[0].page == 2
+    assert len(first.text) + len(rest[0].text) == budget
+    assert result.truncated
+    assert result.success
+    assert result.metadata["truncated_at_page"] == 2
+    
+    print(f"\n   ✅ T24.07: Streaming stopped at {budget} chars (page 2)")
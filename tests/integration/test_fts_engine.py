@@ -0,0 +1,158 @@
+"""
+TEST_FTS_ENGINE.PY - Search Engine over the FTS5 Index
+Task 7.1 - Sprint 7 Search UI
+
+T71.03: <mark> highlighting (escaped snippet text)
+T71.04: file_type filter
+T71.05: Query parsing (prefix / phrase / operators as text)
+T71.06: bm25 ranking + cursor pagination
+T71.07: Hot-result cache invalidated by the writer's commit_seq
+"""
+
+import shutil
+import tempfile
+import unittest
+from pathlib import Path
+
+from src.core.indexer.encrypted_storage import EncryptedIndexerDB
+from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+from src.core.indexer.fts_writer import FTSBatchWriter
+from src.core.services.notes.fts_engine import FTSSearchEngine, parse_query
+
+KEY = b"0" * 32
+
+
+def _result(*texts):
+    return ExtractionResult(
+        segments=[TextSegment(text=t, page=n + 1) for n, t in enumerate(texts)],
+        metadata={},
+        processing_time_ms=1.0,
+        file_size_bytes=1024,
+        errors=[],
+        truncated=False,
+        extractor="test",
+        version="1"
+    )
+
+
+class TestFTSEngine(unittest.TestCase):
+
+    def setUp(self):
+        self.test_dir = Path(tempfile.mkdtemp())
+        db_path = self.test_dir / "index.db"
+
+        # Writer and reader on separate connections (as in the app)
+        self.writer_db = EncryptedIndexerDB(db_path, key=KEY)
+        self.writer_db.connect()
+        self.writer = FTSBatchWriter(self.writer_db, batch_size=1)
+        self.writer.ensure_schema()
+
+        self.reader_db = EncryptedIndexerDB(db_path, key=KEY)
+        self.reader_db.connect()
+        self.engine = FTSSearchEngine(self.reader_db, writer=self.writer)
+
+    def tearDown(self):
+        self.reader_db.close()
+        self.writer_db.close()
+        shutil.rmtree(self.test_dir)
+
+    def _index(self, name, *texts):
+        self.writer.write(self.test_dir / name, _result(*texts))
+        _, error = self.writer.commit()
+        self.assertIsNone(error)
+
+    def test_T71_05_query_parsing(self):
+        """T71.05: Typed word = prefix, phrases kept, operators are plain text"""
+        self.assertEqual(parse_query("vault backu"), '"vault" "backu"*')
+        self.assertEqual(parse_query("vault backup "), '"vault" "backup"')
+        self.assertEqual(parse_query('"secret no'), '"secret no"*')
+        self.assertEqual(parse_query('"secret note" x'), '"secret note" "x"')
+        self.assertEqual(parse_query("NOT xy* "), '"not" "xy"*')
+        self.assertEqual(parse_query('") OR 1=1 --'), '"or 1 1"')
+        self.assertEqual(parse_query("  "), "")
+
+        self._index("notes.pdf", "the vault backup runs nightly")
+        self.assertEqual(len(self.engine.search("vault back").results), 1)
+        self.assertEqual(len(self.engine.search('"backup vault"').results), 0)
+        self.assertEqual(self.engine.search("").results, [])
+
+    def test_T71_03_highlight_and_escape(self):
+        """T71.03: Matches wrapped in <mark>, document text HTML-escaped"""
+        self._index("page.docx", "python <script>alert(1)</script> python")
+        hit = self.engine.search("python ").results[0]
+
+        self.assertIn("<mark>python</mark>", hit.snippet)
+        self.assertNotIn("<script>", hit.snippet)
+        self.assertIn("&lt;script&gt;", hit.snippet)
+        self.assertEqual((hit.file_name, hit.file_type, hit.page), ("page.docx", "docx", 1))
+
+    def test_T71_04_file_type_filter(self):
+        """T71.04: file_type restricts hits, 'all' does not"""
+        self._index("a.pdf", "quarterly report")
+        self._index("b.docx", "quarterly report")
+
+        pdf = self.engine.search("quarterly", file_type="pdf")
+        self.assertEqual([h.file_type for h in pdf.results], ["pdf"])
+        self.assertEqual(self.engine.search("quarterly", file_type="all").total, 2)
+        with self.assertRaises(ValueError):
+            self.engine.search("quarterly", file_type="exe")
+
+    def test_T71_06_ranking_and_cursor_pagination(self):
+        """T71.06: bm25 order, keyset pages cover every hit exactly once"""
+        self._index("dense.pdf", "cipher cipher cipher cipher")
+        for n in range(24):
+            self._index(f"doc{n:02d}.pdf", f"cipher appears once in a much longer text number {n}")
+
+        first = self.engine.search("cipher ", limit=10)
+        self.assertEqual(first.total, 25)
+        self.assertEqual(first.results[0].file_name, "dense.pdf")
+        ranks = [h.rank for h in first.results]
+        self.assertEqual(ranks, sorted(ranks))
+
+        seen = [h.segment_id for h in first.results]
+        cursor = first.next_cursor
+        while cursor:
+            page = self.engine.search("cipher ", limit=10, cursor=cursor)
+            self.assertEqual(page.total, 25)
+            seen.extend(h.segment_id for h in page.results)
+            cursor = page.next_cursor
+        self.assertEqual(len(seen), 25)
+        self.assertEqual(len(set(seen)), 25)
+
+        with self.assertRaises(ValueError):
+            self.engine.search("cipher", cursor="not-a-cursor")
+
+    def test_T71_07_cache_invalidated_by_commit(self):
+        """T71.07: Repeat query served from cache until the writer commits"""
+        self._index("one.pdf", "journal entry")
+
+        first = self.engine.search("journal")
+        again = self.engine.search("Journal")  # same MATCH expression
+        self.assertFalse(first.cached)
+        self.assertTrue(again.cached)
+        self.assertEqual(again.total, 1)
+        self.assertGreaterEqual(again.query_time_ms, 0.0)
+
+        self._index("two.pdf", "journal draft")
+        fresh = self.engine.search("journal")
+        self.assertFalse(fresh.cached)
+        self.assertEqual(fresh.total, 2)
+
+        stats = self.engine.get_stats()
+        self.assertEqual((stats["cache_hits"], stats["cache_invalidations"]), (1, 1))
+        self.assertEqual(stats["latency"]["count"], 3)
+
+    def test_T71_07b_cache_follows_other_connections(self):
+        """T71.07b: Without a writer handle, PRAGMA data_version invalidates"""
+        engine = FTSSearchEngine(self.reader_db)
+        self._index("one.pdf", "meeting minutes")
+        self.assertEqual(engine.search("meeting").total, 1)
+
+        self._index("two.pdf", "meeting agenda")
+        page = engine.search("meeting")
+        self.assertFalse(page.cached)
+        self.assertEqual(page.total, 2)
+
+
+if __name__ == "__main__":
+    unittest.main()
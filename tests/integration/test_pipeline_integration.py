@@ -3,12 +3,18 @@ TEST_PIPELINE_INTEGRATION.PY - Integration Tests for Extraction Pipeline
 Task 6.5 - Sprint 6 Background Services
 
 T30.01 - T30.04: Golden Path and Failure Scenarios
+T30.10: Parallel process_many (per-MIME caps, single writer)
+T30.11: Group commit + bulk import (automerge off, optimize)
+T30.17: Failed document write rolled back alone (SAVEPOINT), keeps its old content_hash
 """
 
+import os
 import unittest
 import tempfile
 import shutil
+import threading
 import time
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from unittest.mock import MagicMock
 
@@ -16,6 +22,7 @@ from unittest.mock import MagicMock
 from src.core.indexer.pipeline import ExtractionPipeline
 from src.core.indexer.utils.idempotency import PipelineStatus
 from src.core.indexer.encrypted_storage import EncryptedIndexerDB
+from src.core.indexer.fts_writer import FTSBatchWriter
 
 class TestPipelineIntegration(unittest.TestCase):
     """
@@ -33,22 +40,9 @@ class TestPipelineIntegration(unittest.TestCase):
         self.db = EncryptedIndexerDB(self.db_path, key=b"0"*32)
         self.db.connect()
         
-        # 3. Create schema (MDS Protocol 2025 Standard)
-        self.db.execute("CREATE VIRTUAL TABLE document_content USING fts5(content)")
-        self.db.execute("""
-            CREATE TABLE documents (
-                id INTEGER PRIMARY KEY AUTOINCREMENT,
-                path TEXT UNIQUE,
-                filename TEXT,
-                mime_type TEXT,
-                total_chars INTEGER,
-                created_at TEXT
-            )
-        """)
-        self.db.commit()
-        
-        # 4. Initialize Pipeline
+        # 3. Initialize Pipeline + content-linked schema (MDS Protocol 2025 Standard)
         self.pipeline = ExtractionPipeline(self.db)
+        self.pipeline.fts_writer.ensure_schema()
         
         # Setup sample files
         self.pdf_file = self.test_dir / "sample.pdf"
@@ -308,5 +302,447 @@ class TestPipelineIntegration(unittest.TestCase):
         # Should return DEGRADED when no extractor is available
         self.assertEqual(status, PipelineStatus.DEGRADED)
 
+    def test_T30_10_process_many_parallel_single_writer(self):
+        """T30.10: process_many -> parallel extraction, per-MIME cap, one writer thread"""
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        # Arrange: 12 PDFs, in-thread pool standing in for worker processes
+        files = []
+        for i in range(12):
+            path = self.test_dir / f"doc_{i}.pdf"
+            path.write_bytes(b"%PDF" + bytes([i]))
+            files.append(path)
+        
+        lock = threading.Lock()
+        active = [0]
+        peak = [0]
+        
+        def fake_extract(path, mime_type):
+            with lock:
+                active[0] += 1
+                peak[0] = max(peak[0], active[0])
+            time.sleep(0.02)
+            with lock:
+                active[0] -= 1
+            return ExtractionResult(
+                segments=[TextSegment(text=f"parallel content {Path(path).stem}", page=1)],
+                extractor="pdf_pymupdf"
+            )
+        
+        executor = ThreadPoolExecutor(max_workers=6)
+        pool = MagicMock(max_workers=6)
+        pool.submit.side_effect = lambda path, mime: executor.submit(fake_extract, path, mime)
+        self.pipeline._worker_pool = pool
+        
+        writer_threads = set()
+        write = self.pipeline.fts_writer.write
+        
+        def tracking_write(path, result, token=None, **kwargs):
+            writer_threads.add(threading.get_ident())
+            write(path, result, token, **kwargs)
+        
+        self.pipeline.fts_writer.write = tracking_write
+        
+        # Act
+        results = list(self.pipeline.process_many(files, mime_limits={"application/pdf": 3}))
+        executor.shutdown()
+        
+        # Assert
+        self.assertEqual(len(results), 12)
+        self.assertTrue(all(status == PipelineStatus.INDEXED for _, status in results))
+        self.assertEqual({path for path, _ in results}, set(files))
+        self.assertLessEqual(peak[0], 3, "Per-MIME cap exceeded")
+        self.assertGreater(peak[0], 1, "Extraction did not run in parallel")
+        self.assertEqual(writer_threads, {threading.get_ident()}, "FTS writes must stay on caller thread")
+        
+        cursor = self.db.execute("SELECT count(*) FROM documents")
+        self.assertEqual(cursor.fetchone()[0], 12)
+
+    def test_T30_11_group_commit_bulk_import(self):
+        """T30.11: process_many(bulk=True) -> N docs per commit, FTS optimized"""
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        files = []
+        for i in range(10):
+            path = self.test_dir / f"bulk_{i}.pdf"
+            path.write_bytes(b"%PDF" + bytes([i]))
+            files.append(path)
+        
+        executor = ThreadPoolExecutor(max_workers=2)
+        pool = MagicMock(max_workers=2)
+        pool.submit.side_effect = lambda path, mime: executor.submit(
+            lambda: ExtractionResult(segments=[TextSegment(text="bulk import text")], extractor="pdf_pymupdf")
+        )
+        self.pipeline._worker_pool = pool
+        self.pipeline.fts_writer.batch_size = 4
+        self.pipeline.fts_writer.max_delay_s = 10.0
+        
+        executed = []
+        execute = self.db.execute
+        self.db.execute = lambda sql, params=(): (executed.append((sql, params)), execute(sql, params))[1]
+        
+        results = list(self.pipeline.process_many(files, bulk=True))
+        executor.shutdown()
+        
+        self.assertEqual(len(results), 10)
+        self.assertTrue(all(status == PipelineStatus.INDEXED for _, status in results))
+        # 10 docs / 4 per group -> 3 document commits
+        self.assertEqual(self.pipeline.fts_writer.commits, 3)
+        
+        options = [params[0] if params else sql for sql, params in executed if "document_content, rank" in sql or "'optimize'" in sql]
+        self.assertEqual(options[0], 0, "automerge should be disabled first")
+        self.assertEqual(options[1], FTSBatchWriter.FTS_DEFAULT_AUTOMERGE)
+        self.assertIn("'optimize'", options[2])
+        
+        cursor = self.db.execute("SELECT count(*) FROM document_content WHERE document_content MATCH 'bulk'")
+        self.assertEqual(cursor.fetchone()[0], 10)
+
+    def test_T30_12_incremental_reindex_changed_segments(self):
+        """T30.12: Re-index -> chỉ segment thay đổi được tokenize lại, không trùng lặp"""
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        writer = self.pipeline.fts_writer
+        pages_v1 = ["alpha page one", "bravo page two", "charlie page three"]
+        writer.write(self.pdf_file, ExtractionResult(
+            segments=[TextSegment(text=t, page=i + 1) for i, t in enumerate(pages_v1)],
+            extractor="pdf_pymupdf"
+        ))
+        writer.commit()
+        doc_id = self.db.execute("SELECT id FROM documents").fetchone()[0]
+        self.assertEqual(writer.segments_indexed, 3)
+        
+        # Page 2 edited, page 3 removed
+        writer.write(self.pdf_file, ExtractionResult(
+            segments=[TextSegment(text="alpha page one", page=1), TextSegment(text="delta page two", page=2)],
+            extractor="pdf_pymupdf"
+        ))
+        writer.commit()
+        
+        self.assertEqual(writer.segments_indexed, 4, "Only the edited page is re-tokenized")
+        self.assertEqual(writer.segments_reused, 1)
+        self.assertEqual(writer.segments_deleted, 2)
+        self.assertEqual(self.db.execute("SELECT id FROM documents").fetchone()[0], doc_id, "documents.id must stay stable")
+        
+        def hits(term):
+            return self.db.execute(
+                "SELECT count(*) FROM document_content WHERE document_content MATCH ?", (term,)
+            ).fetchone()[0]
+        self.assertEqual(hits("alpha"), 1)
+        self.assertEqual(hits("delta"), 1)
+        self.assertEqual(hits("bravo"), 0)
+        self.assertEqual(hits("charlie"), 0)
+        
+        # rowid join back to the owning document
+        cursor = self.db.execute("""
+            SELECT d.filename, s.page FROM document_content
+            JOIN document_segments s ON s.id = document_content.rowid
+            JOIN documents d ON d.id = s.doc_id
+            WHERE document_content MATCH 'delta'
+        """)
+        self.assertEqual(cursor.fetchone(), ("sample.pdf", 2))
+        
+        # FTS index consistent with its content table
+        self.db.execute("INSERT INTO document_content (document_content) VALUES ('integrity-check')")
+
+    def test_T30_13_legacy_fts_schema_migrated(self):
+        """T30.13: Bảng fts5(content) cũ (không liên kết) được thay bằng external-content"""
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        self.db.execute("DROP TABLE document_content")
+        self.db.execute("CREATE VIRTUAL TABLE document_content USING fts5(content)")
+        self.db.execute("INSERT INTO document_content (content) VALUES ('orphan legacy row')")
+        self.db.commit()
+        
+        writer = FTSBatchWriter(self.db)
+        writer.write(self.pdf_file, ExtractionResult(segments=[TextSegment(text="fresh row")], extractor="pdf_pymupdf"))
+        writer.commit()
+        
+        sql = self.db.execute("SELECT sql FROM sqlite_master WHERE name = 'document_content'").fetchone()[0]
+        self.assertIn("content_rowid", sql)
+        cursor = self.db.execute("SELECT count(*) FROM document_content WHERE document_content MATCH 'orphan'")
+        self.assertEqual(cursor.fetchone()[0], 0)
+        cursor = self.db.execute("SELECT count(*) FROM document_content WHERE document_content MATCH 'fresh'")
+        self.assertEqual(cursor.fetchone()[0], 1)
+
+    def test_T30_14_streaming_extractor_writes_page_by_page(self):
+        """T30.14: Extractor streaming -> segment ghi thẳng vào FTS, lỗi nặng thì rollback"""
+        from src.core.indexer.extractors.result import ExtractionError, ExtractionResult, TextSegment
+        
+        self.pdf_file.touch()
+        consumed = []
+        
+        def pages(result, texts, fail=False):
+            for i, text in enumerate(texts):
+                consumed.append(text)
+                yield TextSegment(text=text, page=i + 1)
+            if fail:
+                result.add_error(ExtractionError.CORRUPTED, "xref broken", recoverable=False)
+        
+        class StreamingExtractor:
+            SUPPORTS_STREAMING = True
+            fail = False
+            
+            def extract_stream(self, path):
+                result = ExtractionResult(extractor="pdf_pymupdf")
+                return result, pages(result, ["stream page one", "stream page two"], self.fail)
+        
+        extractor = StreamingExtractor()
+        self.pipeline.registry.get_extractor = MagicMock(return_value=extractor)
+        
+        status = self.pipeline.process_file(self.pdf_file)
+        
+        self.assertEqual(status, PipelineStatus.INDEXED)
+        self.assertEqual(len(consumed), 2)
+        cursor = self.db.execute("SELECT total_chars FROM documents WHERE filename='sample.pdf'")
+        self.assertEqual(cursor.fetchone()[0], 30)
+        cursor = self.db.execute("SELECT count(*) FROM document_content WHERE document_content MATCH 'stream'")
+        self.assertEqual(cursor.fetchone()[0], 2)
+        
+        # Non-recoverable error after pages were written -> nothing persisted
+        time.sleep(0.01)
+        self.pdf_file.write_text("modified")
+        extractor.fail = True
+        
+        status = self.pipeline.process_file(self.pdf_file)
+        
+        self.assertEqual(status, PipelineStatus.QUARANTINED)
+        self.assertEqual(self.pipeline.fts_writer.pending, 0)
+        cursor = self.db.execute("SELECT count(*) FROM document_content WHERE document_content MATCH 'stream'")
+        self.assertEqual(cursor.fetchone()[0], 2, "Previous version must survive the rollback")
+
+    def test_T30_15_process_many_batches_docx(self):
+        """T30.15: Extractor SUPPORTS_BATCH -> DOCX gửi theo nhóm, PDF từng file"""
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        docx_files = []
+        for i in range(10):
+            path = self.test_dir / f"batch_{i}.docx"
+            path.write_bytes(b"PK" + bytes([i]))
+            docx_files.append(path)
+        self.pdf_file.write_bytes(b"%PDF")
+        
+        batch_extractor = MagicMock(SUPPORTS_BATCH=True)
+        self.pipeline.registry.get_extractor = MagicMock(
+            side_effect=lambda mime: batch_extractor if "wordprocessingml" in mime else self.mock_extractor
+        )
+        
+        batches = []
+        executor = ThreadPoolExecutor(max_workers=2)
+        pool = MagicMock(max_workers=2)
+        
+        def submit_batch(paths, mime):
+            batches.append(len(paths))
+            return executor.submit(lambda: [
+                ExtractionResult(segments=[TextSegment(text=f"batched {Path(p).stem}")], extractor="docx_rust")
+                for p in paths
+            ])
+        
+        pool.submit_batch.side_effect = submit_batch
+        pool.submit.side_effect = lambda path, mime: executor.submit(
+            lambda: ExtractionResult(segments=[TextSegment(text="single pdf")], extractor="pdf_pymupdf")
+        )
+        self.pipeline._worker_pool = pool
+        
+        results = dict(self.pipeline.process_many(docx_files + [self.pdf_file]))
+        executor.shutdown()
+        
+        self.assertEqual(len(results), 11)
+        self.assertTrue(all(status == PipelineStatus.INDEXED for status in results.values()))
+        self.assertEqual(sum(batches), 10)
+        self.assertTrue(all(size <= ExtractionPipeline.EXTRACT_BATCH_SIZE for size in batches))
+        self.assertLess(len(batches), 10, "DOCX files should be grouped")
+        self.assertEqual(pool.submit.call_count, 1)
+        
+        cursor = self.db.execute("SELECT count(*) FROM document_content WHERE document_content MATCH 'batched'")
+        self.assertEqual(cursor.fetchone()[0], 10)
+
+    def test_T30_16_content_dedup_relink_and_cache(self):
+        """T30.16: Move -> chỉ cập nhật metadata; copy -> lấy từ cache, không extract lại"""
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        self.pdf_file.write_bytes(b"%PDF-1.7 same bytes")
+        self.mock_extractor.EXTRACTOR_NAME = "pdf_pymupdf"
+        self.mock_extractor.VERSION = "1.0"
+        self.mock_extractor.extract.return_value = ExtractionResult(
+            segments=[TextSegment(text="deduplicated content", page=1)],
+            extractor="pdf_pymupdf", version="1.0"
+        )
+        self.assertEqual(self.pipeline.process_file(self.pdf_file), PipelineStatus.INDEXED)
+        doc_id = self.db.execute("SELECT id FROM documents").fetchone()[0]
+        
+        # Rename: same bytes, old path gone -> row re-pointed, no extraction
+        moved = self.test_dir / "renamed.pdf"
+        self.pdf_file.rename(moved)
+        self.assertEqual(self.pipeline.process_file(moved), PipelineStatus.INDEXED)
+        self.assertEqual(self.mock_extractor.extract.call_count, 1)
+        self.assertEqual(
+            self.db.execute("SELECT id, filename FROM documents").fetchall(),
+            [(doc_id, "renamed.pdf")]
+        )
+        
+        # Copy: old path still exists -> new row from the extraction cache
+        copy = self.test_dir / "copy.pdf"
+        copy.write_bytes(moved.read_bytes())
+        self.assertEqual(self.pipeline.process_file(copy), PipelineStatus.INDEXED)
+        self.assertEqual(self.mock_extractor.extract.call_count, 1)
+        self.assertEqual(self.pipeline.cache.hits, 1)
+        
+        cursor = self.db.execute("SELECT count(*) FROM document_content WHERE document_content MATCH 'deduplicated'")
+        self.assertEqual(cursor.fetchone()[0], 2)
+        
+        # Touch: mtime changes, content does not -> still no extraction
+        time.sleep(0.01)
+        os.utime(copy)
+        self.assertEqual(self.pipeline.process_file(copy), PipelineStatus.INDEXED)
+        self.assertEqual(self.mock_extractor.extract.call_count, 1)
+        self.assertEqual(self.pipeline.get_stats()["relinked"], 1)
+
+    def test_T30_17_failed_write_rolled_back_alone(self):
+        """T30.17: A document failing mid-segments leaves no rows and keeps its old hash"""
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        writer = FTSBatchWriter(self.db, batch_size=10)
+        other = self.test_dir / "other.pdf"
+        writer.write(self.pdf_file, ExtractionResult(
+            segments=[TextSegment(text="original page", page=1)], extractor="pdf_pymupdf"
+        ), content_hash="hash-v1")
+        writer.commit()
+        
+        def failing_pages():
+            yield TextSegment(text="half written page", page=1)
+            raise OSError("extractor died")
+        
+        # Same group: one good document, one re-index that fails midway
+        writer.write(other, ExtractionResult(
+            segments=[TextSegment(text="unrelated page")], extractor="pdf_pymupdf"
+        ), token="other", content_hash="hash-other")
+        with self.assertRaises(OSError):
+            writer.write(self.pdf_file, ExtractionResult(extractor="pdf_pymupdf"),
+                         token="failed", segments=failing_pages(), content_hash="hash-v2")
+        tokens, error = writer.commit()
+        
+        self.assertIsNone(error)
+        self.assertEqual(tokens, ["other"])
+        hits = lambda term: self.db.execute(
+            "SELECT count(*) FROM document_content WHERE document_content MATCH ?", (term,)
+        ).fetchone()[0]
+        self.assertEqual((hits("unrelated"), hits("original"), hits("half")), (1, 1, 0))
+        self.assertEqual(
+            self.db.execute("SELECT content_hash FROM documents WHERE filename = 'sample.pdf'").fetchone(),
+            ("hash-v1",)
+        )
+        # Not mistaken for "already indexed" on the next event
+        self.assertFalse(writer.relink(self.pdf_file, "hash-v2"))
+        self.db.execute("INSERT INTO document_content (document_content) VALUES ('integrity-check')")
+
+    def test_T30_18_cache_keyed_by_producing_backend(self):
+        """T30.18: docx_rs và python-docx không ghi đè nhau trong cache; đổi version Rust → miss"""
+        from src.core.indexer.extraction_cache import ExtractionCache
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        class TwoBackendExtractor:
+            EXTRACTOR_NAME = "docx_python"
+            VERSION = "1.0.0-python-fallback"
+            native = ("docx_rust", "1.1.0")
+            
+            def cache_identities(self):
+                return [self.native, (self.EXTRACTOR_NAME, self.VERSION)]
+        
+        cache = ExtractionCache(self.db)
+        extractor = TwoBackendExtractor()
+        cache.put("digest", extractor, ExtractionResult(
+            segments=[TextSegment(text="from rust")], extractor="docx_rust", version="1.1.0"
+        ))
+        cache.put("digest", extractor, ExtractionResult(
+            segments=[TextSegment(text="from python")], extractor="docx_python",
+            version="1.0.0-python-fallback"
+        ))
+        self.assertEqual(self.db.execute("SELECT count(*) FROM extraction_cache").fetchone()[0], 2)
+        self.assertEqual(cache.get("digest", extractor).segments[0].text, "from rust")
+        
+        extractor.native = ("docx_rust", "1.2.0")  # Rust upgrade: its old entry is stale
+        self.assertEqual(cache.get("digest", extractor).segments[0].text, "from python")
+        
+        stored = self.db.execute("SELECT SUM(size_bytes) FROM extraction_cache").fetchone()[0]
+        self.assertEqual(cache.get_stats()["size_bytes"], stored)
+
+    def test_T30_19_constructor_tuning_defaults(self):
+        """T30.19: max_workers/mime_limits của constructor (tuning profile) là mặc định của process_many"""
+        from unittest import mock
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        
+        files = []
+        for i in range(6):
+            path = self.test_dir / f"tuned_{i}.pdf"
+            path.write_bytes(b"%PDF" + bytes([i]))
+            files.append(path)
+        
+        lock = threading.Lock()
+        active = [0]
+        peak = [0]
+        
+        def fake_extract(path, mime_type):
+            with lock:
+                active[0] += 1
+                peak[0] = max(peak[0], active[0])
+            time.sleep(0.01)
+            with lock:
+                active[0] -= 1
+            return ExtractionResult(segments=[TextSegment(text="tuned")], extractor="pdf_pymupdf")
+        
+        executor = ThreadPoolExecutor(max_workers=4)
+        pool = MagicMock(max_workers=4)
+        pool.submit.side_effect = lambda path, mime: executor.submit(fake_extract, path, mime)
+        
+        pipeline = ExtractionPipeline(self.db, max_workers=4, mime_limits={"application/pdf": 1})
+        with mock.patch("src.core.indexer.pipeline.ExtractionWorkerPool", return_value=pool) as factory:
+            results = list(pipeline.process_many(files))
+        executor.shutdown()
+        
+        self.assertEqual(factory.call_args[0][0], 4)
+        self.assertEqual(len(results), 6)
+        self.assertEqual(peak[0], 1, "Constructor PDF cap ignored")
+
+    def test_T30_20_zero_cap_rejected_and_early_close_releases(self):
+        """T30.20: cap 0 -> ValueError (không treo); đóng generator sớm -> file chưa xong được trả lại"""
+        from concurrent.futures import Future
+        from src.core.indexer.extractors.result import ExtractionResult, TextSegment
+        from src.core.indexer.utils.idempotency import EventIdempotency
+        
+        with self.assertRaises(ValueError):
+            ExtractionPipeline(self.db, mime_limits={"application/pdf": 0})
+        with self.assertRaises(ValueError):
+            next(self.pipeline.process_many([self.pdf_file], mime_limits={"application/pdf": 0}))
+        
+        files = []
+        for i in range(5):
+            path = self.test_dir / f"early_{i}.pdf"
+            path.write_bytes(b"%PDF" + bytes([i]))
+            files.append(path)
+        
+        # First task finishes, the rest never do (hung workers)
+        submitted = []
+        
+        def submit(path, mime_type):
+            future = Future()
+            if not submitted:
+                future.set_result(ExtractionResult(segments=[TextSegment(text="first")], extractor="pdf_pymupdf"))
+            submitted.append(future)
+            return future
+        
+        pool = MagicMock(max_workers=2)
+        pool.submit.side_effect = submit
+        self.pipeline._worker_pool = pool
+        
+        results = self.pipeline.process_many(files)
+        first_path, first_status = next(results)
+        results.close()
+        
+        self.assertEqual((first_path, first_status), (files[0], PipelineStatus.INDEXED))
+        self.assertTrue(all(future.cancelled() for future in submitted[1:]))
+        for path in files[1:]:
+            key = EventIdempotency.generate_key(path)
+            self.assertTrue(self.pipeline.idempotency.should_process(key), f"{path.name} left processing")
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,115 @@
+import asyncio
+import sqlite3
+import pytest
+from types import SimpleNamespace
+from src.core.crypto.hmac_service import HMACService
+from src.core.security.background_verifier import BackgroundChainVerifier, VerificationProgress
+
+DDL = """
+CREATE TABLE domain_events (
+    event_id TEXT PRIMARY KEY,
+    stream_type TEXT NOT NULL,
+    stream_id TEXT NOT NULL,
+    stream_sequence INTEGER NOT NULL,
+    payload BLOB NOT NULL,
+    event_hmac TEXT NOT NULL,
+    hmac_key_version TEXT NOT NULL DEFAULT 'v1',
+    UNIQUE(stream_type, stream_id, stream_sequence)
+)
+"""
+
+
+def _vault(tmp_path, streams=3, events=250):
+    db_path = tmp_path / 'vault.db'
+    hmac_service = HMACService({'v1': b'master_key'})
+    conn = sqlite3.connect(db_path)
+    conn.execute(DDL)
+    for s in range(streams):
+        stream_id = f'stream-{s}'
+        for seq in range(1, events + 1):
+            payload = f'{stream_id}:{seq}'.encode()
+            signature, version = hmac_service.sign(payload, stream_id)
+            conn.execute(
+                "INSERT INTO domain_events VALUES (?, 'domain', ?, ?, ?, ?, ?)",
+                (f'{stream_id}-{seq}', stream_id, seq, payload, signature, version)
+            )
+    conn.commit()
+    conn.close()
+    return SimpleNamespace(db_path=db_path, hmac_service=hmac_service)
+
+
+def _count_checked(adapter):
+    calls = []
+    verify = adapter.hmac_service.verify
+    def counting(payload, hmac_hex, stream_id, key_version):
+        calls.append(stream_id)
+        return verify(payload, hmac_hex, stream_id, key_version)
+    adapter.hmac_service.verify = counting
+    return calls
+
+
+def test_verify_all_batched_with_throughput(tmp_path):
+    adapter = _vault(tmp_path)
+    verifier = BackgroundChainVerifier(adapter, max_workers=2)
+    verifier.BATCH_SIZE = 100
+    progress = []
+
+    results = asyncio.run(verifier.verify_all_async(progress.append))
+    verifier.shutdown()
+
+    assert results == {f'domain:stream-{s}': True for s in range(3)}
+    final = [p for p in progress if p.done]
+    assert len(final) == 3 and all(p.verified == 250 for p in final)
+    assert all(isinstance(p, VerificationProgress) and p.events_per_second > 0 for p in final)
+
+
+def test_checkpoints_survive_restart(tmp_path):
+    adapter = _vault(tmp_path, streams=2, events=50)
+    first = BackgroundChainVerifier(adapter)
+    assert all(asyncio.run(first.verify_all_async()).values())
+    first.shutdown()
+
+    # New process: nothing re-verified
+    checked = _count_checked(adapter)
+    second = BackgroundChainVerifier(adapter)
+    assert all(asyncio.run(second.verify_all_async()).values())
+    second.shutdown()
+    # Only the checkpoint signatures themselves are checked
+    assert set(checked) == {'__chain_verification_checkpoint__'}
+
+
+def test_forged_checkpoint_is_ignored(tmp_path):
+    adapter = _vault(tmp_path, streams=1, events=50)
+    verifier = BackgroundChainVerifier(adapter)
+    assert asyncio.run(verifier.verify_stream_async('domain', 'stream-0'))
+    verifier.shutdown()
+
+    # Tamper an early event, then push the checkpoint past it
+    conn = sqlite3.connect(adapter.db_path)
+    conn.execute("UPDATE domain_events SET payload = X'00' WHERE stream_sequence = 10")
+    conn.execute("UPDATE chain_verification_checkpoints SET verified_count = 999")
+    conn.commit()
+    conn.close()
+
+    restarted = BackgroundChainVerifier(adapter)
+    assert asyncio.run(restarted.verify_stream_async('domain', 'stream-0')) is False
+    restarted.shutdown()
+
+
+def test_rewritten_tail_invalidates_checkpoint(tmp_path):
+    adapter = _vault(tmp_path, streams=1, events=20)
+    verifier = BackgroundChainVerifier(adapter)
+    assert asyncio.run(verifier.verify_stream_async('domain', 'stream-0'))
+    verifier.shutdown()
+
+    # Signed checkpoint is fine, but the event it points at changed
+    conn = sqlite3.connect(adapter.db_path)
+    conn.execute("UPDATE domain_events SET event_hmac = '00' WHERE stream_sequence = 20")
+    conn.commit()
+    conn.close()
+
+    checked = _count_checked(adapter)
+    restarted = BackgroundChainVerifier(adapter)
+    assert asyncio.run(restarted.verify_stream_async('domain', 'stream-0')) is False
+    restarted.shutdown()
+    assert checked.count('stream-0') == 20
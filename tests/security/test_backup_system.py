@@ -3,12 +3,16 @@ import asyncio
 from pathlib import Path
 import tempfile
 import os
+import sqlite3
 
 from src.core.services.backup import (
     create_backup,
     restore_backup,
     BackupCryptoError,
     BackupIntegrityError,
+    BACKUP_KEY_CACHE,
+    create_incremental_backup,
+    restore_incremental_backup,
     secure_wipe_file
 )
 
@@ -102,6 +106,41 @@ def test_secure_wipe(tmp_path):
     secure_wipe_file(test_file)
     assert not test_file.exists()
 
+@pytest.mark.asyncio
+async def test_snapshot_staged_privately_next_to_vault(tmp_path):
+    """Plaintext snapshot never touches the backup target; output is 0600"""
+    from src.core.services import backup as backup_module
+    
+    vault_dir = tmp_path / "vault"
+    vault_dir.mkdir()
+    db_path = vault_dir / "vault.db"
+    conn = sqlite3.connect(db_path)
+    conn.execute("CREATE TABLE notes (body TEXT)")
+    conn.execute("INSERT INTO notes VALUES ('plaintext secret')")
+    conn.commit()
+    conn.close()
+    target = tmp_path / "usb" / "vault.cvbak"
+    target.parent.mkdir()
+    
+    staged = []
+    snapshot = backup_module._snapshot
+    def spy(src, snapshot_path):
+        staged.append((snapshot_path, snapshot_path.parent.stat().st_mode & 0o777))
+        return snapshot(src, snapshot_path)
+    backup_module._snapshot = spy
+    try:
+        await create_backup(db_path, TEST_PASSKEY, target)
+    finally:
+        backup_module._snapshot = snapshot
+    
+    (snapshot_path, dir_mode), = staged
+    assert snapshot_path.parent.parent == vault_dir
+    assert dir_mode == 0o700
+    assert not snapshot_path.parent.exists()
+    assert [p.name for p in target.parent.iterdir()] == ["vault.cvbak"]
+    if os.name == "posix":
+        assert target.stat().st_mode & 0o777 == 0o600
+
 @pytest.mark.asyncio
 async def test_progress_callback(test_db, backup_path):
     """Test that progress callback is called"""
@@ -116,3 +155,146 @@ async def test_progress_callback(test_db, backup_path):
     assert len(progress_updates) > 0
     assert progress_updates[0][0] == 0  # Started at 0%
     assert progress_updates[-1][0] == 100  # Ended at 100%
+
+@pytest.mark.asyncio
+async def test_streamed_backup_multiple_chunks(tmp_path, backup_path):
+    """Test chunked stream round-trip and truncation detection"""
+    large_db = tmp_path / "large.db"
+    content = b"SQLite format 3\x00" + os.urandom(70000)
+    large_db.write_bytes(content)
+    
+    # 4 KB chunks -> 18 secretstream chunks
+    await create_backup(large_db, TEST_PASSKEY, backup_path, chunk_size=4096)
+    restored_db = tmp_path / "restored.db"
+    await restore_backup(backup_path, TEST_PASSKEY, restored_db)
+    assert restored_db.read_bytes() == content
+    
+    # Drop the final chunk: must not restore, must not touch the target
+    data = backup_path.read_bytes()
+    backup_path.write_bytes(data[:-(4096 // 2)])
+    restored_db.write_bytes(b"keep")
+    with pytest.raises(BackupIntegrityError):
+        await restore_backup(backup_path, TEST_PASSKEY, restored_db)
+    assert restored_db.read_bytes() == b"keep"
+
+@pytest.mark.asyncio
+async def test_legacy_backup_still_restores(test_db, backup_path, tmp_path):
+    """Test v1 backups (salt | SecretBox) remain readable"""
+    import nacl.pwhash
+    import nacl.secret
+    import nacl.utils
+    
+    salt = nacl.utils.random(nacl.pwhash.argon2id.SALTBYTES)
+    key = nacl.pwhash.argon2id.kdf(
+        size=nacl.secret.SecretBox.KEY_SIZE,
+        password=TEST_PASSKEY.encode('utf-8'),
+        salt=salt,
+        opslimit=nacl.pwhash.argon2id.OPSLIMIT_MODERATE,
+        memlimit=nacl.pwhash.argon2id.MEMLIMIT_MODERATE
+    )
+    backup_path.write_bytes(salt + nacl.secret.SecretBox(key).encrypt(test_db.read_bytes()))
+    
+    restored_db = tmp_path / "restored.db"
+    assert await restore_backup(backup_path, TEST_PASSKEY, restored_db) is True
+    assert restored_db.read_bytes() == test_db.read_bytes()
+
+def _sqlite_db(path, rows):
+    conn = sqlite3.connect(path)
+    conn.execute("CREATE TABLE IF NOT EXISTS notes (id INTEGER PRIMARY KEY, content TEXT)")
+    conn.executemany("INSERT OR REPLACE INTO notes VALUES (?, ?)", rows)
+    conn.commit()
+    conn.close()
+
+def _notes(path):
+    conn = sqlite3.connect(path)
+    try:
+        return conn.execute("SELECT id, content FROM notes ORDER BY id").fetchall()
+    finally:
+        conn.close()
+
+@pytest.mark.asyncio
+async def test_incremental_backup_chain(tmp_path):
+    """Test base + deltas: only changed pages written, every point restorable"""
+    db_path = tmp_path / "vault.db"
+    chain_dir = tmp_path / "chain"
+    _sqlite_db(db_path, [(n, os.urandom(200).hex()) for n in range(2000)])
+    
+    base = await create_incremental_backup(db_path, TEST_PASSKEY, chain_dir)
+    assert base["sequence"] == 0
+    assert base["changed_pages"] == base["page_count"]
+    v0 = _notes(db_path)
+    
+    _sqlite_db(db_path, [(5, "edited")])
+    delta = await create_incremental_backup(db_path, TEST_PASSKEY, chain_dir)
+    assert delta["sequence"] == 1
+    assert 0 < delta["changed_pages"] < base["page_count"] // 10
+    assert (chain_dir / delta["file"]).stat().st_size < (chain_dir / base["file"]).stat().st_size // 10
+    
+    unchanged = await create_incremental_backup(db_path, TEST_PASSKEY, chain_dir)
+    assert unchanged["changed_pages"] == 0
+    
+    restored = tmp_path / "restored.db"
+    assert await restore_incremental_backup(chain_dir, TEST_PASSKEY, restored) is True
+    assert _notes(restored) == _notes(db_path)
+    
+    assert await restore_incremental_backup(chain_dir, TEST_PASSKEY, restored, upto=0) is True
+    assert _notes(restored) == v0
+
+@pytest.mark.asyncio
+async def test_incremental_chain_tamper_and_passkey(tmp_path):
+    """Test altered delta files and a wrong passkey are rejected"""
+    db_path = tmp_path / "vault.db"
+    chain_dir = tmp_path / "chain"
+    _sqlite_db(db_path, [(n, "x" * 100) for n in range(500)])
+    await create_incremental_backup(db_path, TEST_PASSKEY, chain_dir)
+    _sqlite_db(db_path, [(1, "y")])
+    delta = await create_incremental_backup(db_path, TEST_PASSKEY, chain_dir)
+    
+    restored = tmp_path / "restored.db"
+    with pytest.raises(BackupIntegrityError):
+        await restore_incremental_backup(chain_dir, "WrongPassword", restored)
+    with pytest.raises(BackupIntegrityError):
+        await create_incremental_backup(db_path, "WrongPassword", chain_dir)
+    
+    with open(chain_dir / delta["file"], 'r+b') as f:
+        f.seek(100)
+        f.write(b'\xFF' * 10)
+    with pytest.raises(BackupIntegrityError):
+        await restore_incremental_backup(chain_dir, TEST_PASSKEY, restored)
+    assert not restored.exists()
+
+@pytest.mark.asyncio
+async def test_backup_kdf_cached_per_session(tmp_path):
+    """Test the Argon2id output is derived once for a whole chain"""
+    db_path = tmp_path / "vault.db"
+    _sqlite_db(db_path, [(1, "a")])
+    misses = BACKUP_KEY_CACHE.misses
+    
+    for _ in range(3):
+        await create_incremental_backup(db_path, TEST_PASSKEY, tmp_path / "chain")
+    await restore_incremental_backup(tmp_path / "chain", TEST_PASSKEY, tmp_path / "restored.db")
+    assert BACKUP_KEY_CACHE.misses == misses + 1
+
+@pytest.mark.asyncio
+async def test_crafted_kdf_limits_rejected_before_derivation(test_db, backup_path, tmp_path):
+    """Test oversized Argon2id limits in an unauthenticated header never reach the KDF"""
+    import struct
+    from unittest import mock
+    
+    await create_backup(test_db, TEST_PASSKEY, backup_path)
+    data = bytearray(backup_path.read_bytes())
+    struct.pack_into("<Q", data, 32, 1 << 50)  # memlimit: 1 PiB
+    backup_path.write_bytes(bytes(data))
+    
+    chain_dir = tmp_path / "chain"
+    await create_incremental_backup(test_db, TEST_PASSKEY, chain_dir)
+    manifest = bytearray((chain_dir / "manifest.cvman").read_bytes())
+    struct.pack_into("<Q", manifest, 24, 1 << 40)  # opslimit
+    (chain_dir / "manifest.cvman").write_bytes(bytes(manifest))
+    
+    with mock.patch("nacl.pwhash.argon2id.kdf") as kdf:
+        with pytest.raises(BackupIntegrityError):
+            await restore_backup(backup_path, TEST_PASSKEY, tmp_path / "restored.db")
+        with pytest.raises(BackupIntegrityError):
+            await restore_incremental_backup(chain_dir, TEST_PASSKEY, tmp_path / "restored.db")
+        kdf.assert_not_called()
@@ -24,3 +24,17 @@ def test_kms_invalid_passkey(tmp_path):
     # Wrong pass
     assert kms.unlock('wrong') is False
     assert kms.is_unlocked is False
+
+def test_kms_lock_zeroes_derived_keys(tmp_path):
+    kms = KMS(storage_path=str(tmp_path / 'lock.json'))
+    kms.initialize('secret')
+    kms.unlock('secret')
+    
+    kms.key_cache.get_or_derive(('v1', 'domain_events'), lambda: b'\x01' * 64)
+    cached = next(iter(kms.key_cache._entries.values()))
+    
+    kms.lock()
+    assert kms.is_unlocked is False
+    assert kms.master_key is None
+    assert len(kms.key_cache) == 0
+    assert cached.data == b'\x00' * 64
@@ -9,6 +9,9 @@ Test Categories:
 - T01-T03: Core functionality
 - T04-T05: Performance
 - T06-T08: Resilience
+- T09-T10: Sharded publish
+- T11-T12: Batch subscriber dispatch
+- T13-T16: Flow control (credits, block, spool)
 """
 
 import gc
@@ -24,7 +27,7 @@ from unittest.mock import Mock, patch
 
 import pytest
 
-from src.core.services.eventbus import HeavyEventBus, EventBusMetrics, EventEnvelope
+from src.core.services.eventbus import HeavyEventBus, EventBusMetrics, EventEnvelope, EventBusFull
 
 
 # ===================================================================
@@ -362,6 +365,441 @@ class TestEventBusResilience(unittest.TestCase):
         print(f"\n   ✅ T08: Memory stability smoke test passed")
 
 
+# ===================================================================
+# NHÓM 4: SHARDED PUBLISH (T09-T10)
+# ===================================================================
+
+class TestEventBusSharded(unittest.TestCase):
+    """Sharded multi-producer publish path"""
+    
+    def tearDown(self):
+        gc.collect()
+
+    @pytest.mark.eventbus_performance
+    def test_T09_sharded_concurrent_publish_delivers_all(self):
+        """T09: Sharded mode - nhiều producer, không mất event, giữ thứ tự mỗi producer"""
+        bus = HeavyEventBus(max_queue_size=100000, max_workers=1, name="sharded_test", shards=4)
+        
+        received = []
+        received_lock = threading.Lock()
+        
+        def subscriber(event):
+            with received_lock:
+                received.append(event)
+        
+        bus.subscribe(subscriber, name="collector")
+        bus.start()
+        
+        producers, per_producer = 8, 1000
+        event_ids = []
+        ids_lock = threading.Lock()
+        
+        def producer(pid):
+            local_ids = [bus.publish({"producer": pid, "seq": i}) for i in range(per_producer)]
+            with ids_lock:
+                event_ids.extend(local_ids)
+        
+        threads = [threading.Thread(target=producer, args=(p,)) for p in range(producers)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        
+        bus.stop(graceful=True)
+        
+        total = producers * per_producer
+        metrics = bus.metrics()
+        
+        self.assertEqual(metrics.events_published, total)
+        self.assertEqual(metrics.events_dropped, 0)
+        self.assertEqual(len(received), total)
+        self.assertEqual(len(set(event_ids)), total, "Event IDs must be unique")
+        
+        uuid_pattern = re.compile(
+            r'^[0-9a-f]{8}-[0-9a-f]{4}-4[0-9a-f]{3}-[89ab][0-9a-f]{3}-[0-9a-f]{12}$'
+        )
+        self.assertTrue(all(uuid_pattern.match(e) for e in event_ids))
+        
+        # Single worker → delivery order == dispatch order
+        for pid in range(producers):
+            seqs = [e["seq"] for e in received if e["producer"] == pid]
+            self.assertEqual(seqs, list(range(per_producer)), f"Producer {pid} out of order")
+        
+        print(f"\n   ✅ T09: Sharded bus delivered {total} events from {producers} producers")
+
+    @pytest.mark.eventbus_core
+    def test_T10_sharded_backpressure_per_shard(self):
+        """T10: Sharded mode - drop-oldest theo từng shard"""
+        bus = HeavyEventBus(max_queue_size=20, name="sharded_bp", shards=2)
+        
+        # Not started: nothing drains, single thread → single shard (cap 10)
+        for i in range(15):
+            bus.publish({"seq": i})
+        
+        metrics = bus.metrics()
+        self.assertEqual(metrics.events_published, 15)
+        self.assertEqual(metrics.events_dropped, 5)
+        self.assertEqual(metrics.queue_size_current, 10)
+        
+        print("\n   ✅ T10: Per-shard drop-oldest backpressure")
+
+
+# ===================================================================
+# NHÓM 5: BATCH DISPATCH (T11-T12)
+# ===================================================================
+
+class TestEventBusBatchDispatch(unittest.TestCase):
+    """subscribe(..., batch=True) delivery"""
+    
+    def tearDown(self):
+        gc.collect()
+
+    @pytest.mark.eventbus_performance
+    def test_T11_batch_subscriber_receives_lists(self):
+        """T11: Batch subscriber nhận list theo max_batch, đúng thứ tự"""
+        bus = HeavyEventBus(max_queue_size=10000, max_workers=1, name="batch_test")
+        
+        batches = []
+        
+        def batch_subscriber(events):
+            batches.append(list(events))
+        
+        bus.subscribe(batch_subscriber, name="batcher", batch=True, max_batch=100, max_delay_ms=1000)
+        bus.start()
+        
+        for i in range(1000):
+            bus.publish({"seq": i})
+        
+        bus.stop(graceful=True)
+        
+        self.assertEqual(len(batches), 10, f"Expected 10 batches of 100, got {len(batches)}")
+        self.assertTrue(all(len(b) == 100 for b in batches))
+        self.assertEqual([e["seq"] for b in batches for e in b], list(range(1000)))
+        self.assertEqual(bus.metrics().events_processed, 1000)
+        
+        print("\n   ✅ T11: 1000 events delivered as 10 batch callbacks")
+
+    @pytest.mark.eventbus_core
+    def test_T12_partial_batch_flushed_after_max_delay(self):
+        """T12: Batch chưa đầy được giao sau max_delay_ms"""
+        bus = HeavyEventBus(max_queue_size=1000, name="batch_delay_test")
+        
+        delivered = threading.Event()
+        received = []
+        
+        def batch_subscriber(events):
+            received.extend(events)
+            delivered.set()
+        
+        bus.subscribe(batch_subscriber, name="batcher", batch=True, max_batch=100, max_delay_ms=50)
+        bus.start()
+        
+        start = time.time()
+        for i in range(5):
+            bus.publish({"seq": i})
+        
+        self.assertTrue(delivered.wait(timeout=1.0), "Partial batch should be flushed")
+        elapsed = time.time() - start
+        
+        bus.stop()
+        
+        self.assertEqual(len(received), 5)
+        self.assertLess(elapsed, 0.5, f"Flushed after {elapsed:.3f}s, expected ~50ms")
+        
+        print(f"\n   ✅ T12: Partial batch flushed after {elapsed * 1000:.0f}ms")
+
+
+# ===================================================================
+# NHÓM 6: FLOW CONTROL (T13-T16)
+# ===================================================================
+
+class TestEventBusFlowControl(unittest.TestCase):
+    """Credits + overflow="block"/"spool" (no silent drops)"""
+    
+    def setUp(self):
+        self.temp_dir = tempfile.mkdtemp()
+        self.spool_path = os.path.join(self.temp_dir, "bus.spool")
+    
+    def tearDown(self):
+        shutil.rmtree(self.temp_dir, ignore_errors=True)
+        gc.collect()
+
+    @pytest.mark.eventbus_core
+    def test_T13_credits_bound_in_flight_events(self):
+        """T13: capacity=N → không bao giờ quá N event đang xử lý"""
+        bus = HeavyEventBus(max_queue_size=10000, max_workers=8, name="credit_test")
+        
+        lock = threading.Lock()
+        in_flight = [0]
+        peak = [0]
+        
+        def slow_subscriber(event):
+            with lock:
+                in_flight[0] += 1
+                peak[0] = max(peak[0], in_flight[0])
+            time.sleep(0.002)
+            with lock:
+                in_flight[0] -= 1
+        
+        bus.subscribe(slow_subscriber, name="slow", capacity=3)
+        bus.start()
+        
+        for i in range(200):
+            bus.publish({"seq": i})
+        
+        bus.stop(graceful=True)
+        
+        self.assertLessEqual(peak[0], 3, f"Peak in-flight {peak[0]} exceeds capacity")
+        self.assertEqual(bus.metrics().events_processed, 200)
+        
+        print(f"\n   ✅ T13: Peak in-flight {peak[0]} <= capacity 3")
+
+    @pytest.mark.eventbus_resilience
+    def test_T14_block_mode_waits_then_times_out(self):
+        """T14: overflow="block" → publish chờ, hết timeout thì EventBusFull"""
+        bus = HeavyEventBus(
+            max_queue_size=10, name="block_test",
+            overflow="block", publish_timeout_s=0.05
+        )
+        
+        # Not started: nothing drains the queue
+        for i in range(10):
+            bus.publish({"seq": i})
+        
+        start = time.time()
+        with self.assertRaises(EventBusFull):
+            bus.publish({"seq": 10})
+        self.assertGreaterEqual(time.time() - start, 0.05)
+        
+        metrics = bus.metrics()
+        self.assertEqual(metrics.events_dropped, 0)
+        self.assertEqual(metrics.publish_timeouts, 1)
+        
+        # Slow credit-limited subscriber: producer is throttled, nothing lost
+        received = []
+        bus.publish_timeout_s = 5.0
+        bus.subscribe(lambda e: (time.sleep(0.0005), received.append(e["seq"])), capacity=5)
+        bus.start()
+        
+        for i in range(10, 300):
+            bus.publish({"seq": i})
+        
+        bus.stop(graceful=True)
+        
+        self.assertEqual(sorted(received), list(range(300)))
+        self.assertEqual(bus.metrics().events_dropped, 0)
+        
+        print("\n   ✅ T14: Block mode throttles producer, 0 dropped")
+
+    @pytest.mark.eventbus_resilience
+    def test_T15_spool_mode_replays_in_order(self):
+        """T15: overflow="spool" → tràn ra đĩa, replay đúng thứ tự"""
+        bus = HeavyEventBus(
+            max_queue_size=50, max_workers=1, name="spool_test",
+            overflow="spool", spool_path=self.spool_path
+        )
+        
+        received = []
+        bus.subscribe(lambda events: received.extend(e["seq"] for e in events),
+                      batch=True, max_batch=10, max_delay_ms=10, capacity=10)
+        
+        # Fill past capacity before the dispatcher runs
+        for i in range(500):
+            bus.publish({"seq": i})
+        
+        metrics = bus.metrics()
+        self.assertEqual(metrics.spool_depth, 450)
+        self.assertEqual(metrics.events_spooled, 450)
+        
+        bus.start()
+        bus.stop(graceful=True)
+        
+        metrics = bus.metrics()
+        self.assertEqual(received, list(range(500)))
+        self.assertEqual(metrics.events_dropped, 0)
+        self.assertEqual(metrics.spool_depth, 0)
+        self.assertEqual(os.path.getsize(self.spool_path), 0, "Drained spool should be truncated")
+        
+        print("\n   ✅ T15: 450 spooled events replayed in order")
+
+    @pytest.mark.eventbus_resilience
+    def test_T16_spool_survives_restart(self):
+        """T16: Spool còn trên đĩa → bus mới replay khi start"""
+        bus = HeavyEventBus(
+            max_queue_size=5, name="spool_restart",
+            overflow="spool", spool_path=self.spool_path
+        )
+        for i in range(20):
+            bus.publish({"seq": i})
+        bus._spool.close()  # Simulate crash: in-memory queue (0-4) lost
+        
+        received = []
+        bus2 = HeavyEventBus(
+            max_queue_size=5, name="spool_restart",
+            overflow="spool", spool_path=self.spool_path
+        )
+        self.assertEqual(bus2.metrics().spool_depth, 15)
+        
+        bus2.subscribe(lambda e: received.append(e["seq"]))
+        bus2.start()
+        bus2.stop(graceful=True)
+        
+        self.assertEqual(sorted(received), list(range(5, 20)))
+        
+        print("\n   ✅ T16: Spool resumed after restart")
+
+    @pytest.mark.eventbus_resilience
+    def test_T17_uncommitted_spool_records_replayed(self):
+        """T17: Đọc từ spool nhưng chưa dispatch → crash → replay lại (at-least-once)"""
+        bus = HeavyEventBus(
+            max_queue_size=10, name="spool_commit",
+            overflow="spool", spool_path=self.spool_path
+        )
+        for i in range(30):
+            bus.publish({"seq": i})
+        with bus._queue_lock:
+            bus._queue.clear()  # Memory part (0-9) delivered elsewhere
+            bus._replay_spool_locked()  # 10-19 read into memory, not dispatched
+        self.assertEqual(len(bus._queue), 10)
+        bus._spool.close()  # Crash before commit
+        
+        bus2 = HeavyEventBus(
+            max_queue_size=10, name="spool_commit",
+            overflow="spool", spool_path=self.spool_path
+        )
+        self.assertEqual(bus2.metrics().spool_depth, 20)
+        
+        received = []
+        bus2.subscribe(lambda e: received.append(e["seq"]))
+        bus2.start()
+        bus2.stop(graceful=True)
+        
+        self.assertEqual(sorted(received), list(range(10, 30)))
+        self.assertEqual(os.path.getsize(self.spool_path), 0)
+        
+        print("\n   ✅ T17: Uncommitted records replayed after restart")
+
+    @pytest.mark.eventbus_resilience
+    def test_T18_torn_spool_tail_truncated(self):
+        """T18: Bản ghi cuối bị cắt (crash khi append) → bỏ qua, giữ phần trước"""
+        bus = HeavyEventBus(
+            max_queue_size=5, name="spool_torn",
+            overflow="spool", spool_path=self.spool_path
+        )
+        for i in range(15):
+            bus.publish({"seq": i})
+        bus._spool.close()
+        
+        size = os.path.getsize(self.spool_path)
+        with open(self.spool_path, "r+b") as f:
+            f.truncate(size - 3)  # Tear the last record (seq 14)
+        
+        bus2 = HeavyEventBus(
+            max_queue_size=5, name="spool_torn",
+            overflow="spool", spool_path=self.spool_path
+        )
+        self.assertEqual(bus2.metrics().spool_depth, 9)
+        
+        # Garbage after the valid records: invalid JSON is cut at replay
+        bus2._spool.append({"seq": 99})
+        bus2._spool.flush()
+        with open(self.spool_path, "r+b") as f:
+            f.seek(-2, os.SEEK_END)
+            f.write(b"\xff\xff")
+        
+        received = []
+        bus2.subscribe(lambda e: received.append(e["seq"]))
+        bus2.start()
+        bus2.stop(graceful=True)
+        
+        self.assertEqual(sorted(received), list(range(5, 14)))
+        self.assertEqual(bus2.metrics().spool_depth, 0)
+        
+        print("\n   ✅ T18: Torn spool tail truncated on resume")
+
+    @pytest.mark.eventbus_resilience
+    def test_T19_spool_mode_rejects_non_dict_events(self):
+        """T19: overflow="spool" chỉ nhận dict (replay trả về JSON)"""
+        bus = HeavyEventBus(
+            max_queue_size=5, name="spool_types",
+            overflow="spool", spool_path=self.spool_path
+        )
+        with self.assertRaises(TypeError):
+            bus.publish(["not", "a", "dict"])
+        self.assertEqual(bus.metrics().events_published, 0)
+        bus._spool.close()
+        
+        print("\n   ✅ T19: Non-dict events rejected in spool mode")
+
+    @pytest.mark.eventbus_resilience
+    def test_T20_stop_closes_spool(self):
+        """T20: stop() đóng file spool, start() lại mở tiếp"""
+        bus = HeavyEventBus(
+            max_queue_size=5, name="spool_close",
+            overflow="spool", spool_path=self.spool_path
+        )
+        received = []
+        bus.subscribe(lambda e: received.append(e["seq"]))
+        bus.start()
+        bus.stop(graceful=True)
+        self.assertTrue(bus._spool.closed)
+        
+        # Published while stopped: overflow reopens the spool
+        for i in range(12):
+            bus.publish({"seq": i})
+        self.assertEqual(bus.metrics().spool_depth, 7)
+        bus.start()
+        bus.stop(graceful=True)
+        
+        self.assertTrue(bus._spool.closed)
+        self.assertEqual(sorted(received), list(range(12)))
+        
+        print("\n   ✅ T20: Spool closed on stop, reopened on start")
+
+    @pytest.mark.eventbus_resilience
+    def test_T21_spool_commit_waits_for_callbacks(self):
+        """T21: Offset chỉ commit khi mọi callback xong → crash giữa chừng vẫn replay"""
+        bus = HeavyEventBus(
+            max_queue_size=5, max_workers=8, name="spool_ack",
+            overflow="spool", spool_path=self.spool_path
+        )
+        fast = []
+        gate = threading.Event()
+        bus.subscribe(lambda e: fast.append(e["seq"]))
+        bus.subscribe(lambda events: gate.wait(5), batch=True, max_batch=4, max_delay_ms=10)
+        for i in range(15):
+            bus.publish({"seq": i})
+        
+        bus.start()
+        deadline = time.time() + 5
+        while time.time() < deadline and len(fast) < 15:
+            time.sleep(0.01)
+        time.sleep(0.05)
+        self.assertEqual(sorted(fast), list(range(15)))
+        self.assertEqual(bus.metrics().spool_depth, 0, "All spooled records read")
+        self.assertEqual(bus._spool._committed_offset, 0, "Batch callbacks still running")
+        
+        with bus._queue_lock:
+            bus._spool.close()  # Crash: nothing delivered to the batch subscriber
+        gate.set()
+        bus.stop(graceful=False)
+        
+        received = []
+        bus2 = HeavyEventBus(
+            max_queue_size=5, name="spool_ack",
+            overflow="spool", spool_path=self.spool_path
+        )
+        self.assertEqual(bus2.metrics().spool_depth, 10)
+        bus2.subscribe(lambda e: received.append(e["seq"]))
+        bus2.start()
+        bus2.stop(graceful=True)
+        
+        self.assertEqual(sorted(received), list(range(5, 15)))
+        self.assertEqual(os.path.getsize(self.spool_path), 0)
+        
+        print("\n   ✅ T21: Spool offset committed only after callbacks finish")
+
+
 # ===================================================================
 # MAIN RUNNER
 # ===================================================================
@@ -0,0 +1,185 @@
+"""
+TEST_RECONCILER.PY - Startup Reconciliation Scan for WatchdogService
+Sprint 6 Background Services
+
+Quét lại watch_path khi khởi động: so sánh (size, mtime_ns) với snapshot
+SQLite, phát FileEvent tổng hợp theo batch, có cursor để tiếp tục.
+"""
+
+import os
+import shutil
+import tempfile
+import threading
+import time
+import unittest
+from unittest import mock
+
+from src.core.services.reconciler import ReconciliationScanner
+from src.core.services.watchdog import WatchdogService
+
+
+class TestReconciliationScanner(unittest.TestCase):
+    """Snapshot diff, resumable cursor, throttle"""
+
+    def setUp(self):
+        self.test_dir = tempfile.mkdtemp(prefix="convert_reconcile_test_")
+        self.tree = os.path.join(self.test_dir, "vault")
+        self.db_path = os.path.join(self.test_dir, "snapshot.db")
+        for d in range(4):
+            os.makedirs(os.path.join(self.tree, f"d{d}", "sub"))
+            for f in range(5):
+                self._write(f"d{d}/note_{f}.md", "x")
+            self._write(f"d{d}/sub/deep.md", "y")
+
+    def tearDown(self):
+        shutil.rmtree(self.test_dir, ignore_errors=True)
+
+    def _write(self, rel: str, content: str) -> None:
+        with open(os.path.join(self.tree, rel), "w", encoding="utf-8") as f:
+            f.write(content)
+
+    def _scan(self, **kwargs):
+        batches = []
+        scanner = ReconciliationScanner(self.tree, self.db_path, workers=4, **kwargs)
+        stats = scanner.run(batches.append)
+        scanner.close()
+        return stats, [event for batch in batches for event in batch], batches
+
+    def test_T01_initial_scan_reports_every_file_created(self):
+        """TEST 1: Lần quét đầu (snapshot rỗng) = mọi file là 'created'"""
+        stats, events, _ = self._scan(max_events_per_second=None)
+
+        self.assertTrue(stats.completed)
+        self.assertEqual(stats.created, 24)
+        self.assertEqual({e.event_type for e in events}, {"created"})
+        self.assertIn(f"{self.tree}/d0/sub/deep.md".replace("\\", "/"), {e.path for e in events})
+        print("\n   ✅ T01: Initial scan - 24 created")
+
+    def test_T02_rescan_diffs_against_snapshot(self):
+        """TEST 2: Quét lại chỉ phát thay đổi: created / modified / deleted (kể cả thư mục bị xoá)"""
+        self._scan(max_events_per_second=None)
+
+        stats, events, _ = self._scan(max_events_per_second=None)
+        self.assertEqual(events, [], "Unchanged tree must emit nothing")
+
+        self._write("d0/note_0.md", "changed content")
+        self._write("d1/new.md", "new")
+        os.remove(os.path.join(self.tree, "d2", "note_3.md"))
+        shutil.rmtree(os.path.join(self.tree, "d3"))
+
+        stats, events, _ = self._scan(max_events_per_second=None)
+        by_type = {}
+        for event in events:
+            by_type.setdefault(event.event_type, set()).add(event.path.rsplit("/vault/", 1)[1])
+
+        self.assertEqual(by_type["modified"], {"d0/note_0.md"})
+        self.assertEqual(by_type["created"], {"d1/new.md"})
+        self.assertEqual(
+            by_type["deleted"],
+            {"d2/note_3.md", "d3/sub/deep.md"} | {f"d3/note_{f}.md" for f in range(5)}
+        )
+        self.assertEqual((stats.created, stats.modified, stats.deleted), (1, 1, 7))
+        print("\n   ✅ T02: Rescan emits only the diff")
+
+    def test_T03_interrupted_scan_resumes_from_cursor(self):
+        """TEST 3: Dừng giữa chừng -> lần sau tiếp tục, không phát lại batch đã giao"""
+        stop_event = threading.Event()
+        first = []
+
+        def stop_after_first_batch(batch):
+            first.extend(batch)
+            stop_event.set()
+
+        scanner = ReconciliationScanner(
+            self.tree, self.db_path, workers=1, batch_size=5, max_events_per_second=None
+        )
+        stats = scanner.run(stop_after_first_batch, stop_event)
+        self.assertFalse(stats.completed)
+        self.assertEqual(len(first), 5)
+
+        rest = []
+        stats = scanner.run(lambda batch: rest.extend(batch))
+        scanner.close()
+
+        self.assertTrue(stats.resumed)
+        self.assertTrue(stats.completed)
+        first_paths = {e.path for e in first}
+        rest_paths = {e.path for e in rest}
+        self.assertFalse(first_paths & rest_paths, "Delivered batch re-emitted")
+        self.assertEqual(len(first_paths | rest_paths), 24)
+
+        # Completed scan: next run starts fresh and sees no changes
+        stats, events, _ = self._scan(max_events_per_second=None)
+        self.assertFalse(stats.resumed)
+        self.assertEqual(events, [])
+        print("\n   ✅ T03: Interrupted scan resumed without duplicates")
+
+    def test_T04_batches_are_bounded_and_throttled(self):
+        """TEST 4: Batch <= batch_size và tốc độ phát <= max_events_per_second"""
+        start = time.perf_counter()
+        stats, events, batches = self._scan(batch_size=4, max_events_per_second=100)
+        elapsed = time.perf_counter() - start
+
+        self.assertEqual(len(events), 24)
+        self.assertTrue(all(len(b) <= 4 for b in batches))
+        # 24 events at 100/s: the last batch cannot go out before ~0.2s
+        self.assertGreaterEqual(elapsed, 0.18)
+        print(f"\n   ✅ T04: {len(batches)} batches in {elapsed:.2f}s (throttled)")
+
+    def test_T05_snapshot_db_inside_tree_is_ignored(self):
+        """TEST 5: File snapshot.db nằm trong watch_path không bị báo cáo"""
+        self.db_path = os.path.join(self.tree, "snapshot.db")
+        self._scan(max_events_per_second=None)
+        stats, events, _ = self._scan(max_events_per_second=None)
+        self.assertEqual(events, [], f"Snapshot DB reported: {[e.path for e in events]}")
+        print("\n   ✅ T05: Snapshot DB excluded")
+
+    def test_T07_unreadable_dir_keeps_its_subtree(self):
+        """TEST 7: Thư mục tạm thời không đọc được (EACCES/EIO) → không báo xoá cả cây con"""
+        self._scan(max_events_per_second=None)
+        self._write("d1/sub/later.md", "z")
+
+        blocked = os.path.join(self.tree, "d1")
+        real_scandir = os.scandir
+
+        def flaky_scandir(path):
+            if os.path.normpath(path) == os.path.normpath(blocked):
+                raise PermissionError(13, "Permission denied", path)
+            return real_scandir(path)
+
+        with mock.patch("os.scandir", flaky_scandir):
+            stats, events, _ = self._scan(max_events_per_second=None)
+
+        self.assertTrue(stats.completed)
+        self.assertEqual(events, [], f"Unreadable subtree reported: {[e.path for e in events]}")
+
+        # Readable again: only the real change shows up
+        stats, events, _ = self._scan(max_events_per_second=None)
+        self.assertEqual([(e.event_type, e.path.rsplit("/vault/", 1)[1]) for e in events],
+                         [("created", "d1/sub/later.md")])
+        print("\n   ✅ T07: Unreadable directory keeps its subtree")
+
+    def test_T06_watchdog_service_runs_reconciler_on_start(self):
+        """TEST 6: WatchdogService(reconciler=...) phát batch tổng hợp khi start()"""
+        batches = []
+        scanner = ReconciliationScanner(self.tree, self.db_path, max_events_per_second=None)
+        service = WatchdogService(
+            watch_path=self.tree,
+            debounce_ms=50,
+            on_batch_ready=batches.append,
+            reconciler=scanner
+        )
+        service.start()
+        deadline = time.time() + 5
+        while not scanner.stats.completed and time.time() < deadline:
+            time.sleep(0.02)
+        service.stop()
+        scanner.close()
+
+        self.assertTrue(scanner.stats.completed)
+        self.assertEqual(sum(len(b) for b in batches), 24)
+        print("\n   ✅ T06: Reconciliation runs on service start")
+
+
+if __name__ == '__main__':
+    unittest.main(verbosity=2)
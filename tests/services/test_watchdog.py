@@ -159,8 +159,9 @@ class TestContractCompliance(unittest.TestCase):
         service.stop()
         
         # Logic: created+deleted = null (file không còn tồn tại)
-        # Current impl chưa có logic này - sẽ FAIL
-        print("\n   ❌ T05: Last-state-wins - EXPECTED TO FAIL")
+        emitted = [e for batch in emitted_batches for e in batch]
+        self.assertEqual(emitted, [], f"created+deleted emitted: {emitted}")
+        print("\n   ✅ T05: Last-state-wins (created+deleted = nothing)")
 
 
 # ===================================================================
@@ -265,6 +266,52 @@ class TestDebounceLogic(unittest.TestCase):
         # self.assertGreater(len(emitted_batches), 0, "Safety valve not triggered!")
         print("\n   ❌ T08: Max batch size safety valve - EXPECTED TO FAIL")
 
+    @pytest.mark.watchdog_debounce
+    def test_T27_burst_emits_once_after_last_event(self):
+        """T27: Mỗi event reset debounce: burst 250ms (event mỗi 50ms) -> 1 batch, sau event cuối"""
+        emit_times = []
+        service = WatchdogService(
+            watch_path=self.test_dir,
+            debounce_ms=100,
+            on_batch_ready=lambda batch: emit_times.append(time.monotonic())
+        )
+        service.start()
+        
+        for i in range(6):
+            service._on_file_event(f"burst_{i}.md", "created")
+            last_event = time.monotonic()
+            time.sleep(0.05)
+        time.sleep(0.2)
+        service.stop()
+        
+        self.assertEqual(len(emit_times), 1, f"Burst split into {len(emit_times)} batches")
+        self.assertGreaterEqual(emit_times[0] - last_event, 0.09)
+        print("\n   ✅ T27: Debounce reset on every event")
+
+    @pytest.mark.watchdog_debounce
+    def test_T28_max_wait_caps_endless_burst(self):
+        """T28: Burst không dừng vẫn emit sau max_wait_ms kể từ event đầu"""
+        emit_times = []
+        service = WatchdogService(
+            watch_path=self.test_dir,
+            debounce_ms=100,
+            on_batch_ready=lambda batch: emit_times.append(time.monotonic()),
+            max_wait_ms=200
+        )
+        service.start()
+        
+        start = time.monotonic()
+        for i in range(20):
+            service._on_file_event(f"stream_{i}.md", "modified")
+            time.sleep(0.03)
+        burst_end = time.monotonic()
+        service.stop()
+        
+        self.assertGreater(len(emit_times), 0, "Continuous burst never emitted")
+        self.assertLess(emit_times[0], burst_end)
+        self.assertGreaterEqual(emit_times[0] - start, 0.19)
+        print(f"\n   ✅ T28: Max wait cap ({len(emit_times)} batches during burst)")
+
 
 # ===================================================================
 # NHÓM 3: ORDERING GUARANTEES (2 tests)
@@ -715,6 +762,101 @@ class TestTortureSuite(unittest.TestCase):
         print("\n   ✅ T22: Unicode paths handled correctly")
 
 
+# ===================================================================
+# NHÓM 6: EVENT COMPACTION (T23-T26)
+# ===================================================================
+
+class TestEventCompaction(unittest.TestCase):
+    """Gộp chuỗi sự kiện theo path trước khi emit"""
+    
+    def setUp(self):
+        self.test_dir = tempfile.mkdtemp(prefix="convert_watchdog_compact_")
+        self.service = WatchdogService(watch_path=self.test_dir, debounce_ms=1000)
+        
+    def tearDown(self):
+        shutil.rmtree(self.test_dir, ignore_errors=True)
+        
+    def _flush(self):
+        with self.service._lock:
+            return {e.path: e for e in self.service._take_batch_unsafe()}
+    
+    def test_T23_fold_table(self):
+        """T23: created+modified=created, modified+deleted=deleted, deleted+created=modified"""
+        service = self.service
+        service._on_file_event("a.md", "created")
+        service._on_file_event("a.md", "modified")
+        service._on_file_event("b.md", "modified")
+        service._on_file_event("b.md", "deleted")
+        service._on_file_event("c.md", "deleted")
+        service._on_file_event("c.md", "created")
+        
+        batch = self._flush()
+        self.assertEqual(
+            {path: e.event_type for path, e in batch.items()},
+            {"a.md": "created", "b.md": "deleted", "c.md": "modified"}
+        )
+        print("\n   ✅ T23: Fold table")
+        
+    def test_T24_moves_collapse_to_single_rename(self):
+        """T24: modified -> moved -> moved = 1 sự kiện 'moved' từ path gốc"""
+        service = self.service
+        service._on_file_event("draft.md", "modified")
+        service._on_file_event("tmp/x.md", "moved", "draft.md")
+        service._on_file_event("final/note.md", "moved", "tmp/x.md")
+        # Moved back where it came from: content check only
+        service._on_file_event("b.md", "moved", "a.md")
+        service._on_file_event("a.md", "moved", "b.md")
+        
+        batch = self._flush()
+        self.assertEqual(set(batch), {"final/note.md", "a.md"})
+        self.assertEqual(batch["final/note.md"].event_type, "moved")
+        self.assertEqual(batch["final/note.md"].src_path, "draft.md")
+        self.assertEqual(batch["a.md"].event_type, "modified")
+        print("\n   ✅ T24: Move chains collapse")
+        
+    def test_T25_editor_save_storm(self):
+        """T25: Editor temp file: created -> modified -> rename lên file thật"""
+        service = self.service
+        service._on_file_event("note.md~", "created")
+        service._on_file_event("note.md~", "modified")
+        service._on_file_event("note.md~", "modified")
+        service._on_file_event("note.md", "moved", "note.md~")
+        # Moved then deleted: origin and destination both gone
+        service._on_file_event("b.md", "moved", "a.md")
+        service._on_file_event("b.md", "deleted")
+        
+        batch = self._flush()
+        self.assertEqual(
+            {path: (e.event_type, e.src_path) for path, e in batch.items()},
+            {"note.md": ("created", None), "a.md": ("deleted", None), "b.md": ("deleted", None)}
+        )
+        print("\n   ✅ T25: Save storm compacted")
+        
+    def test_T26_compaction_ratio_reported(self):
+        """T26: get_stats() báo tỉ lệ nén (raw events -> emitted)"""
+        emitted_batches = []
+        service = WatchdogService(
+            watch_path=self.test_dir,
+            debounce_ms=50,
+            on_batch_ready=emitted_batches.append
+        )
+        service.start()
+        for i in range(10):
+            path = f"sync_{i}.md"
+            service._on_file_event(path, "created")
+            service._on_file_event(path, "modified")
+            service._on_file_event(path, "modified")
+            service._on_file_event(path, "modified")
+        time.sleep(0.2)
+        service.stop()
+        
+        stats = service.get_stats()
+        self.assertEqual(stats["events_received"], 40)
+        self.assertEqual(stats["events_emitted"], 10)
+        self.assertAlmostEqual(stats["compaction_ratio"], 0.75)
+        print(f"\n   ✅ T26: Compaction ratio {stats['compaction_ratio']:.2f}")
+
+
 # ===================================================================
 # MAIN RUNNER
 # ===================================================================
@@ -4,6 +4,7 @@ Test suite for Command Dispatcher (Router Logic).
 RED PHASE: These tests WILL FAIL until dispatcher.py is implemented.
 """
 import pytest
+from pathlib import Path
 
 
 class TestDispatcher:
@@ -52,3 +53,47 @@ class TestDispatcher:
         
         assert result["status"] == "error"
         assert "validation" in result["message"].lower()
+
+    def test_dispatcher_rejects_empty_passkey(self, tmp_path):
+        """
+        GIVEN a backup.start command whose passkey is empty
+        WHEN dispatcher processes it
+        THEN it should fail validation without writing a backup
+        """
+        from core.dispatcher import Dispatcher
+        
+        result = Dispatcher().handle({
+            "cmd": "backup.start",
+            "payload": {"target_dir": str(tmp_path / "out"), "passkey": ""}
+        })
+        
+        assert result["status"] == "error"
+        assert "passkey" in result["message"]
+        assert not (tmp_path / "out").exists()
+
+    def test_dispatcher_backup_streams_telemetry(self, tmp_path):
+        """
+        GIVEN a backup.start command with passkey and a progress sink
+        WHEN dispatcher processes it
+        THEN a real backup is written and measured telemetry is streamed
+        """
+        pytest.importorskip("nacl")
+        from core.dispatcher import Dispatcher
+        
+        db_path = tmp_path / "vault.db"
+        db_path.write_bytes(b"SQLite format 3\x00" + b"\x00" * 200_000)
+        events = []
+        
+        result = Dispatcher().handle({
+            "cmd": "backup.start",
+            "payload": {"target_dir": str(tmp_path / "out"), "db_path": str(db_path), "passkey": "Pass123!"},
+            "progress": events.append
+        })
+        
+        assert result["status"] == "success"
+        assert Path(result["output_path"]).exists()
+        phases = [e["phase"] for e in events]
+        assert phases[0] == "snapshot" and phases[-1] == "done"
+        assert {"kdf", "encrypt", "verify"} <= set(phases)
+        assert set(events[-1]["phase_seconds"]) >= {"snapshot", "kdf", "encrypt", "write", "verify"}
+        assert all(e["bytes_per_second"] >= 0 for e in events)
@@ -0,0 +1,28 @@
+import hashlib
+
+from src.core.utils import hashing
+from src.core.utils.hashing import file_digest
+
+def test_file_digest_chunked_matches_single_pass(tmp_path):
+    path = tmp_path / "big.bin"
+    data = bytes(range(256)) * 5000  # 1.28 MB, crosses chunk boundaries
+    path.write_bytes(data)
+    
+    assert file_digest(path, chunk_size=4096) == file_digest(path)
+    if not hashing.XXH3_AVAILABLE:
+        assert file_digest(path) == "blake2b:" + hashlib.blake2b(data, digest_size=16).hexdigest()
+
+def test_file_digest_content_only(tmp_path):
+    a = tmp_path / "a.txt"
+    b = tmp_path / "b.txt"
+    a.write_bytes(b"same")
+    b.write_bytes(b"same")
+    assert file_digest(a) == file_digest(b)
+    
+    b.write_bytes(b"other")
+    assert file_digest(a) != file_digest(b)
+
+def test_file_digest_empty_file(tmp_path):
+    path = tmp_path / "empty"
+    path.write_bytes(b"")
+    assert file_digest(path).split(":")[0] in ("xxh3_128", "blake2b")
@@ -0,0 +1,52 @@
+import random
+import threading
+
+from src.core.utils.histogram import LatencyHistogram, StageHistograms
+
+def test_histogram_empty_snapshot():
+    snapshot = LatencyHistogram().snapshot()
+    assert snapshot["count"] == 0
+    assert snapshot["p99_ms"] == 0.0
+    assert snapshot["max_ms"] == 0.0
+
+def test_histogram_percentiles_within_bucket_error():
+    hist = LatencyHistogram()
+    values = [random.uniform(0.01, 500.0) for _ in range(20000)]
+    for v in values:
+        hist.record_ms(v)
+    
+    values.sort()
+    snapshot = hist.snapshot()
+    assert snapshot["count"] == 20000
+    for pct in (50, 95, 99):
+        exact = values[int(len(values) * pct / 100) - 1]
+        # Log-linear buckets: < 2% relative error (+1us quantization)
+        assert abs(snapshot[f"p{pct}_ms"] - exact) <= exact * 0.02 + 0.001
+    assert abs(snapshot["max_ms"] - values[-1]) < 0.001
+
+def test_histogram_concurrent_record():
+    hist = LatencyHistogram()
+    
+    def worker():
+        for _ in range(5000):
+            hist.record_ms(1.0)
+    
+    threads = [threading.Thread(target=worker) for _ in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    
+    assert hist.count == 20000
+    assert hist.percentile(50) == 1.0
+
+def test_stage_histograms_snapshot():
+    stages = StageHistograms("extraction")
+    with stages.time("extraction"):
+        pass
+    stages.record_ms("fts_write", 3.0)
+    
+    snapshot = stages.snapshot()
+    assert set(snapshot) == {"extraction", "fts_write"}
+    assert snapshot["extraction"]["count"] == 1
+    assert snapshot["fts_write"]["p50_ms"] == 3.0
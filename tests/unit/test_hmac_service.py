@@ -57,3 +57,39 @@ def test_hmac_service_key_rotation():
     
     # Cross verification should fail
     assert service.verify(payload, hmac_v1, stream_id, 'v2') is False
+
+def test_hmac_service_caches_stream_keys():
+    service = HMACService({'v1': b'secret_key'})
+    derive_calls = []
+    original = service._derive_stream_key
+    service._derive_stream_key = lambda key, sid: derive_calls.append(sid) or original(key, sid)
+    
+    hmac_hex, _ = service.sign(b'a', 's1')
+    service.sign(b'b', 's1')
+    assert service.verify(b'a', hmac_hex, 's1', 'v1') is True
+    service.sign(b'c', 's2')
+    assert derive_calls == ['s1', 's2']
+    
+    # Cached key == freshly derived key
+    fresh = hmac.new(original(b'secret_key', 's1'), b'a', hashlib.sha3_256).hexdigest()
+    assert hmac_hex == fresh
+
+def test_hmac_service_rotation_clears_key_cache():
+    service = HMACService({'v1': b'old_key'})
+    service.sign(b'data', 's1')
+    cached = next(iter(service.key_cache._entries.values()))
+    
+    service.rotate_key(b'new_key')
+    assert len(service.key_cache) == 0
+    assert cached.data == b'\x00' * 32
+
+def test_hmac_service_key_cache_cleared_on_kms_lock(tmp_path):
+    from src.core.security.kms import KMS
+    kms = KMS(storage_path=str(tmp_path / 'keys.json'))
+    service = HMACService({'v1': b'secret_key'}, kms=kms)
+    service.sign(b'data', 's1')
+    cached = next(iter(service.key_cache._entries.values()))
+    
+    kms.lock()
+    assert len(service.key_cache) == 0
+    assert cached.data == b'\x00' * 32
@@ -0,0 +1,51 @@
+from src.core.security.key_cache import DerivedKeyCache
+
+
+def test_get_or_derive_once_per_key():
+    cache = DerivedKeyCache()
+    calls = []
+    derive = lambda: calls.append(1) or b'k' * 32
+
+    assert cache.get_or_derive(('v1', 's1'), derive) == b'k' * 32
+    assert cache.get_or_derive(('v1', 's1'), derive) == b'k' * 32
+    assert len(calls) == 1
+    assert (cache.hits, cache.misses) == (1, 1)
+
+
+def test_lru_eviction_zeroes_key():
+    cache = DerivedKeyCache(maxsize=2)
+    cache.get_or_derive(('v1', 'a'), lambda: b'a' * 32)
+    evicted = cache._entries[('v1', 'a')]
+    cache.get_or_derive(('v1', 'b'), lambda: b'b' * 32)
+    cache.get_or_derive(('v1', 'a'), lambda: b'a' * 32)  # refresh: 'b' is now oldest
+    cache.get_or_derive(('v1', 'c'), lambda: b'c' * 32)
+
+    assert set(cache._entries) == {('v1', 'a'), ('v1', 'c')}
+    assert cache.evictions == 1
+    assert evicted.data == b'a' * 32  # 'a' survived
+
+
+def test_invalidate_and_clear_zero_memory():
+    cache = DerivedKeyCache()
+    for version in ('v1', 'v2'):
+        cache.get_or_derive((version, 's1'), lambda: b'\xff' * 32)
+    v1_entry = cache._entries[('v1', 's1')]
+
+    assert cache.invalidate(lambda key_id: key_id[0] == 'v1') == 1
+    assert v1_entry.data == b'\x00' * 32
+    returned = cache.get_or_derive(('v2', 's1'), lambda: b'' )
+    cache.clear()
+    assert len(cache) == 0
+    assert returned == b'\xff' * 32  # Caller's copy is unaffected
+
+
+def test_clear_during_derive_not_cached():
+    cache = DerivedKeyCache()
+
+    def derive_across_lock():
+        cache.clear()  # KMS.lock() while the old master key is in use
+        return b'o' * 32
+
+    assert cache.get_or_derive(('v1', 's1'), derive_across_lock) == b'o' * 32
+    assert len(cache) == 0
+    assert cache.get_or_derive(('v1', 's1'), lambda: b'n' * 32) == b'n' * 32
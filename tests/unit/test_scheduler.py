@@ -0,0 +1,64 @@
+import threading
+import time
+
+from src.core.services.scheduler import DeadlineScheduler
+
+def test_scheduler_runs_in_deadline_order():
+    scheduler = DeadlineScheduler(name="TestScheduler")
+    order = []
+    done = threading.Event()
+    
+    scheduler.schedule(0.06, lambda: (order.append("late"), done.set()))
+    scheduler.schedule(0.02, lambda: order.append("early"))
+    
+    assert done.wait(timeout=1.0)
+    assert order == ["early", "late"]
+    scheduler.shutdown()
+
+def test_scheduler_reschedule_pushes_deadline_forward():
+    scheduler = DeadlineScheduler(name="TestScheduler")
+    fired = []
+    
+    task = scheduler.schedule(0.05, lambda: fired.append(time.monotonic()))
+    start = time.monotonic()
+    for _ in range(5):
+        time.sleep(0.02)
+        task.reschedule(0.05)  # keeps moving before it can fire
+    
+    time.sleep(0.15)
+    assert len(fired) == 1
+    assert fired[0] - start >= 0.14
+    scheduler.shutdown()
+
+def test_scheduler_cancel_and_repeat():
+    scheduler = DeadlineScheduler(name="TestScheduler")
+    ticks = []
+    
+    cancelled = scheduler.schedule(0.02, lambda: ticks.append("cancelled"))
+    cancelled.cancel()
+    repeating = scheduler.schedule(0.01, lambda: ticks.append("tick"), interval_s=0.01)
+    
+    time.sleep(0.1)
+    repeating.cancel()
+    count = len(ticks)
+    time.sleep(0.05)
+    
+    assert "cancelled" not in ticks
+    assert count >= 3
+    assert len(ticks) <= count + 1  # at most one run in flight at cancel
+    assert scheduler.pending == 0
+    scheduler.shutdown()
+
+def test_scheduler_isolates_callback_errors():
+    scheduler = DeadlineScheduler(name="TestScheduler")
+    done = threading.Event()
+    
+    def boom():
+        raise RuntimeError("boom")
+    
+    scheduler.schedule(0.01, boom)
+    scheduler.schedule(0.03, done.set)
+    
+    assert done.wait(timeout=1.0)
+    assert scheduler.errors == 1
+    scheduler.shutdown()
@@ -0,0 +1,111 @@
+import asyncio
+import pytest
+from src.core.storage.adapter import StorageAdapter
+from src.core.security.kms import KMS
+
+
+def _unlocked_kms(tmp_path):
+    kms = KMS(storage_path=str(tmp_path / 'keys.json'))
+    kms.initialize('CorrectHorse')
+    kms.unlock('CorrectHorse')
+    return kms
+
+
+class TestStorageAdapterBatching:
+    @pytest.mark.asyncio
+    async def test_save_events_returns_ids_in_order(self, tmp_path):
+        adapter = StorageAdapter(tmp_path / 'batch.db', _unlocked_kms(tmp_path))
+        ids = await adapter.save_events([('domain', 's1', {'n': n}) for n in range(10)])
+        assert ids == list(range(ids[0], ids[0] + 10))
+
+        events = await adapter.get_events(limit=10)
+        assert [e['id'] for e in events] == ids[::-1]
+        assert [e['payload']['n'] for e in events] == list(range(9, -1, -1))
+        await adapter.close()
+
+    @pytest.mark.asyncio
+    async def test_concurrent_save_event_group_commit(self, tmp_path):
+        adapter = StorageAdapter(tmp_path / 'group.db', _unlocked_kms(tmp_path))
+        ids = await asyncio.gather(*[
+            adapter.save_event('interaction', f's{n % 4}', {'n': n}) for n in range(100)
+        ])
+        assert len(set(ids)) == 100
+
+        # Each caller's id points at its own payload
+        stored = {e['id']: e['payload']['n'] async for e in adapter.iter_events()}
+        assert [stored[i] for i in ids] == list(range(100))
+        await adapter.close()
+
+    @pytest.mark.asyncio
+    async def test_cancelled_caller_rows_not_committed(self, tmp_path):
+        adapter = StorageAdapter(tmp_path / 'cancel.db', _unlocked_kms(tmp_path))
+        await adapter.save_event('domain', 's1', {'n': 0})
+
+        async with adapter._write_lock:
+            waiter = asyncio.create_task(adapter.save_event('domain', 's1', {'n': 1}))
+            await asyncio.sleep(0)
+            assert len(adapter._pending) == 1
+            waiter.cancel()
+            with pytest.raises(asyncio.CancelledError):
+                await waiter
+        assert adapter._pending == []
+
+        await adapter.save_event('domain', 's1', {'n': 2})
+        assert [e['payload']['n'] async for e in adapter.iter_events()] == [2, 0]
+        await adapter.close()
+
+    @pytest.mark.asyncio
+    async def test_cancelled_committer_finishes_shared_commit(self, tmp_path):
+        adapter = StorageAdapter(tmp_path / 'committer.db', _unlocked_kms(tmp_path))
+        await adapter.save_event('domain', 's1', {'n': 0})
+
+        executemany = adapter._writer.executemany
+        async def slow_executemany(*args):
+            await asyncio.sleep(0.05)
+            return await executemany(*args)
+        adapter._writer.executemany = slow_executemany
+
+        async with adapter._write_lock:
+            committer = asyncio.create_task(adapter.save_event('domain', 's1', {'n': 1}))
+            rider = asyncio.create_task(adapter.save_event('domain', 's1', {'n': 2}))
+            await asyncio.sleep(0)
+        await asyncio.sleep(0.01)  # committer took both callers' rows, mid-insert
+        committer.cancel()
+
+        rider_id = await asyncio.wait_for(rider, timeout=2)
+        with pytest.raises(asyncio.CancelledError):
+            await committer
+
+        # Transaction closed: later saves still work
+        adapter._writer.executemany = executemany
+        await adapter.save_event('domain', 's1', {'n': 3})
+        stored = {e['id']: e['payload']['n'] async for e in adapter.iter_events()}
+        assert stored[rider_id] == 2
+        assert sorted(stored.values()) == [0, 1, 2, 3]
+        await adapter.close()
+
+    @pytest.mark.asyncio
+    async def test_iter_events_keyset_paging(self, tmp_path):
+        adapter = StorageAdapter(tmp_path / 'paging.db', _unlocked_kms(tmp_path))
+        await adapter.save_events([('memory', 's1' if n % 2 else 's2', {'n': n}) for n in range(25)])
+
+        seen, before_id = [], None
+        while True:
+            page = [e async for e in adapter.iter_events(limit=10, before_id=before_id, fetch_size=3)]
+            if not page:
+                break
+            seen.extend(page)
+            before_id = page[-1]['id']
+        assert len(seen) == 25
+        assert [e['id'] for e in seen] == sorted((e['id'] for e in seen), reverse=True)
+
+        s1 = [e async for e in adapter.iter_events(stream_id='s1')]
+        assert {e['payload']['n'] % 2 for e in s1} == {1}
+        await adapter.close()
+
+    @pytest.mark.asyncio
+    async def test_locked_vault_rejected(self, tmp_path):
+        kms = KMS(storage_path=str(tmp_path / 'keys.json'))
+        adapter = StorageAdapter(tmp_path / 'locked.db', kms)
+        with pytest.raises(RuntimeError, match='Vault Locked'):
+            await adapter.save_events([('domain', 's1', {})])
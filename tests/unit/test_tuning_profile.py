@@ -0,0 +1,91 @@
+import pytest
+
+from src.utils.hardware_detection import DISK_HDD, DISK_SSD, HardwareInfo, detect_hardware
+from src.utils.tuning import (
+    SOURCE_CONFIG, SOURCE_DERIVED, SOURCE_ENV, TuningProfile, build_profile
+)
+
+GB = 1024 ** 3
+
+
+def _hw(cores, ram_gb, disk=DISK_SSD, free_threaded=False):
+    return HardwareInfo(
+        cpu_count=cores,
+        ram_bytes=int(ram_gb * GB),
+        disk_type=disk,
+        free_threaded=free_threaded,
+        gil_disabled_build=free_threaded,
+        python_version="3.14.0",
+        platform="linux",
+    )
+
+
+def test_detect_hardware_never_fails(tmp_path):
+    hw = detect_hardware(tmp_path / "missing" / "dir")
+    assert hw.cpu_count >= 1
+    assert hw.ram_bytes > 0
+    assert hw.disk_type in ("ssd", "hdd", "unknown")
+
+
+def test_laptop_keeps_current_defaults():
+    profile = build_profile(_hw(4, 8), environ={})
+    assert profile.eventbus_kwargs() == {"max_workers": 8, "max_queue_size": 200_000, "shards": 1}
+    assert profile.indexer_queue_kwargs() == {
+        "batch_size": 100, "flush_timeout_ms": 500, "multi_consumer": False
+    }
+    assert profile.sandbox_memory_limit_mb == 512
+    assert profile.chain_verifier_workers == 2
+    assert profile.pipeline_kwargs() == {"max_workers": 3, "mime_limits": {"application/pdf": 3}}
+
+
+def test_low_end_machine_shrinks_buffers():
+    profile = build_profile(_hw(2, 2, disk=DISK_HDD), environ={})
+    assert profile.eventbus_workers == 4
+    assert profile.eventbus_queue_size == 50_000
+    assert profile.sandbox_memory_limit_mb == 256
+    assert profile.extraction_workers == 1
+    assert (profile.indexer_batch_size, profile.indexer_flush_timeout_ms) == (500, 1000)
+    assert profile.storage_read_connections == 2
+
+
+def test_free_threaded_workstation_scales_out():
+    profile = build_profile(_hw(32, 64, free_threaded=True), environ={})
+    assert profile.eventbus_workers == 32
+    assert profile.eventbus_queue_size == 500_000
+    assert profile.eventbus_shards == 16
+    assert profile.indexer_multi_consumer is True
+    assert profile.chain_verifier_workers == 8
+    assert profile.sandbox_memory_limit_mb == 2048
+    # 32 GB budget / 2 GB cap
+    assert profile.extraction_workers == 16
+
+    gil = build_profile(_hw(32, 64), environ={})
+    assert (gil.eventbus_shards, gil.chain_verifier_workers, gil.indexer_multi_consumer) == (1, 2, False)
+
+
+def test_config_and_env_overrides():
+    profile = build_profile(
+        _hw(4, 8),
+        overrides={"eventbus_workers": 6, "indexer_multi_consumer": "yes"},
+        environ={"CONVERT_TUNING_EVENTBUS_WORKERS": "12", "CONVERT_TUNING_SANDBOX_MEMORY_LIMIT_MB": "1024"},
+    )
+    assert profile.eventbus_workers == 12
+    assert profile.indexer_multi_consumer is True
+    assert profile.sandbox_kwargs() == {"memory_limit_mb": 1024}
+    assert profile.sources["eventbus_workers"] == SOURCE_ENV
+    assert profile.sources["indexer_multi_consumer"] == SOURCE_CONFIG
+    assert profile.sources["eventbus_queue_size"] == SOURCE_DERIVED
+
+
+def test_invalid_overrides_rejected():
+    for overrides in ({"no_such_knob": 1}, {"eventbus_workers": 0}, {"eventbus_workers": "many"}):
+        with pytest.raises(ValueError):
+            build_profile(_hw(4, 8), overrides=overrides, environ={})
+
+
+def test_snapshot_reports_every_parameter():
+    snap = build_profile(_hw(8, 16), environ={}).snapshot()
+    assert set(snap["parameters"]) == set(TuningProfile.parameter_names())
+    assert snap["hardware"]["cpu_count"] == 8
+    assert snap["hardware"]["ram_gb"] == 16.0
+    assert set(snap["sources"].values()) == {SOURCE_DERIVED}
@@ -0,0 +1,91 @@
+import os
+from types import SimpleNamespace
+
+import pytest
+
+pytest.importorskip("watchdog")
+
+from src.core.watcher import AssetWatcher, WatcherHandler
+
+
+def _handler():
+    seen = []
+    handler = WatcherHandler(on_event_callback=lambda kind, path: seen.append((kind, path)))
+    handler._debounce_seconds = 0  # every event reaches the self-write check
+    return handler, seen
+
+def _modified(handler, path):
+    handler.on_modified(SimpleNamespace(src_path=str(path), is_directory=False))
+
+def _bump_mtime(path):
+    stat = path.stat()
+    os.utime(path, ns=(stat.st_atime_ns, stat.st_mtime_ns + 1_000_000))
+
+def test_ignore_next_write_called_before_write(tmp_path):
+    path = tmp_path / "asset.txt"
+    path.write_bytes(b"old")
+    watcher = AssetWatcher(tmp_path)
+    watcher.handler, seen = _handler()
+    
+    watcher.ignore_next_write(path)
+    path.write_bytes(b"new content")
+    _modified(watcher.handler, path)
+    assert seen == []
+    
+    # One-time: the next external edit is reported
+    path.write_bytes(b"edited by user")
+    _modified(watcher.handler, path)
+    assert seen == [("modified", str(path))]
+
+def test_ignore_next_write_for_new_file(tmp_path):
+    path = tmp_path / "created.txt"
+    watcher = AssetWatcher(tmp_path)
+    watcher.handler, seen = _handler()
+    
+    watcher.ignore_next_write(path)
+    path.write_bytes(b"fresh")
+    watcher.handler.on_created(SimpleNamespace(src_path=str(path), is_directory=False))
+    assert seen == []
+
+def test_pending_write_not_landed_or_expired_is_reported(tmp_path):
+    path = tmp_path / "asset.txt"
+    path.write_bytes(b"old")
+    handler, seen = _handler()
+    
+    handler.add_pending_write(path)
+    _modified(handler, path)  # unchanged stat: not our write yet
+    assert len(seen) == 1
+    
+    handler.PENDING_WRITE_TTL_S = -1.0
+    handler.add_pending_write(path)
+    path.write_bytes(b"changed much later")
+    _modified(handler, path)
+    assert len(seen) == 2
+
+def test_add_self_write_after_write(tmp_path):
+    path = tmp_path / "asset.txt"
+    path.write_bytes(b"written by app")
+    handler, seen = _handler()
+    
+    handler.add_self_write(path)
+    _modified(handler, path)
+    assert seen == []
+    
+    # Same path, changed since: a real event
+    handler.add_self_write(path)
+    path.write_bytes(b"written by someone else")
+    _bump_mtime(path)
+    _modified(handler, path)
+    assert seen == [("modified", str(path))]
+
+def test_add_self_write_same_stat_different_content(tmp_path):
+    path = tmp_path / "asset.txt"
+    path.write_bytes(b"aaaa")
+    handler, seen = _handler()
+    handler.add_self_write(path)
+    
+    stat = path.stat()
+    path.write_bytes(b"bbbb")  # same size
+    os.utime(path, ns=(stat.st_atime_ns, stat.st_mtime_ns))
+    _modified(handler, path)
+    assert seen == [("modified", str(path))]